@@ -0,0 +1,211 @@
+//===--- InstructionDecoding.cpp - Instruction decoder benchmark ----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// Measures the throughput of the table-driven instruction decoder by
+// repeatedly decoding a synthesized function body with a mix of
+// control, variable, memory and numeric instructions, or the function
+// bodies of the code section of a real module given with -input.
+//
+//===----------------------------------------------------------------===//
+
+#include <llvm/BinaryFormat/Wasm.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/DiagnosticEngine.h>
+#include <w2n/Basic/LanguageOptions.h>
+#include <w2n/Basic/SourceManager.h>
+#include <w2n/Parse/LEB128.h>
+#include <w2n/Parse/Parser.h>
+
+using namespace w2n;
+
+static llvm::cl::opt<unsigned> NumIterations(
+  "iterations",
+  llvm::cl::desc("Number of times the function body is decoded"),
+  llvm::cl::init(100)
+);
+
+static llvm::cl::opt<unsigned> NumGroups(
+  "groups",
+  llvm::cl::desc("Number of instruction groups in the function body"),
+  llvm::cl::init(10000)
+);
+
+static llvm::cl::opt<std::string> InputFilename(
+  "input",
+  llvm::cl::desc("Decode the code section of a WebAssembly module"),
+  llvm::cl::value_desc("filename")
+);
+
+/// Collects the function bodies of the code section of \p Buffer .
+/// Returns false if the module is malformed.
+static bool collectFunctionBodies(
+  ArrayRef<uint8_t> Buffer, std::vector<ArrayRef<uint8_t>>& Bodies
+) {
+  const uint8_t * Ptr = Buffer.data();
+  const uint8_t * End = Ptr + Buffer.size();
+  // Skip the magic number and the version.
+  if (End - Ptr < 8) {
+    return false;
+  }
+  Ptr += 8;
+  while (Ptr != End) {
+    uint8_t SectionID = *Ptr++;
+    uint32_t SectionSize;
+    unsigned Count = leb128::decodeVaruint32(Ptr, End, SectionSize);
+    if (Count == 0 || (size_t)(End - Ptr - Count) < SectionSize) {
+      return false;
+    }
+    Ptr += Count;
+    const uint8_t * SectionEnd = Ptr + SectionSize;
+    if (SectionID != llvm::wasm::WASM_SEC_CODE) {
+      Ptr = SectionEnd;
+      continue;
+    }
+    uint32_t NumBodies;
+    if ((Count = leb128::decodeVaruint32(Ptr, SectionEnd, NumBodies)) == 0) {
+      return false;
+    }
+    Ptr += Count;
+    for (uint32_t I = 0; I < NumBodies; I++) {
+      uint32_t BodySize;
+      Count = leb128::decodeVaruint32(Ptr, SectionEnd, BodySize);
+      if (Count == 0 || (size_t)(SectionEnd - Ptr - Count) < BodySize) {
+        return false;
+      }
+      Ptr += Count;
+      Bodies.emplace_back(Ptr, BodySize);
+      Ptr += BodySize;
+    }
+    return true;
+  }
+  return true;
+}
+
+/// Appends an instruction group that touches every immediate kind that
+/// can appear in a function body without referring to other sections.
+/// Returns the number of instructions appended.
+static unsigned appendInstructionGroup(std::vector<uint8_t>& Body) {
+  const uint8_t Group[] = {
+    0x20, 0x00,                   // local.get 0
+    0x41, 0xE5, 0x8E, 0x26,       // i32.const 624485
+    0x6A,                         // i32.add
+    0x22, 0x01,                   // local.tee 1
+    0x41, 0x7F,                   // i32.const -1
+    0x71,                         // i32.and
+    0x45,                         // i32.eqz
+    0x1A,                         // drop
+    0x02, 0x40,                   // block
+    0x20, 0x01,                   // local.get 1
+    0x0D, 0x00,                   // br_if 0
+    0x42, 0x80, 0x80, 0x04,       // i64.const 65536
+    0x7A,                         // i64.ctz
+    0xA7,                         // i32.wrap_i64
+    0x21, 0x01,                   // local.set 1
+    0x0B,                         // end
+    0x44, 0x00, 0x00, 0x00, 0x00, // f64.const 1.0
+    0x00, 0x00, 0xF0, 0x3F,
+    0x9F,                         // f64.sqrt
+    0xFC, 0x02,                   // i32.trunc_sat_f64_s
+    0x1A,                         // drop
+    0x01,                         // nop
+  };
+  Body.insert(Body.end(), std::begin(Group), std::end(Group));
+  return 21;
+}
+
+int main(int argc, const char * argv[]) {
+  llvm::InitLLVM X(argc, argv);
+  llvm::cl::ParseCommandLineOptions(
+    argc, argv, "w2n instruction decoder benchmark\n"
+  );
+
+  // locals: 1 entry of 2 x i32.
+  std::vector<uint8_t> Body = {0x01, 0x02, 0x7F};
+  std::unique_ptr<llvm::MemoryBuffer> Input;
+  std::vector<ArrayRef<uint8_t>> Bodies;
+  uint64_t NumInstructions = 0;
+  uint64_t NumBytes = 0;
+
+  if (InputFilename.empty()) {
+    NumInstructions = 1;
+    for (unsigned I = 0; I < NumGroups; I++) {
+      NumInstructions += appendInstructionGroup(Body);
+    }
+    Body.push_back(0x0B); // end
+    Bodies.emplace_back(Body);
+  } else {
+    auto BufferOrErr = llvm::MemoryBuffer::getFile(InputFilename);
+    if (!BufferOrErr) {
+      llvm::errs() << "cannot open " << InputFilename << ": "
+                   << BufferOrErr.getError().message() << "\n";
+      return 1;
+    }
+    Input = std::move(*BufferOrErr);
+    ArrayRef<uint8_t> Buffer(
+      reinterpret_cast<const uint8_t *>(Input->getBufferStart()),
+      Input->getBufferSize()
+    );
+    if (!collectFunctionBodies(Buffer, Bodies)) {
+      llvm::errs() << "malformed module " << InputFilename << "\n";
+      return 1;
+    }
+  }
+  for (auto EachBody : Bodies) {
+    NumBytes += EachBody.size();
+  }
+
+  LanguageOptions LangOpts;
+  SourceManager SourceMgr;
+  DiagnosticEngine Diags(SourceMgr);
+  std::unique_ptr<ASTContext> Context(
+    ASTContext::get(LangOpts, SourceMgr, Diags)
+  );
+
+  using Clock = std::chrono::steady_clock;
+  auto Start = Clock::now();
+  for (unsigned I = 0; I < NumIterations; I++) {
+    for (auto EachBody : Bodies) {
+      if (WasmParser::parseFuncDecl(*Context, EachBody) == nullptr) {
+        llvm::errs() << "failed to decode the function body\n";
+        return 1;
+      }
+    }
+  }
+  auto Duration = Clock::now() - Start;
+  uint64_t Elapsed =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(Duration).count();
+
+  uint64_t TotalBytes = NumBytes * NumIterations;
+  if (NumInstructions != 0) {
+    uint64_t TotalInstructions = NumInstructions * NumIterations;
+    llvm::outs() << "instructions: " << TotalInstructions << "\n"
+                 << "ns/instruction: "
+                 << (double)Elapsed / (double)TotalInstructions << "\n";
+  } else {
+    llvm::outs() << "functions: " << Bodies.size() << "\n";
+  }
+  llvm::outs() << "bytes: " << TotalBytes << "\n"
+               << "elapsed (ms): " << Elapsed / 1000000 << "\n"
+               << "MB/s: "
+               << (double)TotalBytes * 1000.0 / (double)Elapsed << "\n";
+  return 0;
+}
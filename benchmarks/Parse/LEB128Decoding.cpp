@@ -0,0 +1,143 @@
+//===--- LEB128Decoding.cpp - LEB128 decoder benchmark --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// Compares the specialized varuint32 decoder of w2n/Parse/LEB128.h with
+// llvm::decodeULEB128 over a stream of immediates whose encoded sizes
+// follow the distribution found in function bodies: mostly one byte
+// local and label indices, with a tail of wider constants and offsets.
+//
+//===----------------------------------------------------------------===//
+
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/raw_ostream.h>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <w2n/Parse/LEB128.h>
+
+using namespace w2n;
+
+static llvm::cl::opt<unsigned> NumIterations(
+  "iterations",
+  llvm::cl::desc("Number of times the stream is decoded"),
+  llvm::cl::init(100)
+);
+
+static llvm::cl::opt<unsigned> NumValues(
+  "values",
+  llvm::cl::desc("Number of values in the stream"),
+  llvm::cl::init(1000000)
+);
+
+static llvm::cl::opt<unsigned> MultiBytePercentage(
+  "multi-byte-percentage",
+  llvm::cl::desc("Percentage of values encoded with more than one byte"),
+  llvm::cl::init(15)
+);
+
+static std::vector<uint8_t> makeStream() {
+  std::mt19937 Generator(42);
+  std::uniform_int_distribution<unsigned> Percent(0, 99);
+  std::uniform_int_distribution<unsigned> Width(2, 5);
+  std::vector<uint8_t> Stream;
+  uint8_t Buffer[16];
+  for (unsigned I = 0; I < NumValues; I++) {
+    uint32_t Value;
+    if (Percent(Generator) >= MultiBytePercentage) {
+      Value = Generator() & 0x7F;
+    } else {
+      unsigned Bits = 7 * Width(Generator);
+      Value = Bits >= 32 ? Generator() | (1U << 31)
+                         : (Generator() & ((1U << Bits) - 1)) | 0x80;
+    }
+    unsigned Size = llvm::encodeULEB128(Value, Buffer);
+    Stream.insert(Stream.end(), Buffer, Buffer + Size);
+  }
+  return Stream;
+}
+
+template <typename DecoderTy>
+static uint64_t measure(
+  const char * Name, const std::vector<uint8_t>& Stream, DecoderTy Decoder
+) {
+  using Clock = std::chrono::steady_clock;
+  uint64_t Checksum = 0;
+  auto Start = Clock::now();
+  for (unsigned I = 0; I < NumIterations; I++) {
+    const uint8_t * Ptr = Stream.data();
+    const uint8_t * End = Ptr + Stream.size();
+    while (Ptr != End) {
+      uint32_t Value;
+      unsigned Count = Decoder(Ptr, End, Value);
+      if (Count == 0) {
+        llvm::errs() << Name << ": failed to decode the stream\n";
+        return 0;
+      }
+      Checksum += Value;
+      Ptr += Count;
+    }
+  }
+  auto Duration = Clock::now() - Start;
+  uint64_t Elapsed =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(Duration).count();
+  uint64_t TotalValues = (uint64_t)NumValues * NumIterations;
+  llvm::outs() << Name << ":\n"
+               << "  elapsed (ms): " << Elapsed / 1000000 << "\n"
+               << "  ns/value: " << (double)Elapsed / (double)TotalValues
+               << "\n"
+               << "  checksum: " << Checksum << "\n";
+  return Elapsed;
+}
+
+int main(int argc, const char * argv[]) {
+  llvm::InitLLVM X(argc, argv);
+  llvm::cl::ParseCommandLineOptions(
+    argc, argv, "w2n LEB128 decoder benchmark\n"
+  );
+
+  std::vector<uint8_t> Stream = makeStream();
+  llvm::outs() << "values: " << NumValues << "\n"
+               << "bytes: " << Stream.size() << "\n";
+
+  uint64_t Baseline = measure(
+    "llvm::decodeULEB128",
+    Stream,
+    [](const uint8_t * Ptr, const uint8_t * End, uint32_t& Value) {
+      unsigned Count = 0;
+      const char * Error = nullptr;
+      uint64_t Result = llvm::decodeULEB128(Ptr, &Count, End, &Error);
+      if (Error != nullptr || Result > UINT32_MAX) {
+        return 0U;
+      }
+      Value = Result;
+      return Count;
+    }
+  );
+  uint64_t Specialized = measure(
+    "leb128::decodeVaruint32",
+    Stream,
+    [](const uint8_t * Ptr, const uint8_t * End, uint32_t& Value) {
+      return leb128::decodeVaruint32(Ptr, End, Value);
+    }
+  );
+
+  if (Baseline == 0 || Specialized == 0) {
+    return 1;
+  }
+  llvm::outs() << "speedup: " << (double)Baseline / (double)Specialized
+               << "x\n";
+  return 0;
+}
@@ -4,6 +4,9 @@
 #include <llvm/ADT/Optional.h>
 #include <llvm/ADT/SetVector.h>
 #include <llvm/Support/Allocator.h>
+#include <llvm/Support/Mutex.h>
+#include <memory>
+#include <vector>
 #include <w2n/AST/ASTAllocated.h>
 #include <w2n/AST/Decl.h>
 #include <w2n/AST/DiagnosticEngine.h>
@@ -93,12 +96,79 @@ private:
 
   /**
    * @brief Retrieve the allocator for the given arena.
+   *
+   * @note This is the arena of the current task when the current thread
+   * runs within a \c TaskArenas::Scope for this context.
    */
   llvm::BumpPtrAllocator&
   getAllocator(AllocationArena Arena = AllocationArena::Permanent) const;
 
+  /**
+   * @brief Retrieve the lock guarding the uniquing tables.
+   *
+   * @note Tasks on multiple threads may unique the same types or
+   * identifiers, so lookups and insertions must be serialized. The
+   * allocations themselves are not: each task allocates from an arena of
+   * its own.
+   */
+  llvm::sys::SmartMutex<true>& getLock() const;
+
 public:
 
+  /**
+   * @brief The arenas the tasks of a thread pool allocate from.
+   *
+   * @note A task running within a \c Scope allocates from an arena no
+   * other running task uses, without taking any lock. Outside of any
+   * scope, allocations go to the allocator of the context, which only
+   * the thread driving the compilation uses. The context adopts the
+   * arenas when this object is destroyed, which must be after the pool
+   * has finished, so what the tasks allocated lives as long as the
+   * context.
+   */
+  class TaskArenas final {
+    const ASTContext& Ctx;
+
+    /// Guards \c Arenas and \c Idle .
+    llvm::sys::SmartMutex<true> Lock;
+
+    std::vector<std::unique_ptr<llvm::BumpPtrAllocator>> Arenas;
+
+    /// The arenas no running task allocates from.
+    std::vector<llvm::BumpPtrAllocator *> Idle;
+
+  public:
+
+    explicit TaskArenas(const ASTContext& Ctx) : Ctx(Ctx) {
+    }
+
+    TaskArenas(const TaskArenas&) = delete;
+    void operator=(const TaskArenas&) = delete;
+
+    ~TaskArenas();
+
+    /// Makes the allocations the current thread does for the context go
+    /// to an idle arena until the scope ends.
+    class Scope final {
+      TaskArenas& Owner;
+
+      llvm::BumpPtrAllocator * Arena;
+
+      const ASTContext * PreviousCtx;
+
+      llvm::BumpPtrAllocator * PreviousArena;
+
+    public:
+
+      explicit Scope(TaskArenas& Owner);
+
+      Scope(const Scope&) = delete;
+      void operator=(const Scope&) = delete;
+
+      ~Scope();
+    };
+  };
+
   /// Allocate - Allocate memory from the ASTContext bump pointer.
   void * allocate(
     unsigned long Bytes,
@@ -274,6 +344,8 @@ public:
 
   ResultType * getResultType(std::vector<ValueType *> ValueTypes) const;
 
+  /// Returns the uniqued signature from \p Params to \p Returns . Each
+  /// distinct signature gets the next canonical ID when first created.
   FuncType * getFuncType(ResultType * Params, ResultType * Returns) const;
 
   GlobalType * getGlobalType(ValueType * Type, bool IsMutable) const;
@@ -287,6 +359,8 @@ public:
   MemoryType * getMemoryType(LimitsType * Limits) const;
 
   TypeIndexType * getTypeIndexType(uint32_t TypeIndex) const;
+
+  BlockType * getBlockType(BlockType::Types Ty) const;
 };
 
 } // namespace w2n
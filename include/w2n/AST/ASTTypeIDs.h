@@ -23,7 +23,10 @@
 
 namespace w2n {
 
+class CodeDecl;
 class Decl;
+class FuncDecl;
+class Function;
 class ModuleDecl;
 class SourceFile;
 class WasmFile;
@@ -23,6 +23,7 @@ namespace w2n {
 
 class Decl;
 class Expr;
+class InstRef;
 class ModuleDecl;
 class Stmt;
 
@@ -450,6 +451,19 @@ public:
     return Action::createContinue(S);
   }
 
+  /// This method is called for each instruction of an expression that
+  /// is encoded as an \c InstStream . Instructions in a stream have no
+  /// children, so there is no post-visitation counterpart.
+  ///
+  /// \param Inst The instruction to check.
+  ///
+  /// \returns The walking action to perform. By default, this
+  /// is \c Action::Continue().
+  ///
+  virtual PreWalkAction walkToInst(const InstRef& Inst) {
+    return Action::createContinue();
+  }
+
   /// walkToDeclPre - This method is called when first visiting a decl,
   /// before walking into its children.
   ///
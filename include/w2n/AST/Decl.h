@@ -445,16 +445,63 @@ public:
 };
 
 class StartSectionDecl final : public SectionDecl {
+private:
+
+  uint32_t FunctionIndex;
+
+  StartSectionDecl(ASTContext * Ctx, uint32_t FunctionIndex) :
+    SectionDecl(DeclKind::StartSection, Ctx),
+    FunctionIndex(FunctionIndex) {
+  }
+
 public:
 
+  static StartSectionDecl *
+  create(ASTContext& Ctx, uint32_t FunctionIndex) {
+    return new (Ctx) StartSectionDecl(&Ctx, FunctionIndex);
+  }
+
+  /// Returns the index of the function called once the module is
+  /// instantiated.
+  uint32_t getFunctionIndex() const {
+    return FunctionIndex;
+  }
+
   USE_DEFAULT_DECL_IMPL_FOR_PROTOTYPE;
 
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Decl, StartSection);
 };
 
+class ElementSegmentDecl;
+
 class ElementSectionDecl final : public SectionDecl {
+private:
+
+  std::vector<ElementSegmentDecl *> ElementSegments;
+
+  ElementSectionDecl(
+    ASTContext * Ctx, std::vector<ElementSegmentDecl *> ElementSegments
+  ) :
+    SectionDecl(DeclKind::ElementSection, Ctx),
+    ElementSegments(ElementSegments) {
+  }
+
 public:
 
+  static ElementSectionDecl * create(
+    ASTContext& Ctx, std::vector<ElementSegmentDecl *> ElementSegments
+  ) {
+    return new (Ctx) ElementSectionDecl(&Ctx, ElementSegments);
+  }
+
+  std::vector<ElementSegmentDecl *>& getElementSegments() {
+    return ElementSegments;
+  }
+
+  const std::vector<ElementSegmentDecl *>& getElementSegments() const {
+    return ElementSegments;
+  }
+
   USE_DEFAULT_DECL_IMPL_FOR_PROTOTYPE;
 
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Decl, ElementSection);
@@ -609,7 +656,7 @@ private:
   DataSectionDecl(
     ASTContext * Ctx, std::vector<DataSegmentDecl *> DataSegments
   ) :
-    SectionDecl(DeclKind::CodeSection, Ctx),
+    SectionDecl(DeclKind::DataSection, Ctx),
     DataSegments(DataSegments) {
   }
 
@@ -1007,7 +1054,7 @@ private:
   TableType * Type;
 
   TableDecl(ASTContext * Context, TableType * Type) :
-    TypeDecl(DeclKind::Func, Context),
+    TypeDecl(DeclKind::Table, Context),
     Type(Type) {
   }
 
@@ -1032,7 +1079,7 @@ private:
   MemoryType * Type;
 
   MemoryDecl(ASTContext * Context, MemoryType * Type) :
-    TypeDecl(DeclKind::Func, Context),
+    TypeDecl(DeclKind::Memory, Context),
     Type(Type) {
   }
 
@@ -1251,34 +1298,53 @@ public:
 
 class FuncDecl;
 
+/// A function body in the code section.
+///
+/// Only the byte range of the body is recorded while parsing the module.
+/// The body itself is decoded by \c ParseFuncBodyRequest the first time
+/// it is asked for, such that functions that are never emitted or
+/// validated are never decoded.
 class CodeDecl : public TypeDecl {
-  uint32_t Size;
+  friend class ParseFuncBodyRequest;
+  friend class WasmParser;
 
-  FuncDecl * Func;
+  /// The bytes of the function body in the source buffer, right after
+  /// the size prefix.
+  ArrayRef<uint8_t> Body;
 
-  CodeDecl(ASTContext * Context, uint32_t Size, FuncDecl * Func) :
-    TypeDecl(DeclKind::Func, Context),
-    Size(Size),
-    Func(Func) {
+  /// The cached result of \c ParseFuncBodyRequest .
+  mutable FuncDecl * Func = nullptr;
+
+  CodeDecl(ASTContext * Context, ArrayRef<uint8_t> Body) :
+    TypeDecl(DeclKind::Code, Context),
+    Body(Body) {
   }
 
 public:
 
-  static CodeDecl *
-  create(ASTContext& Context, uint32_t Size, FuncDecl * Func) {
-    return new (Context) CodeDecl(&Context, Size, Func);
+  static CodeDecl * create(ASTContext& Context, ArrayRef<uint8_t> Body) {
+    return new (Context) CodeDecl(&Context, Body);
   }
 
   uint32_t getSize() const {
-    return Size;
+    return Body.size();
   }
 
-  FuncDecl * getFunc() {
-    return Func;
+  ArrayRef<uint8_t> getBody() const {
+    return Body;
   }
 
+  /// Returns \c true if the body has already been decoded.
+  bool isParsed() const {
+    return Func != nullptr;
+  }
+
+  /// Returns the decoded function body. The body is decoded on first
+  /// access.
+  FuncDecl * getFunc();
+
   const FuncDecl * getFunc() const {
-    return Func;
+    return const_cast<CodeDecl *>(this)->getFunc();
   }
 
   USE_DEFAULT_DECL_IMPL_FOR_PROTOTYPE;
@@ -1374,10 +1440,12 @@ public:
 class DataSegmentDecl : public TypeDecl {
 protected:
 
-  std::vector<uint8_t> Data;
+  /// The initialization bytes of the segment. Refers to the input buffer
+  /// owned by the \c SourceManager , which outlives the AST.
+  ArrayRef<uint8_t> Data;
 
   DataSegmentDecl(
-    DeclKind Kind, ASTContext * Context, std::vector<uint8_t> Data
+    DeclKind Kind, ASTContext * Context, ArrayRef<uint8_t> Data
   ) :
     TypeDecl(Kind, Context),
     Data(Data) {
@@ -1385,11 +1453,7 @@ protected:
 
 public:
 
-  std::vector<uint8_t>& getData() {
-    return Data;
-  }
-
-  const std::vector<uint8_t>& getData() const {
+  ArrayRef<uint8_t> getData() const {
     return Data;
   }
 
@@ -1411,9 +1475,9 @@ private:
     ASTContext * Context,
     uint32_t MemoryIndex,
     ExpressionDecl * Expression,
-    std::vector<uint8_t> Data
+    ArrayRef<uint8_t> Data
   ) :
-    DataSegmentDecl(DeclKind::DataSegmentPassive, Context, Data),
+    DataSegmentDecl(DeclKind::DataSegmentActive, Context, Data),
     MemoryIndex(MemoryIndex),
     Expression(Expression) {
   }
@@ -1424,7 +1488,7 @@ public:
     ASTContext& Context,
     uint32_t MemoryIndex,
     ExpressionDecl * Expression,
-    std::vector<uint8_t> Data
+    ArrayRef<uint8_t> Data
   ) {
     return new (Context)
       DataSegmentActiveDecl(&Context, MemoryIndex, Expression, Data);
@@ -1451,7 +1515,7 @@ class DataSegmentPassiveDecl : public DataSegmentDecl {
 private:
 
   DataSegmentPassiveDecl(
-    ASTContext * Context, std::vector<uint8_t> Data
+    ASTContext * Context, ArrayRef<uint8_t> Data
   ) :
     DataSegmentDecl(DeclKind::DataSegmentPassive, Context, Data) {
   }
@@ -1459,7 +1523,7 @@ private:
 public:
 
   static DataSegmentPassiveDecl *
-  create(ASTContext& Context, std::vector<uint8_t> Data) {
+  create(ASTContext& Context, ArrayRef<uint8_t> Data) {
     return new (Context) DataSegmentPassiveDecl(&Context, Data);
   }
 
@@ -1468,33 +1532,166 @@ public:
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Decl, DataSegmentPassive);
 };
 
+/// How an element segment is used when a module is instantiated.
+enum class ElementSegmentMode : uint8_t {
+  /// The elements are copied into a table at instantiation.
+  Active,
+
+  /// The elements are only copied into a table by \c table.init .
+  Passive,
+
+  /// The segment only declares the functions \c ref.func may refer to.
+  Declarative,
+};
+
+/// An element segment whose elements are function indices.
+///
+/// The \c ref.func and \c ref.null expressions of the segments of
+/// expressions are decoded into function indices as well.
+class ElementSegmentDecl final : public TypeDecl {
+public:
+
+  /// The function index of a null element.
+  static constexpr uint32_t NullFunction = UINT32_MAX;
+
+private:
+
+  ElementSegmentMode Mode;
+
+  uint32_t TableIndex;
+
+  /// The offset in the table of an active segment.
+  ExpressionDecl * Offset;
+
+  std::vector<uint32_t> FunctionIndices;
+
+  ElementSegmentDecl(
+    ASTContext * Context,
+    ElementSegmentMode Mode,
+    uint32_t TableIndex,
+    ExpressionDecl * Offset,
+    std::vector<uint32_t> FunctionIndices
+  ) :
+    TypeDecl(DeclKind::ElementSegment, Context),
+    Mode(Mode),
+    TableIndex(TableIndex),
+    Offset(Offset),
+    FunctionIndices(FunctionIndices) {
+  }
+
+public:
+
+  static ElementSegmentDecl * createActive(
+    ASTContext& Context,
+    uint32_t TableIndex,
+    ExpressionDecl * Offset,
+    std::vector<uint32_t> FunctionIndices
+  ) {
+    return new (Context) ElementSegmentDecl(
+      &Context,
+      ElementSegmentMode::Active,
+      TableIndex,
+      Offset,
+      FunctionIndices
+    );
+  }
+
+  static ElementSegmentDecl * create(
+    ASTContext& Context,
+    ElementSegmentMode Mode,
+    std::vector<uint32_t> FunctionIndices
+  ) {
+    assert(Mode != ElementSegmentMode::Active && "needs a table");
+    return new (Context)
+      ElementSegmentDecl(&Context, Mode, 0, nullptr, FunctionIndices);
+  }
+
+  ElementSegmentMode getMode() const {
+    return Mode;
+  }
+
+  bool isActive() const {
+    return Mode == ElementSegmentMode::Active;
+  }
+
+  uint32_t getTableIndex() const {
+    return TableIndex;
+  }
+
+  ExpressionDecl * getOffset() {
+    return Offset;
+  }
+
+  const ExpressionDecl * getOffset() const {
+    return Offset;
+  }
+
+  /// Returns the offset of an active segment, if it is an \c i32.const .
+  llvm::Optional<uint32_t> getConstantOffset() const;
+
+  /// Returns the indices of the functions of the elements, which are
+  /// \c NullFunction for the null elements.
+  const std::vector<uint32_t>& getFunctionIndices() const {
+    return FunctionIndices;
+  }
+
+  USE_DEFAULT_DECL_IMPL_FOR_PROTOTYPE;
+
+  LLVM_RTTI_CLASSOF_LEAF_CLASS(Decl, ElementSegment);
+};
+
 class InstNode;
 
+class InstStream;
+
 class ExpressionDecl : public TypeDecl {
 private:
 
-  std::vector<InstNode> Instructions;
+  /// The instructions of the expression, including the terminating
+  /// \c end , allocated in the \c ASTContext arena.
+  ArrayRef<InstNode> Instructions;
 
-  ExpressionDecl(
-    ASTContext * Context, std::vector<InstNode> Instructions
-  ) :
+  /// The compact encoding of the instructions, in place of
+  /// \c Instructions , when \c LanguageOptions::UseCompactInstructions
+  /// is set.
+  InstStream * Stream = nullptr;
+
+  ExpressionDecl(ASTContext * Context, ArrayRef<InstNode> Instructions) :
     TypeDecl(DeclKind::Expression, Context),
     Instructions(Instructions) {
   }
 
+  ExpressionDecl(ASTContext * Context, InstStream * Stream) :
+    TypeDecl(DeclKind::Expression, Context),
+    Stream(Stream) {
+  }
+
 public:
 
+  /// Creates an expression, copying \p Instructions into the arena of
+  /// \p Context .
+  static ExpressionDecl *
+  create(ASTContext& Context, ArrayRef<InstNode> Instructions);
+
   static ExpressionDecl *
-  create(ASTContext& Context, std::vector<InstNode> Instructions) {
-    return new (Context) ExpressionDecl(&Context, Instructions);
+  create(ASTContext& Context, InstStream * Stream) {
+    return new (Context) ExpressionDecl(&Context, Stream);
   }
 
-  std::vector<InstNode>& getInstructions() {
+  ArrayRef<InstNode> getInstructions() const {
     return Instructions;
   }
 
-  const std::vector<InstNode>& getInstructions() const {
-    return Instructions;
+  bool hasInstStream() const {
+    return Stream != nullptr;
+  }
+
+  InstStream * getInstStream() {
+    return Stream;
+  }
+
+  const InstStream * getInstStream() const {
+    return Stream;
   }
 
   USE_DEFAULT_DECL_IMPL_FOR_PROTOTYPE;
@@ -16,6 +16,8 @@
 
 namespace w2n {
 
+enum class Instruction : uint16_t;
+
 enum class ExprKind : uint8_t {
 #define EXPR(Id, Parent) Id,
 #define LAST_EXPR(Id)    Last_Expr = Id,
@@ -167,6 +169,22 @@ public:
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, Drop);
 };
 
+class SelectExpr : public Expr {
+private:
+
+  // FIXME: Can have type since wasm file is one-pass parsable.
+  SelectExpr() : Expr(ExprKind::Select, nullptr) {
+  }
+
+public:
+
+  static SelectExpr * create(ASTContext& Context) {
+    return new (Context) SelectExpr();
+  }
+
+  LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, Select);
+};
+
 class LocalGetExpr : public Expr {
 private:
 
@@ -215,6 +233,30 @@ public:
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, LocalSet);
 };
 
+class LocalTeeExpr : public Expr {
+private:
+
+  uint32_t LocalIndex;
+
+  // FIXME: Can have type since wasm file is one-pass parsable.
+  LocalTeeExpr(uint32_t LocalIndex) :
+    Expr(ExprKind::LocalTee, nullptr),
+    LocalIndex(LocalIndex) {
+  }
+
+public:
+
+  static LocalTeeExpr * create(ASTContext& Context, uint32_t LocalIndex) {
+    return new (Context) LocalTeeExpr(LocalIndex);
+  }
+
+  uint32_t getLocalIndex() const {
+    return LocalIndex;
+  }
+
+  LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, LocalTee);
+};
+
 class GlobalGetExpr : public Expr {
 private:
 
@@ -386,6 +428,36 @@ public:
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, Store);
 };
 
+class MemorySizeExpr : public Expr {
+private:
+
+  MemorySizeExpr(ValueType * Ty) : Expr(ExprKind::MemorySize, Ty) {
+  }
+
+public:
+
+  static MemorySizeExpr * create(ASTContext& Context, ValueType * Ty) {
+    return new (Context) MemorySizeExpr(Ty);
+  }
+
+  LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, MemorySize);
+};
+
+class MemoryGrowExpr : public Expr {
+private:
+
+  MemoryGrowExpr(ValueType * Ty) : Expr(ExprKind::MemoryGrow, Ty) {
+  }
+
+public:
+
+  static MemoryGrowExpr * create(ASTContext& Context, ValueType * Ty) {
+    return new (Context) MemoryGrowExpr(Ty);
+  }
+
+  LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, MemoryGrow);
+};
+
 class ConstExpr : public Expr {
 protected:
 
@@ -458,26 +530,50 @@ public:
     return new (Ctx) FloatConstExpr(Value, Ty);
   }
 
+  llvm::APFloat& getValue() {
+    return Value;
+  }
+
+  const llvm::APFloat& getValue() const {
+    return Value;
+  }
+
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, FloatConst);
 };
 
 class CallBuiltinExpr : public Expr {
+  /// The numeric instruction lowered to the builtin. Several instructions
+  /// share a builtin, e.g. \c i32.eq and \c i64.eq , and differ only by
+  /// their operand types.
+  Instruction Inst;
+
   Identifier BuiltinName;
 
-  CallBuiltinExpr(Identifier BuiltinName, ValueType * Ty) :
+  CallBuiltinExpr(
+    Instruction Inst, Identifier BuiltinName, ValueType * Ty
+  ) :
     Expr(ExprKind::CallBuiltin, Ty),
+    Inst(Inst),
     BuiltinName(BuiltinName) {
   }
 
 public:
 
+  Instruction getInstruction() const {
+    return Inst;
+  }
+
   Identifier getBuiltinName() const {
     return BuiltinName;
   }
 
-  static CallBuiltinExpr *
-  create(ASTContext& Context, Identifier BuiltinName, ValueType * Ty) {
-    return new (Context) CallBuiltinExpr(BuiltinName, Ty);
+  static CallBuiltinExpr * create(
+    ASTContext& Context,
+    Instruction Inst,
+    Identifier BuiltinName,
+    ValueType * Ty
+  ) {
+    return new (Context) CallBuiltinExpr(Inst, BuiltinName, Ty);
   }
 
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Expr, CallBuiltin);
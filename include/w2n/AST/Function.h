@@ -13,6 +13,7 @@
 
 namespace w2n {
 class ASTContext;
+class FunctionValidation;
 
 /**
  * @brief Represents a function or the init procedure of a global in
@@ -26,6 +27,8 @@ class ASTContext;
 class Function :
   public llvm::ilist_node<Function>,
   public ASTAllocated<Function> {
+  friend class ValidateFunctionRequest;
+
 public:
 
   enum class FunctionKind {
@@ -48,19 +51,29 @@ private:
   /// a \c FuncTypeDecl in-place.
   FuncTypeDecl * Type;
 
+  /// The function body in the code section. \c nullptr for global
+  /// inits.
+  CodeDecl * Code;
+
   /// @note: Global variable's init expression does not have locals.
   std::vector<LocalDecl *> Locals;
 
+  /// The init expression of a global. \c nullptr for functions, whose
+  /// expression is decoded on demand from \c Code .
   ExpressionDecl * Expression;
 
   bool Exported;
 
+  /// The cached result of \c ValidateFunctionRequest .
+  mutable FunctionValidation * Validation = nullptr;
+
   Function(
     ModuleDecl * Module,
     FunctionKind Kind,
     uint32_t Index,
     llvm::Optional<Identifier> Name,
     FuncTypeDecl * Type,
+    CodeDecl * Code,
     std::vector<LocalDecl *> Locals,
     ExpressionDecl * Expression,
     bool IsExported
@@ -70,6 +83,7 @@ private:
     Index(Index),
     Name(Name),
     Type(Type),
+    Code(Code),
     Locals(Locals),
     Expression(Expression),
     Exported(IsExported) {
@@ -85,18 +99,18 @@ public:
     uint32_t Index,
     llvm::Optional<Identifier> Name,
     FuncTypeDecl * Type,
-    std::vector<LocalDecl *> Locals,
-    ExpressionDecl * Expression,
+    CodeDecl * Code,
     bool IsExported
   ) {
-    return new (Expression->getASTContext()) Function(
+    return new (Code->getASTContext()) Function(
       Module,
       FunctionKind::Function,
       Index,
       Name,
       Type,
-      Locals,
-      Expression,
+      Code,
+      {},
+      nullptr,
       IsExported
     );
   }
@@ -129,20 +143,38 @@ public:
     return Type;
   }
 
+  CodeDecl * getCode() {
+    return Code;
+  }
+
+  const CodeDecl * getCode() const {
+    return Code;
+  }
+
+  /// Returns the locals of the function. Decodes the function body if it
+  /// has not been decoded yet.
   std::vector<LocalDecl *>& getLocals() {
+    if (Code != nullptr) {
+      return Code->getFunc()->getLocals();
+    }
     return Locals;
   }
 
   const std::vector<LocalDecl *>& getLocals() const {
-    return Locals;
+    return const_cast<Function *>(this)->getLocals();
   }
 
+  /// Returns the expression of the function. Decodes the function body if
+  /// it has not been decoded yet.
   ExpressionDecl * getExpression() {
+    if (Code != nullptr) {
+      return Code->getFunc()->getExpression();
+    }
     return Expression;
   }
 
   const ExpressionDecl * getExpression() const {
-    return Expression;
+    return const_cast<Function *>(this)->getExpression();
   }
 
   llvm::Optional<Identifier> getName() {
@@ -176,11 +208,14 @@ public:
   }
 
   DeclContext * getDeclContext() const {
-    return getExpression()->getDeclContext();
+    if (Code != nullptr) {
+      return Code->getDeclContext();
+    }
+    return Expression->getDeclContext();
   }
 
   ASTContext& getASTContext() const {
-    return getExpression()->getASTContext();
+    return Module->getASTContext();
   }
 
   ModuleDecl * getModule() {
@@ -211,6 +246,10 @@ public:
   void dump(raw_ostream& OS, unsigned Indent = 0) const;
 };
 
+void simple_display(llvm::raw_ostream& OS, const Function * Fn);
+
+SourceLoc extractNearestSourceLoc(const Function * Fn);
+
 } // namespace w2n
 
 //===----------------------------------------------------------------------===//
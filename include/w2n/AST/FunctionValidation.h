@@ -0,0 +1,47 @@
+#ifndef W2N_AST_FUNCTIONVALIDATION_H
+#define W2N_AST_FUNCTIONVALIDATION_H
+
+#include <llvm/ADT/StringRef.h>
+#include <w2n/AST/ASTAllocated.h>
+#include <w2n/AST/ASTContext.h>
+
+namespace w2n {
+
+/**
+ * @brief The result of validating the body of a function or the init
+ * expression of a global, computed by \c ValidateFunctionRequest .
+ *
+ * IR generation only emits valid bodies, and reuses the cached result
+ * instead of validating them again.
+ */
+class FunctionValidation : public ASTAllocated<FunctionValidation> {
+  /// The reason why the body is invalid. Empty for a valid body.
+  StringRef Error;
+
+  FunctionValidation(StringRef Error) : Error(Error) {
+  }
+
+public:
+
+  static FunctionValidation * createValid(ASTContext& Ctx) {
+    return new (Ctx) FunctionValidation(StringRef());
+  }
+
+  static FunctionValidation *
+  createInvalid(ASTContext& Ctx, StringRef Error) {
+    assert(!Error.empty() && "invalid body without a reason");
+    return new (Ctx) FunctionValidation(Ctx.allocateCopy(Error));
+  }
+
+  bool isValid() const {
+    return Error.empty();
+  }
+
+  StringRef getError() const {
+    return Error;
+  }
+};
+
+} // namespace w2n
+
+#endif // W2N_AST_FUNCTIONVALIDATION_H
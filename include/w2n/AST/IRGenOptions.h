@@ -42,6 +42,38 @@ enum class IRGenEmbedMode : unsigned {
   EmbedBitcode
 };
 
+/// How the accesses to a linear memory are kept in its bounds.
+enum class IRGenMemoryBoundsChecks : unsigned {
+  /// Use guard pages on targets with a 64-bit address space, and explicit
+  /// checks on the others.
+  Automatic,
+
+  /// Reserve the whole 4 GiB a wasm32 address can reach plus a guard
+  /// region, and leave the pages past the end of the memory
+  /// inaccessible. Accesses are not checked and out-of-bounds accesses
+  /// fault into the trap handler of the runtime.
+  GuardPages,
+
+  /// Compare the end of every access with the size of the memory and
+  /// trap when it is out of bounds. Only the size of the memory is
+  /// reserved, which suits constrained address spaces.
+  Explicit,
+};
+
+/// Where the code addressing a linear memory finds its base.
+enum class IRGenMemoryBase : unsigned {
+  /// Load the base from the descriptor of the memory into a register and
+  /// add the effective address to it.
+  Register,
+
+  /// Let the runtime hold the base in a segment register of the thread,
+  /// and access the memory with addresses relative to the segment. This
+  /// frees the register holding the base in every function. Only
+  /// targets with a \c WasmTargetInfo::MemorySegmentAddressSpace support
+  /// it, and the others fall back to \c Register .
+  Segment,
+};
+
 class IRGenOptions {
 public:
 
@@ -84,9 +116,32 @@ public:
 
   unsigned EnableStackProtection : 1;
 
+  /// The number of threads for multi-threaded IR generation and code
+  /// generation. Zero means that everything is done on the calling
+  /// thread, into a single LLVM module.
+  unsigned NumThreads = 0;
+
+  /// The number of partitions the optimized LLVM module is split into
+  /// for code generation, each compiled on its own thread. Zero or one
+  /// means that the module is compiled as a whole.
+  unsigned CodeGenPartitions = 0;
+
+  /// The approximate number of bytes of Wasm code emitted into each LLVM
+  /// module in multi-threaded IR generation.
+  uint64_t IRGenPartitionSize = 64 * 1024;
+
+  IRGenMemoryBoundsChecks MemoryBoundsChecks =
+    IRGenMemoryBoundsChecks::Automatic;
+
+  IRGenMemoryBase MemoryBase = IRGenMemoryBase::Register;
+
   bool shouldOptimize() const {
     return OptMode > OptimizationMode::NoOptimization;
   }
+
+  bool shouldPerformIRGenerationInParallel() const {
+    return NumThreads != 0;
+  }
 };
 
 } // namespace w2n
@@ -0,0 +1,369 @@
+//===--- InstStream.h - Compact Instruction Streams -------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// This file defines InstStream, a flat structure-of-arrays encoding of
+// the instructions of an expression, as an alternative to one Expr or
+// Stmt node per instruction.
+//
+// An instruction occupies one slot in each of three parallel arrays:
+//
+//  - Opcodes: the \c Instruction .
+//  - Immediates: the immediate itself when it fits in 32 bits, otherwise
+//    the offset of its words in the operand pool.
+//  - Matches: for \c block , \c loop and \c if , the index of the
+//    matching \c else or \c end ; for \c else , the index of the matching
+//    \c end . Other instructions do not use their slot.
+//
+// All arrays are allocated in the ASTContext arena.
+//
+//===----------------------------------------------------------------===//
+
+#ifndef W2N_AST_INSTSTREAM_H
+#define W2N_AST_INSTSTREAM_H
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <cstdint>
+#include <w2n/AST/ASTAllocated.h>
+#include <w2n/AST/Expr.h>
+#include <w2n/AST/Instructions.h>
+#include <w2n/AST/Type.h>
+
+namespace w2n {
+
+class ASTContext;
+class InstStream;
+
+/// Marks the \c Matches slot of an instruction that does not open or
+/// continue a structured instruction.
+constexpr uint32_t NoMatchingInst = UINT32_MAX;
+
+/// A lightweight reference to an instruction of an \c InstStream .
+class InstRef {
+  const InstStream * Stream;
+
+  uint32_t Index;
+
+public:
+
+  InstRef(const InstStream * Stream, uint32_t Index) :
+    Stream(Stream),
+    Index(Index) {
+  }
+
+  uint32_t getIndex() const {
+    return Index;
+  }
+
+  inline Instruction getOpcode() const;
+
+  inline const InstInfo& getInfo() const;
+
+  /// Returns the label, function, local or global index of the
+  /// instruction, the type index of a \c call_indirect , or the default
+  /// label of a \c br_table .
+  inline uint32_t getIndexImmediate() const;
+
+  /// Returns the table index of a \c call_indirect .
+  inline uint32_t getTableIndex() const;
+
+  /// Returns the label indices of a \c br_table , excluding the default
+  /// label.
+  inline ArrayRef<uint32_t> getLabelTable() const;
+
+  inline BlockType * getBlockType() const;
+
+  inline MemoryArgument getMemArg() const;
+
+  /// Returns the bits of an integer or a floating-point constant.
+  inline uint64_t getBits() const;
+
+  /// Returns the index of the matching \c else or \c end of a structured
+  /// instruction.
+  inline uint32_t getMatch() const;
+
+  bool operator==(const InstRef& Other) const {
+    return Stream == Other.Stream && Index == Other.Index;
+  }
+
+  bool operator!=(const InstRef& Other) const {
+    return !(*this == Other);
+  }
+};
+
+class InstStream : public ASTAllocated<InstStream> {
+  friend class InstRef;
+  friend class InstStreamBuilder;
+
+  ArrayRef<Instruction> Opcodes;
+
+  ArrayRef<uint32_t> Immediates;
+
+  ArrayRef<uint32_t> Matches;
+
+  /// Immediates that do not fit in a single 32-bit slot.
+  ArrayRef<uint32_t> Operands;
+
+  ArrayRef<BlockType *> BlockTypes;
+
+  InstStream(
+    ArrayRef<Instruction> Opcodes,
+    ArrayRef<uint32_t> Immediates,
+    ArrayRef<uint32_t> Matches,
+    ArrayRef<uint32_t> Operands,
+    ArrayRef<BlockType *> BlockTypes
+  ) :
+    Opcodes(Opcodes),
+    Immediates(Immediates),
+    Matches(Matches),
+    Operands(Operands),
+    BlockTypes(BlockTypes) {
+  }
+
+public:
+
+  class iterator {
+    const InstStream * Stream;
+    uint32_t Index;
+
+  public:
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = InstRef;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = InstRef;
+
+    iterator(const InstStream * Stream, uint32_t Index) :
+      Stream(Stream),
+      Index(Index) {
+    }
+
+    InstRef operator*() const {
+      return InstRef(Stream, Index);
+    }
+
+    iterator& operator++() {
+      Index++;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator Copy = *this;
+      Index++;
+      return Copy;
+    }
+
+    bool operator==(const iterator& Other) const {
+      return Index == Other.Index;
+    }
+
+    bool operator!=(const iterator& Other) const {
+      return Index != Other.Index;
+    }
+  };
+
+  uint32_t size() const {
+    return Opcodes.size();
+  }
+
+  bool empty() const {
+    return Opcodes.empty();
+  }
+
+  iterator begin() const {
+    return iterator(this, 0);
+  }
+
+  iterator end() const {
+    return iterator(this, size());
+  }
+
+  InstRef operator[](uint32_t Index) const {
+    assert(Index < size() && "instruction index out of range");
+    return InstRef(this, Index);
+  }
+
+  ArrayRef<Instruction> getOpcodes() const {
+    return Opcodes;
+  }
+
+  /// Returns the number of bytes held by the stream in the arena.
+  size_t getMemoryUsage() const;
+};
+
+/// Accumulates instructions in scratch buffers and copies them into the
+/// \c ASTContext arena at once when finished.
+class InstStreamBuilder {
+  llvm::SmallVector<Instruction, 64> Opcodes;
+
+  llvm::SmallVector<uint32_t, 64> Immediates;
+
+  llvm::SmallVector<uint32_t, 64> Matches;
+
+  llvm::SmallVector<uint32_t, 16> Operands;
+
+  llvm::SmallVector<BlockType *, 8> BlockTypes;
+
+  /// Indices of the structured instructions that are not terminated yet.
+  llvm::SmallVector<uint32_t, 16> ControlStack;
+
+  uint32_t append(Instruction Opcode, uint32_t Immediate) {
+    uint32_t Index = Opcodes.size();
+    Opcodes.push_back(Opcode);
+    Immediates.push_back(Immediate);
+    Matches.push_back(NoMatchingInst);
+    return Index;
+  }
+
+  uint32_t appendOperand(uint32_t Word) {
+    uint32_t Offset = Operands.size();
+    Operands.push_back(Word);
+    return Offset;
+  }
+
+public:
+
+  /// Appends an instruction whose immediate fits in 32 bits, including
+  /// \c else and \c end which are matched with the innermost structured
+  /// instruction.
+  void add(Instruction Opcode, const InstInfo& Info, uint32_t Immediate);
+
+  void addBlock(Instruction Opcode, BlockType * Ty);
+
+  void addBrTable(ArrayRef<uint32_t> Labels, uint32_t DefaultLabel);
+
+  void addCallIndirect(
+    Instruction Opcode, uint32_t TypeIndex, uint32_t TableIndex
+  );
+
+  void addMemoryAccess(Instruction Opcode, MemoryArgument MemArg);
+
+  void add64(Instruction Opcode, uint64_t Bits);
+
+  /// Returns the current nesting level of structured instructions. The
+  /// expression ends at the \c end decoded at level zero.
+  uint32_t getDepth() const {
+    return ControlStack.size();
+  }
+
+  uint32_t size() const {
+    return Opcodes.size();
+  }
+
+  /// Copies the instructions into the arena of \p Ctx and resets the
+  /// builder for reuse.
+  InstStream * finish(ASTContext& Ctx);
+};
+
+#pragma mark - InstRef Inline Implementations
+
+Instruction InstRef::getOpcode() const {
+  return Stream->Opcodes[Index];
+}
+
+const InstInfo& InstRef::getInfo() const {
+  return getInstInfo(getOpcode());
+}
+
+uint32_t InstRef::getIndexImmediate() const {
+  switch (getInfo().Immediate) {
+  case InstImmediateKind::LabelIdx:
+  case InstImmediateKind::FuncIdx:
+  case InstImmediateKind::LocalIdx:
+  case InstImmediateKind::GlobalIdx:
+    return Stream->Immediates[Index];
+  case InstImmediateKind::LabelTable:
+    return Stream->Operands[Stream->Immediates[Index] + 1];
+  case InstImmediateKind::TypeAndTableIdx:
+    return Stream->Operands[Stream->Immediates[Index]];
+  default: llvm_unreachable("instruction has no index immediate");
+  }
+}
+
+uint32_t InstRef::getTableIndex() const {
+  assert(getInfo().Immediate == InstImmediateKind::TypeAndTableIdx);
+  return Stream->Operands[Stream->Immediates[Index] + 1];
+}
+
+ArrayRef<uint32_t> InstRef::getLabelTable() const {
+  assert(getInfo().Immediate == InstImmediateKind::LabelTable);
+  uint32_t Offset = Stream->Immediates[Index];
+  return Stream->Operands.slice(Offset + 2, Stream->Operands[Offset]);
+}
+
+BlockType * InstRef::getBlockType() const {
+  assert(getInfo().Immediate == InstImmediateKind::BlockType);
+  return Stream->BlockTypes[Stream->Immediates[Index]];
+}
+
+MemoryArgument InstRef::getMemArg() const {
+  assert(getInfo().Immediate == InstImmediateKind::MemArg);
+  uint32_t Offset = Stream->Immediates[Index];
+  return MemoryArgument{
+    Stream->Operands[Offset], Stream->Operands[Offset + 1]};
+}
+
+uint64_t InstRef::getBits() const {
+  switch (getInfo().Immediate) {
+  case InstImmediateKind::I32:
+  case InstImmediateKind::F32: return Stream->Immediates[Index];
+  case InstImmediateKind::I64:
+  case InstImmediateKind::F64: {
+    uint32_t Offset = Stream->Immediates[Index];
+    return (uint64_t)Stream->Operands[Offset]
+         | ((uint64_t)Stream->Operands[Offset + 1] << 32);
+  }
+  default: llvm_unreachable("instruction has no constant immediate");
+  }
+}
+
+uint32_t InstRef::getMatch() const {
+  return Stream->Matches[Index];
+}
+
+#pragma mark - InstStreamVisitor
+
+/// Dispatches the instructions of an \c InstStream on their
+/// \c InstNodeKind , mirroring \c ASTVisitor for \c Expr and \c Stmt
+/// nodes.
+template <typename ImplClass, typename RetTy = void>
+class InstStreamVisitor {
+public:
+
+  RetTy visit(InstRef Inst) {
+    switch (Inst.getInfo().Node) {
+#define INST_NODE_KIND(Id)                                               \
+  case InstNodeKind::Id:                                                 \
+    return static_cast<ImplClass *>(this)->visit##Id##Inst(Inst);
+#include <w2n/AST/InstNodeKinds.def>
+    case InstNodeKind::Invalid: break;
+    }
+    llvm_unreachable("invalid instruction in stream");
+  }
+
+  RetTy visitInst(InstRef Inst) {
+    return RetTy();
+  }
+
+#define INST_NODE_KIND(Id)                                               \
+  RetTy visit##Id##Inst(InstRef Inst) {                                  \
+    return static_cast<ImplClass *>(this)->visitInst(Inst);              \
+  }
+#include <w2n/AST/InstNodeKinds.def>
+};
+
+} // namespace w2n
+
+#endif // W2N_AST_INSTSTREAM_H
@@ -1,15 +1,120 @@
 #ifndef W2N_AST_INSTRUCTIONS_H
 #define W2N_AST_INSTRUCTIONS_H
 
+#include <array>
 #include <cstdint>
+#include <w2n/AST/Builtins.h>
+#include <w2n/AST/Type.h>
 
 namespace w2n {
 
-enum class Instruction : uint8_t {
-#define INST(Id, Opcode0, ...) Id = Opcode0,
-#include <w2n/ASt/Instructions.def>
+/// The \c Pops or \c Pushes of an instruction whose stack effect depends
+/// on a type index, a block type or the enclosing control frame.
+constexpr uint8_t DynamicArity = 0xFF;
+
+/// The prefix bytes of multi-byte opcodes.
+enum class InstPrefix : uint8_t {
+  None = 0x00,
+  Misc = 0xFC,
+  Vector = 0xFD,
+};
+
+enum class Instruction : uint16_t {
+#define INST(Id, Prefix, Opcode, ...) Id = ((Prefix) << 8) | (Opcode),
+#include <w2n/AST/Instructions.def>
+};
+
+/// The kinds of immediates following an opcode.
+enum class InstImmediateKind : uint8_t {
+  None,
+  BlockType,
+  LabelIdx,
+  /// \c vec(labelidx) followed by the default \c labelidx .
+  LabelTable,
+  FuncIdx,
+  /// \c typeidx followed by \c tableidx .
+  TypeAndTableIdx,
+  LocalIdx,
+  GlobalIdx,
+  MemArg,
+  /// A reserved \c 0x00 byte standing for the memory index.
+  MemIdx,
+  I32,
+  I64,
+  F32,
+  F64,
+};
+
+/// The kinds of AST nodes an instruction decodes into.
+enum class InstNodeKind : uint8_t {
+  /// Marks table entries of opcodes that are not supported.
+  Invalid = 0,
+#define INST_NODE_KIND(Id) Id,
+#include <w2n/AST/InstNodeKinds.def>
+};
+
+/// Decoding metadata of an instruction. See \file Instructions.def for
+/// the meaning of each field.
+struct InstInfo {
+  InstNodeKind Node = InstNodeKind::Invalid;
+  InstImmediateKind Immediate = InstImmediateKind::None;
+  BuiltinValueKind Builtin = BuiltinValueKind::None;
+  ValueTypeKind OperandType = ValueTypeKind::None;
+  ValueTypeKind ResultType = ValueTypeKind::None;
+  ValueTypeKind MemoryType = ValueTypeKind::None;
+  uint8_t Pops = 0;
+  uint8_t Pushes = 0;
+  const char * Name = nullptr;
+
+  constexpr bool isValid() const {
+    return Node != InstNodeKind::Invalid;
+  }
+
+  constexpr bool hasDynamicArity() const {
+    return Pops == DynamicArity || Pushes == DynamicArity;
+  }
 };
 
+/// A dense decode table indexed by an opcode byte.
+using InstTable = std::array<InstInfo, 256>;
+
+/// Decode tables of single-byte opcodes, and of sub-opcodes following the
+/// \c 0xFC and \c 0xFD prefixes, generated from \file Instructions.def .
+extern const InstTable SingleByteInstTable;
+extern const InstTable MiscInstTable;
+extern const InstTable VectorInstTable;
+
+/// Returns the metadata of a single-byte opcode. The result is invalid
+/// for prefixes and unsupported opcodes.
+inline const InstInfo& getInstInfo(uint8_t Opcode) {
+  return SingleByteInstTable[Opcode];
+}
+
+/// Returns the metadata of the sub-opcode of a prefixed opcode. The
+/// result is invalid for unsupported sub-opcodes.
+inline const InstInfo&
+getPrefixedInstInfo(InstPrefix Prefix, uint32_t Opcode) {
+  static const InstInfo Invalid;
+  if (Opcode >= std::tuple_size<InstTable>::value) {
+    return Invalid;
+  }
+  switch (Prefix) {
+  case InstPrefix::Misc: return MiscInstTable[Opcode];
+  case InstPrefix::Vector: return VectorInstTable[Opcode];
+  case InstPrefix::None: return Invalid;
+  }
+  return Invalid;
+}
+
+inline const InstInfo& getInstInfo(Instruction Inst) {
+  uint8_t Prefix = (uint16_t)Inst >> 8;
+  uint8_t Opcode = (uint16_t)Inst & 0xFF;
+  if (Prefix == (uint8_t)InstPrefix::None) {
+    return getInstInfo(Opcode);
+  }
+  return getPrefixedInstInfo((InstPrefix)Prefix, Opcode);
+}
+
 } // namespace w2n
 
-#endif // W2N_AST_INSTRUCTIONS_H
\ No newline at end of file
+#endif // W2N_AST_INSTRUCTIONS_H
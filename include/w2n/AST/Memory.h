@@ -2,10 +2,16 @@
 #define W2N_AST_MEMORY_H
 
 #include <llvm/ADT/ilist.h>
+#include <cstdint>
+#include <string>
 #include <w2n/AST/ASTAllocated.h>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Type.h>
 
 namespace w2n {
 
+class ModuleDecl;
+
 /**
  * @brief Represents a memory in WebAssembly.
  *
@@ -17,10 +23,79 @@ namespace w2n {
 class Memory :
   public llvm::ilist_node<Memory>,
   public ASTAllocated<Memory> {
+private:
+
+  ModuleDecl * Module;
+  uint32_t Index;
+  MemoryType * Ty;
+  bool IsExported;
+  MemoryDecl * Decl;
+
+  Memory(
+    ModuleDecl * Module,
+    uint32_t Index,
+    MemoryType * Ty,
+    bool IsExported,
+    MemoryDecl * Decl
+  );
+
 public:
 
+  static Memory * create(
+    ModuleDecl * Module,
+    uint32_t Index,
+    MemoryType * Ty,
+    bool IsExported,
+    MemoryDecl * Decl
+  );
+
   ~Memory() {
   }
+
+  ModuleDecl * getModule() {
+    return Module;
+  }
+
+  const ModuleDecl * getModule() const {
+    return Module;
+  }
+
+  uint32_t getIndex() const {
+    return Index;
+  }
+
+  MemoryType * getType() const {
+    return Ty;
+  }
+
+  /// Returns the initial size of the memory in pages.
+  uint64_t getMinPages() const {
+    return Ty->getLimits()->getMin();
+  }
+
+  /// Returns the maximum size of the memory in pages, if any.
+  llvm::Optional<uint64_t> getMaxPages() const {
+    return Ty->getLimits()->getMax();
+  }
+
+  bool isExported() const {
+    return IsExported;
+  }
+
+  MemoryDecl * getDecl() {
+    return Decl;
+  }
+
+  const MemoryDecl * getDecl() const {
+    return Decl;
+  }
+
+  /// A name used for debugging the compiler like: memory$0, memory$1 ...
+  std::string getDescriptiveName() const;
+
+  /// A full qualified name used for debugging the compiler like:
+  /// module.memory$0, module.memory$1 ...
+  std::string getFullQualifiedDescriptiveName() const;
 };
 
 } // namespace w2n
@@ -2,14 +2,17 @@
 #define W2N_AST_MODULE_H
 
 #include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/BitVector.h>
 #include <llvm/ADT/None.h>
 #include <llvm/ADT/Optional.h>
 #include <llvm/ADT/STLExtras.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/ilist.h>
 #include <llvm/Support/ErrorHandling.h>
+#include <array>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <w2n/AST/Decl.h>
 #include <w2n/AST/DeclContext.h>
 #include <w2n/AST/Function.h>
@@ -29,6 +32,19 @@ class FileUnit;
 class SourceFile;
 class ASTContext;
 class GlobalVariable;
+class ModuleIndex;
+
+/// Maps a concrete section declaration class to its \c DeclKind .
+template <typename Ty>
+struct SectionDeclKind;
+
+#define DECL(Id, Parent)
+#define SECTION_DECL(Id, Parent)                                         \
+  template <>                                                            \
+  struct SectionDeclKind<Id##Decl> {                                     \
+    static constexpr DeclKind Kind = DeclKind::Id;                       \
+  };
+#include <w2n/AST/DeclNodes.def>
 
 /// A \c ModuleDecl may be a main module that the being compiled by the
 /// \c CompilerInstance or a module represents a source file.
@@ -43,6 +59,9 @@ public:
   friend class FunctionRequest;
   friend class MemoryRequest;
   friend class TableRequest;
+  friend class ModuleIndexRequest;
+  friend class ImmutableTableRequest;
+  friend class ReachableFunctionRequest;
 
   using GlobalListType = llvm::ilist<GlobalVariable>;
   using FunctionListType = llvm::ilist<Function>;
@@ -79,6 +98,14 @@ private:
 
   llvm::SmallVector<SectionDecl *> SectionDecls;
 
+  static constexpr unsigned NumSectionKinds =
+    static_cast<unsigned>(DeclKind::Last_SectionDecl) -
+    static_cast<unsigned>(DeclKind::First_SectionDecl) + 1;
+
+  /// The first section of each kind, indexed by the offset of its kind
+  /// from \c DeclKind::First_SectionDecl .
+  std::array<SectionDecl *, NumSectionKinds> SectionsByKind = {};
+
   ModuleDecl(Identifier Name, ASTContext& Context);
 
   mutable std::shared_ptr<GlobalListType> Globals = nullptr;
@@ -89,6 +116,29 @@ private:
 
   mutable std::shared_ptr<MemoryListType> Memories = nullptr;
 
+  // The module primitives addressed by their index in the Wasm index
+  // spaces, filled in along with the lists above. The slots of the
+  // imported entities, which come first in an index space, are null.
+
+  mutable std::vector<GlobalVariable *> GlobalsByIndex;
+
+  mutable std::vector<Function *> FunctionsByIndex;
+
+  mutable std::vector<Table *> TablesByIndex;
+
+  mutable std::vector<Memory *> MemoriesByIndex;
+
+  /// The cached result of \c ModuleIndexRequest .
+  mutable std::shared_ptr<const ModuleIndex> Index = nullptr;
+
+  /// The cached result of \c ImmutableTableRequest .
+  mutable std::shared_ptr<const llvm::BitVector> ImmutableTables =
+    nullptr;
+
+  /// The cached result of \c ReachableFunctionRequest .
+  mutable std::shared_ptr<const llvm::BitVector> ReachableFunctions =
+    nullptr;
+
   /// Unused functions kept for generating debug info.
   FunctionListType ZombieFunctions;
 
@@ -120,6 +170,10 @@ public:
     return Magic;
   }
 
+  void setMagic(uint32_t Magic) {
+    this->Magic = Magic;
+  }
+
   bool hasVersion() const {
     return Version.has_value();
   }
@@ -128,6 +182,10 @@ public:
     return Version;
   }
 
+  void setVersion(uint32_t Version) {
+    this->Version = Version;
+  }
+
   /**
    * @brief Retrieve the module name for this module
    */
@@ -188,8 +246,26 @@ public:
 
   void addSectionDecl(SectionDecl * SectionDecl) {
     SectionDecls.push_back(SectionDecl);
+    unsigned Offset = getSectionKindOffset(SectionDecl->getKind());
+    auto& Slot = SectionsByKind[Offset];
+    if (Slot == nullptr) {
+      Slot = SectionDecl;
+    }
   }
 
+private:
+
+  static unsigned getSectionKindOffset(DeclKind Kind) {
+    assert(
+      Kind >= DeclKind::First_SectionDecl &&
+      Kind <= DeclKind::Last_SectionDecl && "not a section kind"
+    );
+    return static_cast<unsigned>(Kind) -
+           static_cast<unsigned>(DeclKind::First_SectionDecl);
+  }
+
+public:
+
 #pragma mark Accessing Section by Name
 
   template <typename Ty>
@@ -201,12 +277,9 @@ public:
 
   template <typename Ty>
   const Ty * getSection() const {
-    for (auto * Sect : getSectionDecls()) {
-      if (Ty * TySect = dyn_cast<Ty>(Sect)) {
-        return TySect;
-      }
-    }
-    return nullptr;
+    const SectionDecl * Sect =
+      SectionsByKind[getSectionKindOffset(SectionDeclKind<Ty>::Kind)];
+    return cast_or_null<Ty>(Sect);
   }
 
 #define DECL(Id, Parent)
@@ -279,6 +352,68 @@ public:                                                                  \
 
   W2N_MODULE_PRIMITIVE_ACCESSOR_2(Memory, Memories, memory, memories);
 
+#pragma mark Accessing Module Primitives by Index
+
+  /// Returns the global at \p Index in the global index space, or
+  /// \c nullptr when the global is imported.
+  GlobalVariable * getGlobal(uint32_t Index) const {
+    getGlobalList();
+    assert(Index < GlobalsByIndex.size() && "global index out of range");
+    return GlobalsByIndex[Index];
+  }
+
+  /// Returns the function at \p Index in the function index space, or
+  /// \c nullptr when the function is imported.
+  Function * getFunction(uint32_t Index) const {
+    getFunctionList();
+    assert(
+      Index < FunctionsByIndex.size() && "function index out of range"
+    );
+    return FunctionsByIndex[Index];
+  }
+
+  Table * getTable(uint32_t Index) const {
+    getTableList();
+    assert(Index < TablesByIndex.size() && "table index out of range");
+    return TablesByIndex[Index];
+  }
+
+  Memory * getMemory(uint32_t Index) const {
+    getMemoryList();
+    assert(Index < MemoriesByIndex.size() && "memory index out of range");
+    return MemoriesByIndex[Index];
+  }
+
+  /// Returns the function type at \p Index in the type section.
+  FuncTypeDecl * getType(uint32_t Index) const {
+    const TypeSectionDecl * Types = getTypeSection();
+    assert(
+      Types != nullptr && Index < Types->getTypes().size() &&
+      "type index out of range"
+    );
+    return Types->getTypes()[Index];
+  }
+
+#pragma mark Accessing Module Index
+
+  /// Returns the lookup tables of the names, the exports and the imports
+  /// of the module, shared by all the consumers of the module.
+  const ModuleIndex& getModuleIndex() const;
+
+#pragma mark Accessing Table Analyses
+
+  /// Returns true when the table at \p Index is defined by the module,
+  /// and its elements after instantiation are fully determined by the
+  /// element section and never change.
+  bool isTableImmutable(uint32_t Index) const;
+
+#pragma mark Accessing Function Analyses
+
+  /// Returns true when the function at \p Index may be called once the
+  /// module is instantiated, from the host, through a table or from
+  /// another reachable function.
+  bool isFunctionReachable(uint32_t Index) const;
+
 #pragma mark Accessing Linkage Infos
 
   using LinkLibraryCallback = llvm::function_ref<void(LinkLibrary)>;
@@ -0,0 +1,149 @@
+#ifndef W2N_AST_MODULEINDEX_H
+#define W2N_AST_MODULEINDEX_H
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Optional.h>
+#include <cstdint>
+#include <vector>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Identifier.h>
+
+namespace w2n {
+
+/**
+ * @brief Dense lookup tables of the names, the exports and the imports
+ * of a module, computed once by \c ModuleIndexRequest .
+ *
+ * The name section and the export section list their entries in no
+ * particular order. Looking an entry up by scanning them for each
+ * function is quadratic in the size of the module, so the tables are
+ * indexed by the index of the entity in its index space instead.
+ *
+ * The index spaces of functions, tables, memories and globals start
+ * with the imported entities, followed by the ones defined by the
+ * module.
+ */
+class ModuleIndex {
+  friend class ModuleIndexRequest;
+
+  std::vector<ImportFuncDecl *> ImportedFunctions;
+
+  std::vector<ImportTableDecl *> ImportedTables;
+
+  std::vector<ImportMemoryDecl *> ImportedMemories;
+
+  std::vector<ImportGlobalDecl *> ImportedGlobals;
+
+  std::vector<llvm::Optional<Identifier>> FunctionNames;
+
+  std::vector<llvm::Optional<Identifier>> GlobalNames;
+
+  std::vector<ExportFuncDecl *> FunctionExports;
+
+  std::vector<ExportTableDecl *> TableExports;
+
+  std::vector<ExportMemoryDecl *> MemoryExports;
+
+  std::vector<ExportGlobalDecl *> GlobalExports;
+
+  llvm::DenseMap<Identifier, ExportDecl *> ExportsByName;
+
+  template <typename T>
+  static T * lookup(const std::vector<T *>& Table, uint32_t Index) {
+    return Index < Table.size() ? Table[Index] : nullptr;
+  }
+
+  static llvm::Optional<Identifier> lookup(
+    const std::vector<llvm::Optional<Identifier>>& Table, uint32_t Index
+  ) {
+    return Index < Table.size() ? Table[Index] : llvm::None;
+  }
+
+public:
+
+#pragma mark Accessing Imports
+
+  uint32_t getImportedFunctionCount() const {
+    return ImportedFunctions.size();
+  }
+
+  uint32_t getImportedTableCount() const {
+    return ImportedTables.size();
+  }
+
+  uint32_t getImportedMemoryCount() const {
+    return ImportedMemories.size();
+  }
+
+  uint32_t getImportedGlobalCount() const {
+    return ImportedGlobals.size();
+  }
+
+  /// Returns the import of the function at \p Index , or \c nullptr when
+  /// the function is defined by the module.
+  ImportFuncDecl * getFunctionImport(uint32_t Index) const {
+    return lookup(ImportedFunctions, Index);
+  }
+
+  ImportTableDecl * getTableImport(uint32_t Index) const {
+    return lookup(ImportedTables, Index);
+  }
+
+  ImportMemoryDecl * getMemoryImport(uint32_t Index) const {
+    return lookup(ImportedMemories, Index);
+  }
+
+  ImportGlobalDecl * getGlobalImport(uint32_t Index) const {
+    return lookup(ImportedGlobals, Index);
+  }
+
+#pragma mark Accessing Names
+
+  /// Returns the name of the function at \p Index in the name section.
+  llvm::Optional<Identifier> getFunctionName(uint32_t Index) const {
+    return lookup(FunctionNames, Index);
+  }
+
+  /// Returns the name of the global at \p Index in the name section.
+  llvm::Optional<Identifier> getGlobalName(uint32_t Index) const {
+    return lookup(GlobalNames, Index);
+  }
+
+#pragma mark Accessing Exports
+
+  /// Returns the first export of the function at \p Index , or
+  /// \c nullptr when the function is not exported.
+  ExportFuncDecl * getFunctionExport(uint32_t Index) const {
+    return lookup(FunctionExports, Index);
+  }
+
+  ExportTableDecl * getTableExport(uint32_t Index) const {
+    return lookup(TableExports, Index);
+  }
+
+  ExportMemoryDecl * getMemoryExport(uint32_t Index) const {
+    return lookup(MemoryExports, Index);
+  }
+
+  ExportGlobalDecl * getGlobalExport(uint32_t Index) const {
+    return lookup(GlobalExports, Index);
+  }
+
+  bool isFunctionExported(uint32_t Index) const {
+    return getFunctionExport(Index) != nullptr;
+  }
+
+  bool isGlobalExported(uint32_t Index) const {
+    return getGlobalExport(Index) != nullptr;
+  }
+
+  /// Returns the export named \p Name , or \c nullptr when the module
+  /// exports nothing under that name.
+  ExportDecl * lookupExport(Identifier Name) const {
+    return ExportsByName.lookup(Name);
+  }
+};
+
+} // namespace w2n
+
+#endif // W2N_AST_MODULEINDEX_H
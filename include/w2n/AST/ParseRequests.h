@@ -49,6 +49,38 @@ public:
   readDependencySource(const evaluator::DependencyRecorder&) const;
 };
 
+/// Parse the body of a function in the code section.
+///
+/// \c CodeDecl only records the byte range of the body at module parsing
+/// time. This request decodes the locals and the instructions the first
+/// time they are asked for.
+class ParseFuncBodyRequest :
+  public SimpleRequest<
+    ParseFuncBodyRequest,
+    FuncDecl *(CodeDecl *),
+    RequestFlags::SeparatelyCached> {
+public:
+
+  using SimpleRequest::SimpleRequest;
+
+private:
+
+  friend SimpleRequest;
+
+  // Evaluation.
+  FuncDecl * evaluate(Evaluator& Eval, CodeDecl * Code) const;
+
+public:
+
+  // Caching.
+  bool isCached() const {
+    return true;
+  }
+
+  Optional<FuncDecl *> getCachedResult() const;
+  void cacheResult(FuncDecl * Result) const;
+};
+
 /// The zone number for the parser.
 #define W2N_TYPEID_ZONE   Parse
 #define W2N_TYPEID_HEADER <w2n/AST/ParseTypeIDZone.def>
@@ -93,17 +93,34 @@ public:
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Stmt, Unreachable);
 };
 
+class NopStmt : public Stmt {
+private:
+
+  NopStmt() : Stmt(StmtKind::Nop) {
+  }
+
+public:
+
+  static NopStmt * create(ASTContext& Ctx) {
+    return new (Ctx) NopStmt();
+  }
+
+  LLVM_RTTI_CLASSOF_LEAF_CLASS(Stmt, Nop);
+};
+
 class BlockStmt : public Stmt {
 private:
 
   BlockType * Ty;
 
-  std::vector<InstNode> Instructions;
+  /// The instructions of the body, excluding the terminating \c end ,
+  /// allocated in the \c ASTContext arena.
+  ArrayRef<InstNode> Instructions;
 
   EndStmt * End;
 
   BlockStmt(
-    BlockType * Ty, std::vector<InstNode> Instructions, EndStmt * End
+    BlockType * Ty, ArrayRef<InstNode> Instructions, EndStmt * End
   ) :
     Stmt(StmtKind::Block),
     Ty(Ty),
@@ -116,10 +133,10 @@ public:
   static BlockStmt * create(
     ASTContext& Ctx,
     BlockType * Ty,
-    std::vector<InstNode> Instructions,
+    ArrayRef<InstNode> Instructions,
     EndStmt * End
   ) {
-    return new (Ctx) BlockStmt(Ty, Instructions, End);
+    return new (Ctx) BlockStmt(Ty, Ctx.allocateCopy(Instructions), End);
   }
 
   BlockType * getType() {
@@ -130,11 +147,7 @@ public:
     return Ty;
   }
 
-  std::vector<InstNode>& getInstructions() {
-    return Instructions;
-  }
-
-  const std::vector<InstNode>& getInstructions() const {
+  ArrayRef<InstNode> getInstructions() const {
     return Instructions;
   }
 
@@ -180,12 +193,14 @@ private:
 
   BlockType * Ty;
 
-  std::vector<InstNode> Instructions;
+  /// The instructions of the body, excluding the terminating \c end ,
+  /// allocated in the \c ASTContext arena.
+  ArrayRef<InstNode> Instructions;
 
   EndStmt * End;
 
   LoopStmt(
-    BlockType * Ty, std::vector<InstNode> Instructions, EndStmt * End
+    BlockType * Ty, ArrayRef<InstNode> Instructions, EndStmt * End
   ) :
     LabeledStmt(StmtKind::Loop),
     Ty(Ty),
@@ -198,10 +213,10 @@ public:
   static LoopStmt * create(
     ASTContext& Ctx,
     BlockType * Ty,
-    std::vector<InstNode> Instructions,
+    ArrayRef<InstNode> Instructions,
     EndStmt * End
   ) {
-    return new (Ctx) LoopStmt(Ty, Instructions, End);
+    return new (Ctx) LoopStmt(Ty, Ctx.allocateCopy(Instructions), End);
   }
 
   BlockType * getType() {
@@ -212,11 +227,7 @@ public:
     return Ty;
   }
 
-  std::vector<InstNode>& getInstructions() {
-    return Instructions;
-  }
-
-  const std::vector<InstNode>& getInstructions() const {
+  ArrayRef<InstNode> getInstructions() const {
     return Instructions;
   }
 
@@ -238,19 +249,21 @@ private:
 
   BlockType * Ty;
 
-  std::vector<InstNode> TrueInstructions;
+  /// The instructions of the arms, excluding the terminating \c else
+  /// and \c end , allocated in the \c ASTContext arena.
+  ArrayRef<InstNode> TrueInstructions;
 
   ElseStmt * Else;
 
-  llvm::Optional<std::vector<InstNode>> FalseInstructions;
+  llvm::Optional<ArrayRef<InstNode>> FalseInstructions;
 
   EndStmt * End;
 
   IfStmt(
     BlockType * Ty,
-    std::vector<InstNode> TrueInstructions,
+    ArrayRef<InstNode> TrueInstructions,
     ElseStmt * Else,
-    llvm::Optional<std::vector<InstNode>> FalseInstructions,
+    llvm::Optional<ArrayRef<InstNode>> FalseInstructions,
     EndStmt * End
   ) :
     LabeledStmt(StmtKind::If),
@@ -266,13 +279,17 @@ public:
   static IfStmt * create(
     ASTContext& Ctx,
     BlockType * Ty,
-    std::vector<InstNode> TrueInstructions,
+    ArrayRef<InstNode> TrueInstructions,
     ElseStmt * Else,
-    llvm::Optional<std::vector<InstNode>> FalseInstructions,
+    llvm::Optional<ArrayRef<InstNode>> FalseInstructions,
     EndStmt * End
   ) {
-    return new (Ctx)
-      IfStmt(Ty, TrueInstructions, Else, FalseInstructions, End);
+    if (FalseInstructions.has_value()) {
+      FalseInstructions = Ctx.allocateCopy(*FalseInstructions);
+    }
+    return new (Ctx) IfStmt(
+      Ty, Ctx.allocateCopy(TrueInstructions), Else, FalseInstructions, End
+    );
   }
 
   BlockType * getType() {
@@ -283,11 +300,7 @@ public:
     return Ty;
   }
 
-  std::vector<InstNode>& getTrueInstructions() {
-    return TrueInstructions;
-  }
-
-  const std::vector<InstNode>& getTrueInstructions() const {
+  ArrayRef<InstNode> getTrueInstructions() const {
     return TrueInstructions;
   }
 
@@ -299,12 +312,7 @@ public:
     return Else;
   }
 
-  llvm::Optional<std::vector<InstNode>>& getFalseInstructions() {
-    return FalseInstructions;
-  }
-
-  const llvm::Optional<std::vector<InstNode>>&
-  getFalseInstructions() const {
+  llvm::Optional<ArrayRef<InstNode>> getFalseInstructions() const {
     return FalseInstructions;
   }
 
@@ -320,8 +328,17 @@ public:
 };
 
 class ElseStmt : public LabeledStmt {
+private:
+
+  ElseStmt() : LabeledStmt(StmtKind::Else) {
+  }
+
 public:
 
+  static ElseStmt * create(ASTContext& Ctx) {
+    return new (Ctx) ElseStmt();
+  }
+
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Stmt, Else);
 };
 
@@ -382,6 +399,7 @@ private:
     std::vector<uint32_t> LabelIndices, uint32_t DefaultLabelIndex
   ) :
     LabeledStmt(StmtKind::BrTable),
+    LabelIndices(std::move(LabelIndices)),
     DefaultLabelIndex(DefaultLabelIndex) {
   }
 
@@ -392,7 +410,8 @@ public:
     std::vector<uint32_t> LabelIndices,
     uint32_t DefaultLabelIndex
   ) {
-    return new (Context) BrTableStmt(LabelIndices, DefaultLabelIndex);
+    return new (Context)
+      BrTableStmt(std::move(LabelIndices), DefaultLabelIndex);
   }
 
   std::vector<uint32_t>& getLabelIndices() {
@@ -2,10 +2,16 @@
 #define W2N_AST_TABLE_H
 
 #include <llvm/ADT/ilist.h>
+#include <cstdint>
+#include <string>
 #include <w2n/AST/ASTAllocated.h>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Type.h>
 
 namespace w2n {
 
+class ModuleDecl;
+
 /**
  * @brief Represents a table in WebAssembly.
  *
@@ -14,9 +20,83 @@ namespace w2n {
  * is designed to coalesce the separated info about tables into one place.
  */
 class Table : public llvm::ilist_node<Table>, public ASTAllocated<Table> {
+private:
+
+  ModuleDecl * Module;
+  uint32_t Index;
+  TableType * Ty;
+  bool IsExported;
+  TableDecl * Decl;
+
+  Table(
+    ModuleDecl * Module,
+    uint32_t Index,
+    TableType * Ty,
+    bool IsExported,
+    TableDecl * Decl
+  );
+
 public:
 
-  ~Table(){};
+  static Table * create(
+    ModuleDecl * Module,
+    uint32_t Index,
+    TableType * Ty,
+    bool IsExported,
+    TableDecl * Decl
+  );
+
+  ~Table() {
+  }
+
+  ModuleDecl * getModule() {
+    return Module;
+  }
+
+  const ModuleDecl * getModule() const {
+    return Module;
+  }
+
+  uint32_t getIndex() const {
+    return Index;
+  }
+
+  TableType * getType() const {
+    return Ty;
+  }
+
+  /// Returns the initial number of elements of the table.
+  uint64_t getMinSize() const {
+    return Ty->getLimits()->getMin();
+  }
+
+  /// Returns the maximum number of elements of the table, if any.
+  llvm::Optional<uint64_t> getMaxSize() const {
+    return Ty->getLimits()->getMax();
+  }
+
+  bool isExported() const {
+    return IsExported;
+  }
+
+  /// Returns true when the elements of the table after instantiation are
+  /// fully determined by the element section, and never change.
+  bool isImmutable() const;
+
+  TableDecl * getDecl() {
+    return Decl;
+  }
+
+  const TableDecl * getDecl() const {
+    return Decl;
+  }
+
+  /// A name used for debugging the compiler like: table$0, table$1 ...
+  std::string getDescriptiveName() const;
+
+  /// A full qualified name used for debugging the compiler like:
+  /// module.table$0, module.table$1 ...
+  std::string getFullQualifiedDescriptiveName() const;
 };
 
 } // namespace w2n
@@ -370,9 +370,12 @@ public:
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Type, Void);
 };
 
+/// A sequence of value types, uniqued by \c ASTContext::getResultType .
 class ResultType : public Type {
 private:
 
+  friend class ASTContext;
+
   std::vector<ValueType *> ValueTypes;
 
   ResultType(std::vector<ValueType *> ValueTypes) :
@@ -380,6 +383,11 @@ private:
     ValueTypes(ValueTypes) {
   }
 
+  static ResultType *
+  create(ASTContext& Context, std::vector<ValueType *> ValueTypes) {
+    return new (Context) ResultType(ValueTypes);
+  }
+
 public:
 
   std::vector<ValueType *>& getValueTypes() {
@@ -390,25 +398,41 @@ public:
     return ValueTypes;
   }
 
-  static ResultType *
-  create(ASTContext& Context, std::vector<ValueType *> ValueTypes) {
-    return new (Context) ResultType(ValueTypes);
-  }
-
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Type, Result);
 };
 
+/// A function signature, uniqued by \c ASTContext::getFuncType .
+///
+/// Structurally equal signatures share one \c FuncType , so two
+/// signatures are equal if and only if they are the same pointer, or
+/// equivalently have the same canonical ID.
 class FuncType : public Type {
 private:
 
+  friend class ASTContext;
+
   ResultType * Parameters;
 
   ResultType * Returns;
 
-  FuncType(ResultType * Parameters, ResultType * Returns) :
+  uint32_t CanonicalID;
+
+  FuncType(
+    ResultType * Parameters, ResultType * Returns, uint32_t CanonicalID
+  ) :
     Type(TypeKind::Func),
     Parameters(Parameters),
-    Returns(Returns) {
+    Returns(Returns),
+    CanonicalID(CanonicalID) {
+  }
+
+  static FuncType * create(
+    ASTContext& Context,
+    ResultType * Parameters,
+    ResultType * Returns,
+    uint32_t CanonicalID
+  ) {
+    return new (Context) FuncType(Parameters, Returns, CanonicalID);
   }
 
 public:
@@ -429,18 +453,22 @@ public:
     return Returns;
   }
 
-  static FuncType * create(
-    ASTContext& Context, ResultType * Parameters, ResultType * Returns
-  ) {
-    return new (Context) FuncType(Parameters, Returns);
+  /// Returns the dense index of the signature among the signatures
+  /// created by the \c ASTContext , in creation order.
+  uint32_t getCanonicalID() const {
+    return CanonicalID;
   }
 
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Type, Func);
 };
 
+/// The limits of a table or a memory, uniqued by
+/// \c ASTContext::getLimits .
 class LimitsType : public Type {
 private:
 
+  friend class ASTContext;
+
   uint64_t Min;
 
   llvm::Optional<uint64_t> Max;
@@ -451,6 +479,12 @@ private:
     Max(Max) {
   }
 
+  static LimitsType * create(
+    ASTContext& Context, uint64_t Min, llvm::Optional<uint64_t> Max
+  ) {
+    return new (Context) LimitsType(Min, Max);
+  }
+
 public:
 
   uint64_t getMin() const {
@@ -465,12 +499,6 @@ public:
     return Max;
   }
 
-  static LimitsType * create(
-    ASTContext& Context, uint64_t Min, llvm::Optional<uint64_t> Max
-  ) {
-    return new (Context) LimitsType(Min, Max);
-  }
-
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Type, Limits);
 };
 
@@ -618,6 +646,10 @@ public:
     return new (Context) BlockType(Ty);
   }
 
+  Types getType() const {
+    return Ty;
+  }
+
   LLVM_RTTI_CLASSOF_LEAF_CLASS(Type, Block);
 };
 
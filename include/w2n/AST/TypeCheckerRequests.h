@@ -3,6 +3,7 @@
 #ifndef W2N_TYPE_CHECK_REQUESTS_H
 #define W2N_TYPE_CHECK_REQUESTS_H
 
+#include <llvm/ADT/BitVector.h>
 #include <memory>
 #include <w2n/AST/Evaluator.h>
 #include <w2n/AST/EvaluatorDependencies.h>
@@ -11,6 +12,9 @@
 #include <w2n/AST/SimpleRequest.h>
 
 namespace w2n {
+class Function;
+class FunctionValidation;
+class ModuleIndex;
 class SourceFile;
 class ModuleDecl;
 
@@ -172,6 +176,146 @@ public:
   readDependencySource(const evaluator::DependencyRecorder&) const;
 };
 
+/// Builds the lookup tables of the names, the exports and the imports of
+/// a module.
+/// FIXME: This isn't really a type-checking request, if we ever split off
+/// a zone for more basic AST requests, this should be moved there.
+class ModuleIndexRequest :
+  public SimpleRequest<
+    ModuleIndexRequest,
+    std::shared_ptr<const ModuleIndex>(ModuleDecl *),
+    RequestFlags::SeparatelyCached | RequestFlags::DependencySource> {
+public:
+
+  using SimpleRequest::SimpleRequest;
+
+private:
+
+  friend SimpleRequest;
+
+  OutputType evaluate(Evaluator& Eval, ModuleDecl * Mod) const;
+
+public:
+
+  // Cached.
+  bool isCached() const {
+    return true;
+  }
+
+  Optional<OutputType> getCachedResult() const;
+
+  void cacheResult(OutputType Result) const;
+
+  evaluator::DependencySource
+  readDependencySource(const evaluator::DependencyRecorder&) const;
+};
+
+/// Finds the tables of a module whose elements after instantiation are
+/// fully determined by the element section, and never change.
+///
+/// The result has a bit for each table in the table index space, set
+/// for the immutable tables. IR generation turns \c call_indirect on
+/// these tables into direct calls.
+class ImmutableTableRequest :
+  public SimpleRequest<
+    ImmutableTableRequest,
+    std::shared_ptr<const llvm::BitVector>(ModuleDecl *),
+    RequestFlags::SeparatelyCached | RequestFlags::DependencySource> {
+public:
+
+  using SimpleRequest::SimpleRequest;
+
+private:
+
+  friend SimpleRequest;
+
+  OutputType evaluate(Evaluator& Eval, ModuleDecl * Mod) const;
+
+public:
+
+  // Cached.
+  bool isCached() const {
+    return true;
+  }
+
+  Optional<OutputType> getCachedResult() const;
+
+  void cacheResult(OutputType Result) const;
+
+  evaluator::DependencySource
+  readDependencySource(const evaluator::DependencyRecorder&) const;
+};
+
+/// Finds the functions of a module which can be called once it is
+/// instantiated: the exported functions, the start function, the
+/// elements of the element segments, and the functions they call.
+///
+/// The result has a bit for each function in the function index space,
+/// set for the reachable functions. Only these are emitted, and only
+/// these are validated under \c -validate-reachable-functions-only .
+class ReachableFunctionRequest :
+  public SimpleRequest<
+    ReachableFunctionRequest,
+    std::shared_ptr<const llvm::BitVector>(ModuleDecl *),
+    RequestFlags::SeparatelyCached | RequestFlags::DependencySource> {
+public:
+
+  using SimpleRequest::SimpleRequest;
+
+private:
+
+  friend SimpleRequest;
+
+  OutputType evaluate(Evaluator& Eval, ModuleDecl * Mod) const;
+
+public:
+
+  // Cached.
+  bool isCached() const {
+    return true;
+  }
+
+  Optional<OutputType> getCachedResult() const;
+
+  void cacheResult(OutputType Result) const;
+
+  evaluator::DependencySource
+  readDependencySource(const evaluator::DependencyRecorder&) const;
+};
+
+/// Validates the body of a function or the init expression of a global
+/// against the validation rules of the WebAssembly specification.
+///
+/// \c validateFunctions validates the functions of a module on a thread
+/// pool and fills the cache directly, so evaluating the request from IR
+/// generation usually returns the cached result.
+class ValidateFunctionRequest :
+  public SimpleRequest<
+    ValidateFunctionRequest,
+    FunctionValidation *(Function *),
+    RequestFlags::SeparatelyCached> {
+public:
+
+  using SimpleRequest::SimpleRequest;
+
+private:
+
+  friend SimpleRequest;
+
+  OutputType evaluate(Evaluator& Eval, Function * Fn) const;
+
+public:
+
+  // Cached.
+  bool isCached() const {
+    return true;
+  }
+
+  Optional<OutputType> getCachedResult() const;
+
+  void cacheResult(OutputType Result) const;
+};
+
 #define W2N_TYPEID_ZONE   TypeChecker
 #define W2N_TYPEID_HEADER <w2n/AST/TypeCheckerTypeIDZone.def>
 #include <w2n/Basic/DefineTypeIDZone.h>
@@ -1,7 +1,11 @@
 #ifndef W2N_BASIC_DEBUG_H
 #define W2N_BASIC_DEBUG_H
 
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Compiler.h>
+#include <llvm/Support/JSON.h>
+#include <atomic>
+#include <cstdint>
 
 /// Adds attributes to the provided method signature indicating that it is
 /// a debugging helper that should never be called directly from compiler
@@ -22,4 +26,94 @@
 /// this macro should never be called except in the debugger.
 #define W2N_DEBUG_DUMP W2N_DEBUG_DUMPER(dump())
 
+#pragma mark - Structured Tracing
+
+/// Whether \c W2N_TRACE compiles to a runtime check. When disabled, trace
+/// points and the evaluation of their arguments are compiled out.
+#ifndef W2N_ENABLE_TRACING
+#ifdef NDEBUG
+#define W2N_ENABLE_TRACING 0
+#else
+#define W2N_ENABLE_TRACING 1
+#endif
+#endif
+
+namespace w2n {
+
+namespace trace {
+
+enum class Category : uint8_t {
+#define TRACE_CATEGORY(Id, Name) Id,
+#include <w2n/Basic/TraceCategories.def>
+};
+
+enum class Level : uint8_t {
+  /// Events emitted a bounded number of times per module, such as once
+  /// per section.
+  Info,
+  /// Events emitted once per function, expression or instruction.
+  Verbose,
+};
+
+/// The enabled categories, one bit per \c Category .
+extern std::atomic<uint32_t> EnabledCategories;
+
+/// The most detailed \c Level that is emitted.
+extern std::atomic<uint8_t> EnabledLevel;
+
+inline bool isEnabled(Category C, Level L) {
+  uint32_t Mask = EnabledCategories.load(std::memory_order_relaxed);
+  return (Mask & (1U << (unsigned)C)) != 0
+      && (uint8_t)L <= EnabledLevel.load(std::memory_order_relaxed);
+}
+
+llvm::StringRef getCategoryName(Category C);
+
+/// Enables the categories in the comma-separated list \p Names , where
+/// \c all enables every category. Returns \c true and enables nothing if
+/// a name is unknown.
+bool enableCategories(llvm::StringRef Names);
+
+/// Sets the enabled level from its name, \c info or \c verbose . Returns
+/// \c true if the name is unknown.
+bool setLevel(llvm::StringRef Name);
+
+/// Writes an event to the standard error as a single JSON object per
+/// line. Events from concurrent threads are never interleaved.
+void emit(
+  Category C, Level L, llvm::StringRef Event, llvm::json::Object Args
+);
+
+} // namespace trace
+
+} // namespace w2n
+
+/// Emits a trace event when \p Cat and \p Lvl are enabled, e.g.
+///
+/// \code
+///   W2N_TRACE(Parse, Info, "section", {"kind", "Code"}, {"size", Size});
+/// \endcode
+///
+/// The trailing key-value pairs become the \c args of the event and are
+/// only evaluated when the event is emitted.
+#if W2N_ENABLE_TRACING
+#define W2N_TRACE(Cat, Lvl, Event, ...)                                  \
+  do {                                                                   \
+    if (LLVM_UNLIKELY(::w2n::trace::isEnabled(                           \
+          ::w2n::trace::Category::Cat, ::w2n::trace::Level::Lvl          \
+        ))) {                                                            \
+      ::w2n::trace::emit(                                                \
+        ::w2n::trace::Category::Cat,                                     \
+        ::w2n::trace::Level::Lvl,                                        \
+        Event,                                                           \
+        ::llvm::json::Object{__VA_ARGS__}                                \
+      );                                                                 \
+    }                                                                    \
+  } while (false)
+#else
+#define W2N_TRACE(Cat, Lvl, Event, ...)                                  \
+  do {                                                                   \
+  } while (false)
+#endif
+
 #endif
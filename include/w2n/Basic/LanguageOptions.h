@@ -26,6 +26,15 @@ public:
 
   bool UsesMalloc = false;
 
+  /// Decode expressions into flat \c InstStream s instead of one AST node
+  /// per instruction.
+  bool UseCompactInstructions = false;
+
+  /// Validate only the bodies of the functions reachable from the
+  /// exports, the element segments and the start function, leaving the
+  /// bodies of the others undecoded.
+  bool ValidateReachableFunctionsOnly = false;
+
   bool DebugDumpCycles = true;
 
   bool RecordRequestReferences = true;
@@ -0,0 +1,55 @@
+//===--- MemoryAdvice.h - Memory Access Pattern Hints -----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// Hints about how a range of memory, typically a memory-mapped input
+// file, is about to be accessed. The hints are forwarded to madvise(2)
+// where available and ignored elsewhere.
+//
+//===----------------------------------------------------------------===//
+
+#ifndef W2N_BASIC_MEMORYADVICE_H
+#define W2N_BASIC_MEMORYADVICE_H
+
+#include <llvm/ADT/ArrayRef.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace w2n {
+
+enum class MemoryAccess {
+  /// No particular access pattern. Resets a previous hint.
+  Normal,
+  /// The range is read from the lowest to the highest address, so the
+  /// kernel may read ahead aggressively and drop pages once read.
+  Sequential,
+  /// The range is read soon, so the kernel may start paging it in.
+  WillNeed,
+};
+
+/// Hints the access pattern of the memory in [\p Start, \p Start +
+/// \p Size ). The range is widened to page boundaries.
+///
+/// The hint never changes the contents of the memory, so it is safe to
+/// give for heap memory as well as for memory-mapped files.
+void adviseMemoryAccess(
+  const void * Start, size_t Size, MemoryAccess Access
+);
+
+inline void
+adviseMemoryAccess(llvm::ArrayRef<uint8_t> Range, MemoryAccess Access) {
+  adviseMemoryAccess(Range.data(), Range.size(), Access);
+}
+
+} // namespace w2n
+
+#endif // W2N_BASIC_MEMORYADVICE_H
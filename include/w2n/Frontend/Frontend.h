@@ -218,6 +218,10 @@ public:
 
 private:
 
+  /// Enables the trace categories and level requested by the frontend
+  /// options. Returns true if a category or the level is unknown.
+  bool setUpTracing();
+
   /// Set up the file system by loading and validating all VFS overlay
   /// YAML files. If the process of validating VFS files failed, or the
   /// overlay file system could not be initialized, this function returns
@@ -40,6 +40,12 @@ public:
 
   unsigned BadFileDescriptorRetryCount = 0;
 
+  /// The categories of \c W2N_TRACE events to emit.
+  std::vector<std::string> TraceCategories;
+
+  /// The detail of \c W2N_TRACE events to emit, if not the default.
+  std::string TraceLevel;
+
   /// Whether to reuse a frontend (i.e. compiler instance) for multiple
   /// compilations. This prevents ASTContext being freed.
   bool ReuseFrontendForMultipleCompilations = false;
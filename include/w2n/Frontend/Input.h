@@ -43,6 +43,9 @@ public:
   }
 
   /// Constructs an input file from the provided data.
+  ///
+  /// \p Buffer is referenced, not copied, by the \c SourceManager of the
+  /// compilation and must outlive it.
   Input(
     StringRef Filename,
     bool IsPrimary,
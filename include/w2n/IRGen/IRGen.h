@@ -29,10 +29,14 @@ bool performLLVM(
 /// Given an already created LLVM module, construct a pass pipeline and
 /// run the Swift LLVM Pipeline upon it. This does not cause the module to
 /// be printed, only to be optimized.
+///
+/// The time spent in the pipeline is reported to \p Stats if it is not
+/// null.
 void performLLVMOptimizations(
   const IRGenOptions& Opts,
   llvm::Module * Module,
-  llvm::TargetMachine * TargetMachine
+  llvm::TargetMachine * TargetMachine,
+  UnifiedStatsReporter * Stats = nullptr
 );
 
 /// Compiles and writes the given LLVM module into an output stream in the
@@ -47,6 +51,24 @@ bool compileAndWriteLLVM(
   llvm::sys::Mutex * DiagMutex = nullptr
 );
 
+/// Splits the given LLVM module into \c IRGenOptions::CodeGenPartitions
+/// partitions along the references between its globals, and compiles
+/// them in parallel.
+///
+/// The first partition is written to \p Out . The others are written
+/// next to \p OutputFilename as "foo.1.o", "foo.2.o" and so on, or to
+/// \p Out as well when it is the standard output.
+bool splitAndCompileLLVM(
+  llvm::Module * Module,
+  llvm::TargetMachine * TargetMachine,
+  const IRGenOptions& Opts,
+  UnifiedStatsReporter * Stats,
+  DiagnosticEngine& Diags,
+  StringRef OutputFilename,
+  llvm::raw_pwrite_stream& Out,
+  llvm::sys::Mutex * DiagMutex = nullptr
+);
+
 /// Get the CPU, subtarget feature options, and triple to use when
 /// emitting code.
 std::tuple<
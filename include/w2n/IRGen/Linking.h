@@ -98,8 +98,8 @@ public:
 /// For example, functions may be uncurried at different levels, each of
 /// which potentially creates a different top-level function.
 class LinkEntity {
-  /// Function *, Table *, Memory *, or GlobalVariable *, depending on
-  /// Kind.
+  /// Function *, Table *, Memory *, GlobalVariable *, or ModuleDecl *,
+  /// depending on Kind.
   /// TODO: Can optimize with llvm::PointerUnion?
   void * Pointer;
 
@@ -133,6 +133,10 @@ class LinkEntity {
 
     /// A readonly global variable. Points to a `w2n::GlobalVariable *`.
     ReadonlyGlobalVariable,
+
+    /// The default instance context of a module. Points to a
+    /// `w2n::ModuleDecl *`.
+    VMContext,
   };
 
   friend struct llvm::DenseMapInfo<LinkEntity>;
@@ -157,6 +161,10 @@ class LinkEntity {
     return reinterpret_cast<Memory *>(Pointer);
   }
 
+  ModuleDecl * getWasmModule() const {
+    return reinterpret_cast<ModuleDecl *>(Pointer);
+  }
+
   LinkEntity() = default;
 
 public:
@@ -169,6 +177,8 @@ public:
 
   static LinkEntity forMemory(Memory * M);
 
+  static LinkEntity forVMContext(ModuleDecl * M);
+
   void mangle(llvm::raw_ostream& os) const;
 
   void mangle(SmallVectorImpl<char>& buffer) const;
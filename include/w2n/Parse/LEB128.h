@@ -0,0 +1,208 @@
+//===--- LEB128.h - Fast LEB128 Decoding ------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// LEB128 decoders specialized for the integer widths of the WebAssembly
+// binary format.
+//
+// Almost all immediates of a function body fit in a single byte, so each
+// decoder tries a one-byte fast path first. Multi-byte 32-bit values are
+// decoded either a word at a time with bit tricks or with an unrolled
+// 5-byte loop. Both paths check the remaining length once per value
+// instead of once per byte, and only values at the very end of a buffer
+// take the byte-by-byte path.
+//
+// Every decoder returns the number of bytes consumed, or 0 when the
+// encoding is malformed, overflows the target width or runs past the
+// end of the buffer.
+//
+//===----------------------------------------------------------------===//
+
+#ifndef W2N_PARSE_LEB128_H
+#define W2N_PARSE_LEB128_H
+
+#include <llvm/Support/Compiler.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/MathExtras.h>
+#include <cstdint>
+
+/// Decodes multi-byte 32-bit values by loading eight bytes at once and
+/// locating the terminating byte with a bit scan instead of testing each
+/// continuation bit in turn.
+#ifndef W2N_LEB128_WORD_AT_A_TIME
+#define W2N_LEB128_WORD_AT_A_TIME 1
+#endif
+
+namespace w2n {
+
+namespace leb128 {
+
+/// The maximum number of bytes of a \c varuint32 or a \c varint32 .
+constexpr unsigned MaxVar32Size = 5;
+
+inline unsigned decodeVaruint32MultiByte(
+  const uint8_t * Ptr, const uint8_t * End, uint32_t& Value
+) {
+#if W2N_LEB128_WORD_AT_A_TIME
+  if (LLVM_LIKELY(End - Ptr >= 8)) {
+    uint64_t Word = llvm::support::endian::read64le(Ptr);
+    // The high bit of each byte is the continuation bit. The first byte
+    // with it cleared terminates the value.
+    uint64_t Stops = ~Word & 0x8080808080808080ULL;
+    unsigned Length = (llvm::countTrailingZeros(Stops) >> 3) + 1;
+    if (Length > MaxVar32Size) {
+      return 0;
+    }
+    uint64_t Bits = Word & (~0ULL >> (64 - 8 * Length));
+    uint64_t Result = (Bits & 0x7FULL) | ((Bits >> 1) & (0x7FULL << 7))
+                    | ((Bits >> 2) & (0x7FULL << 14))
+                    | ((Bits >> 3) & (0x7FULL << 21))
+                    | ((Bits >> 4) & (0x7FULL << 28));
+    if (Result > UINT32_MAX) {
+      return 0;
+    }
+    Value = Result;
+    return Length;
+  }
+#endif
+
+  if (LLVM_LIKELY(End - Ptr >= MaxVar32Size)) {
+    uint32_t Result = Ptr[0] & 0x7F;
+    uint8_t Byte = Ptr[1];
+    Result |= uint32_t(Byte & 0x7F) << 7;
+    if (Byte < 0x80) {
+      Value = Result;
+      return 2;
+    }
+    Byte = Ptr[2];
+    Result |= uint32_t(Byte & 0x7F) << 14;
+    if (Byte < 0x80) {
+      Value = Result;
+      return 3;
+    }
+    Byte = Ptr[3];
+    Result |= uint32_t(Byte & 0x7F) << 21;
+    if (Byte < 0x80) {
+      Value = Result;
+      return 4;
+    }
+    Byte = Ptr[4];
+    // The last byte may only carry the 4 remaining bits.
+    if (Byte > 0x0F) {
+      return 0;
+    }
+    Value = Result | (uint32_t(Byte) << 28);
+    return 5;
+  }
+
+  // Values at the end of the buffer.
+  uint64_t Result = 0;
+  for (unsigned I = 0; I < MaxVar32Size; I++) {
+    if (Ptr + I == End) {
+      return 0;
+    }
+    uint8_t Byte = Ptr[I];
+    Result |= uint64_t(Byte & 0x7F) << (7 * I);
+    if (Byte < 0x80) {
+      if (Result > UINT32_MAX) {
+        return 0;
+      }
+      Value = Result;
+      return I + 1;
+    }
+  }
+  return 0;
+}
+
+inline unsigned decodeVarint32MultiByte(
+  const uint8_t * Ptr, const uint8_t * End, int32_t& Value
+) {
+  int64_t Result = 0;
+  unsigned Size = End - Ptr >= MaxVar32Size ? MaxVar32Size : End - Ptr;
+  for (unsigned I = 0; I < Size; I++) {
+    uint8_t Byte = Ptr[I];
+    Result |= int64_t(Byte & 0x7F) << (7 * I);
+    if (Byte < 0x80) {
+      unsigned Shift = 7 * (I + 1);
+      // Sign extend negative numbers.
+      if ((Byte & 0x40) != 0) {
+        Result |= -1LL << Shift;
+      }
+      if (Result > INT32_MAX || Result < INT32_MIN) {
+        return 0;
+      }
+      Value = Result;
+      return I + 1;
+    }
+  }
+  return 0;
+}
+
+/// Decodes a \c varuint32 .
+LLVM_ATTRIBUTE_ALWAYS_INLINE unsigned
+decodeVaruint32(const uint8_t * Ptr, const uint8_t * End, uint32_t& Value) {
+  if (LLVM_LIKELY(Ptr != End && *Ptr < 0x80)) {
+    Value = *Ptr;
+    return 1;
+  }
+  if (Ptr == End) {
+    return 0;
+  }
+  return decodeVaruint32MultiByte(Ptr, End, Value);
+}
+
+/// Decodes a \c varint32 .
+LLVM_ATTRIBUTE_ALWAYS_INLINE unsigned
+decodeVarint32(const uint8_t * Ptr, const uint8_t * End, int32_t& Value) {
+  if (LLVM_LIKELY(Ptr != End && *Ptr < 0x80)) {
+    // Sign extend the 7 payload bits.
+    Value = int32_t(uint32_t(*Ptr) << 25) >> 25;
+    return 1;
+  }
+  if (Ptr == End) {
+    return 0;
+  }
+  return decodeVarint32MultiByte(Ptr, End, Value);
+}
+
+/// Decodes a \c varuint64 .
+LLVM_ATTRIBUTE_ALWAYS_INLINE unsigned
+decodeVaruint64(const uint8_t * Ptr, const uint8_t * End, uint64_t& Value) {
+  if (LLVM_LIKELY(Ptr != End && *Ptr < 0x80)) {
+    Value = *Ptr;
+    return 1;
+  }
+  unsigned Count = 0;
+  const char * Error = nullptr;
+  Value = llvm::decodeULEB128(Ptr, &Count, End, &Error);
+  return Error != nullptr ? 0 : Count;
+}
+
+/// Decodes a \c varint64 .
+LLVM_ATTRIBUTE_ALWAYS_INLINE unsigned
+decodeVarint64(const uint8_t * Ptr, const uint8_t * End, int64_t& Value) {
+  if (LLVM_LIKELY(Ptr != End && *Ptr < 0x80)) {
+    Value = int64_t(uint64_t(*Ptr) << 57) >> 57;
+    return 1;
+  }
+  unsigned Count = 0;
+  const char * Error = nullptr;
+  Value = llvm::decodeSLEB128(Ptr, &Count, End, &Error);
+  return Error != nullptr ? 0 : Count;
+}
+
+} // namespace leb128
+
+} // namespace w2n
+
+#endif // W2N_PARSE_LEB128_H
@@ -7,7 +7,10 @@
 #include <w2n/AST/SourceFile.h>
 
 namespace w2n {
+class ASTContext;
+class CodeDecl;
 class Decl;
+class FuncDecl;
 class MagicDecl;
 class VersionDecl;
 class SectionDecl;
@@ -52,6 +55,21 @@ public:
 
   ~WasmParser();
 
+  /// The minimum number of function bodies to decode them on a thread
+  /// pool in \c parseFuncDecls .
+  static constexpr size_t MinParallelFuncCount = 64;
+
+  /// Decodes a function body recorded by a \c CodeDecl . \p Body is the
+  /// byte range right after the size prefix of the body.
+  static FuncDecl * parseFuncDecl(ASTContext& Ctx, ArrayRef<uint8_t> Body);
+
+  /// Decodes the bodies of \p Codes that have not been decoded yet.
+  ///
+  /// The bodies are independent of each other and are decoded on a thread
+  /// pool when there are enough of them to amortize the cost of
+  /// dispatching.
+  static void parseFuncDecls(ASTContext& Ctx, ArrayRef<CodeDecl *> Codes);
+
 private:
 
   ModuleDecl * parseModuleDecl();
@@ -0,0 +1,46 @@
+#ifndef W2N_RUNTIME_RUNTIME_H
+#define W2N_RUNTIME_RUNTIME_H
+
+#include <cstdint>
+
+extern "C" {
+
+/// The descriptor of a linear memory, which generated code reads the base
+/// and the size of the memory from. Laid out like
+/// \c IRGenModule::MemoryTy .
+struct w2n_memory {
+  uint8_t * base;
+  uint64_t size;
+};
+
+/// Reserves \p ReservedSize bytes of inaccessible address space, maps the
+/// first \p Size bytes of it, and fills \p M in.
+///
+/// Accessing the reserved bytes past the size of the memory faults into
+/// the trap handler of the runtime, which reports an out-of-bounds memory
+/// access. Memories compiled with guard pages rely on this instead of
+/// checking their accesses.
+void w2n_memory_init(
+  w2n_memory * M, uint64_t Size, uint64_t ReservedSize
+);
+
+/// Points the segment register of the calling thread which generated
+/// code addresses \p M relative to at the base of \p M .
+///
+/// Modules compiled with \c -memory-base=segment do it for the thread
+/// running their constructors. Any other thread has to call it before
+/// running code of the module. Only x86-64 Linux is supported, where the
+/// segment register is GS.
+void w2n_memory_set_segment_base(const w2n_memory * M);
+
+/// Grows \p M by \p Delta pages of 64 KiB, mapping them in the address
+/// space reserved by \c w2n_memory_init , and returns the previous size
+/// of \p M in pages.
+///
+/// Returns -1 and leaves \p M unchanged when the new size would exceed
+/// \p MaxSize bytes or the pages cannot be mapped. The base of \p M
+/// never moves, as \p MaxSize never exceeds the reserved size.
+int32_t w2n_memory_grow(w2n_memory * M, uint32_t Delta, uint64_t MaxSize);
+}
+
+#endif // W2N_RUNTIME_RUNTIME_H
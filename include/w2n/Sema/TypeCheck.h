@@ -7,8 +7,22 @@ namespace w2n {
 
 namespace TypeCheck {};
 
+class ASTContext;
+class Function;
+
 void performImportResolution(SourceFile& SF);
 
+/// The minimum number of functions to validate them on a thread pool in
+/// \c validateFunctions .
+constexpr size_t MinParallelValidationCount = 64;
+
+/// Validates the functions in \p Functions that have not been validated
+/// yet, and caches the results of \c ValidateFunctionRequest .
+///
+/// Functions are validated independently of each other, on a thread pool
+/// when there are enough of them to amortize the cost of dispatching.
+void validateFunctions(ASTContext& Ctx, ArrayRef<Function *> Functions);
+
 void registerTypeCheckerRequestFunctions(Evaluator& evaluator);
 
 } // namespace w2n
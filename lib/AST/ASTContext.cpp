@@ -1,6 +1,7 @@
 #include <llvm/ADT/DenseMapInfo.h>
 #include <llvm/ADT/MapVector.h>
 #include <llvm/Support/ErrorHandling.h>
+#include <iterator>
 #include <w2n/AST/ASTAllocated.h>
 #include <w2n/AST/ASTContext.h>
 #include <w2n/AST/Type.h>
@@ -70,6 +71,8 @@ using MemoryTypeKey = TypeKey<LimitsType *>;
 
 using TypeIndexTypeKey = TypeKey<uint32_t>;
 
+using BlockTypeKey = TypeKey<void *>;
+
 } // namespace w2n
 
 namespace llvm {
@@ -117,6 +120,13 @@ struct ASTContext::Implementation {
 
   llvm::BumpPtrAllocator Allocator; // used in later initializations
 
+  /// The arenas of the tasks which ran on thread pools.
+  std::vector<std::unique_ptr<llvm::BumpPtrAllocator>> AdoptedArenas;
+
+  /// Guards \c AdoptedArenas , \c IdentifierTable and the type uniquing
+  /// tables below.
+  llvm::sys::SmartMutex<true> Lock;
+
   /// The set of cleanups to be called when the ASTContext is destroyed.
   std::vector<std::function<void(void)>> Cleanups;
 
@@ -152,6 +162,8 @@ struct ASTContext::Implementation {
 
   llvm::DenseMap<TypeIndexTypeKey, TypeIndexType *> TypeIndexTypes;
 
+  llvm::DenseMap<BlockTypeKey, BlockType *> BlockTypes;
+
   Implementation() : IdentifierTable(Allocator) {
   }
 
@@ -213,19 +225,66 @@ ASTContext * ASTContext::get(
   return new (RetAddr) ASTContext(LangOpts, SourceMgr, Diags);
 }
 
+/// The arena of the task the current thread runs, if any.
+static thread_local llvm::BumpPtrAllocator * CurrentTaskArena = nullptr;
+
+/// The context \c CurrentTaskArena allocates for.
+static thread_local const ASTContext * CurrentTaskCtx = nullptr;
+
 llvm::BumpPtrAllocator& ASTContext::getAllocator(AllocationArena Arena
 ) const {
   switch (Arena) {
-  case AllocationArena::Permanent: return getImpl().Allocator;
+  case AllocationArena::Permanent:
+    if (CurrentTaskCtx == this) {
+      return *CurrentTaskArena;
+    }
+    return getImpl().Allocator;
   }
   llvm_unreachable("bad AllocationArena");
 }
 
+llvm::sys::SmartMutex<true>& ASTContext::getLock() const {
+  return getImpl().Lock;
+}
+
+#pragma mark ASTContext::TaskArenas
+
+ASTContext::TaskArenas::~TaskArenas() {
+  assert(Idle.size() == Arenas.size() && "a task is still running");
+  llvm::sys::SmartScopedLock<true> Guard(Ctx.getLock());
+  auto& Adopted = Ctx.getImpl().AdoptedArenas;
+  std::move(Arenas.begin(), Arenas.end(), std::back_inserter(Adopted));
+}
+
+ASTContext::TaskArenas::Scope::Scope(TaskArenas& Owner) :
+  Owner(Owner),
+  PreviousCtx(CurrentTaskCtx),
+  PreviousArena(CurrentTaskArena) {
+  {
+    llvm::sys::SmartScopedLock<true> Guard(Owner.Lock);
+    if (Owner.Idle.empty()) {
+      Owner.Arenas.push_back(std::make_unique<llvm::BumpPtrAllocator>());
+      Owner.Idle.push_back(Owner.Arenas.back().get());
+    }
+    Arena = Owner.Idle.back();
+    Owner.Idle.pop_back();
+  }
+  CurrentTaskCtx = &Owner.Ctx;
+  CurrentTaskArena = Arena;
+}
+
+ASTContext::TaskArenas::Scope::~Scope() {
+  CurrentTaskCtx = PreviousCtx;
+  CurrentTaskArena = PreviousArena;
+  llvm::sys::SmartScopedLock<true> Guard(Owner.Lock);
+  Owner.Idle.push_back(Arena);
+}
+
 /// Set a new stats reporter.
 void ASTContext::setStatsReporter(UnifiedStatsReporter * NewValue) {
   if (NewValue != nullptr) {
     NewValue->getFrontendCounters().NumASTBytesAllocated =
-      getAllocator().getBytesAllocated();
+      getImpl().Allocator.getBytesAllocated();
   }
   Eval.setStatsReporter(NewValue);
   Stats = NewValue;
@@ -248,6 +307,7 @@ Identifier ASTContext::getIdentifier(StringRef Str) const {
     return Identifier(nullptr);
   }
 
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Pair = std::make_pair(Str, Identifier::Aligner());
   auto I = getImpl().IdentifierTable.insert(Pair).first;
   return Identifier(I->getKeyData());
@@ -267,6 +327,7 @@ ValueType * ASTContext::getValueTypeForKind(ValueTypeKind Kind) const {
 #define TYPE(Id, Parent)
 #define VALUE_TYPE(Id, Parent)                                           \
   Id##Type * ASTContext::get##Id##Type() const {                         \
+    llvm::sys::SmartScopedLock<true> Lock(getLock());                    \
     if (getImpl().Id##Type != nullptr) {                                 \
       return getImpl().Id##Type;                                         \
     }                                                                    \
@@ -279,6 +340,7 @@ ValueType * ASTContext::getValueTypeForKind(ValueTypeKind Kind) const {
 
 ResultType * ASTContext::getResultType(std::vector<ValueType *> ValueTypes
 ) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Key = ResultTypeKey(ValueTypes);
   auto Iter = getImpl().ResultTypes.find(Key);
   if (Iter != getImpl().ResultTypes.end()) {
@@ -292,19 +354,23 @@ ResultType * ASTContext::getResultType(std::vector<ValueType *> ValueTypes
 
 FuncType *
 ASTContext::getFuncType(ResultType * Params, ResultType * Returns) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Key = FuncTypeKey(Params, Returns);
   auto Iter = getImpl().FuncTypes.find(Key);
   if (Iter != getImpl().FuncTypes.end()) {
     return Iter->getSecond();
   }
-  FuncType * Ty =
-    FuncType::create(const_cast<ASTContext&>(*this), Params, Returns);
+  uint32_t CanonicalID = getImpl().FuncTypes.size();
+  FuncType * Ty = FuncType::create(
+    const_cast<ASTContext&>(*this), Params, Returns, CanonicalID
+  );
   getImpl().FuncTypes.insert({Key, Ty});
   return Ty;
 }
 
 GlobalType *
 ASTContext::getGlobalType(ValueType * Type, bool IsMutable) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Key = GlobalTypeKey(Type, IsMutable);
   auto Iter = getImpl().GlobalTypes.find(Key);
   if (Iter != getImpl().GlobalTypes.end()) {
@@ -318,6 +384,7 @@ ASTContext::getGlobalType(ValueType * Type, bool IsMutable) const {
 
 LimitsType *
 ASTContext::getLimits(uint64_t Min, llvm::Optional<uint64_t> Max) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Key = LimitsKey(Min, Max);
   auto Iter = getImpl().Limits.find(Key);
   if (Iter != getImpl().Limits.end()) {
@@ -332,6 +399,7 @@ ASTContext::getLimits(uint64_t Min, llvm::Optional<uint64_t> Max) const {
 TableType * ASTContext::getTableType(
   ReferenceType * ElementType, LimitsType * Limits
 ) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Key = TableTypeKey(ElementType, Limits);
   auto Iter = getImpl().TableTypes.find(Key);
   if (Iter != getImpl().TableTypes.end()) {
@@ -345,6 +413,7 @@ TableType * ASTContext::getTableType(
 }
 
 MemoryType * ASTContext::getMemoryType(LimitsType * Limits) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Key = MemoryTypeKey(Limits);
   auto Iter = getImpl().MemoryTypes.find(Key);
   if (Iter != getImpl().MemoryTypes.end()) {
@@ -357,6 +426,7 @@ MemoryType * ASTContext::getMemoryType(LimitsType * Limits) const {
 }
 
 TypeIndexType * ASTContext::getTypeIndexType(uint32_t TypeIndex) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
   auto Key = TypeIndexTypeKey(TypeIndex);
   auto Iter = getImpl().TypeIndexTypes.find(Key);
   if (Iter != getImpl().TypeIndexTypes.end()) {
@@ -367,3 +437,16 @@ TypeIndexType * ASTContext::getTypeIndexType(uint32_t TypeIndex) const {
   getImpl().TypeIndexTypes.insert({Key, Ty});
   return Ty;
 }
+
+BlockType * ASTContext::getBlockType(BlockType::Types Ty) const {
+  llvm::sys::SmartScopedLock<true> Lock(getLock());
+  auto Key = BlockTypeKey(Ty.getOpaqueValue());
+  auto Iter = getImpl().BlockTypes.find(Key);
+  if (Iter != getImpl().BlockTypes.end()) {
+    return Iter->getSecond();
+  }
+  BlockType * BlockTy =
+    BlockType::create(const_cast<ASTContext&>(*this), Ty);
+  getImpl().BlockTypes.insert({Key, BlockTy});
+  return BlockTy;
+}
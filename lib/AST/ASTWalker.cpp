@@ -59,6 +59,7 @@
 #include <w2n/AST/Decl.h>
 #include <w2n/AST/Expr.h>
 #include <w2n/AST/InstNode.h>
+#include <w2n/AST/InstStream.h>
 #include <w2n/AST/Module.h>
 #include <w2n/AST/Stmt.h>
 #include <w2n/Basic/Defer.h>
@@ -317,7 +318,9 @@ bool Traversal::visitStartSectionDecl(StartSectionDecl * D) {
 }
 
 bool Traversal::visitElementSectionDecl(ElementSectionDecl * D) {
-  return w2n_proto_implemented([] { return false; });
+  return llvm::any_of(D->getElementSegments(), [this](auto * Segment) {
+    return doIt(Segment);
+  });
 }
 
 bool Traversal::visitCodeSectionDecl(CodeSectionDecl * D) {
@@ -401,6 +404,10 @@ bool Traversal::visitLocalDecl(LocalDecl * D) {
   return false;
 }
 
+bool Traversal::visitElementSegmentDecl(ElementSegmentDecl * D) {
+  return false;
+}
+
 bool Traversal::visitDataSegmentActiveDecl(DataSegmentActiveDecl * D) {
   return false;
 }
@@ -410,6 +417,11 @@ bool Traversal::visitDataSegmentPassiveDecl(DataSegmentPassiveDecl * D) {
 }
 
 bool Traversal::visitExpressionDecl(ExpressionDecl * D) {
+  if (D->hasInstStream()) {
+    return llvm::any_of(*D->getInstStream(), [&](InstRef Inst) {
+      return Walker.walkToInst(Inst).Action == PreWalkAction::Stop;
+    });
+  }
   bool Result = false;
   llvm::any_of(D->getInstructions(), [&](InstNode Inst) {
     if (Expr * E = Inst.dyn_cast<Expr *>()) {
@@ -457,6 +469,10 @@ Expr * Traversal::visitDropExpr(DropExpr * E) {
   return E;
 }
 
+Expr * Traversal::visitSelectExpr(SelectExpr * E) {
+  return E;
+}
+
 Expr * Traversal::visitLoadExpr(LoadExpr * E) {
   return E;
 }
@@ -465,6 +481,14 @@ Expr * Traversal::visitStoreExpr(StoreExpr * E) {
   return E;
 }
 
+Expr * Traversal::visitMemorySizeExpr(MemorySizeExpr * E) {
+  return E;
+}
+
+Expr * Traversal::visitMemoryGrowExpr(MemoryGrowExpr * E) {
+  return E;
+}
+
 Expr * Traversal::visitLocalGetExpr(LocalGetExpr * E) {
   return E;
 }
@@ -473,6 +497,10 @@ Expr * Traversal::visitLocalSetExpr(LocalSetExpr * E) {
   return E;
 }
 
+Expr * Traversal::visitLocalTeeExpr(LocalTeeExpr * E) {
+  return E;
+}
+
 Expr * Traversal::visitGlobalGetExpr(GlobalGetExpr * E) {
   return E;
 }
@@ -541,6 +569,10 @@ Stmt * Traversal::visitUnreachableStmt(UnreachableStmt * S) {
   return S;
 }
 
+Stmt * Traversal::visitNopStmt(NopStmt * S) {
+  return S;
+}
+
 } // end anonymous namespace
 
 #pragma mark Traversal
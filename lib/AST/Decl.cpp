@@ -1,7 +1,11 @@
 #include <llvm/Support/raw_ostream.h>
+#include <w2n/AST/ASTContext.h>
 #include <w2n/AST/Decl.h>
+#include <w2n/AST/Expr.h>
 #include <w2n/AST/FileUnit.h>
+#include <w2n/AST/InstStream.h>
 #include <w2n/AST/Module.h>
+#include <w2n/AST/ParseRequests.h>
 #include <w2n/Basic/SourceLoc.h>
 #include <w2n/Basic/Unimplemented.h>
 
@@ -72,6 +76,7 @@ StringRef Decl::getDescriptiveKindName(DescriptiveDeclKind K) const {
     W2N_ENTRY(Code, "code");
     W2N_ENTRY(Func, "function");
     W2N_ENTRY(Local, "local");
+    W2N_ENTRY(ElementSegment, "element segment");
     W2N_ENTRY(DataSegmentActive, "data segment - active");
     W2N_ENTRY(DataSegmentPassive, "data segment - passive");
     W2N_ENTRY(Expression, "expression");
@@ -178,3 +183,51 @@ void w2n::simple_display(llvm::raw_ostream& os, const ValueDecl * ss) {
 #pragma mark - SectionDecl
 
 #pragma mark - Subclasses of SectionDecl
+
+#pragma mark - CodeDecl
+
+FuncDecl * CodeDecl::getFunc() {
+  if (Func != nullptr) {
+    return Func;
+  }
+  return evaluateOrDefault(
+    getASTContext().Eval, ParseFuncBodyRequest{this}, nullptr
+  );
+}
+
+#pragma mark - ElementSegmentDecl
+
+llvm::Optional<uint32_t> ElementSegmentDecl::getConstantOffset() const {
+  if (Offset == nullptr) {
+    return llvm::None;
+  }
+  if (Offset->hasInstStream()) {
+    for (InstRef Inst : *Offset->getInstStream()) {
+      if (Inst.getInfo().Node != InstNodeKind::IntegerConst) {
+        break;
+      }
+      return static_cast<uint32_t>(Inst.getBits());
+    }
+    return llvm::None;
+  }
+  ArrayRef<InstNode> Instructions = Offset->getInstructions();
+  if (Instructions.empty()) {
+    return llvm::None;
+  }
+  auto * Const = dyn_cast_or_null<IntegerConstExpr>(
+    Instructions.front().dyn_cast<Expr *>()
+  );
+  if (Const == nullptr) {
+    return llvm::None;
+  }
+  return static_cast<uint32_t>(Const->getValue().getZExtValue());
+}
+
+#pragma mark - ExpressionDecl
+
+ExpressionDecl * ExpressionDecl::create(
+  ASTContext& Context, ArrayRef<InstNode> Instructions
+) {
+  return new (Context)
+    ExpressionDecl(&Context, Context.allocateCopy(Instructions));
+}
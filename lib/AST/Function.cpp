@@ -1,3 +1,4 @@
+#include <w2n/AST/ASTContext.h>
 #include <w2n/AST/Function.h>
 #include <w2n/AST/Module.h>
 
@@ -10,18 +11,18 @@ Function * Function::createInit(
   ExpressionDecl * Expression,
   llvm::Optional<Identifier> Name
 ) {
-  auto * ParamTys = ResultType::create(Module->getASTContext(), {});
-  auto * ResultTys =
-    ResultType::create(Module->getASTContext(), {ReturnType});
-  auto * FnTy =
-    FuncType::create(Module->getASTContext(), ParamTys, ResultTys);
-  auto * FnTyDecl = FuncTypeDecl::create(Module->getASTContext(), FnTy);
+  ASTContext& Ctx = Module->getASTContext();
+  auto * FnTy = Ctx.getFuncType(
+    Ctx.getResultType({}), Ctx.getResultType({ReturnType})
+  );
+  auto * FnTyDecl = FuncTypeDecl::create(Ctx, FnTy);
   return new (Expression->getASTContext()) Function(
     Module,
     FunctionKind::GlobalInit,
     Index,
     Name,
     FnTyDecl,
+    nullptr,
     {},
     Expression,
     false
@@ -50,3 +51,15 @@ void Function::dump(raw_ostream& OS, unsigned Indent) const {
   OS << " : ";
   Type->getType()->dump(OS);
 }
+
+void w2n::simple_display(llvm::raw_ostream& OS, const Function * Fn) {
+  if (Fn == nullptr) {
+    OS << "(null)";
+    return;
+  }
+  OS << Fn->getFullQualifiedDescriptiveName();
+}
+
+SourceLoc w2n::extractNearestSourceLoc(const Function * Fn) {
+  return extractNearestSourceLoc(Fn->getDeclContext());
+}
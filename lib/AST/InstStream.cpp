@@ -0,0 +1,101 @@
+//===--- InstStream.cpp - Compact Instruction Streams ---------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/InstStream.h>
+
+using namespace w2n;
+
+size_t InstStream::getMemoryUsage() const {
+  return sizeof(InstStream) + Opcodes.size() * sizeof(Instruction)
+       + Immediates.size() * sizeof(uint32_t)
+       + Matches.size() * sizeof(uint32_t)
+       + Operands.size() * sizeof(uint32_t)
+       + BlockTypes.size() * sizeof(BlockType *);
+}
+
+#pragma mark - InstStreamBuilder
+
+void InstStreamBuilder::add(
+  Instruction Opcode, const InstInfo& Info, uint32_t Immediate
+) {
+  uint32_t Index = append(Opcode, Immediate);
+  switch (Info.Node) {
+  case InstNodeKind::Else:
+    assert(!ControlStack.empty() && "else without if");
+    Matches[ControlStack.back()] = Index;
+    ControlStack.back() = Index;
+    break;
+  case InstNodeKind::End:
+    // The end of the expression itself has no matching instruction.
+    if (!ControlStack.empty()) {
+      Matches[ControlStack.pop_back_val()] = Index;
+    }
+    break;
+  default: break;
+  }
+}
+
+void InstStreamBuilder::addBlock(Instruction Opcode, BlockType * Ty) {
+  uint32_t TypeIndex = BlockTypes.size();
+  BlockTypes.push_back(Ty);
+  ControlStack.push_back(append(Opcode, TypeIndex));
+}
+
+void InstStreamBuilder::addBrTable(
+  ArrayRef<uint32_t> Labels, uint32_t DefaultLabel
+) {
+  uint32_t Offset = appendOperand(Labels.size());
+  appendOperand(DefaultLabel);
+  Operands.append(Labels.begin(), Labels.end());
+  append(Instruction::BrTable, Offset);
+}
+
+void InstStreamBuilder::addCallIndirect(
+  Instruction Opcode, uint32_t TypeIndex, uint32_t TableIndex
+) {
+  uint32_t Offset = appendOperand(TypeIndex);
+  appendOperand(TableIndex);
+  append(Opcode, Offset);
+}
+
+void InstStreamBuilder::addMemoryAccess(
+  Instruction Opcode, MemoryArgument MemArg
+) {
+  uint32_t Offset = appendOperand(MemArg.Align);
+  appendOperand(MemArg.Offset);
+  append(Opcode, Offset);
+}
+
+void InstStreamBuilder::add64(Instruction Opcode, uint64_t Bits) {
+  uint32_t Offset = appendOperand((uint32_t)Bits);
+  appendOperand((uint32_t)(Bits >> 32));
+  append(Opcode, Offset);
+}
+
+InstStream * InstStreamBuilder::finish(ASTContext& Ctx) {
+  assert(ControlStack.empty() && "unterminated structured instruction");
+  auto * Stream = new (Ctx) InstStream(
+    Ctx.allocateCopy(ArrayRef<Instruction>(Opcodes)),
+    Ctx.allocateCopy(ArrayRef<uint32_t>(Immediates)),
+    Ctx.allocateCopy(ArrayRef<uint32_t>(Matches)),
+    Ctx.allocateCopy(ArrayRef<uint32_t>(Operands)),
+    Ctx.allocateCopy(ArrayRef<BlockType *>(BlockTypes))
+  );
+  Opcodes.clear();
+  Immediates.clear();
+  Matches.clear();
+  Operands.clear();
+  BlockTypes.clear();
+  return Stream;
+}
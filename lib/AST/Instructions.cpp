@@ -0,0 +1,62 @@
+//===--- Instructions.cpp - Web Assembly Instruction Tables ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// This file generates the dense decode tables of the instruction set
+// from Instructions.def at compile time.
+//
+//===----------------------------------------------------------------===//
+
+#include <w2n/AST/Instructions.h>
+
+using namespace w2n;
+
+static constexpr InstTable makeInstTable(uint8_t TablePrefix) {
+  InstTable Table{};
+#define INST(                                                            \
+  Id,                                                                    \
+  Prefix,                                                                \
+  Opcode,                                                                \
+  Immediate,                                                             \
+  Node,                                                                  \
+  Builtin,                                                               \
+  OperandType,                                                           \
+  ResultType,                                                            \
+  MemoryType,                                                            \
+  Pops,                                                                  \
+  Pushes                                                                 \
+)                                                                        \
+  if ((Prefix) == TablePrefix) {                                         \
+    Table[(Opcode)] = InstInfo{                                          \
+      InstNodeKind::Node,                                                \
+      InstImmediateKind::Immediate,                                      \
+      BuiltinValueKind::Builtin,                                         \
+      ValueTypeKind::OperandType,                                        \
+      ValueTypeKind::ResultType,                                         \
+      ValueTypeKind::MemoryType,                                         \
+      (Pops),                                                            \
+      (Pushes),                                                          \
+      #Id,                                                               \
+    };                                                                   \
+  }
+#include <w2n/AST/Instructions.def>
+  return Table;
+}
+
+const InstTable w2n::SingleByteInstTable =
+  makeInstTable((uint8_t)InstPrefix::None);
+
+const InstTable w2n::MiscInstTable =
+  makeInstTable((uint8_t)InstPrefix::Misc);
+
+const InstTable w2n::VectorInstTable =
+  makeInstTable((uint8_t)InstPrefix::Vector);
@@ -0,0 +1,40 @@
+#include <llvm/ADT/Twine.h>
+#include <w2n/AST/Memory.h>
+#include <w2n/AST/Module.h>
+
+using namespace w2n;
+
+Memory::Memory(
+  ModuleDecl * Module,
+  uint32_t Index,
+  MemoryType * Ty,
+  bool IsExported,
+  MemoryDecl * Decl
+) :
+  Module(Module),
+  Index(Index),
+  Ty(Ty),
+  IsExported(IsExported),
+  Decl(Decl) {
+}
+
+Memory * Memory::create(
+  ModuleDecl * Module,
+  uint32_t Index,
+  MemoryType * Ty,
+  bool IsExported,
+  MemoryDecl * Decl
+) {
+  return new (Module->getASTContext())
+    Memory(Module, Index, Ty, IsExported, Decl);
+}
+
+std::string Memory::getDescriptiveName() const {
+  return (llvm::Twine("memory$") + llvm::Twine(getIndex())).str();
+}
+
+std::string Memory::getFullQualifiedDescriptiveName() const {
+  return (llvm::Twine(Module->getName().str()) + llvm::Twine(".")
+          + llvm::Twine(getDescriptiveName()))
+    .str();
+}
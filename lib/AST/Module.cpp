@@ -8,6 +8,7 @@
 #include <w2n/AST/GlobalVariable.h>
 #include <w2n/AST/Linkage.h>
 #include <w2n/AST/Module.h>
+#include <w2n/AST/ModuleIndex.h>
 #include <w2n/AST/SourceFile.h>
 #include <w2n/AST/TypeCheckerRequests.h>
 #include <w2n/Basic/Unimplemented.h>
@@ -68,6 +69,34 @@ const ModuleDecl::MemoryListType& ModuleDecl::getMemoryListImpl() const {
   return *evaluateOrDefault(Eval, MemoryRequest{Mutable}, {});
 }
 
+const ModuleIndex& ModuleDecl::getModuleIndex() const {
+  auto& Eval = getASTContext().Eval;
+  auto * Mutable = const_cast<ModuleDecl *>(this);
+  return *evaluateOrDefault(Eval, ModuleIndexRequest{Mutable}, {});
+}
+
+#pragma mark Accessing Table Analyses
+
+bool ModuleDecl::isTableImmutable(uint32_t Index) const {
+  auto& Eval = getASTContext().Eval;
+  auto * Mutable = const_cast<ModuleDecl *>(this);
+  auto Immutable =
+    evaluateOrDefault(Eval, ImmutableTableRequest{Mutable}, nullptr);
+  return Immutable != nullptr && Index < Immutable->size()
+        && Immutable->test(Index);
+}
+
+#pragma mark Accessing Function Analyses
+
+bool ModuleDecl::isFunctionReachable(uint32_t Index) const {
+  auto& Eval = getASTContext().Eval;
+  auto * Mutable = const_cast<ModuleDecl *>(this);
+  auto Reachable =
+    evaluateOrDefault(Eval, ReachableFunctionRequest{Mutable}, nullptr);
+  return Reachable != nullptr && Index < Reachable->size()
+        && Reachable->test(Index);
+}
+
 #pragma mark Accessing Linkage Infos
 
 // FIXME: Forwards to synthesized file if needed.
@@ -0,0 +1,44 @@
+#include <llvm/ADT/Twine.h>
+#include <w2n/AST/Module.h>
+#include <w2n/AST/Table.h>
+
+using namespace w2n;
+
+Table::Table(
+  ModuleDecl * Module,
+  uint32_t Index,
+  TableType * Ty,
+  bool IsExported,
+  TableDecl * Decl
+) :
+  Module(Module),
+  Index(Index),
+  Ty(Ty),
+  IsExported(IsExported),
+  Decl(Decl) {
+}
+
+Table * Table::create(
+  ModuleDecl * Module,
+  uint32_t Index,
+  TableType * Ty,
+  bool IsExported,
+  TableDecl * Decl
+) {
+  return new (Module->getASTContext())
+    Table(Module, Index, Ty, IsExported, Decl);
+}
+
+bool Table::isImmutable() const {
+  return Module->isTableImmutable(Index);
+}
+
+std::string Table::getDescriptiveName() const {
+  return (llvm::Twine("table$") + llvm::Twine(getIndex())).str();
+}
+
+std::string Table::getFullQualifiedDescriptiveName() const {
+  return (llvm::Twine(Module->getName().str()) + llvm::Twine(".")
+          + llvm::Twine(getDescriptiveName()))
+    .str();
+}
@@ -4,12 +4,28 @@
 #include <w2n/AST/Decl.h>
 #include <w2n/AST/FileUnit.h>
 #include <w2n/AST/Module.h>
+#include <w2n/AST/ModuleIndex.h>
 #include <w2n/AST/NameAssociation.h>
 #include <w2n/AST/Type.h>
 #include <w2n/AST/TypeCheckerRequests.h>
+#include <w2n/Basic/Debug.h>
 
 using namespace w2n;
 
+/// Fills \p ByIndex with the primitives in \p List , preceded by a null
+/// slot for each of the \p ImportedCount imported ones.
+template <typename ListTy, typename Ty>
+static void indexPrimitives(
+  ListTy& List, uint32_t ImportedCount, std::vector<Ty *>& ByIndex
+) {
+  ByIndex.clear();
+  ByIndex.reserve(ImportedCount + List.size());
+  ByIndex.resize(ImportedCount, nullptr);
+  for (Ty& Each : List) {
+    ByIndex.push_back(&Each);
+  }
+}
+
 #pragma mark - GlobalVariableRequest
 
 GlobalVariableRequest::OutputType
@@ -29,6 +45,8 @@ GlobalVariableRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
 
   uint32_t GlobalCount = 0;
 
+  const ModuleIndex& Index = Mod->getModuleIndex();
+
   for (GlobalDecl * D : G->getGlobals()) {
     auto * InitFn = Function::createInit(
       Mod, D->getIndex(), D->getType()->getType(), D->getInit(), None
@@ -37,11 +55,10 @@ GlobalVariableRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
       Mod,
       GetASTLinkage(D),
       D->getIndex(),
-      None,
+      Index.getGlobalName(D->getIndex()),
       D->getType()->getType(),
       D->getType()->isMutable(),
-      // FIXME: Check export info when export is implemented
-      false,
+      Index.isGlobalExported(D->getIndex()),
       InitFn,
       D
     );
@@ -49,8 +66,7 @@ GlobalVariableRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
     GlobalCount += 1;
   }
 
-  llvm::errs() << "[GlobalVariableRequest] [evaluate] global count = "
-               << GlobalCount << "\n";
+  W2N_TRACE(AST, Info, "global-variables", {"count", GlobalCount});
 
   return Globals;
 }
@@ -76,6 +92,11 @@ void GlobalVariableRequest::cacheResult(
 ) const {
   auto * Mod = std::get<0>(getStorage());
   Mod->Globals = Result;
+  indexPrimitives(
+    *Result,
+    Mod->getModuleIndex().getImportedGlobalCount(),
+    Mod->GlobalsByIndex
+  );
 }
 
 #pragma mark - FunctionRequest
@@ -86,8 +107,6 @@ FunctionRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
   TypeSectionDecl * TypeSection = Mod->getTypeSection();
   CodeSectionDecl * CodeSection = Mod->getCodeSection();
   FuncSectionDecl * FuncSection = Mod->getFuncSection();
-  ExportSectionDecl * ExportSection = Mod->getExportSection();
-  NameSectionDecl * NameSection = Mod->getNameSection();
 
   auto Functions = std::make_shared<ModuleDecl::FunctionListType>();
 
@@ -109,8 +128,7 @@ FunctionRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
     uint32_t Index;
     Optional<Identifier> Name;
     FuncTypeDecl * Type;
-    std::vector<LocalDecl *> LocalVariables;
-    ExpressionDecl * Expression;
+    CodeDecl * Code;
     bool IsExported;
   };
 
@@ -123,8 +141,7 @@ FunctionRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
       WorkItemIndex,
       None,
       nullptr,
-      C->getFunc()->getLocals(),
-      C->getFunc()->getExpression(),
+      C,
       false,
     });
     WorkItemIndex += 1;
@@ -132,53 +149,16 @@ FunctionRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
 
   auto& FuncTypeIndices = FuncSection->getFuncTypes();
   auto& Types = TypeSection->getTypes();
+  const ModuleIndex& Index = Mod->getModuleIndex();
 
-  auto FindFuncName = [&](uint32_t Index) -> Optional<Identifier> {
-    if (NameSection == nullptr || NameSection->getFuncNameSubsection() == nullptr) {
-      return None;
-    }
-
-    auto& FuncNameMap =
-      NameSection->getFuncNameSubsection()->getNameMap();
-    auto Iter = std::find_if(
-      FuncNameMap.begin(),
-      FuncNameMap.end(),
-      [&](NameAssociation Entry) -> bool { return Entry.Index == Index; }
-    );
-
-    if (Iter != FuncNameMap.end()) {
-      return Iter->Name;
-    }
-
-    return None;
-  };
-
-  auto GetExport = [&](uint32_t Index) -> bool {
-    if (ExportSection == nullptr) {
-      return false;
-    }
-    auto& Exports = ExportSection->getExports();
-
-    auto Iter = std::find_if(
-      Exports.begin(),
-      Exports.end(),
-      [&](ExportDecl * D) -> bool {
-        if (auto * F = dyn_cast<ExportFuncDecl>(D)) {
-          return F->getFuncIndex() == Index;
-        }
-        return false;
-      }
-    );
+  // Imported functions come first in the function index space.
+  uint32_t ImportedFuncCount = Index.getImportedFunctionCount();
 
-    return Iter != Exports.end();
-  };
-
-  for (size_t Index = 0; Index < FuncCount; Index++) {
-    auto FuncTypeIdx = FuncTypeIndices[Index];
-    auto * Type = Types[FuncTypeIdx];
-    WorkItems[Index].Type = Type;
-    WorkItems[Index].Name = FindFuncName(Index);
-    WorkItems[Index].IsExported = GetExport(Index);
+  for (size_t I = 0; I < FuncCount; I++) {
+    uint32_t FuncIndex = ImportedFuncCount + I;
+    WorkItems[I].Type = Types[FuncTypeIndices[I]];
+    WorkItems[I].Name = Index.getFunctionName(FuncIndex);
+    WorkItems[I].IsExported = Index.isFunctionExported(FuncIndex);
   }
 
   for (const auto& WorkItem : WorkItems) {
@@ -187,8 +167,7 @@ FunctionRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
       WorkItem.Index,
       WorkItem.Name,
       WorkItem.Type,
-      WorkItem.LocalVariables,
-      WorkItem.Expression,
+      WorkItem.Code,
       WorkItem.IsExported
     );
     Functions->push_back(F);
@@ -217,6 +196,11 @@ void FunctionRequest::cacheResult(FunctionRequest::OutputType Result
 ) const {
   auto * Mod = std::get<0>(getStorage());
   Mod->Functions = Result;
+  indexPrimitives(
+    *Result,
+    Mod->getModuleIndex().getImportedFunctionCount(),
+    Mod->FunctionsByIndex
+  );
 }
 
 #pragma mark - TableRequest
@@ -224,15 +208,32 @@ void FunctionRequest::cacheResult(FunctionRequest::OutputType Result
 TableRequest::OutputType
 TableRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
   assert(Mod);
-  CodeSectionDecl * F = Mod->getCodeSection();
+  TableSectionDecl * T = Mod->getTableSection();
 
   auto Tables = std::make_shared<ModuleDecl::TableListType>();
 
-  if (F == nullptr || F->getCodes().empty()) {
+  if (T == nullptr || T->getTables().empty()) {
     return Tables;
   }
 
-  // FIXME: not implemented
+  const ModuleIndex& Index = Mod->getModuleIndex();
+
+  // Defined tables follow the imported ones in the table index space.
+  uint32_t TableIndex = Index.getImportedTableCount();
+
+  for (TableDecl * D : T->getTables()) {
+    Table * Tab = Table::create(
+      Mod,
+      TableIndex,
+      D->getType(),
+      Index.getTableExport(TableIndex) != nullptr,
+      D
+    );
+    Tables->push_back(Tab);
+    TableIndex += 1;
+  }
+
+  W2N_TRACE(AST, Info, "tables", {"count", Tables->size()});
 
   return Tables;
 }
@@ -255,6 +256,11 @@ Optional<TableRequest::OutputType> TableRequest::getCachedResult() const {
 void TableRequest::cacheResult(TableRequest::OutputType Result) const {
   auto * Mod = std::get<0>(getStorage());
   Mod->Tables = Result;
+  indexPrimitives(
+    *Result,
+    Mod->getModuleIndex().getImportedTableCount(),
+    Mod->TablesByIndex
+  );
 }
 
 #pragma mark - MemoryRequest
@@ -262,15 +268,32 @@ void TableRequest::cacheResult(TableRequest::OutputType Result) const {
 MemoryRequest::OutputType
 MemoryRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
   assert(Mod);
-  CodeSectionDecl * F = Mod->getCodeSection();
+  MemorySectionDecl * M = Mod->getMemorySection();
 
   auto Memories = std::make_shared<ModuleDecl::MemoryListType>();
 
-  if (F == nullptr || F->getCodes().empty()) {
+  if (M == nullptr || M->getMemories().empty()) {
     return Memories;
   }
 
-  // FIXME: not implemented
+  const ModuleIndex& Index = Mod->getModuleIndex();
+
+  // Defined memories follow the imported ones in the memory index space.
+  uint32_t MemoryIndex = Index.getImportedMemoryCount();
+
+  for (MemoryDecl * D : M->getMemories()) {
+    Memory * Mem = Memory::create(
+      Mod,
+      MemoryIndex,
+      D->getType(),
+      Index.getMemoryExport(MemoryIndex) != nullptr,
+      D
+    );
+    Memories->push_back(Mem);
+    MemoryIndex += 1;
+  }
+
+  W2N_TRACE(AST, Info, "memories", {"count", Memories->size()});
 
   return Memories;
 }
@@ -294,6 +317,250 @@ MemoryRequest::getCachedResult() const {
 void MemoryRequest::cacheResult(MemoryRequest::OutputType Result) const {
   auto * Mod = std::get<0>(getStorage());
   Mod->Memories = Result;
+  indexPrimitives(
+    *Result,
+    Mod->getModuleIndex().getImportedMemoryCount(),
+    Mod->MemoriesByIndex
+  );
+}
+
+#pragma mark - ModuleIndexRequest
+
+ModuleIndexRequest::OutputType
+ModuleIndexRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
+  assert(Mod);
+  auto Index = std::make_shared<ModuleIndex>();
+
+  if (auto * ImportSection = Mod->getImportSection()) {
+    for (ImportDecl * D : ImportSection->getImports()) {
+      if (auto * Func = dyn_cast<ImportFuncDecl>(D)) {
+        Index->ImportedFunctions.push_back(Func);
+      } else if (auto * Table = dyn_cast<ImportTableDecl>(D)) {
+        Index->ImportedTables.push_back(Table);
+      } else if (auto * Memory = dyn_cast<ImportMemoryDecl>(D)) {
+        Index->ImportedMemories.push_back(Memory);
+      } else if (auto * Global = dyn_cast<ImportGlobalDecl>(D)) {
+        Index->ImportedGlobals.push_back(Global);
+      }
+    }
+  }
+
+  // Size each table to the whole index space, so that lookups of entities
+  // that have no entry are bounds checked only once.
+  size_t FuncCount = Index->ImportedFunctions.size();
+  if (auto * FuncSection = Mod->getFuncSection()) {
+    FuncCount += FuncSection->getFuncTypes().size();
+  }
+  size_t TableCount = Index->ImportedTables.size();
+  if (auto * TableSection = Mod->getTableSection()) {
+    TableCount += TableSection->getTables().size();
+  }
+  size_t MemoryCount = Index->ImportedMemories.size();
+  if (auto * MemorySection = Mod->getMemorySection()) {
+    MemoryCount += MemorySection->getMemories().size();
+  }
+  size_t GlobalCount = Index->ImportedGlobals.size();
+  if (auto * GlobalSection = Mod->getGlobalSection()) {
+    GlobalCount += GlobalSection->getGlobals().size();
+  }
+
+  if (auto * NameSection = Mod->getNameSection()) {
+    auto FillNames = [](
+                       std::vector<Optional<Identifier>>& Names,
+                       size_t Count,
+                       const std::vector<NameAssociation>& NameMap
+                     ) {
+      Names.resize(Count);
+      for (const NameAssociation& Entry : NameMap) {
+        if (Entry.Index < Count) {
+          Names[Entry.Index] = Entry.Name;
+        }
+      }
+    };
+    if (auto * FuncNames = NameSection->getFuncNameSubsection()) {
+      FillNames(Index->FunctionNames, FuncCount, FuncNames->getNameMap());
+    }
+    if (auto * GlobalNames = NameSection->getGlobalNameSubsection()) {
+      FillNames(
+        Index->GlobalNames, GlobalCount, GlobalNames->getNameMap()
+      );
+    }
+  }
+
+  if (auto * ExportSection = Mod->getExportSection()) {
+    auto& Exports = ExportSection->getExports();
+    Index->FunctionExports.resize(FuncCount);
+    Index->TableExports.resize(TableCount);
+    Index->MemoryExports.resize(MemoryCount);
+    Index->GlobalExports.resize(GlobalCount);
+    Index->ExportsByName.reserve(Exports.size());
+
+    // Records the first export of each entity.
+    auto Record = [](auto& Table, uint32_t EntityIndex, auto * D) {
+      if (EntityIndex < Table.size() && Table[EntityIndex] == nullptr) {
+        Table[EntityIndex] = D;
+      }
+    };
+    for (ExportDecl * D : Exports) {
+      Index->ExportsByName.try_emplace(D->getName(), D);
+      if (auto * Func = dyn_cast<ExportFuncDecl>(D)) {
+        Record(Index->FunctionExports, Func->getFuncIndex(), Func);
+      } else if (auto * Table = dyn_cast<ExportTableDecl>(D)) {
+        Record(Index->TableExports, Table->getTableIndex(), Table);
+      } else if (auto * Memory = dyn_cast<ExportMemoryDecl>(D)) {
+        Record(Index->MemoryExports, Memory->getMemoryIndex(), Memory);
+      } else if (auto * Global = dyn_cast<ExportGlobalDecl>(D)) {
+        Record(Index->GlobalExports, Global->getGlobalIndex(), Global);
+      }
+    }
+  }
+
+  W2N_TRACE(
+    AST,
+    Info,
+    "module-index",
+    {"functions", FuncCount},
+    {"exports", Index->ExportsByName.size()}
+  );
+
+  return Index;
+}
+
+evaluator::DependencySource ModuleIndexRequest::readDependencySource(
+  const evaluator::DependencyRecorder& E
+) const {
+  return std::get<0>(getStorage())->getParentSourceFile();
+}
+
+Optional<ModuleIndexRequest::OutputType>
+ModuleIndexRequest::getCachedResult() const {
+  auto * Mod = std::get<0>(getStorage());
+  if (Mod == nullptr || Mod->Index == nullptr) {
+    return None;
+  }
+
+  return Mod->Index;
+}
+
+void ModuleIndexRequest::cacheResult(ModuleIndexRequest::OutputType Result
+) const {
+  auto * Mod = std::get<0>(getStorage());
+  Mod->Index = Result;
+}
+
+#pragma mark - ImmutableTableRequest
+
+ImmutableTableRequest::OutputType
+ImmutableTableRequest::evaluate(Evaluator& Eval, ModuleDecl * Mod) const {
+  assert(Mod);
+  const ModuleIndex& Index = Mod->getModuleIndex();
+  uint32_t TableCount = Index.getImportedTableCount();
+  if (auto * TableSection = Mod->getTableSection()) {
+    TableCount += TableSection->getTables().size();
+  }
+
+  auto Immutable = std::make_shared<llvm::BitVector>(TableCount);
+
+  // The host and the other instances may write the imported and the
+  // exported tables. The instruction set the decoder understands has no
+  // instruction writing a table, so the active element segments are the
+  // only writers of the others.
+  for (const Table& T : Mod->getTables()) {
+    if (!T.isExported()) {
+      Immutable->set(T.getIndex());
+    }
+  }
+
+  if (auto * Section = Mod->getElementSection()) {
+    for (ElementSegmentDecl * Segment : Section->getElementSegments()) {
+      uint32_t TableIndex = Segment->getTableIndex();
+      if (!Segment->isActive() || TableIndex >= TableCount
+          || !Immutable->test(TableIndex)) {
+        continue;
+      }
+      // The elements written at an offset read from an imported global
+      // are only known at instantiation, and a segment which does not
+      // fit fails the instantiation.
+      Optional<uint32_t> Offset = Segment->getConstantOffset();
+      if (!Offset.has_value()
+          || uint64_t(*Offset) + Segment->getFunctionIndices().size()
+               > Mod->getTable(TableIndex)->getMinSize()) {
+        Immutable->reset(TableIndex);
+      }
+    }
+  }
+
+  W2N_TRACE(AST, Info, "immutable-tables", {"count", Immutable->count()});
+
+  return Immutable;
+}
+
+evaluator::DependencySource ImmutableTableRequest::readDependencySource(
+  const evaluator::DependencyRecorder& E
+) const {
+  return std::get<0>(getStorage())->getParentSourceFile();
+}
+
+Optional<ImmutableTableRequest::OutputType>
+ImmutableTableRequest::getCachedResult() const {
+  auto * Mod = std::get<0>(getStorage());
+  if (Mod == nullptr || Mod->ImmutableTables == nullptr) {
+    return None;
+  }
+
+  return Mod->ImmutableTables;
+}
+
+void ImmutableTableRequest::cacheResult(
+  ImmutableTableRequest::OutputType Result
+) const {
+  auto * Mod = std::get<0>(getStorage());
+  Mod->ImmutableTables = Result;
+}
+
+#pragma mark - ReachableFunctionRequest
+
+evaluator::DependencySource
+ReachableFunctionRequest::readDependencySource(
+  const evaluator::DependencyRecorder& E
+) const {
+  return std::get<0>(getStorage())->getParentSourceFile();
+}
+
+Optional<ReachableFunctionRequest::OutputType>
+ReachableFunctionRequest::getCachedResult() const {
+  auto * Mod = std::get<0>(getStorage());
+  if (Mod == nullptr || Mod->ReachableFunctions == nullptr) {
+    return None;
+  }
+
+  return Mod->ReachableFunctions;
+}
+
+void ReachableFunctionRequest::cacheResult(
+  ReachableFunctionRequest::OutputType Result
+) const {
+  auto * Mod = std::get<0>(getStorage());
+  Mod->ReachableFunctions = Result;
+}
+
+#pragma mark - ValidateFunctionRequest
+
+Optional<ValidateFunctionRequest::OutputType>
+ValidateFunctionRequest::getCachedResult() const {
+  auto * Fn = std::get<0>(getStorage());
+  if (Fn->Validation == nullptr) {
+    return None;
+  }
+
+  return Fn->Validation;
+}
+
+void ValidateFunctionRequest::cacheResult(
+  ValidateFunctionRequest::OutputType Result
+) const {
+  auto * Fn = std::get<0>(getStorage());
+  Fn->Validation = Result;
 }
 
 namespace w2n {
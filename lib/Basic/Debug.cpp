@@ -0,0 +1,108 @@
+//===--- Debug.cpp - Structured Tracing -----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringSwitch.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/raw_ostream.h>
+#include <chrono>
+#include <mutex>
+#include <w2n/Basic/Debug.h>
+#include <w2n/Basic/LLVM.h>
+
+using namespace w2n;
+using namespace w2n::trace;
+
+std::atomic<uint32_t> trace::EnabledCategories{0};
+
+std::atomic<uint8_t> trace::EnabledLevel{(uint8_t)Level::Info};
+
+StringRef trace::getCategoryName(Category C) {
+  switch (C) {
+#define TRACE_CATEGORY(Id, Name)                                         \
+  case Category::Id: return Name;
+#include <w2n/Basic/TraceCategories.def>
+  }
+  llvm_unreachable("invalid trace category");
+}
+
+bool trace::enableCategories(StringRef Names) {
+  llvm::SmallVector<StringRef, 4> Parts;
+  Names.split(Parts, ',', /*MaxSplit*/ -1, /*KeepEmpty*/ false);
+  uint32_t Mask = 0;
+  for (StringRef Part : Parts) {
+    Part = Part.trim();
+    if (Part == "all") {
+      Mask = ~0U;
+      continue;
+    }
+    uint32_t Bit = llvm::StringSwitch<uint32_t>(Part)
+#define TRACE_CATEGORY(Id, Name) .Case(Name, 1U << (unsigned)Category::Id)
+#include <w2n/Basic/TraceCategories.def>
+                     .Default(0);
+    if (Bit == 0) {
+      return true;
+    }
+    Mask |= Bit;
+  }
+  EnabledCategories.fetch_or(Mask, std::memory_order_relaxed);
+  return false;
+}
+
+bool trace::setLevel(StringRef Name) {
+  if (Name == "info") {
+    EnabledLevel.store((uint8_t)Level::Info, std::memory_order_relaxed);
+    return false;
+  }
+  if (Name == "verbose") {
+    EnabledLevel.store(
+      (uint8_t)Level::Verbose, std::memory_order_relaxed
+    );
+    return false;
+  }
+  return true;
+}
+
+void trace::emit(
+  Category C, Level L, StringRef Event, llvm::json::Object Args
+) {
+  using Clock = std::chrono::steady_clock;
+  static const Clock::time_point Start = Clock::now();
+  static std::mutex OutputMutex;
+
+  auto Elapsed = Clock::now() - Start;
+  uint64_t Timestamp =
+    std::chrono::duration_cast<std::chrono::microseconds>(Elapsed)
+      .count();
+
+  // Format outside of the lock and write each event with a single call.
+  std::string Line;
+  llvm::raw_string_ostream OS(Line);
+  llvm::json::OStream J(OS);
+  J.object([&] {
+    J.attribute("ts", Timestamp);
+    J.attribute("tid", llvm::get_threadid());
+    J.attribute("cat", getCategoryName(C));
+    J.attribute("level", L == Level::Info ? "info" : "verbose");
+    J.attribute("event", Event);
+    if (!Args.empty()) {
+      J.attribute("args", llvm::json::Value(std::move(Args)));
+    }
+  });
+  OS << '\n';
+  OS.flush();
+
+  std::lock_guard<std::mutex> Lock(OutputMutex);
+  llvm::errs() << Line;
+}
@@ -0,0 +1,48 @@
+//===--- MemoryAdvice.cpp - Memory Access Pattern Hints -------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Process.h>
+#include <w2n/Basic/MemoryAdvice.h>
+
+#if LLVM_ON_UNIX
+#include <sys/mman.h>
+#endif
+
+using namespace w2n;
+
+void w2n::adviseMemoryAccess(
+  const void * Start, size_t Size, MemoryAccess Access
+) {
+#if LLVM_ON_UNIX
+  if (Size == 0) {
+    return;
+  }
+  static const uintptr_t PageSize =
+    llvm::sys::Process::getPageSizeEstimate();
+  uintptr_t Begin = (uintptr_t)Start & ~(PageSize - 1);
+  uintptr_t End = (uintptr_t)Start + Size;
+  int Advice = MADV_NORMAL;
+  switch (Access) {
+  case MemoryAccess::Normal: Advice = MADV_NORMAL; break;
+  case MemoryAccess::Sequential: Advice = MADV_SEQUENTIAL; break;
+  case MemoryAccess::WillNeed: Advice = MADV_WILLNEED; break;
+  }
+  // The hint is best effort: a failure only costs the optimization.
+  (void)::madvise((void *)Begin, End - Begin, Advice);
+#else
+  (void)Start;
+  (void)Size;
+  (void)Access;
+#endif
+}
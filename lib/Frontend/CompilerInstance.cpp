@@ -3,6 +3,7 @@
 #include <w2n/AST/ParseRequests.h>
 #include <w2n/AST/TBDGenRequests.h>
 #include <w2n/AST/TypeCheckerRequests.h>
+#include <w2n/Basic/Debug.h>
 #include <w2n/Basic/Filesystem.h>
 #include <w2n/Frontend/Frontend.h>
 #include <w2n/Sema/Sema.h>
@@ -30,6 +31,11 @@ bool CompilerInstance::setup(
 ) {
   this->Invocation = Invocation;
 
+  if (setUpTracing()) {
+    Error = "Setting up tracing failed";
+    return true;
+  }
+
   // If initializing the overlay file system fails there's no sense in
   // continuing because the compiler will read the wrong files.
   if (setUpVirtualFileSystemOverlays()) {
@@ -58,6 +64,19 @@ void CompilerInstance::freeASTContext() {
   PrimaryBufferIDs.clear();
 }
 
+bool CompilerInstance::setUpTracing() {
+  const auto& Opts = Invocation.getFrontendOptions();
+  for (const std::string& Categories : Opts.TraceCategories) {
+    if (trace::enableCategories(Categories)) {
+      return true;
+    }
+  }
+  if (!Opts.TraceLevel.empty() && trace::setLevel(Opts.TraceLevel)) {
+    return true;
+  }
+  return false;
+}
+
 bool CompilerInstance::setUpVirtualFileSystemOverlays() {
   // FIXME: Set overlay filesystem to SourceMgr when introduce search
   // paths.
@@ -134,18 +153,26 @@ Optional<unsigned> CompilerInstance::getRecordedBufferID(
 Optional<ModuleBuffers>
 CompilerInstance::getInputBuffersIfPresent(const Input& I) {
   if (auto * B = I.getBuffer()) {
-    return ModuleBuffers(llvm::MemoryBuffer::getMemBufferCopy(
-      B->getBuffer(), B->getBufferIdentifier()
+    // The buffer is owned by the client and outlives the compilation, so
+    // it is referenced rather than copied.
+    return ModuleBuffers(llvm::MemoryBuffer::getMemBuffer(
+      B->getMemBufferRef(), /*RequiresNullTerminator*/ false
     ));
   }
   // FIXME: Working with filenames is fragile, maybe use the real path
   // or have some kind of FileManager.
+  //
+  // The binary format is read with explicit bounds and never needs a
+  // null terminator. Not requiring one lets the file be memory-mapped
+  // read-only even when its size is a multiple of the page size, so the
+  // input is neither copied nor duplicated out of the page cache.
   using FileOrError = llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>;
+  bool RequiresNullTerminator = I.getType() != file_types::TY_Wasm;
   FileOrError InputFileOrErr = w2n::vfs::getFileOrSTDIN(
     getFileSystem(),
     I.getFileName(),
     /*FileSize*/ -1,
-    /*RequiresNullTerminator*/ true,
+    RequiresNullTerminator,
     /*IsVolatile*/ false,
     /*Bad File Descriptor Retry*/
     getInvocation().getFrontendOptions().BadFileDescriptorRetryCount
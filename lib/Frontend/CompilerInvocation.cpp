@@ -1,4 +1,5 @@
 #include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringSwitch.h>
 #include <llvm/Option/Arg.h>
 #include <llvm/Option/ArgList.h>
 #include <llvm/Option/Option.h>
@@ -168,6 +169,10 @@ bool parseFrontendOptions(
   // Derive ModuleLinkName
   Options.ModuleLinkName = Options.ModuleName;
 
+  Options.TraceCategories = Args.getAllArgValues(options::OPT_trace_only);
+  Options.TraceLevel =
+    Args.getLastArgValue(options::OPT_trace_level).str();
+
   // Derive RequestedAction
   if (Args.hasArg(options::OPT_emit_object)) {
     Options.RequestedAction = FrontendOptions::ActionType::EmitObject;
@@ -210,6 +215,14 @@ bool parseLanguageOptions(
     Options.EntryPointFunctionName = true;
   }
 
+  if (Args.hasArg(options::OPT_compact_instructions)) {
+    Options.UseCompactInstructions = true;
+  }
+
+  if (Args.hasArg(options::OPT_validate_reachable_functions_only)) {
+    Options.ValidateReachableFunctionsOnly = true;
+  }
+
   return false;
 }
 
@@ -241,6 +254,62 @@ bool parseIRGenOptions(
     } else if (Args.hasArg(options::OPT_emit_bc)) {
       Options.OutputKind = IRGenOutputKind::LLVMBitcode;
     }
+    if (const Arg * A = Args.getLastArg(options::OPT_O_Group)) {
+      if (A->getOption().matches(options::OPT_Onone)) {
+        Options.OptMode = OptimizationMode::NoOptimization;
+      } else if (A->getOption().matches(options::OPT_Osize)) {
+        Options.OptMode = OptimizationMode::ForSize;
+      } else {
+        Options.OptMode = OptimizationMode::ForSpeed;
+      }
+    } else {
+      Options.OptMode = OptimizationMode::NotSet;
+    }
+    Options.NumThreads = 0;
+    if (const Arg * A = Args.getLastArg(options::OPT_num_threads)) {
+      if (StringRef(A->getValue()).getAsInteger(10, Options.NumThreads)) {
+        // TODO: Diagnose invalid number of threads.
+        Options.NumThreads = 0;
+      }
+    }
+    Options.CodeGenPartitions = 0;
+    if (const Arg * A =
+          Args.getLastArg(options::OPT_codegen_partitions)) {
+      StringRef Value(A->getValue());
+      if (Value.getAsInteger(10, Options.CodeGenPartitions)) {
+        // TODO: Diagnose invalid number of partitions.
+        Options.CodeGenPartitions = 0;
+      }
+    }
+    Options.IRGenPartitionSize = 64 * 1024;
+    if (const Arg * A =
+          Args.getLastArg(options::OPT_irgen_partition_size)) {
+      uint64_t Size = 0;
+      StringRef Value(A->getValue());
+      // TODO: Diagnose invalid partition sizes.
+      if (!Value.getAsInteger(10, Size) && Size != 0) {
+        Options.IRGenPartitionSize = Size;
+      }
+    }
+    Options.MemoryBoundsChecks = IRGenMemoryBoundsChecks::Automatic;
+    if (const Arg * A =
+          Args.getLastArg(options::OPT_memory_bounds_checks)) {
+      // TODO: Diagnose invalid memory bounds checks.
+      Options.MemoryBoundsChecks =
+        llvm::StringSwitch<IRGenMemoryBoundsChecks>(A->getValue())
+          .Case("guard-pages", IRGenMemoryBoundsChecks::GuardPages)
+          .Case("explicit", IRGenMemoryBoundsChecks::Explicit)
+          .Default(IRGenMemoryBoundsChecks::Automatic);
+    }
+    Options.MemoryBase = IRGenMemoryBase::Register;
+    if (const Arg * A = Args.getLastArg(options::OPT_memory_base)) {
+      // TODO: Diagnose invalid memory bases.
+      Options.MemoryBase =
+        llvm::StringSwitch<IRGenMemoryBase>(A->getValue())
+          .Case("register", IRGenMemoryBase::Register)
+          .Case("segment", IRGenMemoryBase::Segment)
+          .Default(IRGenMemoryBase::Register);
+    }
     Options.EnableStackProtection = Args.hasFlag(
       options::OPT_enable_stack_protector,
       options::OPT_disable_stack_protector,
@@ -188,16 +188,23 @@ bool performCompileStepsPostSema(
         Opts.InputsAndOutputs.copyOutputFilenames();
       llvm::GlobalVariable * HashGlobal;
       auto * Mod = PrimaryFile->getModule();
+      // Multi-threaded IR generation works on the whole module and
+      // writes the output of every LLVM module itself.
+      bool IsParallel = IRGenOpts.shouldPerformIRGenerationInParallel();
       auto IRModule = generateIR(
         IRGenOpts,
         Invocation.getTBDGenOptions(),
         Mod,
         PSPs,
         OutputFilename,
-        PrimaryFile,
+        IsParallel ? ModuleOrSourceFile(Mod) : PrimaryFile,
         HashGlobal,
         ParallelOutputFilenames
       );
+      if (IsParallel) {
+        Result |= Instance.getDiags().hadAnyError();
+        continue;
+      }
       Result |= generateCode(
         Instance, OutputFilename, IRModule.getModule(), HashGlobal
       );
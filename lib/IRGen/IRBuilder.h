@@ -415,6 +415,20 @@ public:
     return Call;
   }
 
+  /// Calls the function \p Callee points to, whose type is \p FTy ,
+  /// like a function pointer loaded from a table.
+  llvm::CallInst * CreateIndirectCall(
+    llvm::FunctionType * FTy,
+    llvm::Value * Callee,
+    ArrayRef<llvm::Value *> Args,
+    const Twine& Name = ""
+  ) {
+    assert(
+      (!DebugInfo || getCurrentDebugLocation()) && "no debugloc on call"
+    );
+    return IRBuilderBase::CreateCall(FTy, Callee, Args, Name);
+  }
+
   llvm::CallInst * CreateCallWithoutDbgLoc(
     llvm::FunctionType * FTy,
     llvm::Constant * Callee,
@@ -1,13 +1,21 @@
 #include "IRGenModule.h"
+#include "MemoryBoundsChecks.h"
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Bitcode/BitcodeReader.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/Bitcode/BitcodeWriterPass.h>
 #include <llvm/IR/IRPrintingPasses.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/PassManager.h>
+#include <llvm/IR/Verifier.h>
 #include <llvm/MC/SubtargetFeature.h>
 #include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
 #include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Timer.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
@@ -19,13 +27,17 @@
 #include <llvm/Transforms/Instrumentation/ThreadSanitizer.h>
 #include <llvm/Transforms/ObjCARC.h>
 #include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/Scalar/SimplifyCFG.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 #include <w2n/AST/DiagnosticsCommon.h>
 #include <w2n/AST/DiagnosticsIRGen.h>
 #include <w2n/AST/FileUnit.h>
 #include <w2n/AST/IRGenRequests.h>
 #include <w2n/AST/Module.h>
 #include <w2n/AST/SourceFile.h>
+#include <w2n/AST/TypeCheckerRequests.h>
 #include <w2n/Basic/Defer.h>
+#include <w2n/Basic/Filesystem.h>
 #include <w2n/Basic/Unimplemented.h>
 #include <w2n/IRGen/IRGen.h>
 
@@ -52,6 +64,22 @@ void diagnoseSync(
   }
 }
 
+/// Returns the output filename of the LLVM module or partition at
+/// \p Index when the output is split: "foo.o", "foo.1.o", "foo.2.o" and
+/// so on.
+static std::string
+getPartitionOutputFilename(StringRef OutputFilename, unsigned Index) {
+  if (Index == 0 || OutputFilename.empty() || OutputFilename == "-") {
+    return OutputFilename.str();
+  }
+  SmallString<PathLength128> Filename(OutputFilename);
+  llvm::sys::path::replace_extension(
+    Filename,
+    llvm::Twine(Index) + llvm::sys::path::extension(OutputFilename)
+  );
+  return Filename.str().str();
+}
+
 bool w2n::performLLVM(
   const IRGenOptions& Opts,
   DiagnosticEngine& Diags,
@@ -92,10 +120,28 @@ bool w2n::performLLVM(
     );
   }
 
+  performLLVMOptimizations(Opts, Module, TargetMachine, Stats);
+
   if (!RawOS) {
     return false;
   }
 
+  bool IsNativeOutput =
+    Opts.OutputKind == IRGenOutputKind::NativeAssembly
+    || Opts.OutputKind == IRGenOutputKind::ObjectFile;
+  if (IsNativeOutput && Opts.CodeGenPartitions > 1) {
+    return splitAndCompileLLVM(
+      Module,
+      TargetMachine,
+      Opts,
+      Stats,
+      Diags,
+      OutputFilename,
+      *RawOS,
+      DiagMutex
+    );
+  }
+
   return compileAndWriteLLVM(
     Module, TargetMachine, Opts, Stats, Diags, *RawOS, DiagMutex
   );
@@ -104,8 +150,68 @@ bool w2n::performLLVM(
 void w2n::performLLVMOptimizations(
   const IRGenOptions& Opts,
   llvm::Module * Module,
-  llvm::TargetMachine * TargetMachine
+  llvm::TargetMachine * TargetMachine,
+  UnifiedStatsReporter * Stats
 ) {
+  FrontendStatsTracer Tracer(Stats, "LLVM pipeline");
+
+  bool OptimizeForSize = Opts.OptMode == OptimizationMode::ForSize;
+
+  PipelineTuningOptions PTO;
+  // Loop unrolling and vectorization grow the code for speed, which is
+  // not what -Osize asks for.
+  PTO.LoopUnrolling = !OptimizeForSize;
+  PTO.LoopInterleaving = !OptimizeForSize;
+  PTO.LoopVectorization = !OptimizeForSize;
+  PTO.SLPVectorization = !OptimizeForSize;
+  // Wasm modules carry many identical functions produced by generic code
+  // of the source language, which are worth folding for size.
+  PTO.MergeFunctions = OptimizeForSize;
+
+  PassBuilder PB(TargetMachine, PTO);
+
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  ModulePassManager MPM;
+  if (Opts.shouldOptimize()) {
+    // The producer of the Wasm module has already optimized it. What is
+    // left is mostly the blocks IRGen creates for every label and the
+    // continuation of every br_if, which are folded before the inliner
+    // looks at the size of the functions.
+    PB.registerPipelineStartEPCallback(
+      [](ModulePassManager& MPM, OptimizationLevel Level) {
+        MPM.addPass(createModuleToFunctionPassAdaptor(SimplifyCFGPass()));
+      }
+    );
+    // The bounds checks of a memory are only redundant once GVN and LICM
+    // have made the indices of the accesses the same values. The checks
+    // removed are left as branches on false for SimplifyCFG to fold.
+    PB.registerScalarOptimizerLateEPCallback(
+      [](FunctionPassManager& FPM, OptimizationLevel Level) {
+        FPM.addPass(MemoryBoundsCheckOptPass());
+        FPM.addPass(SimplifyCFGPass());
+      }
+    );
+    OptimizationLevel Level =
+      OptimizeForSize ? OptimizationLevel::Os : OptimizationLevel::O2;
+    MPM = PB.buildPerModuleDefaultPipeline(Level);
+  } else {
+    MPM = PB.buildO0DefaultPipeline(OptimizationLevel::O0);
+  }
+
+  if (Opts.Verify) {
+    MPM.addPass(VerifierPass());
+  }
+
+  MPM.run(*Module, MAM);
 }
 
 bool w2n::compileAndWriteLLVM(
@@ -198,6 +304,128 @@ bool w2n::compileAndWriteLLVM(
   return false;
 }
 
+/// Creates a target machine for the same target and with the same
+/// options as \p TM .
+static std::unique_ptr<llvm::TargetMachine>
+cloneTargetMachine(const llvm::TargetMachine& TM) {
+  return std::unique_ptr<llvm::TargetMachine>(
+    TM.getTarget().createTargetMachine(
+      TM.getTargetTriple().str(),
+      TM.getTargetCPU(),
+      TM.getTargetFeatureString(),
+      TM.Options,
+      TM.getRelocationModel(),
+      TM.getCodeModel(),
+      TM.getOptLevel()
+    )
+  );
+}
+
+bool w2n::splitAndCompileLLVM(
+  llvm::Module * Module,
+  llvm::TargetMachine * TargetMachine,
+  const IRGenOptions& Opts,
+  UnifiedStatsReporter * Stats,
+  DiagnosticEngine& Diags,
+  StringRef OutputFilename,
+  llvm::raw_pwrite_stream& Out,
+  llvm::sys::Mutex * DiagMutex
+) {
+  // An LLVMContext can only be used by one thread at a time, so every
+  // partition is serialized and read back into its own context.
+  SmallVector<SmallString<0>, 8> Bitcodes;
+  {
+    FrontendStatsTracer Tracer(Stats, "LLVM module splitting");
+    SplitModule(
+      *Module,
+      Opts.CodeGenPartitions,
+      [&](std::unique_ptr<llvm::Module> Partition) {
+        raw_svector_ostream OS(Bitcodes.emplace_back());
+        WriteBitcodeToFile(*Partition, OS);
+      },
+      /*PreserveLocals*/ false
+    );
+  }
+
+  std::vector<std::unique_ptr<llvm::TargetMachine>> TargetMachines;
+  TargetMachines.reserve(Bitcodes.size());
+  for (size_t I = 0; I < Bitcodes.size(); I++) {
+    TargetMachines.push_back(cloneTargetMachine(*TargetMachine));
+  }
+
+  // compileAndWriteLLVM updates the statistics under the mutex.
+  llvm::sys::Mutex StatsMutex;
+  if (DiagMutex == nullptr) {
+    DiagMutex = &StatsMutex;
+  }
+
+  std::vector<SmallString<0>> Outputs(Bitcodes.size());
+  std::atomic<bool> HadError(false);
+  auto CompilePartition = [&](unsigned I) {
+    std::string TimerName =
+      "LLVM codegen partition " + std::to_string(I);
+    llvm::NamedRegionTimer Timer(
+      TimerName, TimerName, "swift", "Swift compilation", Stats != nullptr
+    );
+
+    LLVMContext Context;
+    std::unique_ptr<llvm::Module> Partition = cantFail(parseBitcodeFile(
+      MemoryBufferRef(Bitcodes[I], "<partition>"), Context
+    ));
+    raw_svector_ostream OS(Outputs[I]);
+    if (compileAndWriteLLVM(
+          Partition.get(),
+          TargetMachines[I].get(),
+          Opts,
+          Stats,
+          Diags,
+          OS,
+          DiagMutex
+        )) {
+      HadError = true;
+    }
+  };
+
+  {
+    FrontendStatsTracer Tracer(Stats, "LLVM parallel codegen");
+    llvm::ThreadPool Pool(llvm::hardware_concurrency(Bitcodes.size()));
+    for (unsigned I = 0; I < Bitcodes.size(); I++) {
+      Pool.async(CompilePartition, I);
+    }
+    Pool.wait();
+  }
+
+  if (HadError) {
+    return true;
+  }
+
+  // Write the outputs in the order of the partitions, so the output does
+  // not depend on the scheduling of the threads.
+  for (unsigned I = 0; I < Outputs.size(); I++) {
+    std::string Filename = getPartitionOutputFilename(OutputFilename, I);
+    if (Filename == OutputFilename) {
+      Out << Outputs[I];
+      continue;
+    }
+    std::error_code EC;
+    raw_fd_ostream OS(Filename, EC, llvm::sys::fs::OF_None);
+    if (OS.has_error() || EC) {
+      diagnoseSync(
+        Diags,
+        DiagMutex,
+        SourceLoc(),
+        diag::error_opening_output,
+        Filename,
+        EC.message()
+      );
+      OS.clear_error();
+      return true;
+    }
+    OS << Outputs[I];
+  }
+  return false;
+}
+
 std::tuple<
   llvm::TargetOptions,
   std::string,
@@ -301,6 +529,8 @@ w2n::createTargetMachine(const IRGenOptions& Opts, ASTContext& Ctx) {
   return std::unique_ptr<llvm::TargetMachine>(TargetMachine);
 }
 
+static void performParallelIRGeneration(IRGenDescriptor Desc);
+
 GeneratedModule w2n::performIRGeneration(
   ModuleDecl * M,
   const IRGenOptions& Opts,
@@ -311,7 +541,25 @@ GeneratedModule w2n::performIRGeneration(
   ArrayRef<std::string> ParallelOutputFilenames,
   llvm::GlobalVariable ** OutModuleHash
 ) {
-  w2n_unimplemented();
+  auto Desc = IRGenDescriptor::forWholeModule(
+    *M,
+    Opts,
+    TBDOpts,
+    ModuleName,
+    PSPs,
+    /*symsToEmit*/ None,
+    ParallelOutputFilenames,
+    OutModuleHash
+  );
+
+  if (Opts.shouldPerformIRGenerationInParallel()) {
+    performParallelIRGeneration(Desc);
+    // The output of every LLVM module has been written already, and there
+    // is no single module to return.
+    return GeneratedModule::null();
+  }
+
+  return llvm::cantFail(M->getASTContext().Eval(IRGenRequest{Desc}));
 }
 
 GeneratedModule w2n::performIRGeneration(
@@ -394,6 +642,184 @@ static void embedBitcode(llvm::Module * M, const IRGenOptions& Opts) {
   w2n_proto_implemented();
 }
 
+/// Generates LLVM IR, runs the LLVM passes and produces the output files
+/// on multiple threads.
+///
+/// The functions of the module are distributed over several LLVM modules,
+/// each with its own LLVMContext, which are generated, optimized and
+/// compiled independently. Each thread writes its output into memory, and
+/// the outputs are written in the order of the LLVM modules at the end,
+/// so the output does not depend on the number of threads.
+static void performParallelIRGeneration(IRGenDescriptor Desc) {
+  const auto& Opts = Desc.Opts;
+  const auto& PSPs = Desc.PSPs;
+  auto * M = Desc.getParentModule();
+  auto& Ctx = M->getASTContext();
+  assert(!Ctx.hadError());
+
+  FrontendStatsTracer Tracer(Ctx.Stats, "parallel IRGen");
+
+  auto& WasmModule = Desc.Mod;
+  IRGenerator IRGen(Opts, WasmModule);
+
+  SourceFile * PrimaryFile = nullptr;
+  std::vector<w2n::Function *> Functions;
+  for (auto * File : Desc.getFilesToEmit()) {
+    if (auto * SF = dyn_cast<SourceFile>(File)) {
+      if (PrimaryFile == nullptr) {
+        PrimaryFile = SF;
+      }
+      auto FunctionsOfFile = IRGen.collectFunctionsToEmit(*SF);
+      Functions.insert(
+        Functions.end(), FunctionsOfFile.begin(), FunctionsOfFile.end()
+      );
+    }
+  }
+
+  // The evaluator is not thread-safe. Everything IR generation looks up
+  // through it is computed here, so the threads only read cached results,
+  // whatever the order the module is emitted in.
+  WasmModule.getModuleIndex();
+  WasmModule.getGlobalList();
+  for (auto& T : WasmModule.getTableList()) {
+    WasmModule.isTableImmutable(T.getIndex());
+  }
+  WasmModule.getMemoryList();
+  for (auto * F : Functions) {
+    evaluateOrDefault(Ctx.Eval, ValidateFunctionRequest{F}, nullptr);
+  }
+
+  // Create the IR emitters. The first one also emits everything which is
+  // not a function defined by the module.
+  unsigned PartitionCount = IRGen.getPartitionCount(Functions);
+  std::vector<std::unique_ptr<IRGenModule>> IGMs;
+  IGMs.reserve(PartitionCount);
+  for (unsigned I = 0; I < PartitionCount; I++) {
+    auto TargetMachine = IRGen.createTargetMachine();
+    if (!TargetMachine) {
+      return;
+    }
+    std::string ModuleName = Desc.ModuleName.str();
+    if (I != 0) {
+      ModuleName += "." + std::to_string(I);
+    }
+    IGMs.push_back(std::make_unique<IRGenModule>(
+      IRGen,
+      std::move(TargetMachine),
+      I == 0 ? PrimaryFile : nullptr,
+      ModuleName,
+      getPartitionOutputFilename(PSPs.OutputFilename, I),
+      PSPs.MainInputFilenameForDebugInfo
+    ));
+    initLLVMModule(*IGMs.back(), WasmModule);
+  }
+  IRGen.partitionFunctions(Functions);
+
+  IRGenModule& PrimaryIGM = *IGMs.front();
+  runIRGenPreparePasses(WasmModule, PrimaryIGM);
+  IRGen.emitGlobalTopLevel(Desc.getLinkerDirectives());
+  if (PrimaryFile != nullptr) {
+    PrimaryIGM.emitGlobalsAndDataSegments(*PrimaryFile);
+  }
+  IRGen.emitLazyDefinitions();
+  PrimaryIGM.emitCoverageMapping();
+  if (Ctx.hadError()) {
+    return;
+  }
+
+  llvm::sys::Mutex DiagMutex;
+  std::vector<SmallString<0>> Outputs(IGMs.size());
+  std::atomic<bool> HadError(false);
+
+  // The reduction configurations of the emitted functions are allocated
+  // in the context, from an arena of each task.
+  ASTContext::TaskArenas Arenas(Ctx);
+
+  auto EmitPartition = [&](unsigned I) {
+    ASTContext::TaskArenas::Scope Arena(Arenas);
+    IRGenModule& IGM = *IGMs[I];
+    for (w2n::Function * F : IRGen.getQueuedFunctions(&IGM)) {
+      IGM.emitFunction(F);
+    }
+    if (!IGM.finalize()) {
+      HadError = true;
+      return;
+    }
+    setModuleFlags(IGM);
+    embedBitcode(IGM.getModule(), Opts);
+
+    raw_svector_ostream OS(Outputs[I]);
+    if (Opts.OutputKind
+        == IRGenOutputKind::LLVMAssemblyBeforeOptimization) {
+      IGM.getModule()->print(OS, nullptr);
+      return;
+    }
+    {
+      // Stats tracers may only run on the main thread, so the pipeline
+      // of each partition is timed on its own, as the code generation of
+      // the partitions of splitAndCompileLLVM is.
+      std::string TimerName =
+        "LLVM pipeline partition " + std::to_string(I);
+      llvm::NamedRegionTimer Timer(
+        TimerName,
+        TimerName,
+        "swift",
+        "Swift compilation",
+        Ctx.Stats != nullptr
+      );
+      performLLVMOptimizations(
+        Opts, IGM.getModule(), IGM.TargetMachine.get()
+      );
+    }
+    if (Opts.OutputKind == IRGenOutputKind::Module) {
+      return;
+    }
+    if (compileAndWriteLLVM(
+          IGM.getModule(),
+          IGM.TargetMachine.get(),
+          Opts,
+          Ctx.Stats,
+          Ctx.Diags,
+          OS,
+          &DiagMutex
+        )) {
+      HadError = true;
+    }
+  };
+
+  {
+    llvm::ThreadPool Pool(llvm::hardware_concurrency(Opts.NumThreads));
+    for (unsigned I = 0; I < IGMs.size(); I++) {
+      Pool.async(EmitPartition, I);
+    }
+    Pool.wait();
+  }
+
+  if (HadError || Ctx.hadError()) {
+    return;
+  }
+
+  for (unsigned I = 0; I < IGMs.size(); I++) {
+    StringRef OutputFilename = IGMs[I]->OutputFilename;
+    if (OutputFilename.empty()) {
+      continue;
+    }
+    std::error_code EC;
+    raw_fd_ostream OS(OutputFilename, EC, llvm::sys::fs::OF_None);
+    if (OS.has_error() || EC) {
+      Ctx.Diags.diagnose(
+        SourceLoc(),
+        diag::error_opening_output,
+        OutputFilename,
+        EC.message()
+      );
+      OS.clear_error();
+      return;
+    }
+    OS << Outputs[I];
+  }
+}
+
 /// Generates LLVM IR, runs the LLVM passes and produces the output file.
 /// All this is done in a single thread.
 GeneratedModule
@@ -495,7 +921,16 @@ IRGenRequest::evaluate(Evaluator& Eval, IRGenDescriptor Desc) const {
 GeneratedModule OptimizedIRRequest::evaluate(
   Evaluator& Eval, IRGenDescriptor Desc
 ) const {
-  w2n_unimplemented();
+  auto& Ctx = Desc.getParentModule()->getASTContext();
+  auto IRMod = cantFail(Eval(IRGenRequest{Desc}));
+  if (!IRMod) {
+    return IRMod;
+  }
+
+  performLLVMOptimizations(
+    Desc.Opts, IRMod.getModule(), IRMod.getTargetMachine(), Ctx.Stats
+  );
+  return IRMod;
 }
 
 StringRef SymbolObjectCodeRequest::evaluate(
@@ -0,0 +1,330 @@
+#include "IRBuilder.h"
+#include "IRGenFunction.h"
+#include "IRGenModule.h"
+#include "Reduction.h"
+#include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Intrinsics.h>
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/Instructions.h>
+
+using namespace w2n;
+using namespace w2n::irgen;
+
+#pragma mark - IRGenFunction
+
+/// Returns the LLVM predicate of an integer comparison builtin.
+static llvm::CmpInst::Predicate getIntegerPredicate(BuiltinValueKind K) {
+  switch (K) {
+  case BuiltinValueKind::ICMP_EQ: return llvm::CmpInst::ICMP_EQ;
+  case BuiltinValueKind::ICMP_NE: return llvm::CmpInst::ICMP_NE;
+  case BuiltinValueKind::ICMP_SLE: return llvm::CmpInst::ICMP_SLE;
+  case BuiltinValueKind::ICMP_SLT: return llvm::CmpInst::ICMP_SLT;
+  case BuiltinValueKind::ICMP_SGE: return llvm::CmpInst::ICMP_SGE;
+  case BuiltinValueKind::ICMP_SGT: return llvm::CmpInst::ICMP_SGT;
+  case BuiltinValueKind::ICMP_ULE: return llvm::CmpInst::ICMP_ULE;
+  case BuiltinValueKind::ICMP_ULT: return llvm::CmpInst::ICMP_ULT;
+  case BuiltinValueKind::ICMP_UGE: return llvm::CmpInst::ICMP_UGE;
+  case BuiltinValueKind::ICMP_UGT: return llvm::CmpInst::ICMP_UGT;
+  default: llvm_unreachable("not an integer comparison");
+  }
+}
+
+/// Returns the LLVM predicate of a floating-point comparison builtin.
+static llvm::CmpInst::Predicate getFloatPredicate(BuiltinValueKind K) {
+  switch (K) {
+  case BuiltinValueKind::FCMP_OEQ: return llvm::CmpInst::FCMP_OEQ;
+  case BuiltinValueKind::FCMP_OGT: return llvm::CmpInst::FCMP_OGT;
+  case BuiltinValueKind::FCMP_OGE: return llvm::CmpInst::FCMP_OGE;
+  case BuiltinValueKind::FCMP_OLT: return llvm::CmpInst::FCMP_OLT;
+  case BuiltinValueKind::FCMP_OLE: return llvm::CmpInst::FCMP_OLE;
+  case BuiltinValueKind::FCMP_UNE: return llvm::CmpInst::FCMP_UNE;
+  default: llvm_unreachable("not a floating-point comparison");
+  }
+}
+
+/// Returns the LLVM intrinsic of a floating-point builtin which maps to
+/// one.
+static llvm::Intrinsic::ID getFloatIntrinsic(BuiltinValueKind K) {
+  switch (K) {
+  // Wasm min and max propagate NaNs and order -0 below +0.
+  case BuiltinValueKind::FMin: return llvm::Intrinsic::minimum;
+  case BuiltinValueKind::FMax: return llvm::Intrinsic::maximum;
+  case BuiltinValueKind::FCopySign: return llvm::Intrinsic::copysign;
+  case BuiltinValueKind::FAbs: return llvm::Intrinsic::fabs;
+  case BuiltinValueKind::FCeil: return llvm::Intrinsic::ceil;
+  case BuiltinValueKind::FFloor: return llvm::Intrinsic::floor;
+  case BuiltinValueKind::FTrunc: return llvm::Intrinsic::trunc;
+  // Wasm rounds the halfway cases of nearest to even.
+  case BuiltinValueKind::FNearest: return llvm::Intrinsic::roundeven;
+  case BuiltinValueKind::FSqrt: return llvm::Intrinsic::sqrt;
+  default: llvm_unreachable("not a floating-point intrinsic");
+  }
+}
+
+/// Returns whether \p Value truncates toward zero to an integer of type
+/// \p IntTy , which it does not when it is a NaN.
+static llvm::Value * emitIsTruncationInRange(
+  IRBuilder& Builder,
+  llvm::Value * Value,
+  llvm::Type * IntTy,
+  bool IsSigned
+) {
+  const llvm::fltSemantics& Semantics =
+    Value->getType()->getFltSemantics();
+  unsigned BitWidth = IntTy->getIntegerBitWidth();
+
+  // The bounds are one past the smallest and the largest integers, with
+  // one more bit to hold them.
+  llvm::APInt Min = llvm::APInt::getNullValue(BitWidth + 1);
+  if (IsSigned) {
+    Min = llvm::APInt::getSignedMinValue(BitWidth).sext(BitWidth + 1);
+  }
+  llvm::APInt Max = llvm::APInt::getOneBitSet(
+    BitWidth + 1, IsSigned ? BitWidth - 1 : BitWidth
+  );
+
+  // The upper bound is a power of two, which is exact. The lower bound
+  // is exact when the type has the precision to tell it from the
+  // smallest integer, and the smallest integer is the bound otherwise.
+  llvm::APFloat Upper(Semantics);
+  Upper.convertFromAPInt(
+    Max, /*IsSigned*/ false, llvm::APFloat::rmNearestTiesToEven
+  );
+  llvm::APFloat Lower(Semantics);
+  auto Status = Lower.convertFromAPInt(
+    Min - 1, /*IsSigned*/ true, llvm::APFloat::rmNearestTiesToEven
+  );
+  llvm::Value * AboveLower = nullptr;
+  if (Status == llvm::APFloat::opOK) {
+    AboveLower = Builder.CreateFCmpOGT(
+      Value, llvm::ConstantFP::get(Value->getType(), Lower)
+    );
+  } else {
+    Lower.convertFromAPInt(
+      Min, /*IsSigned*/ true, llvm::APFloat::rmNearestTiesToEven
+    );
+    AboveLower = Builder.CreateFCmpOGE(
+      Value, llvm::ConstantFP::get(Value->getType(), Lower)
+    );
+  }
+  llvm::Value * BelowUpper = Builder.CreateFCmpOLT(
+    Value, llvm::ConstantFP::get(Value->getType(), Upper)
+  );
+  return Builder.CreateAnd(AboveLower, BelowUpper);
+}
+
+void IRGenFunction::emitBuiltin(Instruction Inst) {
+  const InstInfo& Info = getInstInfo(Inst);
+  ASTContext& Ctx = Fn->getASTContext();
+  auto * ResultTy = IGM.getType(Ctx.getValueTypeForKind(Info.ResultType));
+
+  SmallVector<llvm::Value *, 2> Operands;
+  popValues(Operands, Info.Pops);
+  llvm::Value * LHS = Operands.front();
+  llvm::Value * RHS = Operands.back();
+  auto * OperandTy = LHS->getType();
+
+  // Wasm shifts and rotates by the count modulo the bit width, where
+  // LLVM shifts by counts past the bit width are poison.
+  auto MaskShiftCount = [&]() {
+    return Builder.CreateAnd(
+      RHS, OperandTy->getIntegerBitWidth() - 1, "shift.count"
+    );
+  };
+
+  llvm::Value * Result = nullptr;
+  switch (Info.Builtin) {
+  case BuiltinValueKind::Add: Result = Builder.CreateAdd(LHS, RHS); break;
+  case BuiltinValueKind::Sub: Result = Builder.CreateSub(LHS, RHS); break;
+  case BuiltinValueKind::Mul: Result = Builder.CreateMul(LHS, RHS); break;
+  case BuiltinValueKind::And: Result = Builder.CreateAnd(LHS, RHS); break;
+  case BuiltinValueKind::Or: Result = Builder.CreateOr(LHS, RHS); break;
+  case BuiltinValueKind::Xor: Result = Builder.CreateXor(LHS, RHS); break;
+  case BuiltinValueKind::Shl:
+    Result = Builder.CreateShl(LHS, MaskShiftCount());
+    break;
+  case BuiltinValueKind::AShr:
+    Result = Builder.CreateAShr(LHS, MaskShiftCount());
+    break;
+  case BuiltinValueKind::LShr:
+    Result = Builder.CreateLShr(LHS, MaskShiftCount());
+    break;
+  case BuiltinValueKind::RotL:
+  case BuiltinValueKind::RotR:
+    // Funnel shifts take the count modulo the bit width already.
+    Result = Builder.CreateIntrinsic(
+      Info.Builtin == BuiltinValueKind::RotL ? llvm::Intrinsic::fshl
+                                             : llvm::Intrinsic::fshr,
+      {OperandTy},
+      {LHS, LHS, RHS}
+    );
+    break;
+  case BuiltinValueKind::UDiv:
+  case BuiltinValueKind::URem:
+  case BuiltinValueKind::SDiv:
+  case BuiltinValueKind::SRem: {
+    auto * Zero = llvm::ConstantInt::get(OperandTy, 0);
+    emitTrapIf(Builder.CreateICmpEQ(RHS, Zero), "div.nonzero");
+    if (Info.Builtin == BuiltinValueKind::UDiv) {
+      Result = Builder.CreateUDiv(LHS, RHS);
+      break;
+    }
+    if (Info.Builtin == BuiltinValueKind::URem) {
+      Result = Builder.CreateURem(LHS, RHS);
+      break;
+    }
+    auto * IsMinusOne = Builder.CreateICmpEQ(
+      RHS, llvm::ConstantInt::getAllOnesValue(OperandTy)
+    );
+    if (Info.Builtin == BuiltinValueKind::SDiv) {
+      // The quotient of the smallest integer by -1 does not fit.
+      auto * Min = llvm::ConstantInt::get(
+        OperandTy,
+        llvm::APInt::getSignedMinValue(OperandTy->getIntegerBitWidth())
+      );
+      emitTrapIf(
+        Builder.CreateAnd(IsMinusOne, Builder.CreateICmpEQ(LHS, Min)),
+        "div.nooverflow"
+      );
+      Result = Builder.CreateSDiv(LHS, RHS);
+      break;
+    }
+    // The remainder by -1 is 0, which is also the remainder by 1, where
+    // LLVM leaves the remainder of the smallest integer by -1 undefined.
+    Result = Builder.CreateSRem(
+      LHS,
+      Builder.CreateSelect(
+        IsMinusOne, llvm::ConstantInt::get(OperandTy, 1), RHS
+      )
+    );
+    break;
+  }
+  case BuiltinValueKind::ICMP_EQZ:
+    Result = Builder.CreateZExt(Builder.CreateIsNull(LHS), ResultTy);
+    break;
+  case BuiltinValueKind::ICMP_EQ:
+  case BuiltinValueKind::ICMP_NE:
+  case BuiltinValueKind::ICMP_SLE:
+  case BuiltinValueKind::ICMP_SLT:
+  case BuiltinValueKind::ICMP_SGE:
+  case BuiltinValueKind::ICMP_SGT:
+  case BuiltinValueKind::ICMP_ULE:
+  case BuiltinValueKind::ICMP_ULT:
+  case BuiltinValueKind::ICMP_UGE:
+  case BuiltinValueKind::ICMP_UGT:
+    Result = Builder.CreateZExt(
+      Builder.CreateICmp(getIntegerPredicate(Info.Builtin), LHS, RHS),
+      ResultTy
+    );
+    break;
+  case BuiltinValueKind::Clz:
+  case BuiltinValueKind::Ctz:
+    // The count of zeros of 0 is the bit width.
+    Result = Builder.CreateIntrinsic(
+      Info.Builtin == BuiltinValueKind::Clz ? llvm::Intrinsic::ctlz
+                                            : llvm::Intrinsic::cttz,
+      {OperandTy},
+      {LHS, Builder.getFalse()}
+    );
+    break;
+  case BuiltinValueKind::Popcnt:
+    Result = Builder.CreateUnaryIntrinsic(llvm::Intrinsic::ctpop, LHS);
+    break;
+  case BuiltinValueKind::Trunc:
+    Result = Builder.CreateTrunc(LHS, ResultTy);
+    break;
+  case BuiltinValueKind::ZExt:
+    Result = Builder.CreateZExt(LHS, ResultTy);
+    break;
+  case BuiltinValueKind::SExt:
+    Result = Builder.CreateSExt(LHS, ResultTy);
+    break;
+  case BuiltinValueKind::FAdd:
+    Result = Builder.CreateFAdd(LHS, RHS);
+    break;
+  case BuiltinValueKind::FSub:
+    Result = Builder.CreateFSub(LHS, RHS);
+    break;
+  case BuiltinValueKind::FMul:
+    Result = Builder.CreateFMul(LHS, RHS);
+    break;
+  case BuiltinValueKind::FDiv:
+    Result = Builder.CreateFDiv(LHS, RHS);
+    break;
+  case BuiltinValueKind::FMin:
+  case BuiltinValueKind::FMax:
+  case BuiltinValueKind::FCopySign:
+    Result = Builder.CreateBinaryIntrinsic(
+      getFloatIntrinsic(Info.Builtin), LHS, RHS
+    );
+    break;
+  case BuiltinValueKind::FNeg: Result = Builder.CreateFNeg(LHS); break;
+  case BuiltinValueKind::FAbs:
+  case BuiltinValueKind::FCeil:
+  case BuiltinValueKind::FFloor:
+  case BuiltinValueKind::FTrunc:
+  case BuiltinValueKind::FNearest:
+  case BuiltinValueKind::FSqrt:
+    Result = Builder.CreateUnaryIntrinsic(
+      getFloatIntrinsic(Info.Builtin), LHS
+    );
+    break;
+  case BuiltinValueKind::FCMP_OEQ:
+  case BuiltinValueKind::FCMP_OGT:
+  case BuiltinValueKind::FCMP_OGE:
+  case BuiltinValueKind::FCMP_OLT:
+  case BuiltinValueKind::FCMP_OLE:
+  case BuiltinValueKind::FCMP_UNE:
+    Result = Builder.CreateZExt(
+      Builder.CreateFCmp(getFloatPredicate(Info.Builtin), LHS, RHS),
+      ResultTy
+    );
+    break;
+  case BuiltinValueKind::FPToSI:
+  case BuiltinValueKind::FPToUI: {
+    // Wasm traps where LLVM truncations of NaNs and of the values out of
+    // the range of the integer are poison.
+    bool IsSigned = Info.Builtin == BuiltinValueKind::FPToSI;
+    emitTrapIf(
+      Builder.CreateNot(
+        emitIsTruncationInRange(Builder, LHS, ResultTy, IsSigned)
+      ),
+      "trunc.inrange"
+    );
+    Result = IsSigned ? Builder.CreateFPToSI(LHS, ResultTy)
+                      : Builder.CreateFPToUI(LHS, ResultTy);
+    break;
+  }
+  case BuiltinValueKind::FPToSISat:
+  case BuiltinValueKind::FPToUISat:
+    // The saturating truncations take NaNs to 0, like Wasm.
+    Result = Builder.CreateIntrinsic(
+      Info.Builtin == BuiltinValueKind::FPToSISat
+        ? llvm::Intrinsic::fptosi_sat
+        : llvm::Intrinsic::fptoui_sat,
+      {ResultTy, OperandTy},
+      {LHS}
+    );
+    break;
+  case BuiltinValueKind::SIToFP:
+    Result = Builder.CreateSIToFP(LHS, ResultTy);
+    break;
+  case BuiltinValueKind::UIToFP:
+    Result = Builder.CreateUIToFP(LHS, ResultTy);
+    break;
+  case BuiltinValueKind::FPTrunc:
+    Result = Builder.CreateFPTrunc(LHS, ResultTy);
+    break;
+  case BuiltinValueKind::FPExt:
+    Result = Builder.CreateFPExt(LHS, ResultTy);
+    break;
+  case BuiltinValueKind::BitCast:
+    Result = Builder.CreateBitCast(LHS, ResultTy);
+    break;
+  default: llvm_unreachable("not the builtin of a numeric instruction");
+  }
+  TopConfig->push<Operand>(Result);
+}
@@ -1,6 +1,8 @@
 #include "IRGenConstructor.h"
 #include "Address.h"
+#include "IRBuilder.h"
 #include "IRGenModule.h"
+#include "IRGenVMContext.h"
 #include <llvm/Transforms/Utils/ModuleUtils.h>
 #include <w2n/AST/GlobalVariable.h>
 
@@ -8,7 +10,7 @@
 void w2n::irgen::emitGlobalVariableConstructor(
   IRGenModule& Module,
   GlobalVariable * V,
-  Address Addr,
+  Address VMContext,
   llvm::Function * Init
 ) {
   std::string FnName =
@@ -35,12 +37,14 @@ void w2n::irgen::emitGlobalVariableConstructor(
   llvm::BasicBlock * EntryBB = llvm::BasicBlock::Create(
     Module.getLLVMContext(), "entry", Constructor
   );
-  llvm::IRBuilder<> Builder(EntryBB);
-  llvm::Value * Result = Builder.CreateCall(Init);
-  llvm::PointerType * PtrType =
-    llvm::cast<llvm::PointerType>(Addr->getType());
-  Builder.CreateStore(
-    Result, Builder.CreateBitCast(Addr.getAddress(), PtrType)
+  IRBuilder Builder(Module.getLLVMContext(), false);
+  Builder.SetInsertPoint(EntryBB);
+  llvm::Value * Result = Builder.CreateCall(
+    Init->getFunctionType(), Init, {VMContext.getAddress()}
   );
+  Address Addr = Module.getVMContextLayout().projectGlobalVariable(
+    Builder, VMContext, V
+  );
+  Builder.CreateStore(Result, Addr);
   Builder.CreateRetVoid();
 }
@@ -10,10 +10,13 @@ namespace irgen {
 class IRGenModule;
 class Address;
 
+/// Emits a constructor which stores the value of the initializer of
+/// \p V , \p Init , to the instance context at \p VMContext . Only the
+/// initializers which are not evaluated at compile time need one.
 void emitGlobalVariableConstructor(
   IRGenModule& Module,
   GlobalVariable * V,
-  Address Addr,
+  Address VMContext,
   llvm::Function * Init
 );
 
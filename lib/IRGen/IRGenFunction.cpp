@@ -3,6 +3,7 @@
 #include "IRBuilder.h"
 #include "IRGenInternal.h"
 #include "IRGenModule.h"
+#include "IRGenVMContext.h"
 #include "Reduction.h"
 #include <llvm/ADT/Twine.h>
 #include <llvm/IR/Constants.h>
@@ -22,6 +23,7 @@
 #include <w2n/AST/Expr.h>
 #include <w2n/AST/Lowering.h>
 #include <w2n/AST/Stmt.h>
+#include <w2n/AST/TypeCheckerRequests.h>
 #include <w2n/Basic/Unimplemented.h>
 #include <w2n/IRGen/Linking.h>
 
@@ -36,7 +38,9 @@ IRGenFunction::IRGenFunction(
   Builder(IGM.getLLVMContext(), true),
   OptMode(Mode),
   CurFn(nullptr),
-  Fn(Fn) {
+  Fn(Fn),
+  Validation(nullptr),
+  CurFrame(nullptr) {
 }
 
 IRGenFunction::~IRGenFunction() {
@@ -47,6 +51,16 @@ llvm::Function * IRGenFunction::emitFunction() {
     return CurFn;
   }
 
+  // Function bodies are validated by semantic analysis before IR
+  // generation, so this is a cache hit.
+  Validation = evaluateOrDefault(
+    getASTContext().Eval, ValidateFunctionRequest{Fn}, nullptr
+  );
+  assert(
+    Validation != nullptr && Validation->isValid()
+    && "emitting an invalid function"
+  );
+
   llvm::FunctionType * FnTy = IGM.getFuncType(Fn->getType()->getType());
 
   CurFn = llvm::Function::Create(
@@ -55,6 +69,7 @@ llvm::Function * IRGenFunction::emitFunction() {
     Fn->getDescriptiveName(),
     IGM.getModule()
   );
+  addVMContextAttributes(IGM, CurFn);
 
   auto Locals = emitProlog(
     Fn->getDeclContext(),
@@ -63,12 +78,20 @@ llvm::Function * IRGenFunction::emitFunction() {
     Fn->getType()->getType()->getReturns()
   );
 
-  auto Return = prepareEpilog(Fn->getType()->getType()->getReturns());
-
   RootConfig = std::make_unique<Configuration>(
-    &getASTContext(), Fn, std::move(Locals), std::move(Return)
+    &getASTContext(), Fn, std::move(Locals)
   );
   TopConfig = RootConfig.get();
+  CurFrame = &TopConfig->top<Frame>();
+
+  // The function body is a block whose results are the results of the
+  // function, and which `return` branches to.
+  SmallVector<llvm::Type *, 2> ResultTypes;
+  auto * Returns = Fn->getType()->getType()->getReturns();
+  for (auto * Ty : Returns->getValueTypes()) {
+    ResultTypes.push_back(IGM.getType(Ty));
+  }
+  pushLabel(LabelKind::Function, {}, ResultTypes);
 
   emitProfilerIncrement(Fn->getExpression());
 
@@ -79,6 +102,11 @@ llvm::Function * IRGenFunction::emitFunction() {
 
   mergeCleanupBlocks();
 
+  // The alloca point only marks where allocas are inserted.
+  AllocaIP->eraseFromParent();
+  AllocaIP = nullptr;
+  EarliestIP = nullptr;
+
   return CurFn;
 }
 
@@ -88,7 +116,7 @@ void IRGenFunction::unimplemented(SourceLoc Loc, StringRef Message) {
 
 #pragma mark Function prologue and epilogue
 
-std::vector<Address> IRGenFunction::emitProlog(
+std::vector<llvm::Value *> IRGenFunction::emitProlog(
   DeclContext * DC,
   const std::vector<LocalDecl *>& Locals,
   ResultType * ParamsTy,
@@ -110,71 +138,50 @@ std::vector<Address> IRGenFunction::emitProlog(
   );
   EarliestIP = AllocaIP;
 
-  std::vector<Address> FuncLocals;
-
-  // Emit locals in activation record for funciton arguments
-  for (auto& EachArg : CurFn->args()) {
-    // FIXME: Needs cache?
-    auto * Ty = EachArg.getType();
-    // FIXME: Alignment
-    Alignment FixedAlignment = Alignment(4);
-    auto DebugName =
-      (llvm::Twine("$local") + llvm::Twine(FuncLocals.size())
-       + llvm::Twine(" aka $arg") + llvm::Twine(FuncLocals.size()))
-        .str();
-    auto Addr = createAlloca(Ty, FixedAlignment, DebugName);
-    Builder.CreateStore(&EachArg, Addr);
-    // TODO: zero-initialize Addr
-    FuncLocals.emplace_back(Addr);
+  std::vector<llvm::Value *> FuncLocals;
+
+  // The params start with the arguments of the function following the
+  // instance context.
+  VMContext = CurFn->getArg(0);
+  for (auto& EachArg : llvm::drop_begin(CurFn->args())) {
+    FuncLocals.push_back(&EachArg);
   }
 
-  // Emit locals in activation record for local decls
+  // The other locals are zero-initialized.
   for (auto * EachLocal : Locals) {
-    for (uint32_t I = 0; I < EachLocal->getCount(); I++) {
-      // FIXME: Needs cache?
-      auto * Ty = IGM.getType(EachLocal->getType());
-      // FIXME: Alignment
-      Alignment FixedAlignment = Alignment(4);
-      auto DebugName =
-        (llvm::Twine("$local") + llvm::Twine(FuncLocals.size())).str();
-      auto Addr = createAlloca(Ty, FixedAlignment, DebugName);
-      // TODO: zero-initialize Addr
-      FuncLocals.emplace_back(Addr);
-    }
+    auto * Ty = IGM.getType(EachLocal->getType());
+    auto * Zero = llvm::Constant::getNullValue(Ty);
+    FuncLocals.insert(FuncLocals.end(), EachLocal->getCount(), Zero);
   }
 
   return FuncLocals;
 }
 
-Address IRGenFunction::prepareEpilog(ResultType * ResultTy) {
-  auto * ReturnTy = CurFn->getReturnType();
-  if (ReturnTy->isVoidTy()) {
-    return Address();
-  }
-  auto Name = llvm::Twine("$return-value").str();
-  // FIXME: Alignment
-  Alignment Align = Alignment(4);
-  auto ReturnAddress = createAlloca(ReturnTy, Align, Name);
-  // TODO: zero-initialize ReturnAddress
-  return ReturnAddress;
-}
-
 // TODO: void IRGenFunction::emitProfilerIncrement(ExpressionDecl * Expr)
 
 void IRGenFunction::emitEpilog() {
-  w2n_proto_implemented([&] {
-    assert(RootConfig != nullptr);
-    assert(TopConfig != nullptr);
-    auto& RetVal = RootConfig->top<Frame>().getReturn();
-    auto ReturnType = CurFn->getReturnType();
-    if (ReturnType->isVoidTy()) {
-      Builder.CreateRetVoid();
-    } else {
-      auto * LoadInst =
-        Builder.CreateLoad(RetVal, "$loaded-return-value");
-      Builder.CreateRet(LoadInst);
-    }
-  });
+  assert(Labels.empty() && "function body is not ended");
+  if (!isReachable()) {
+    return;
+  }
+  auto * ReturnTy = CurFn->getReturnType();
+  if (ReturnTy->isVoidTy()) {
+    Builder.CreateRetVoid();
+    return;
+  }
+  size_t ResultCount =
+    Fn->getType()->getType()->getReturns()->getValueTypes().size();
+  SmallVector<llvm::Value *, 2> Results;
+  popValues(Results, ResultCount);
+  if (ResultCount == 1) {
+    Builder.CreateRet(Results.front());
+    return;
+  }
+  llvm::Value * Aggregate = llvm::UndefValue::get(ReturnTy);
+  for (unsigned I = 0; I < ResultCount; I++) {
+    Aggregate = Builder.CreateInsertValue(Aggregate, Results[I], I);
+  }
+  Builder.CreateRet(Aggregate);
 }
 
 void IRGenFunction::mergeCleanupBlocks() {
@@ -183,13 +190,65 @@ void IRGenFunction::mergeCleanupBlocks() {
 #pragma mark Expression Emission
 
 void IRGenFunction::emitExpression(ExpressionDecl * D) {
-  for (auto& EachInst : D->getInstructions()) {
-    if (Expr * E = EachInst.dyn_cast<Expr *>()) {
-      emitRValue(E);
-    } else if (Stmt * S = EachInst.dyn_cast<Stmt *>()) {
-      emitStmt(S);
-    } else {
-      llvm_unreachable("unexpected kind of instruction node.");
+  if (D->hasInstStream()) {
+    emitInstStream(*D->getInstStream());
+    return;
+  }
+
+  // The nodes of the structured instructions being emitted, which are
+  // visited with an explicit stack so that deeply nested code does not
+  // exhaust the native stack.
+  struct PendingNodes {
+    ArrayRef<InstNode> Rest;
+    /// The false arm of an if, until the true arm is emitted.
+    Optional<ArrayRef<InstNode>> FalseArm;
+  };
+
+  SmallVector<PendingNodes, 16> Pending;
+  Pending.push_back({D->getInstructions(), None});
+  while (!Pending.empty()) {
+    PendingNodes& Nodes = Pending.back();
+    if (Nodes.Rest.empty()) {
+      // The expression itself keeps its end among its nodes.
+      if (Pending.size() == 1) {
+        Pending.pop_back();
+        continue;
+      }
+      if (Nodes.FalseArm.has_value()) {
+        Nodes.Rest = *Nodes.FalseArm;
+        Nodes.FalseArm.reset();
+        emitElse();
+        continue;
+      }
+      Pending.pop_back();
+      emitEnd();
+      continue;
+    }
+
+    InstNode Node = Nodes.Rest.front();
+    Nodes.Rest = Nodes.Rest.drop_front();
+    if (Expr * E = Node.dyn_cast<Expr *>()) {
+      if (isReachable()) {
+        emitRValue(E);
+      }
+      continue;
+    }
+
+    Stmt * S = Node.get<Stmt *>();
+    // Code following an unconditional branch is never executed, and is
+    // skipped along with the structured instructions it contains.
+    if (!isReachable() && !isa<EndStmt>(S)) {
+      continue;
+    }
+    emitStmt(S);
+    if (auto * Block = dyn_cast<BlockStmt>(S)) {
+      Pending.push_back({Block->getInstructions(), None});
+    } else if (auto * Loop = dyn_cast<LoopStmt>(S)) {
+      Pending.push_back({Loop->getInstructions(), None});
+    } else if (auto * If = dyn_cast<IfStmt>(S)) {
+      Pending.push_back(
+        {If->getTrueInstructions(), If->getFalseInstructions()}
+      );
     }
   }
 }
@@ -3,13 +3,17 @@
 
 #include "IRBuilder.h"
 #include "Reduction.h"
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/Function.h>
 #include <memory>
 #include <w2n/AST/ASTContext.h>
 #include <w2n/AST/ASTVisitor.h>
 #include <w2n/AST/Decl.h>
+#include <w2n/AST/FunctionValidation.h>
 #include <w2n/AST/IRGenOptions.h>
 #include <w2n/AST/InstNode.h>
+#include <w2n/AST/InstStream.h>
 #include <w2n/AST/Module.h>
 #include <w2n/AST/Type.h>
 #include <w2n/Basic/OptimizationMode.h>
@@ -48,6 +52,10 @@ public:
 
   Function * Fn;
 
+  /// The cached result of validating the body of \c Fn , which must be
+  /// valid.
+  const FunctionValidation * Validation;
+
   /// The root config for WebAssembly VM stack reduction.
   std::unique_ptr<Configuration> RootConfig;
 
@@ -76,28 +84,22 @@ public:
 
 #pragma mark Function prologue and epilogue
 
-  /// Generates prolog code to allocate and clean up mutable storage for
-  /// local arguments.
-  /// Prepares the root config for wasm VM stack reduction.
-  std::vector<Address> emitProlog(
+  /// Generates prolog code and returns the initial values of the locals:
+  /// the arguments for the params, and zero for the other locals.
+  std::vector<llvm::Value *> emitProlog(
     DeclContext * DC,
     const std::vector<LocalDecl *>& Locals,
     ResultType * ParamsTy,
     ResultType * ResultTy
   );
 
-  /// Create (but do not emit) the epilog branch, and save the
-  /// current cleanups depth as the destination for return statement
-  /// branches.
-  Address prepareEpilog(ResultType * ResultTy);
-
   /// Emit code to increment a counter for profiling.
   void emitProfilerIncrement(ExpressionDecl * Expr) {
     w2n_proto_implemented([] {});
   }
 
-  /// Emits a standard epilog which runs top-level cleanups then returns
-  /// the function return value, if any.
+  /// Emits a standard epilog which returns the results of the function
+  /// body left on the operand stack, if the end of the body is reachable.
   void emitEpilog();
 
   void mergeCleanupBlocks();
@@ -120,10 +122,226 @@ public:
   //
   RValue emitRValue(Expr * E);
 
+  /// Emits an expression encoded as an \c InstStream by iterating its
+  /// instructions in place.
+  void emitInstStream(const InstStream& Stream);
+
+#pragma mark Locals
+
+  llvm::Value * getLocal(uint32_t Index) const {
+    return CurFrame->getLocal(Index);
+  }
+
+  void setLocal(uint32_t Index, llvm::Value * Val) {
+    CurFrame->setLocal(Index, Val);
+  }
+
 #pragma mark Control Flow
 
   llvm::BasicBlock * createBasicBlock(const llvm::Twine& Name) const;
 
+  /// Returns \c true if the instruction being emitted is reachable, that
+  /// is the builder has a block to insert into.
+  bool isReachable() const {
+    return Builder.hasValidIP();
+  }
+
+  void emitUnreachable();
+
+  void emitBlock(BlockType * Ty);
+
+  void emitLoop(BlockType * Ty);
+
+  void emitIf(BlockType * Ty);
+
+  void emitElse();
+
+  void emitEnd();
+
+  void emitBr(uint32_t LabelIndex);
+
+  void emitBrIf(uint32_t LabelIndex);
+
+  void emitBrTable(ArrayRef<uint32_t> LabelIndices, uint32_t Default);
+
+  void emitReturn();
+
+#pragma mark Numeric Instructions
+
+  /// Pops the operands of the numeric instruction \p Inst , applies the
+  /// builtin it is lowered to and pushes the result. Traps on integer
+  /// division by zero, on signed division overflow and on truncations of
+  /// NaNs and of floats out of the range of the integer.
+  void emitBuiltin(Instruction Inst);
+
+#pragma mark Calls
+
+  /// Pops the arguments of the function at \p FuncIndex , calls it in
+  /// the same instance and pushes its results.
+  void emitCall(uint32_t FuncIndex);
+
+  /// Pops an element index and the arguments of a function of the type
+  /// at \p TypeIndex , calls the function at the element of the table at
+  /// \p TableIndex and pushes its results. Traps when the element is out
+  /// of bounds, null, or a function of another type. Calls the functions
+  /// of an immutable table directly where it can.
+  void emitCallIndirect(uint32_t TypeIndex, uint32_t TableIndex);
+
+#pragma mark Instance Context
+
+  /// Returns the address of the instance context the function is called
+  /// with.
+  Address getVMContext() const;
+
+  /// Returns the address of the descriptor of \p M in the instance
+  /// context.
+  Address getAddrOfMemory(Memory * M);
+
+  /// Returns the address of the descriptor of \p T in the instance
+  /// context.
+  Address getAddrOfTable(Table * T);
+
+  /// Returns the address of the value of \p G in the instance context.
+  Address getAddrOfGlobalVariable(GlobalVariable * G);
+
+#pragma mark Globals
+
+  /// Returns the value of \p G , which is the value of its initializer
+  /// when \p G is immutable and initialized at compile time.
+  llvm::Value * emitGlobalGet(GlobalVariable * G);
+
+#pragma mark Memory
+
+  /// Pops an address and pushes the value of type \p MemoryTy loaded
+  /// from it in memory 0, extended to \p ResultTy .
+  void emitLoad(
+    MemoryArgument MemArg, ValueType * MemoryTy, ValueType * ResultTy
+  );
+
+  /// Pops a value and an address, and stores the value truncated to
+  /// \p MemoryTy at the address in memory 0.
+  void emitStore(MemoryArgument MemArg, ValueType * MemoryTy);
+
+  /// Pushes the size of memory 0 in pages.
+  void emitMemorySize();
+
+  /// Pops a number of pages, grows memory 0 by them and pushes the
+  /// previous size of the memory in pages, or -1 if it cannot grow.
+  void emitMemoryGrow();
+
+private:
+
+  /// The hidden first argument of the function.
+  llvm::Value * VMContext = nullptr;
+
+  /// Whether an access to an imported memory has been diagnosed in the
+  /// function already.
+  bool DiagnosedImportedMemory = false;
+
+  /// Returns memory 0, which the memory instructions access, or null
+  /// when it is imported, which is diagnosed once per function.
+  Memory * getAccessedMemory();
+
+  /// Returns the address of an access of type \p AccessTy at \p Index
+  /// plus \p Offset in \p M , checking the access against the size of
+  /// the memory when guard pages do not cover it.
+  Address emitMemoryAddress(
+    Memory * M,
+    llvm::Value * Index,
+    uint32_t Offset,
+    llvm::Type * AccessTy
+  );
+
+  /// Pops the arguments of \p Ty , calls \p Callee with them in the
+  /// instance at \p CalleeVMContext and pushes the results.
+  void emitCall(
+    FuncType * Ty, llvm::Value * Callee, llvm::Value * CalleeVMContext
+  );
+
+  /// Fills \p Args with \p CalleeVMContext and the arguments of \p Ty
+  /// popped from the stack.
+  void popCallArguments(
+    FuncType * Ty,
+    llvm::Value * CalleeVMContext,
+    SmallVectorImpl<llvm::Value *>& Args
+  );
+
+  /// Pushes the results of a call to a function of type \p Ty , which
+  /// returned \p Result .
+  void pushCallResults(FuncType * Ty, llvm::Value * Result);
+
+  /// Calls the function at the element \p Index of the immutable table
+  /// \p T directly when \p Index is a constant, or through a switch over
+  /// the few elements which are functions of type \p Ty . Returns false
+  /// when there are too many of them.
+  bool emitDevirtualizedCallIndirect(
+    FuncType * Ty, Table * T, llvm::Value * Index
+  );
+
+  /// The block the failed bounds and signature checks of the function
+  /// branch to.
+  llvm::BasicBlock * TrapBB = nullptr;
+
+  llvm::BasicBlock * getTrapBB();
+
+  /// Branches to the trap block when \p Cond is true, and continues in
+  /// a new block named \p ContName otherwise.
+  void emitTrapIf(llvm::Value * Cond, const llvm::Twine& ContName);
+
+  /// The frame of the function, which holds the current values of the
+  /// locals.
+  Frame * CurFrame;
+
+  /// The active labels, from the outermost one, which is the label of the
+  /// function body.
+  SmallVector<Label *, 16> Labels;
+
+  Label& getLabel(uint32_t LabelIndex) const {
+    assert(LabelIndex < Labels.size() && "unknown label");
+    return *Labels[Labels.size() - 1 - LabelIndex];
+  }
+
+  void pushLabel(
+    LabelKind Kind,
+    ArrayRef<llvm::Type *> ParamTypes,
+    ArrayRef<llvm::Type *> ResultTypes
+  );
+
+  void lowerBlockType(
+    BlockType * Ty,
+    SmallVectorImpl<llvm::Type *>& ParamTypes,
+    SmallVectorImpl<llvm::Type *>& ResultTypes
+  ) const;
+
+  /// Pops \p Count operands and appends their values to \p Values from
+  /// the bottommost one.
+  void popValues(SmallVectorImpl<llvm::Value *>& Values, size_t Count);
+
+  void pushValues(ArrayRef<llvm::Value *> Values);
+
+  /// Appends the operands a branch to \p L carries, which are left on
+  /// the operand stack, and the locals to \p Values .
+  void collectBranchValues(
+    Label& L, SmallVectorImpl<llvm::Value *>& Values
+  ) const;
+
+  /// Records \p EdgeCount edges from the current block to \p L , which
+  /// the caller emits the terminator of.
+  void addBranchEdges(Label& L, unsigned EdgeCount);
+
+  /// Returns the block a branch to \p L jumps to.
+  llvm::BasicBlock * getBranchBB(Label& L);
+
+  /// Moves to the continuation of the innermost label, merging the
+  /// values of its incoming edges, and pops the label.
+  void emitContinuation();
+
+  /// Replaces the phis of a loop which merge a single value with that
+  /// value.
+  void removeTrivialPhis(Label& Loop);
+
+public:
+
 #pragma mark Helper Methods
 
   Address createAlloca(
@@ -0,0 +1,213 @@
+#include "IRGenGlobal.h"
+#include "Address.h"
+#include "IRBuilder.h"
+#include "IRGenFunction.h"
+#include "IRGenModule.h"
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Constants.h>
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Expr.h>
+#include <w2n/AST/Function.h>
+#include <w2n/AST/GlobalVariable.h>
+#include <w2n/AST/InstStream.h>
+#include <w2n/AST/Module.h>
+#include <w2n/AST/Stmt.h>
+
+using namespace w2n;
+using namespace w2n::irgen;
+
+#pragma mark - Constant Expressions
+
+namespace {
+
+/// Evaluates a constant expression on a stack of LLVM constants.
+class ConstantEvaluator {
+  IRGenModule& IGM;
+
+  const ModuleDecl * Module;
+
+  SmallVector<llvm::Constant *, 4> Stack;
+
+public:
+
+  ConstantEvaluator(IRGenModule& IGM, const ModuleDecl * Module) :
+    IGM(IGM),
+    Module(Module) {
+  }
+
+  /// Returns the value of the expression, or null when it could not be
+  /// evaluated.
+  llvm::Constant * evaluate(const ExpressionDecl * E) {
+    bool Evaluated = E->hasInstStream() ? evaluate(*E->getInstStream())
+                                        : evaluate(E->getInstructions());
+    if (!Evaluated || Stack.size() != 1) {
+      return nullptr;
+    }
+    return Stack.back();
+  }
+
+private:
+
+  bool evaluate(const InstStream& Stream) {
+    const ASTContext& Ctx = Module->getASTContext();
+    for (InstRef Inst : Stream) {
+      const InstInfo& Info = Inst.getInfo();
+      switch (Info.Node) {
+      case InstNodeKind::End: continue;
+      case InstNodeKind::IntegerConst:
+        Stack.push_back(llvm::ConstantInt::get(
+          IGM.getType(Ctx.getValueTypeForKind(Info.ResultType)),
+          Inst.getBits()
+        ));
+        continue;
+      case InstNodeKind::FloatConst:
+        Stack.push_back(getFloat(Info.ResultType, Inst.getBits()));
+        continue;
+      case InstNodeKind::GlobalGet:
+        if (!pushGlobal(Inst.getIndexImmediate())) {
+          return false;
+        }
+        continue;
+      case InstNodeKind::Builtin:
+        if (!applyBuiltin(Inst.getOpcode())) {
+          return false;
+        }
+        continue;
+      default: return false;
+      }
+    }
+    return true;
+  }
+
+  bool evaluate(ArrayRef<InstNode> Instructions) {
+    for (InstNode Node : Instructions) {
+      if (auto * S = Node.dyn_cast<Stmt *>()) {
+        if (!isa<EndStmt>(S)) {
+          return false;
+        }
+        continue;
+      }
+      auto * E = Node.get<Expr *>();
+      if (auto * Const = dyn_cast<IntegerConstExpr>(E)) {
+        Stack.push_back(llvm::ConstantInt::get(
+          IGM.getType(Const->getIntegerType()), Const->getValue()
+        ));
+      } else if (auto * Const = dyn_cast<FloatConstExpr>(E)) {
+        Stack.push_back(
+          llvm::ConstantFP::get(IGM.getLLVMContext(), Const->getValue())
+        );
+      } else if (auto * Get = dyn_cast<GlobalGetExpr>(E)) {
+        if (!pushGlobal(Get->getGlobalIndex())) {
+          return false;
+        }
+      } else if (auto * Builtin = dyn_cast<CallBuiltinExpr>(E)) {
+        if (!applyBuiltin(Builtin->getInstruction())) {
+          return false;
+        }
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  llvm::Constant * getFloat(ValueTypeKind Kind, uint64_t Bits) {
+    if (Kind == ValueTypeKind::F64) {
+      return llvm::ConstantFP::get(
+        IGM.getLLVMContext(),
+        llvm::APFloat(llvm::APFloat::IEEEdouble(), llvm::APInt(64, Bits))
+      );
+    }
+    return llvm::ConstantFP::get(
+      IGM.getLLVMContext(),
+      llvm::APFloat(llvm::APFloat::IEEEsingle(), llvm::APInt(32, Bits))
+    );
+  }
+
+  /// Pushes the value of the global at \p GlobalIndex . Validation only
+  /// lets constant expressions read the immutable globals defined before
+  /// them, so the recursion ends, and the values of the globals read are
+  /// cached.
+  bool pushGlobal(uint32_t GlobalIndex) {
+    const GlobalVariable * G = Module->getGlobal(GlobalIndex);
+    if (G == nullptr) {
+      // TODO: Evaluate the reads of imported globals at instantiation.
+      return false;
+    }
+    llvm::Constant * Value = evaluateInitializer(IGM, G);
+    if (Value == nullptr) {
+      return false;
+    }
+    Stack.push_back(Value);
+    return true;
+  }
+
+  /// Applies an arithmetic instruction of the extended constant
+  /// expressions to the top of the stack.
+  bool applyBuiltin(Instruction Opcode) {
+    if (Stack.size() < 2) {
+      return false;
+    }
+    auto * R = dyn_cast<llvm::ConstantInt>(Stack.pop_back_val());
+    auto * L = dyn_cast<llvm::ConstantInt>(Stack.pop_back_val());
+    if (L == nullptr || R == nullptr) {
+      return false;
+    }
+    const llvm::APInt& LHS = L->getValue();
+    const llvm::APInt& RHS = R->getValue();
+    llvm::APInt Result;
+    switch (Opcode) {
+    case Instruction::I32Add:
+    case Instruction::I64Add: Result = LHS + RHS; break;
+    case Instruction::I32Sub:
+    case Instruction::I64Sub: Result = LHS - RHS; break;
+    case Instruction::I32Mul:
+    case Instruction::I64Mul: Result = LHS * RHS; break;
+    default: return false;
+    }
+    Stack.push_back(llvm::ConstantInt::get(IGM.getLLVMContext(), Result));
+    return true;
+  }
+};
+
+} // namespace
+
+llvm::Constant *
+irgen::evaluateInitializer(IRGenModule& IGM, const GlobalVariable * V) {
+  auto& Cache = IGM.getEvaluatedInitializers();
+  auto Cached = Cache.find(V);
+  if (Cached != Cache.end()) {
+    return Cached->second;
+  }
+  llvm::Constant * Value = nullptr;
+  if (const Function * Init = V->getInit()) {
+    Value = evaluateConstantExpression(
+      IGM, V->getModule(), Init->getExpression()
+    );
+  }
+  // The evaluation may have cached the globals it read, so the entry is
+  // only inserted now.
+  Cache[V] = Value;
+  return Value;
+}
+
+llvm::Constant * irgen::evaluateConstantExpression(
+  IRGenModule& IGM, const ModuleDecl * M, const ExpressionDecl * E
+) {
+  return ConstantEvaluator(IGM, M).evaluate(E);
+}
+
+#pragma mark - IRGenFunction
+
+llvm::Value * IRGenFunction::emitGlobalGet(GlobalVariable * G) {
+  // The value of an immutable global is the value of its initializer,
+  // which is folded into the reads of the global when it is known at
+  // compile time.
+  if (!G->isMutable()) {
+    if (llvm::Constant * Value = evaluateInitializer(IGM, G)) {
+      return Value;
+    }
+  }
+  return Builder.CreateLoad(getAddrOfGlobalVariable(G));
+}
@@ -1,6 +1,38 @@
 #ifndef W2N_IRGEN_IRGENGLOBAL_H
 #define W2N_IRGEN_IRGENGLOBAL_H
 
-namespace w2n {}
+namespace llvm {
+class Constant;
+} // namespace llvm
+
+namespace w2n {
+class ExpressionDecl;
+class GlobalVariable;
+class ModuleDecl;
+
+namespace irgen {
+class IRGenModule;
+
+/// Evaluates the init expression of \p V at compile time. The expression
+/// may hold constants, \c global.get of the immutable globals defined
+/// before \p V , and the integer \c add , \c sub and \c mul of the
+/// extended constant expressions.
+///
+/// Returns null when the expression reads an imported global, whose
+/// value is only known at instantiation. Each initializer is evaluated
+/// once per \c IRGenModule .
+llvm::Constant *
+evaluateInitializer(IRGenModule& IGM, const GlobalVariable * V);
+
+/// Evaluates the constant expression \p E of \p M at compile time, as
+/// \c evaluateInitializer does. Returns null when \p E reads an imported
+/// global.
+llvm::Constant * evaluateConstantExpression(
+  IRGenModule& IGM, const ModuleDecl * M, const ExpressionDecl * E
+);
+
+} // namespace irgen
+
+} // namespace w2n
 
 #endif // W2N_IRGEN_IRGENGLOBAL_H
@@ -0,0 +1,210 @@
+#include "IRGenFunction.h"
+#include "IRGenModule.h"
+#include "Reduction.h"
+#include <llvm/IR/Constants.h>
+#include <cassert>
+#include <w2n/AST/InstStream.h>
+#include <w2n/Basic/Unimplemented.h>
+
+using namespace w2n;
+using namespace w2n::irgen;
+
+#pragma mark - InstEmitter
+
+namespace {
+
+/// Emits the instructions of an \c InstStream . Mirrors \c RValueEmitter
+/// and \c StmtEmitter , reading the immediates from the stream instead
+/// of from \c Expr and \c Stmt nodes.
+class InstEmitter : public InstStreamVisitor<InstEmitter> {
+public:
+
+  IRGenFunction& IGF;
+
+  Function * Fn;
+
+  IRGenModule& IGM;
+
+  IRBuilder& Builder;
+
+  Configuration& Config;
+
+  InstEmitter(IRGenFunction& IGF) :
+    IGF(IGF),
+    Fn(IGF.Fn),
+    IGM(IGF.IGM),
+    Builder(IGF.Builder),
+    Config(*IGF.TopConfig){};
+
+  InstEmitter(const InstEmitter&) = delete;
+  InstEmitter& operator=(const InstEmitter&) = delete;
+
+  InstEmitter(InstEmitter&&) = delete;
+  InstEmitter& operator=(InstEmitter&&) = delete;
+
+  void visitInst(InstRef Inst) {
+    w2n_unimplemented();
+  }
+
+  void visitUnreachableInst(InstRef Inst) {
+    IGF.emitUnreachable();
+  }
+
+  void visitNopInst(InstRef Inst) {
+  }
+
+  void visitBlockInst(InstRef Inst) {
+    IGF.emitBlock(Inst.getBlockType());
+  }
+
+  void visitLoopInst(InstRef Inst) {
+    IGF.emitLoop(Inst.getBlockType());
+  }
+
+  void visitIfInst(InstRef Inst) {
+    IGF.emitIf(Inst.getBlockType());
+  }
+
+  void visitElseInst(InstRef Inst) {
+    IGF.emitElse();
+  }
+
+  void visitEndInst(InstRef Inst) {
+    IGF.emitEnd();
+  }
+
+  void visitBrInst(InstRef Inst) {
+    IGF.emitBr(Inst.getIndexImmediate());
+  }
+
+  void visitBrIfInst(InstRef Inst) {
+    IGF.emitBrIf(Inst.getIndexImmediate());
+  }
+
+  void visitBrTableInst(InstRef Inst) {
+    IGF.emitBrTable(Inst.getLabelTable(), Inst.getIndexImmediate());
+  }
+
+  void visitReturnInst(InstRef Inst) {
+    IGF.emitReturn();
+  }
+
+  void visitCallInst(InstRef Inst) {
+    IGF.emitCall(Inst.getIndexImmediate());
+  }
+
+  void visitCallIndirectInst(InstRef Inst) {
+    IGF.emitCallIndirect(Inst.getIndexImmediate(), Inst.getTableIndex());
+  }
+
+  void visitGlobalGetInst(InstRef Inst) {
+    auto * Global = Fn->getModule()->getGlobal(Inst.getIndexImmediate());
+    Config.push<Operand>(IGF.emitGlobalGet(Global));
+  }
+
+  void visitGlobalSetInst(InstRef Inst) {
+    auto * Op = Config.pop<Operand>();
+    auto * Global = Fn->getModule()->getGlobal(Inst.getIndexImmediate());
+    auto Addr = IGF.getAddrOfGlobalVariable(Global);
+    Builder.CreateStore(Op->getLowered(), Addr);
+  }
+
+  void visitLoadInst(InstRef Inst) {
+    const InstInfo& Info = Inst.getInfo();
+    ASTContext& Ctx = Fn->getASTContext();
+    IGF.emitLoad(
+      Inst.getMemArg(),
+      Ctx.getValueTypeForKind(Info.MemoryType),
+      Ctx.getValueTypeForKind(Info.ResultType)
+    );
+  }
+
+  void visitStoreInst(InstRef Inst) {
+    IGF.emitStore(
+      Inst.getMemArg(),
+      Fn->getASTContext().getValueTypeForKind(Inst.getInfo().MemoryType)
+    );
+  }
+
+  void visitMemorySizeInst(InstRef Inst) {
+    IGF.emitMemorySize();
+  }
+
+  void visitMemoryGrowInst(InstRef Inst) {
+    IGF.emitMemoryGrow();
+  }
+
+  void visitLocalGetInst(InstRef Inst) {
+    Config.push<Operand>(IGF.getLocal(Inst.getIndexImmediate()));
+  }
+
+  void visitLocalSetInst(InstRef Inst) {
+    auto * Op = Config.pop<Operand>();
+    IGF.setLocal(Inst.getIndexImmediate(), Op->getLowered());
+  }
+
+  void visitLocalTeeInst(InstRef Inst) {
+    IGF.setLocal(
+      Inst.getIndexImmediate(), Config.top<Operand>().getLowered()
+    );
+  }
+
+  void visitIntegerConstInst(InstRef Inst) {
+    const InstInfo& Info = Inst.getInfo();
+    auto * Ty = IGM.getType(
+      Fn->getASTContext().getValueTypeForKind(Info.ResultType)
+    );
+    auto * ConstVal = llvm::ConstantInt::get(Ty, Inst.getBits());
+    Config.push<Operand>(ConstVal);
+  }
+
+  void visitBuiltinInst(InstRef Inst) {
+    IGF.emitBuiltin(Inst.getOpcode());
+  }
+
+  void visitDropInst(InstRef Inst) {
+    Config.pop<Operand>();
+  }
+
+  void visitSelectInst(InstRef Inst) {
+    auto * Cond = Config.pop<Operand>()->getLowered();
+    auto * FalseVal = Config.pop<Operand>()->getLowered();
+    auto * TrueVal = Config.pop<Operand>()->getLowered();
+    auto * IsTrue = Builder.CreateIsNotNull(Cond);
+    Config.push<Operand>(Builder.CreateSelect(IsTrue, TrueVal, FalseVal));
+  }
+};
+
+} // namespace
+
+#pragma mark - IRGenFunction
+
+void IRGenFunction::emitInstStream(const InstStream& Stream) {
+  InstEmitter Emitter(*this);
+  // The number of structured instructions entered by unreachable code.
+  uint32_t UnreachableDepth = 0;
+  for (InstRef Inst : Stream) {
+    if (!isReachable()) {
+      // Code following an unconditional branch is never executed, and is
+      // skipped up to the else or the end closing the current label.
+      switch (Inst.getInfo().Node) {
+      case InstNodeKind::Block:
+      case InstNodeKind::Loop:
+      case InstNodeKind::If: UnreachableDepth += 1; continue;
+      case InstNodeKind::Else:
+        if (UnreachableDepth > 0) {
+          continue;
+        }
+        break;
+      case InstNodeKind::End:
+        if (UnreachableDepth > 0) {
+          UnreachableDepth -= 1;
+          continue;
+        }
+        break;
+      default: continue;
+      }
+    }
+    Emitter.visit(Inst);
+  }
+}
@@ -0,0 +1,406 @@
+#include "IRGenMemory.h"
+#include "Address.h"
+#include "IRBuilder.h"
+#include "IRGenFunction.h"
+#include "IRGenGlobal.h"
+#include "IRGenModule.h"
+#include "IRGenVMContext.h"
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+#include <algorithm>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Memory.h>
+#include <w2n/Basic/Unimplemented.h>
+
+using namespace w2n;
+using namespace w2n::irgen;
+
+#pragma mark - Bounds Checks
+
+IRGenMemoryBoundsChecks
+irgen::getMemoryBoundsChecks(const IRGenModule& IGM) {
+  switch (IGM.getOptions().MemoryBoundsChecks) {
+  case IRGenMemoryBoundsChecks::Automatic:
+    // Reserving 4 GiB plus the guard region per memory is only
+    // reasonable in a 64-bit address space.
+    return IGM.Triple.isArch64Bit() ? IRGenMemoryBoundsChecks::GuardPages
+                                    : IRGenMemoryBoundsChecks::Explicit;
+  case IRGenMemoryBoundsChecks::GuardPages:
+  case IRGenMemoryBoundsChecks::Explicit:
+    return IGM.getOptions().MemoryBoundsChecks;
+  }
+  llvm_unreachable("bad memory bounds checks");
+}
+
+bool irgen::needsExplicitBoundsCheck(
+  const IRGenModule& IGM, uint64_t Offset, uint64_t AccessSize
+) {
+  if (getMemoryBoundsChecks(IGM) == IRGenMemoryBoundsChecks::Explicit) {
+    return true;
+  }
+  return Offset + AccessSize > MemoryGuardSize;
+}
+
+#pragma mark - Memory Base
+
+llvm::Optional<unsigned> irgen::getMemorySegmentAddressSpace(
+  const IRGenModule& IGM, const Memory * M
+) {
+  if (IGM.getOptions().MemoryBase != IRGenMemoryBase::Segment
+      || M->getIndex() != 0) {
+    return llvm::None;
+  }
+  return IGM.TargetInfo.MemorySegmentAddressSpace;
+}
+
+#pragma mark - Memory Size
+
+uint64_t
+irgen::getMemoryMaxSize(const IRGenModule& IGM, const Memory * M) {
+  constexpr uint64_t MaxPages = Wasm32AddressSpaceSize / WasmPageSize;
+  switch (getMemoryBoundsChecks(IGM)) {
+  case IRGenMemoryBoundsChecks::Automatic:
+    llvm_unreachable("bounds checks should have been resolved");
+  case IRGenMemoryBoundsChecks::GuardPages:
+    return std::min(M->getMaxPages().value_or(MaxPages), MaxPages)
+         * WasmPageSize;
+  case IRGenMemoryBoundsChecks::Explicit:
+    return std::min(M->getMaxPages().value_or(M->getMinPages()), MaxPages)
+         * WasmPageSize;
+  }
+  llvm_unreachable("bad memory bounds checks");
+}
+
+#pragma mark - Memory Constructor
+
+/// Calls into the runtime like C++ static initializers do.
+///
+/// The runtime function is declared as:
+///
+///   void w2n_memory_init(w2n_memory * M, uint64_t Size,
+///                        uint64_t ReservedSize);
+///   void w2n_memory_set_segment_base(const w2n_memory * M);
+void irgen::emitMemoryConstructor(
+  IRGenModule& Module,
+  Memory * M,
+  Address VMContext,
+  ArrayRef<ActiveDataSegment> Segments
+) {
+  std::string FnName =
+    M->getFullQualifiedDescriptiveName() + "-initializer";
+  llvm::Function * Constructor = Module.getModule()->getFunction(FnName);
+
+  if (Constructor != nullptr) {
+    return;
+  }
+
+  uint64_t Size = M->getMinPages() * WasmPageSize;
+  uint64_t ReservedSize = 0;
+  switch (getMemoryBoundsChecks(Module)) {
+  case IRGenMemoryBoundsChecks::Automatic:
+    llvm_unreachable("bounds checks should have been resolved");
+  case IRGenMemoryBoundsChecks::GuardPages:
+    // The base of the memory never moves, and the pages past its end
+    // stay inaccessible until it grows.
+    ReservedSize = Wasm32AddressSpaceSize + MemoryGuardSize;
+    break;
+  case IRGenMemoryBoundsChecks::Explicit:
+    ReservedSize = getMemoryMaxSize(Module, M);
+    break;
+  }
+
+  llvm::FunctionType * InitTy = llvm::FunctionType::get(
+    Module.VoidTy, {Module.PtrTy, Module.I64Ty, Module.I64Ty}, false
+  );
+  llvm::FunctionCallee Init =
+    Module.getModule()->getOrInsertFunction("w2n_memory_init", InitTy);
+
+  llvm::FunctionType * FTy = llvm::FunctionType::get(
+    llvm::Type::getVoidTy(Module.getLLVMContext()), false
+  );
+
+  Constructor = llvm::Function::Create(
+    FTy,
+    llvm::GlobalValue::InternalLinkage,
+    FnName,
+    Module.getModule()
+  );
+
+  llvm::appendToGlobalCtors(*Module.getModule(), Constructor, 0);
+
+  llvm::BasicBlock * EntryBB = llvm::BasicBlock::Create(
+    Module.getLLVMContext(), "entry", Constructor
+  );
+  IRBuilder Builder(Module.getLLVMContext(), false);
+  Builder.SetInsertPoint(EntryBB);
+  Address Addr =
+    Module.getVMContextLayout().projectMemory(Builder, VMContext, M);
+  Builder.CreateCall(
+    Init.getFunctionType(),
+    cast<llvm::Constant>(Init.getCallee()),
+    {Addr.getAddress(),
+     llvm::ConstantInt::get(Module.I64Ty, Size),
+     llvm::ConstantInt::get(Module.I64Ty, ReservedSize)}
+  );
+
+  if (getMemorySegmentAddressSpace(Module, M).has_value()) {
+    // Constructors run on the main thread. The embedder sets the segment
+    // base of the other threads running the module itself.
+    llvm::FunctionType * SetSegmentBaseTy = llvm::FunctionType::get(
+      Module.VoidTy, {Module.PtrTy}, false
+    );
+    llvm::FunctionCallee SetSegmentBase =
+      Module.getModule()->getOrInsertFunction(
+        "w2n_memory_set_segment_base", SetSegmentBaseTy
+      );
+    Builder.CreateCall(
+      SetSegmentBase.getFunctionType(),
+      cast<llvm::Constant>(SetSegmentBase.getCallee()),
+      {Addr.getAddress()}
+    );
+  }
+
+  // The pages the runtime maps are zeroed, so only the bytes of the
+  // active segments are copied in, in the order of the data section.
+  llvm::Value * Base = nullptr;
+  for (const ActiveDataSegment& Segment : Segments) {
+    ArrayRef<uint8_t> Data = Segment.Decl->getData();
+    auto * Offset = dyn_cast_or_null<llvm::ConstantInt>(
+      evaluateConstantExpression(
+        Module, M->getModule(), Segment.Decl->getExpression()
+      )
+    );
+    if (Offset == nullptr) {
+      // TODO: Support offsets read from imported globals.
+      Module.unimplemented(
+        Segment.Decl->getLoc(), "data segment offsets of imported globals"
+      );
+      continue;
+    }
+    if (Offset->getZExtValue() + Data.size() > Size) {
+      Module.error(
+        Segment.Decl->getLoc(), "data segment does not fit in the memory"
+      );
+      continue;
+    }
+    if (Data.empty()) {
+      continue;
+    }
+    if (Base == nullptr) {
+      Address BaseAddr = Builder.CreateStructGEP(
+        Addr,
+        0,
+        Module.DataLayout.getStructLayout(Module.MemoryTy),
+        "memory.base.addr"
+      );
+      Base = Builder.CreateLoad(BaseAddr, "memory.base");
+    }
+    Builder.CreateMemCpy(
+      Builder.CreateInBoundsGEP(
+        Module.I8Ty,
+        Base,
+        llvm::ConstantInt::get(Module.I64Ty, Offset->getZExtValue())
+      ),
+      llvm::MaybeAlign(1),
+      Segment.Bytes,
+      llvm::MaybeAlign(1),
+      Data.size()
+    );
+  }
+  Builder.CreateRetVoid();
+}
+
+#pragma mark - IRGenFunction
+
+Address IRGenFunction::emitMemoryAddress(
+  Memory * M, llvm::Value * Index, uint32_t Offset, llvm::Type * AccessTy
+) {
+  Address Descriptor = getAddrOfMemory(M);
+  uint64_t AccessSize = IGM.DataLayout.getTypeStoreSize(AccessTy);
+
+  // The effective address is computed in 64 bits, where adding the
+  // 32-bit index and the 32-bit offset cannot overflow.
+  llvm::Value * EffectiveAddr = Builder.CreateZExt(Index, IGM.I64Ty);
+  if (Offset != 0) {
+    EffectiveAddr = Builder.CreateAdd(
+      EffectiveAddr,
+      llvm::ConstantInt::get(IGM.I64Ty, Offset),
+      "",
+      /*HasNUW*/ true,
+      /*HasNSW*/ true
+    );
+  }
+
+  if (needsExplicitBoundsCheck(IGM, Offset, AccessSize)) {
+    Address SizeAddr = Builder.CreateStructGEP(
+      Descriptor,
+      1,
+      IGM.DataLayout.getStructLayout(IGM.MemoryTy),
+      "memory.size.addr"
+    );
+    llvm::Value * Size = Builder.CreateLoad(SizeAddr, "memory.size");
+    llvm::Value * End = Builder.CreateAdd(
+      EffectiveAddr,
+      llvm::ConstantInt::get(IGM.I64Ty, AccessSize),
+      "",
+      /*HasNUW*/ true,
+      /*HasNSW*/ true
+    );
+    emitTrapIf(Builder.CreateICmpUGT(End, Size), "memory.inbounds");
+  }
+
+  if (auto AddrSpace = getMemorySegmentAddressSpace(IGM, M)) {
+    // The effective address is an offset into the segment, which the
+    // target folds into the access with a segment override.
+    llvm::Value * Addr = Builder.CreateIntToPtr(
+      EffectiveAddr,
+      llvm::PointerType::get(IGM.getLLVMContext(), *AddrSpace)
+    );
+    return Address(Addr, AccessTy, Alignment(1));
+  }
+
+  Address BaseAddr = Builder.CreateStructGEP(
+    Descriptor,
+    0,
+    IGM.DataLayout.getStructLayout(IGM.MemoryTy),
+    "memory.base.addr"
+  );
+  llvm::LoadInst * Base = Builder.CreateLoad(BaseAddr, "memory.base");
+  if (getMemoryBoundsChecks(IGM) == IRGenMemoryBoundsChecks::GuardPages) {
+    // The runtime reserves all the memory can grow to up front, so the
+    // base is set once before any function runs and never moves.
+    Base->setMetadata(
+      llvm::LLVMContext::MD_invariant_load,
+      llvm::MDNode::get(IGM.getLLVMContext(), {})
+    );
+  }
+
+  llvm::Value * Addr =
+    Builder.CreateInBoundsGEP(IGM.I8Ty, Base, EffectiveAddr);
+  // The alignment of a memory argument is only a hint.
+  return Address(Addr, AccessTy, Alignment(1));
+}
+
+llvm::BasicBlock * IRGenFunction::getTrapBB() {
+  if (TrapBB != nullptr) {
+    return TrapBB;
+  }
+  TrapBB = createBasicBlock("memory.trap");
+  CurFn->getBasicBlockList().push_back(TrapBB);
+  llvm::IRBuilder<> TrapBuilder(TrapBB);
+  TrapBuilder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+  TrapBuilder.CreateUnreachable();
+  return TrapBB;
+}
+
+void IRGenFunction::emitTrapIf(
+  llvm::Value * Cond, const llvm::Twine& ContName
+) {
+  llvm::BasicBlock * ContBB = createBasicBlock(ContName);
+  Builder.CreateCondBr(
+    Cond,
+    getTrapBB(),
+    ContBB,
+    llvm::MDBuilder(IGM.getLLVMContext())
+      .createBranchWeights(1, (1U << 20) - 1)
+  );
+  CurFn->getBasicBlockList().push_back(ContBB);
+  Builder.SetInsertPoint(ContBB);
+}
+
+Memory * IRGenFunction::getAccessedMemory() {
+  Memory * M = Fn->getModule()->getMemory(0);
+  if (M == nullptr && !DiagnosedImportedMemory) {
+    // TODO: Support imported memories.
+    unimplemented(extractNearestSourceLoc(Fn), "imported memories");
+    DiagnosedImportedMemory = true;
+  }
+  return M;
+}
+
+void IRGenFunction::emitLoad(
+  MemoryArgument MemArg, ValueType * MemoryTy, ValueType * ResultTy
+) {
+  auto * Index = TopConfig->pop<Operand>()->getLowered();
+  llvm::Type * LoweredResultTy = IGM.getType(ResultTy);
+  auto * M = getAccessedMemory();
+  if (M == nullptr) {
+    TopConfig->push<Operand>(llvm::PoisonValue::get(LoweredResultTy));
+    return;
+  }
+  llvm::Type * AccessTy = IGM.getStorageType(MemoryTy);
+  Address Addr = emitMemoryAddress(M, Index, MemArg.Offset, AccessTy);
+  llvm::Value * Result = Builder.CreateLoad(Addr);
+  if (AccessTy != LoweredResultTy) {
+    Result = isa<UnsignedIntegerType>(MemoryTy)
+             ? Builder.CreateZExt(Result, LoweredResultTy)
+             : Builder.CreateSExt(Result, LoweredResultTy);
+  }
+  TopConfig->push<Operand>(Result);
+}
+
+void IRGenFunction::emitStore(
+  MemoryArgument MemArg, ValueType * MemoryTy
+) {
+  auto * Value = TopConfig->pop<Operand>()->getLowered();
+  auto * Index = TopConfig->pop<Operand>()->getLowered();
+  auto * M = getAccessedMemory();
+  if (M == nullptr) {
+    return;
+  }
+  llvm::Type * AccessTy = IGM.getStorageType(MemoryTy);
+  Address Addr = emitMemoryAddress(M, Index, MemArg.Offset, AccessTy);
+  if (Value->getType() != AccessTy) {
+    Value = Builder.CreateTrunc(Value, AccessTy);
+  }
+  Builder.CreateStore(Value, Addr);
+}
+
+void IRGenFunction::emitMemorySize() {
+  auto * M = getAccessedMemory();
+  if (M == nullptr) {
+    TopConfig->push<Operand>(llvm::PoisonValue::get(IGM.I32Ty));
+    return;
+  }
+  Address SizeAddr = Builder.CreateStructGEP(
+    getAddrOfMemory(M),
+    1,
+    IGM.DataLayout.getStructLayout(IGM.MemoryTy),
+    "memory.size.addr"
+  );
+  llvm::Value * Size = Builder.CreateLoad(SizeAddr, "memory.size");
+  // A wasm32 memory has at most 65536 pages, which fit in an i32.
+  llvm::Value * Pages = Builder.CreateLShr(Size, 16, "memory.pages");
+  TopConfig->push<Operand>(Builder.CreateTrunc(Pages, IGM.I32Ty));
+}
+
+/// Grows the memory through the runtime, which is declared as:
+///
+///   int32_t w2n_memory_grow(w2n_memory * M, uint32_t Delta,
+///                           uint64_t MaxSize);
+void IRGenFunction::emitMemoryGrow() {
+  auto * Delta = TopConfig->pop<Operand>()->getLowered();
+  auto * M = getAccessedMemory();
+  if (M == nullptr) {
+    TopConfig->push<Operand>(llvm::PoisonValue::get(IGM.I32Ty));
+    return;
+  }
+  llvm::FunctionType * GrowTy = llvm::FunctionType::get(
+    IGM.I32Ty, {IGM.PtrTy, IGM.I32Ty, IGM.I64Ty}, false
+  );
+  llvm::FunctionCallee Grow =
+    IGM.getModule()->getOrInsertFunction("w2n_memory_grow", GrowTy);
+  // The descriptor is passed by address, so the reads of the size after
+  // the call see the new size.
+  llvm::Value * Result = Builder.CreateCall(
+    Grow.getFunctionType(),
+    cast<llvm::Constant>(Grow.getCallee()),
+    {getAddrOfMemory(M).getAddress(),
+     Delta,
+     llvm::ConstantInt::get(IGM.I64Ty, getMemoryMaxSize(IGM, M))},
+    "memory.grow"
+  );
+  TopConfig->push<Operand>(Result);
+}
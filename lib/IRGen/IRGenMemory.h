@@ -1,6 +1,83 @@
 #ifndef W2N_IRGEN_IRGENMEMORY_H
 #define W2N_IRGEN_IRGENMEMORY_H
 
-namespace w2n {}
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/Optional.h>
+#include <cstdint>
+#include <w2n/AST/IRGenOptions.h>
+
+namespace llvm {
+class GlobalVariable;
+} // namespace llvm
+
+namespace w2n {
+class DataSegmentActiveDecl;
+class Memory;
+
+namespace irgen {
+class Address;
+class IRGenModule;
+
+/// The size of a WebAssembly page.
+constexpr uint64_t WasmPageSize = 64 * 1024;
+
+/// The number of bytes a wasm32 address can reach.
+constexpr uint64_t Wasm32AddressSpaceSize = uint64_t(1) << 32;
+
+/// The size of the inaccessible region reserved after the 4 GiB of a
+/// memory with guard pages.
+///
+/// An access reaches at most 4 GiB - 1 + its static offset + its size,
+/// so only accesses whose offset and size exceed the guard region need
+/// an explicit check.
+constexpr uint64_t MemoryGuardSize = uint64_t(2) << 30;
+
+/// Resolves \c IRGenMemoryBoundsChecks::Automatic for the target of
+/// \p IGM .
+IRGenMemoryBoundsChecks getMemoryBoundsChecks(const IRGenModule& IGM);
+
+/// Returns \c true if an access of \p AccessSize bytes at a static
+/// offset of \p Offset needs to be compared with the size of the memory.
+bool needsExplicitBoundsCheck(
+  const IRGenModule& IGM, uint64_t Offset, uint64_t AccessSize
+);
+
+/// Returns the address space in which \p M is accessed relative to the
+/// segment register holding its base, or \c None if its base is loaded
+/// into a register.
+///
+/// Only the first memory of a module can live in the segment.
+llvm::Optional<unsigned>
+getMemorySegmentAddressSpace(const IRGenModule& IGM, const Memory * M);
+
+/// Returns the number of bytes \p M can grow to with \c memory.grow .
+///
+/// The runtime reserves them up front, so the base of a memory never
+/// moves. Without a maximum, a memory checked explicitly keeps its
+/// initial size rather than reserving 4 GiB of a 32-bit address space.
+uint64_t getMemoryMaxSize(const IRGenModule& IGM, const Memory * M);
+
+/// An active data segment, and the constant holding its bytes.
+struct ActiveDataSegment {
+  DataSegmentActiveDecl * Decl;
+  llvm::GlobalVariable * Bytes;
+};
+
+/// Emits a constructor which asks the runtime to reserve and map \p M ,
+/// to fill its descriptor in the instance context at \p VMContext , and
+/// then copies the active data segments of \p M into it.
+///
+/// The segments which do not fit in the initial size of \p M are
+/// diagnosed, as instantiating the module would fail.
+void emitMemoryConstructor(
+  IRGenModule& Module,
+  Memory * M,
+  Address VMContext,
+  llvm::ArrayRef<ActiveDataSegment> Segments
+);
+
+} // namespace irgen
+
+} // namespace w2n
 
 #endif // W2N_IRGEN_IRGENMEMORY_H
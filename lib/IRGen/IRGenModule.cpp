@@ -3,6 +3,10 @@
 #include "GenDecl.h"
 #include "IRGenConstructor.h"
 #include "IRGenFunction.h"
+#include "IRGenGlobal.h"
+#include "IRGenMemory.h"
+#include "IRGenTable.h"
+#include "IRGenVMContext.h"
 #include "llvm/Transforms/Utils/ModuleUtils.h"
 #include <llvm/ADT/APFloat.h>
 #include <llvm/ADT/Twine.h>
@@ -26,8 +30,10 @@
 #include <w2n/AST/IRGenRequests.h>
 #include <w2n/AST/Linkage.h>
 #include <w2n/AST/Module.h>
+#include <w2n/Basic/Debug.h>
 #include <w2n/Basic/Unimplemented.h>
 #include <w2n/IRGen/Linking.h>
+#include <w2n/Parse/Parser.h>
 #include <w2n/Sema/Sema.h>
 
 using namespace w2n;
@@ -73,7 +79,17 @@ IRGenModule::IRGenModule(
   U32Ty(llvm::Type::getInt32Ty(getLLVMContext())),
   U64Ty(llvm::Type::getInt64Ty(getLLVMContext())),
   F32Ty(llvm::Type::getFloatTy(getLLVMContext())),
-  F64Ty(llvm::Type::getDoubleTy(getLLVMContext())) {
+  F64Ty(llvm::Type::getDoubleTy(getLLVMContext())),
+  MemoryTy(llvm::StructType::create(
+    getLLVMContext(), {I8Ty->getPointerTo(), I64Ty}, "w2n.memory"
+  )),
+  PtrTy(I8Ty->getPointerTo()),
+  TableTy(llvm::StructType::create(
+    getLLVMContext(), {PtrTy, I32Ty}, "w2n.table"
+  )),
+  TableEntryTy(llvm::StructType::create(
+    getLLVMContext(), {PtrTy, I32Ty}, "w2n.table.entry"
+  )) {
   IRGen.addGenModule(SF, this);
 }
 
@@ -87,19 +103,53 @@ GeneratedModule IRGenModule::intoGeneratedModule() && {
 }
 
 void IRGenModule::emitGlobalVariable(GlobalVariable * V) {
-  ForDefinition_t Def = ForDefinition;
   if (V->isImported()) {
-    Def = NotForDefinition;
+    return;
   }
-  Address Addr = getAddrOfGlobalVariable(V, Def);
-  if (Def != NotForDefinition) {
-    auto * InitFn = emitFunction(V->getInit());
-    emitGlobalVariableConstructor(*this, V, Addr, InitFn);
+  // The values known at compile time are part of the static initializer
+  // of the instance context instead.
+  if (evaluateInitializer(*this, V) != nullptr) {
+    return;
   }
+  auto * InitFn = emitFunction(V->getInit());
+  emitGlobalVariableConstructor(
+    *this, V, getAddrOfDefaultVMContext(NotForDefinition), InitFn
+  );
+}
+
+void IRGenModule::emitMemory(
+  Memory * M, ArrayRef<ActiveDataSegment> Segments
+) {
+  emitMemoryConstructor(
+    *this, M, getAddrOfDefaultVMContext(NotForDefinition), Segments
+  );
+}
+
+void IRGenModule::emitTable(Table * T) {
+  emitTableElements(
+    *this, T, getAddrOfDefaultVMContext(NotForDefinition)
+  );
+}
+
+llvm::GlobalVariable *
+IRGenModule::emitDataSegment(DataSegmentDecl * D, uint32_t SegmentIndex) {
+  llvm::Constant * Init =
+    llvm::ConstantDataArray::get(getLLVMContext(), D->getData());
+  auto * GVar = new llvm::GlobalVariable(
+    *Module,
+    Init->getType(),
+    /*isConstant*/ true,
+    llvm::GlobalValue::PrivateLinkage,
+    Init,
+    llvm::Twine("data.segment.") + llvm::Twine(SegmentIndex)
+  );
+  GVar->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  GVar->setAlignment(llvm::MaybeAlign(1));
+  return GVar;
 }
 
 llvm::Function * IRGenModule::emitFunction(Function * F) {
-  llvm::errs() << "[IRGenModule] " << __FUNCTION__ << "\n";
+  W2N_TRACE(IRGen, Verbose, "emit-function", {"index", F->getIndex()});
   if (F->isExternalDeclaration()) {
     return nullptr;
   }
@@ -126,12 +176,30 @@ void IRGenModule::addLinkLibrary(const LinkLibrary& LinkLib) {
 
 /// Emit all the top-level code in the source file.
 void IRGenModule::emitSourceFile(SourceFile& SF) {
+  emitGlobalsAndDataSegments(SF);
+
+  for (Function * F : IRGen.collectFunctionsToEmit(SF)) {
+    CurrentIGMPtr IGM = IRGen.getGenModule(F->getDeclContext());
+    IGM->emitFunction(F);
+  }
+  w2n_proto_implemented();
+}
+
+void IRGenModule::emitGlobalsAndDataSegments(SourceFile& SF) {
+  Address VMContext = getAddrOfDefaultVMContext(ForDefinition);
+
   for (Decl * D : SF.getTopLevelDecls()) {
     ModuleDecl * M = dyn_cast<ModuleDecl>(D);
     if (M == nullptr) {
       continue;
     }
     for (GlobalVariable& V : M->getGlobals()) {
+      if (llvm::Constant * Value = evaluateInitializer(*this, &V)) {
+        getVMContextLayout().initializeGlobalVariable(
+          cast<llvm::GlobalVariable>(VMContext.getAddress()), &V, Value
+        );
+        continue;
+      }
       GlobalDecl * VarDecl = V.getDecl();
       CurrentIGMPtr IGM = IRGen.getGenModule(
         VarDecl != nullptr ? VarDecl->getDeclContext() : nullptr
@@ -139,13 +207,34 @@ void IRGenModule::emitSourceFile(SourceFile& SF) {
       IGM->emitGlobalVariable(&V);
     }
 
-    for (Function& F : M->getFunctions()) {
-      auto * DC = F.getDeclContext();
-      CurrentIGMPtr IGM = IRGen.getGenModule(DC);
-      IGM->emitFunction(&F);
+    // The active segments are copied into their memories by the
+    // constructors of the memories.
+    SmallVector<ActiveDataSegment, 4> ActiveSegments;
+    if (auto * DataSection = M->getDataSection()) {
+      uint32_t SegmentIndex = 0;
+      for (auto * Segment : DataSection->getDataSegments()) {
+        llvm::GlobalVariable * Bytes =
+          emitDataSegment(Segment, SegmentIndex++);
+        if (auto * Active = dyn_cast<DataSegmentActiveDecl>(Segment)) {
+          ActiveSegments.push_back({Active, Bytes});
+        }
+      }
+    }
+
+    for (Memory& Mem : M->getMemories()) {
+      SmallVector<ActiveDataSegment, 4> Segments;
+      for (const ActiveDataSegment& Segment : ActiveSegments) {
+        if (Segment.Decl->getMemoryIndex() == Mem.getIndex()) {
+          Segments.push_back(Segment);
+        }
+      }
+      emitMemory(&Mem, Segments);
+    }
+
+    for (Table& T : M->getTables()) {
+      emitTable(&T);
     }
   }
-  w2n_proto_implemented();
 }
 
 void IRGenModule::unimplemented(SourceLoc Loc, StringRef Message) {
@@ -172,36 +261,38 @@ llvm::Module * IRGenModule::getModule() const {
   return Module.get();
 }
 
-Address IRGenModule::getAddrOfGlobalVariable(
-  GlobalVariable * Global, ForDefinition_t ForDefinition
-) {
-  std::string GName = Global->getFullQualifiedDescriptiveName();
-
-  auto * GVar = Module->getGlobalVariable(GName, /*allowInternal*/ true);
-
-  llvm::Type * StorageType = getType(Global->getType());
+const VMContextLayout& IRGenModule::getVMContextLayout() {
+  if (VMContext == nullptr) {
+    VMContext = std::make_unique<VMContextLayout>(*this, getWasmModule());
+  }
+  return *VMContext;
+}
 
-  LinkEntity Entity = LinkEntity::forGlobalVariable(Global);
+Address
+IRGenModule::getAddrOfDefaultVMContext(ForDefinition_t ForDefinition) {
+  const VMContextLayout& Layout = getVMContextLayout();
+  LinkEntity Entity = LinkEntity::forVMContext(getWasmModule());
   LinkInfo Info = LinkInfo::get(*this, Entity, ForDefinition);
 
+  auto * GVar = Module->getGlobalVariable(Info.getName(), true);
+
   if (GVar == nullptr) {
-    // FIXME: Alignment
-    Alignment FixedAlignment = Alignment(4);
-    GVar = createGlobalVariable(*this, Info, StorageType, FixedAlignment);
+    GVar = createGlobalVariable(
+      *this, Info, Layout.getType(), Layout.getAlignment()
+    );
 
-    /// Add a zero initializer.
+    /// The constructors of the module fill the context in before any
+    /// function runs.
     if (ForDefinition != 0) {
-      GVar->setInitializer(llvm::Constant::getNullValue(StorageType));
+      GVar->setInitializer(
+        llvm::Constant::getNullValue(Layout.getType())
+      );
     } else {
       GVar->setComdat(nullptr);
     }
   }
 
-  llvm::Constant * Addr = GVar;
-  Addr =
-    llvm::ConstantExpr::getBitCast(Addr, StorageType->getPointerTo());
-
-  return Address(Addr, StorageType, Alignment(GVar->getAlignment()));
+  return Address(GVar, Layout.getType(), Layout.getAlignment());
 }
 
 StackProtectorMode IRGenModule::shouldEmitStackProtector(Function * F) {
@@ -35,13 +35,17 @@
 
 namespace w2n {
 
+class DataSegmentDecl;
 class FuncDecl;
 class GeneratedModule;
+class Table;
 
 namespace irgen {
 
 class Address;
+struct ActiveDataSegment;
 class IRGenerator;
+class VMContextLayout;
 
 /// IRGenModule - Primary class for emitting IR for global declarations.
 ///
@@ -118,10 +122,31 @@ public:
 
   void emitSourceFile(SourceFile& SF);
 
+  /// Emits the globals, the memories and the data segments of the
+  /// modules of \p SF ,
+  /// which are not distributed in multi-threaded compilation.
+  void emitGlobalsAndDataSegments(SourceFile& SF);
+
   void addLinkLibrary(const LinkLibrary& LinkLib);
 
   void emitGlobalVariable(GlobalVariable * V);
 
+  /// Emits the descriptor of a memory and the constructor which sets it
+  /// up with the runtime and copies the active data \p Segments of the
+  /// memory into it.
+  void emitMemory(Memory * M, ArrayRef<ActiveDataSegment> Segments);
+
+  /// Emits the elements of a table, filled in by the active element
+  /// segments of the module, as a static initializer.
+  void emitTable(Table * T);
+
+  /// Emits the bytes of a data segment as a private constant, which the
+  /// constructor of its memory copies from when the segment is active.
+  /// The bytes are read directly from the input buffer the segment
+  /// refers to.
+  llvm::GlobalVariable *
+  emitDataSegment(DataSegmentDecl * D, uint32_t SegmentIndex);
+
   llvm::Function * emitFunction(Function * Func);
 
   void emitCoverageMapping();
@@ -147,13 +172,16 @@ public:
 
   llvm::Module * getModule() const;
 
-  Address getAddrOfGlobalVariable(
-    GlobalVariable * Global, ForDefinition_t ForDefinition
-  );
-
   llvm::Function *
   getAddrOfFunction(Function * F, ForDefinition_t ForDefinition);
 
+  /// Returns the layout of the instance context of the module.
+  const VMContextLayout& getVMContextLayout();
+
+  /// Returns the address of the instance of the module which the
+  /// constructors of the module set up.
+  Address getAddrOfDefaultVMContext(ForDefinition_t ForDefinition);
+
 #pragma mark Types
 
   llvm::Type * VoidTy;
@@ -169,16 +197,69 @@ public:
   llvm::Type * F32Ty;        /// f32, float
   llvm::Type * F64Ty;        /// f64, double
 
+  /// The descriptor of a linear memory, which the runtime fills in:
+  /// { ptr base, i64 size in bytes }.
+  llvm::StructType * MemoryTy;
+
+  /// ptr, the type of the hidden instance context argument of every
+  /// function.
+  llvm::PointerType * PtrTy;
+
+  /// The descriptor of a table of functions: { ptr elements, i32 size }.
+  llvm::StructType * TableTy;
+
+  /// An element of a table of functions, which \c call_indirect reads
+  /// at once: { ptr function, i32 signature id }. A null element has
+  /// the signature id 0, which no signature has. The functions run in
+  /// the instance of the caller.
+  llvm::StructType * TableEntryTy;
+
 private:
 
+  std::unique_ptr<VMContextLayout> VMContext;
+
   mutable llvm::DenseMap<VectorTyKey, llvm::ArrayType *> VectorTys;
 
   mutable llvm::DenseMap<StructTyKey, llvm::StructType *> StructTys;
 
-  mutable llvm::DenseMap<FuncTyKey, llvm::FunctionType *> FuncTys;
+  /// Lowered function types, keyed by the uniqued \c FuncType they
+  /// lower.
+  mutable llvm::DenseMap<const FuncType *, llvm::FunctionType *> FuncTys;
+
+  /// The values of the global initializers evaluated at compile time,
+  /// or null for those only known at instantiation.
+  llvm::DenseMap<const GlobalVariable *, llvm::Constant *>
+    EvaluatedInitializers;
+
+  /// The elements of the immutable tables, computed once per table for
+  /// the indirect calls which switch over them.
+  llvm::DenseMap<const Table *, std::vector<Function *>> TableElements;
+
+  /// The indices of the elements of the immutable tables which are
+  /// functions of a type, computed once per table and type.
+  llvm::DenseMap<
+    std::pair<const Table *, const FuncType *>,
+    std::vector<uint32_t>>
+    TableTargets;
 
 public:
 
+  /// Returns the elements of the immutable table \p T as its active
+  /// element segments set them, null where no segment sets them.
+  ArrayRef<Function *> getImmutableTableElements(Table * T);
+
+  /// Returns the indices of the elements of the immutable table \p T
+  /// which are functions of type \p Ty , in increasing order.
+  ArrayRef<uint32_t> getImmutableTableTargets(Table * T, FuncType * Ty);
+
+  /// Returns the cache of \c evaluateInitializer , which keeps the reads
+  /// of globals and the initializers reading them from evaluating the
+  /// same expressions again.
+  llvm::DenseMap<const GlobalVariable *, llvm::Constant *>&
+  getEvaluatedInitializers() {
+    return EvaluatedInitializers;
+  }
+
   llvm::Type * getType(Type * Ty) const {
 #define TYPE(Id, Parent)
 #define NUMBER_TYPE(Id, Parent)                                          \
@@ -227,26 +308,24 @@ private:
 public:
 
   llvm::FunctionType * getFuncType(FuncType * Ty) const {
-    auto LoweredParamTypes = lowerResultType(Ty->getParameters());
-
-    std::vector<llvm::Type *> LoweredResultTypes =
-      lowerResultType(Ty->getReturns());
-
-    FuncTyKey FuncKey = FuncTyKey(LoweredParamTypes, LoweredResultTypes);
-
-    auto Iter = FuncTys.find(FuncKey);
+    auto Iter = FuncTys.find(Ty);
 
     if (Iter != FuncTys.end()) {
       return Iter->second;
     }
 
+    // Every function takes the instance context as a hidden first
+    // argument.
+    auto LoweredParamTypes = lowerResultType(Ty->getParameters());
+    LoweredParamTypes.insert(LoweredParamTypes.begin(), PtrTy);
+
     auto * ResultTy = getResultType(Ty->getReturns());
 
     auto * FuncTy = llvm::FunctionType::get(
       ResultTy, LoweredParamTypes, /*variadic*/ false
     );
 
-    FuncTys.insert({FuncKey, FuncTy});
+    FuncTys.insert({Ty, FuncTy});
 
     return FuncTy;
   }
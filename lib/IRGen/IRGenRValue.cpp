@@ -2,6 +2,7 @@
 #include "IRGenModule.h"
 #include "Reduction.h"
 #include <w2n/AST/Lowering.h>
+#include <w2n/Basic/Debug.h>
 #include <w2n/Basic/Unimplemented.h>
 
 using namespace w2n;
@@ -15,6 +16,8 @@ class RValueEmitter :
   public Lowering::ExprVisitor<RValueEmitter, RValue> {
 public:
 
+  IRGenFunction& IGF;
+
   Function * Fn;
 
   IRGenModule& IGM;
@@ -23,16 +26,12 @@ public:
 
   Configuration& Config;
 
-  RValueEmitter(
-    Function * Fn,
-    IRGenModule& IGM,
-    IRBuilder& Builder,
-    Configuration& Config
-  ) :
-    Fn(Fn),
-    IGM(IGM),
-    Builder(Builder),
-    Config(Config){};
+  RValueEmitter(IRGenFunction& IGF) :
+    IGF(IGF),
+    Fn(IGF.Fn),
+    IGM(IGF.IGM),
+    Builder(IGF.Builder),
+    Config(*IGF.TopConfig){};
 
   RValueEmitter(const RValueEmitter&) = delete;
   RValueEmitter& operator=(const RValueEmitter&) = delete;
@@ -45,48 +44,44 @@ public:
   }
 
 #define W2N_LOG_VISIT()                                                  \
-  llvm::errs() << "[RValueEmitter] " << __FUNCTION__ << "\n";
-
-  // Grab a global variable address an push to the stack.
+  W2N_TRACE(                                                             \
+    IRGen,                                                               \
+    Verbose,                                                             \
+    "visit",                                                             \
+    {"emitter", "RValueEmitter"},                                        \
+    {"method", __FUNCTION__}                                             \
+  )
+
+  // Push the value of a global variable to the stack.
   RValue visitGlobalGetExpr(GlobalGetExpr * E) {
     W2N_LOG_VISIT();
-    auto GlobalIter = Fn->getModule()->global_begin();
-    std::advance(GlobalIter, E->getGlobalIndex());
-    auto& Global = *GlobalIter;
-    auto Addr = IGM.getAddrOfGlobalVariable(&Global, NotForDefinition);
-    Config.push<Operand>(Addr.getAddress());
+    auto * Global = Fn->getModule()->getGlobal(E->getGlobalIndex());
+    Config.push<Operand>(IGF.emitGlobalGet(Global));
     return RValue(Config.top<Operand>());
   }
 
   RValue visitGlobalSetExpr(GlobalSetExpr * E) {
     W2N_LOG_VISIT();
     auto * Op = Config.pop<Operand>();
-    auto GlobalIter = Fn->getModule()->global_begin();
-    std::advance(GlobalIter, E->getGlobalIndex());
-    auto& Global = *GlobalIter;
-    auto Addr = IGM.getAddrOfGlobalVariable(&Global, NotForDefinition);
+    auto * Global = Fn->getModule()->getGlobal(E->getGlobalIndex());
+    auto Addr = IGF.getAddrOfGlobalVariable(Global);
     Builder.CreateStore(Op->getLowered(), Addr);
-    Config.push<Operand>(Addr.getAddress());
-    return RValue(Config.top<Operand>());
+    return RValue();
   }
 
   RValue visitLocalSetExpr(LocalSetExpr * E) {
     W2N_LOG_VISIT();
     auto * Op = Config.pop<Operand>();
-    auto * F = Config.findTopmost<Frame>();
-    assert(F);
-    auto Asignee = F->getLocals().at(E->getLocalIndex());
-    // FIXME: Alignment
-    Alignment FixedAlignment = Alignment(4);
-    auto * Load = Builder.CreateLoad(
-      Asignee, llvm::Twine("local$") + llvm::Twine(E->getLocalIndex())
-    );
-    Builder.CreateStore(
-      Op->getLowered(), Load->getPointerOperand(), FixedAlignment
-    );
+    IGF.setLocal(E->getLocalIndex(), Op->getLowered());
     return RValue();
   }
 
+  RValue visitLocalTeeExpr(LocalTeeExpr * E) {
+    W2N_LOG_VISIT();
+    IGF.setLocal(E->getLocalIndex(), Config.top<Operand>().getLowered());
+    return RValue(Config.top<Operand>());
+  }
+
   RValue visitIntegerConstExpr(IntegerConstExpr * E) {
     W2N_LOG_VISIT();
     auto * Ty = IGM.getType(E->getIntegerType());
@@ -97,9 +92,7 @@ public:
 
   RValue visitLocalGetExpr(LocalGetExpr * E) {
     W2N_LOG_VISIT();
-    auto * F = Config.findTopmost<Frame>();
-    auto LocalAddr = F->getLocals().at(E->getLocalIndex());
-    Config.push<Operand>(LocalAddr.getAddress());
+    Config.push<Operand>(IGF.getLocal(E->getLocalIndex()));
     return RValue(Config.top<Operand>());
   }
 
@@ -109,27 +102,61 @@ public:
     return RValue();
   }
 
+  RValue visitSelectExpr(SelectExpr * E) {
+    W2N_LOG_VISIT();
+    auto * Cond = Config.pop<Operand>()->getLowered();
+    auto * FalseVal = Config.pop<Operand>()->getLowered();
+    auto * TrueVal = Config.pop<Operand>()->getLowered();
+    auto * IsTrue = Builder.CreateIsNotNull(Cond);
+    Config.push<Operand>(Builder.CreateSelect(IsTrue, TrueVal, FalseVal));
+    return RValue(Config.top<Operand>());
+  }
+
   RValue visitStoreExpr(StoreExpr * E) {
     W2N_LOG_VISIT();
-    w2n_unimplemented();
+    IGF.emitStore(E->getMemArg(), E->getDestinationType());
+    return RValue();
   }
 
   RValue visitLoadExpr(LoadExpr * E) {
     W2N_LOG_VISIT();
-    w2n_unimplemented();
+    IGF.emitLoad(
+      E->getMemArg(), E->getSourceType(), E->getDestinationType()
+    );
+    return RValue(Config.top<Operand>());
+  }
+
+  RValue visitMemorySizeExpr(MemorySizeExpr * E) {
+    W2N_LOG_VISIT();
+    IGF.emitMemorySize();
+    return RValue(Config.top<Operand>());
+  }
+
+  RValue visitMemoryGrowExpr(MemoryGrowExpr * E) {
+    W2N_LOG_VISIT();
+    IGF.emitMemoryGrow();
+    return RValue(Config.top<Operand>());
   }
 
   RValue visitCallExpr(CallExpr * E) {
     W2N_LOG_VISIT();
-    w2n_unimplemented();
+    IGF.emitCall(E->getFuncIndex());
+    return RValue();
+  }
+
+  RValue visitCallIndirectExpr(CallIndirectExpr * E) {
+    W2N_LOG_VISIT();
+    IGF.emitCallIndirect(E->getTypeIndex(), E->getTableIndex());
+    return RValue();
   }
 
   RValue visitCallBuiltinExpr(CallBuiltinExpr * E) {
     W2N_LOG_VISIT();
-    w2n_unimplemented();
+    IGF.emitBuiltin(E->getInstruction());
+    return RValue(Config.top<Operand>());
   }
 
-#undef LOG_VISIT
+#undef W2N_LOG_VISIT
 };
 
 } // namespace
@@ -137,5 +164,5 @@ public:
 #pragma mark - IRGenFunction
 
 RValue IRGenFunction::emitRValue(Expr * E) {
-  return RValueEmitter(Fn, IGM, Builder, *TopConfig).visit(E);
+  return RValueEmitter(*this).visit(E);
 }
@@ -1,10 +1,14 @@
 #include "Address.h"
 #include "IRGenFunction.h"
+#include "IRGenModule.h"
 #include "Reduction.h"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/MapVector.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Intrinsics.h>
 #include <cassert>
-#include <stack>
 #include <w2n/AST/Lowering.h>
 #include <w2n/Basic/Unimplemented.h>
 
@@ -18,18 +22,9 @@ namespace {
 class StmtEmitter : public Lowering::ASTVisitor<StmtEmitter> {
 public:
 
-  IRGenModule& IGM;
+  IRGenFunction& IGF;
 
-  IRBuilder& Builder;
-
-  Configuration& Config;
-
-  StmtEmitter(
-    IRGenModule& IGM, IRBuilder& Builder, Configuration& Config
-  ) :
-    IGM(IGM),
-    Builder(Builder),
-    Config(Config){};
+  StmtEmitter(IRGenFunction& IGF) : IGF(IGF){};
 
   StmtEmitter(const StmtEmitter&) = delete;
   StmtEmitter& operator=(const StmtEmitter&) = delete;
@@ -46,70 +41,505 @@ public:
 #pragma mark - IRGenFunction
 
 void IRGenFunction::emitStmt(Stmt * S) {
-  StmtEmitter(IGM, Builder, *TopConfig).visit(S);
+  StmtEmitter(*this).visit(S);
 }
 
 #pragma mark - StmtEmitter Implementation
 
 void StmtEmitter::visitUnreachableStmt(UnreachableStmt * S) {
-  w2n_unimplemented();
+  IGF.emitUnreachable();
+}
+
+void StmtEmitter::visitNopStmt(NopStmt * S) {
 }
 
 void StmtEmitter::visitBrStmt(BrStmt * S) {
-  w2n_unimplemented();
+  IGF.emitBr(S->getLabelIndex());
 }
 
 void StmtEmitter::visitEndStmt(EndStmt * S) {
-  auto NextTopKind = Config.topKind();
-  std::stack<Operand *> PoppedOps;
-  while (NextTopKind == ExecutionStackRecordKind::Operand) {
-    PoppedOps.push(Config.pop<Operand>());
-    NextTopKind = Config.topKind();
-  }
-  if (NextTopKind == ExecutionStackRecordKind::Frame) {
-    auto& F = Config.top<Frame>();
-    auto& RetAddr = F.getReturn();
-    if (!PoppedOps.empty()) {
-      assert(PoppedOps.size() == 1);
-      // FIXME: Alignment
-      Builder.CreateStore(PoppedOps.top()->getLowered(), RetAddr);
-    } else {
-      assert(F.hasNoReturn());
-    }
-  } else if (NextTopKind == ExecutionStackRecordKind::Label) {
-    Config.pop<Label>();
-    while (!PoppedOps.empty()) {
-      auto * Node = PoppedOps.top();
-      PoppedOps.pop();
-      Config.push(Node);
-    }
-  }
+  IGF.emitEnd();
 }
 
 void StmtEmitter::visitBrIfStmt(BrIfStmt * S) {
-  w2n_unimplemented();
+  IGF.emitBrIf(S->getLabelIndex());
 }
 
 void StmtEmitter::visitElseStmt(ElseStmt * S) {
-  w2n_unimplemented();
+  // The arms of an if are kept apart by the parser, and the else is
+  // emitted when the true arm is exhausted.
+  llvm_unreachable("else is emitted along with its if");
 }
 
 void StmtEmitter::visitLoopStmt(LoopStmt * S) {
-  w2n_unimplemented();
+  IGF.emitLoop(S->getType());
 }
 
 void StmtEmitter::visitBlockStmt(BlockStmt * S) {
-  w2n_unimplemented();
+  IGF.emitBlock(S->getType());
 }
 
 void StmtEmitter::visitReturnStmt(ReturnStmt * S) {
-  w2n_unimplemented();
+  IGF.emitReturn();
 }
 
 void StmtEmitter::visitBrTableStmt(BrTableStmt * S) {
-  w2n_unimplemented();
+  IGF.emitBrTable(S->getLabelIndices(), S->getDefaultLabelIndex());
 }
 
 void StmtEmitter::visitIfStmt(IfStmt * S) {
-  w2n_unimplemented();
-}
\ No newline at end of file
+  IGF.emitIf(S->getType());
+}
+
+#pragma mark - IRGenFunction Control Flow
+
+void IRGenFunction::pushLabel(
+  LabelKind Kind,
+  ArrayRef<llvm::Type *> ParamTypes,
+  ArrayRef<llvm::Type *> ResultTypes
+) {
+  TopConfig->push<Label>(Kind, ParamTypes, ResultTypes);
+  Labels.push_back(&TopConfig->top<Label>());
+}
+
+void IRGenFunction::lowerBlockType(
+  BlockType * Ty,
+  SmallVectorImpl<llvm::Type *>& ParamTypes,
+  SmallVectorImpl<llvm::Type *>& ResultTypes
+) const {
+  BlockType::Types T = Ty->getType();
+  if (T.is<VoidType *>()) {
+    return;
+  }
+  if (auto * ValueTy = T.dyn_cast<ValueType *>()) {
+    if (!isa<VoidType>(ValueTy)) {
+      ResultTypes.push_back(IGM.getType(ValueTy));
+    }
+    return;
+  }
+  uint32_t TypeIndex = T.get<TypeIndexType *>()->getTypeIndex();
+  FuncType * FnTy = Fn->getModule()->getType(TypeIndex)->getType();
+  for (auto * Param : FnTy->getParameters()->getValueTypes()) {
+    ParamTypes.push_back(IGM.getType(Param));
+  }
+  for (auto * Result : FnTy->getReturns()->getValueTypes()) {
+    ResultTypes.push_back(IGM.getType(Result));
+  }
+}
+
+void IRGenFunction::popValues(
+  SmallVectorImpl<llvm::Value *>& Values, size_t Count
+) {
+  size_t Start = Values.size();
+  Values.resize(Start + Count);
+  for (size_t I = Count; I > 0; I--) {
+    Values[Start + I - 1] = TopConfig->pop<Operand>()->getLowered();
+  }
+}
+
+void IRGenFunction::pushValues(ArrayRef<llvm::Value *> Values) {
+  for (auto * Each : Values) {
+    TopConfig->push<Operand>(Each);
+  }
+}
+
+void IRGenFunction::collectBranchValues(
+  Label& L, SmallVectorImpl<llvm::Value *>& Values
+) const {
+  uint32_t Count = L.getBranchTypes().size();
+  for (uint32_t I = Count; I > 0; I--) {
+    Values.push_back(TopConfig->findTopmostNth<Operand>(I)->getLowered());
+  }
+  // Nothing follows the end of the function body but returning.
+  if (L.getKind() != LabelKind::Function) {
+    auto& Locals = CurFrame->getLocals();
+    Values.append(Locals.begin(), Locals.end());
+  }
+}
+
+void IRGenFunction::addBranchEdges(Label& L, unsigned EdgeCount) {
+  SmallVector<llvm::Value *, 16> Values;
+  collectBranchValues(L, Values);
+  llvm::BasicBlock * From = Builder.GetInsertBlock();
+  if (!L.isLoop()) {
+    L.addIncoming(From, EdgeCount, Values);
+    return;
+  }
+  auto& Phis = L.getPhis();
+  assert(Phis.size() == Values.size() && "unexpected loop phis");
+  for (size_t I = 0; I < Phis.size(); I++) {
+    for (unsigned Edge = 0; Edge < EdgeCount; Edge++) {
+      Phis[I]->addIncoming(Values[I], From);
+    }
+  }
+}
+
+llvm::BasicBlock * IRGenFunction::getBranchBB(Label& L) {
+  if (L.getBranchBB() == nullptr) {
+    switch (L.getKind()) {
+    case LabelKind::Function:
+      L.setBranchBB(createBasicBlock("return"));
+      break;
+    case LabelKind::Block:
+      L.setBranchBB(createBasicBlock("block.end"));
+      break;
+    case LabelKind::If: L.setBranchBB(createBasicBlock("if.end")); break;
+    case LabelKind::Loop: llvm_unreachable("loop without header");
+    }
+  }
+  return L.getBranchBB();
+}
+
+void IRGenFunction::emitUnreachable() {
+  Builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+  Builder.CreateUnreachable();
+  Builder.ClearInsertionPoint();
+}
+
+void IRGenFunction::emitBlock(BlockType * Ty) {
+  SmallVector<llvm::Type *, 2> ParamTypes;
+  SmallVector<llvm::Type *, 2> ResultTypes;
+  lowerBlockType(Ty, ParamTypes, ResultTypes);
+  SmallVector<llvm::Value *, 2> Params;
+  popValues(Params, ParamTypes.size());
+  pushLabel(LabelKind::Block, ParamTypes, ResultTypes);
+  pushValues(Params);
+}
+
+void IRGenFunction::emitLoop(BlockType * Ty) {
+  SmallVector<llvm::Type *, 2> ParamTypes;
+  SmallVector<llvm::Type *, 2> ResultTypes;
+  lowerBlockType(Ty, ParamTypes, ResultTypes);
+  SmallVector<llvm::Value *, 2> Params;
+  popValues(Params, ParamTypes.size());
+  pushLabel(LabelKind::Loop, ParamTypes, ResultTypes);
+
+  llvm::BasicBlock * EntryBB = Builder.GetInsertBlock();
+  llvm::BasicBlock * HeaderBB = createBasicBlock("loop");
+  Builder.CreateBr(HeaderBB);
+  CurFn->getBasicBlockList().push_back(HeaderBB);
+  Builder.SetInsertPoint(HeaderBB);
+
+  // The params and the locals may be changed by the iterations of the
+  // loop, which are not emitted yet. Every one of them gets a phi, and
+  // the phis turning out to merge a single value are removed at the end
+  // of the loop.
+  Label& Loop = *Labels.back();
+  Loop.setBranchBB(HeaderBB);
+  auto& Phis = Loop.getPhis();
+  auto& Locals = CurFrame->getLocals();
+  Phis.reserve(Params.size() + Locals.size());
+  for (auto * Param : Params) {
+    auto * Phi = Builder.CreatePHI(Param->getType(), 2);
+    Phi->addIncoming(Param, EntryBB);
+    Phis.push_back(Phi);
+    TopConfig->push<Operand>(Phi);
+  }
+  for (size_t I = 0; I < Locals.size(); I++) {
+    auto *& Local = Locals[I];
+    auto * Phi = Builder.CreatePHI(
+      Local->getType(), 2, llvm::Twine("$local") + llvm::Twine(I)
+    );
+    Phi->addIncoming(Local, EntryBB);
+    Phis.push_back(Phi);
+    Local = Phi;
+  }
+}
+
+void IRGenFunction::emitIf(BlockType * Ty) {
+  SmallVector<llvm::Type *, 2> ParamTypes;
+  SmallVector<llvm::Type *, 2> ResultTypes;
+  lowerBlockType(Ty, ParamTypes, ResultTypes);
+  auto * Cond = TopConfig->pop<Operand>()->getLowered();
+  SmallVector<llvm::Value *, 16> Values;
+  popValues(Values, ParamTypes.size());
+  pushLabel(LabelKind::If, ParamTypes, ResultTypes);
+
+  llvm::BasicBlock * ThenBB = createBasicBlock("if.then");
+  llvm::BasicBlock * ElseBB = createBasicBlock("if.else");
+  Builder.CreateCondBr(Builder.CreateIsNotNull(Cond), ThenBB, ElseBB);
+
+  // The false arm starts with the same params and locals.
+  pushValues(Values);
+  auto& Locals = CurFrame->getLocals();
+  Values.append(Locals.begin(), Locals.end());
+  Labels.back()->setElse(ElseBB, Values);
+
+  CurFn->getBasicBlockList().push_back(ThenBB);
+  Builder.SetInsertPoint(ThenBB);
+}
+
+void IRGenFunction::emitElse() {
+  Label& If = *Labels.back();
+  assert(If.getKind() == LabelKind::If && "else without if");
+  if (isReachable()) {
+    addBranchEdges(If, 1);
+    Builder.CreateBr(getBranchBB(If));
+  }
+  TopConfig->popOperands();
+
+  If.setHasElse();
+  CurFn->getBasicBlockList().push_back(If.getElseBB());
+  Builder.SetInsertPoint(If.getElseBB());
+  size_t ParamCount = If.getParamTypes().size();
+  auto ElseValues = If.getElseValues();
+  pushValues(ElseValues.take_front(ParamCount));
+  auto ElseLocals = ElseValues.drop_front(ParamCount);
+  CurFrame->getLocals().assign(ElseLocals.begin(), ElseLocals.end());
+}
+
+void IRGenFunction::emitEnd() {
+  Label& L = *Labels.back();
+  if (!L.isLoop()) {
+    emitContinuation();
+    return;
+  }
+
+  // Branches to a loop jump back to its header, so the end of a loop is
+  // only reached by falling through.
+  SmallVector<llvm::Value *, 2> Results;
+  if (isReachable()) {
+    popValues(Results, L.getResultTypes().size());
+  }
+  TopConfig->popOperands();
+  TopConfig->pop<Label>();
+  Labels.pop_back();
+  pushValues(Results);
+  removeTrivialPhis(L);
+}
+
+void IRGenFunction::emitContinuation() {
+  Label& L = *Labels.back();
+  if (L.getKind() == LabelKind::If && !L.hasElse()) {
+    // Without an else, the false arm passes the params on as the results.
+    if (isReachable()) {
+      addBranchEdges(L, 1);
+      Builder.CreateBr(getBranchBB(L));
+    }
+    CurFn->getBasicBlockList().push_back(L.getElseBB());
+    Builder.SetInsertPoint(L.getElseBB());
+    L.addIncoming(L.getElseBB(), 1, L.getElseValues());
+    Builder.CreateBr(getBranchBB(L));
+    Builder.ClearInsertionPoint();
+  }
+
+  bool FallsThrough = isReachable();
+  if (FallsThrough) {
+    addBranchEdges(L, 1);
+  }
+  TopConfig->popOperands();
+  TopConfig->pop<Label>();
+  Labels.pop_back();
+
+  auto Incomings = L.getIncomings();
+  if (Incomings.empty()) {
+    // Every path through the label ends with a branch elsewhere.
+    return;
+  }
+
+  size_t ResultCount = L.getResultTypes().size();
+  if (Incomings.size() == 1 && FallsThrough
+      && L.getBranchBB() == nullptr) {
+    // Nothing branches to the label, so the code following the end
+    // continues in the same block.
+    pushValues(
+      ArrayRef<llvm::Value *>(Incomings.front().Values).take_front(
+        ResultCount
+      )
+    );
+    return;
+  }
+
+  llvm::BasicBlock * ContBB = getBranchBB(L);
+  if (FallsThrough) {
+    Builder.CreateBr(ContBB);
+  }
+  CurFn->getBasicBlockList().push_back(ContBB);
+  Builder.SetInsertPoint(ContBB);
+
+  unsigned EdgeCount = 0;
+  for (const auto& Each : Incomings) {
+    EdgeCount += Each.EdgeCount;
+  }
+
+  // Only the values which differ between the incoming edges need a phi.
+  size_t ValueCount = Incomings.front().Values.size();
+  SmallVector<llvm::Value *, 16> Merged;
+  Merged.reserve(ValueCount);
+  for (size_t I = 0; I < ValueCount; I++) {
+    llvm::Value * First = Incomings.front().Values[I];
+    bool IsSame = llvm::all_of(Incomings, [&](const auto& Each) {
+      return Each.Values[I] == First;
+    });
+    if (IsSame) {
+      Merged.push_back(First);
+      continue;
+    }
+    std::string Name;
+    if (I >= ResultCount) {
+      Name = "$local" + std::to_string(I - ResultCount);
+    }
+    auto * Phi = Builder.CreatePHI(First->getType(), EdgeCount, Name);
+    for (const auto& Each : Incomings) {
+      for (unsigned Edge = 0; Edge < Each.EdgeCount; Edge++) {
+        Phi->addIncoming(Each.Values[I], Each.From);
+      }
+    }
+    Merged.push_back(Phi);
+  }
+
+  pushValues(ArrayRef<llvm::Value *>(Merged).take_front(ResultCount));
+  if (L.getKind() != LabelKind::Function) {
+    auto Locals = ArrayRef<llvm::Value *>(Merged).drop_front(ResultCount);
+    CurFrame->getLocals().assign(Locals.begin(), Locals.end());
+  }
+}
+
+void IRGenFunction::removeTrivialPhis(Label& Loop) {
+  llvm::DenseMap<llvm::Value *, llvm::Value *> Replacements;
+  SmallVector<llvm::PHINode *, 16> Phis(
+    Loop.getPhis().begin(), Loop.getPhis().end()
+  );
+  // Removing a phi may make the phis using it trivial.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (auto *& Phi : Phis) {
+      if (Phi == nullptr) {
+        continue;
+      }
+      llvm::Value * Same = nullptr;
+      bool IsTrivial = true;
+      for (llvm::Value * Incoming : Phi->incoming_values()) {
+        if (Incoming == Phi || Incoming == Same) {
+          continue;
+        }
+        if (Same != nullptr) {
+          IsTrivial = false;
+          break;
+        }
+        Same = Incoming;
+      }
+      if (!IsTrivial) {
+        continue;
+      }
+      assert(Same != nullptr && "loop phi without an entry value");
+      Phi->replaceAllUsesWith(Same);
+      for (auto& Each : Replacements) {
+        if (Each.second == Phi) {
+          Each.second = Same;
+        }
+      }
+      Replacements[Phi] = Same;
+      Phi->eraseFromParent();
+      Phi = nullptr;
+      Changed = true;
+    }
+  }
+  Loop.getPhis().clear();
+  if (!Replacements.empty()) {
+    TopConfig->replaceValues(Replacements);
+  }
+}
+
+void IRGenFunction::emitBr(uint32_t LabelIndex) {
+  Label& L = getLabel(LabelIndex);
+  addBranchEdges(L, 1);
+  Builder.CreateBr(getBranchBB(L));
+  Builder.ClearInsertionPoint();
+}
+
+void IRGenFunction::emitBrIf(uint32_t LabelIndex) {
+  auto * Cond = TopConfig->pop<Operand>()->getLowered();
+  Label& L = getLabel(LabelIndex);
+  addBranchEdges(L, 1);
+  llvm::BasicBlock * ContBB = createBasicBlock("br_if.cont");
+  Builder.CreateCondBr(
+    Builder.CreateIsNotNull(Cond), getBranchBB(L), ContBB
+  );
+  CurFn->getBasicBlockList().push_back(ContBB);
+  Builder.SetInsertPoint(ContBB);
+}
+
+void IRGenFunction::emitBrTable(
+  ArrayRef<uint32_t> LabelIndices, uint32_t Default
+) {
+  auto * Index = TopConfig->pop<Operand>()->getLowered();
+
+  // Labels targeted by several entries get one edge per entry.
+  llvm::SmallMapVector<uint32_t, unsigned, 8> EdgeCounts;
+  for (uint32_t LabelIndex : LabelIndices) {
+    EdgeCounts[LabelIndex] += 1;
+  }
+  EdgeCounts[Default] += 1;
+  for (const auto& Each : EdgeCounts) {
+    addBranchEdges(getLabel(Each.first), Each.second);
+  }
+
+  auto * Switch = Builder.CreateSwitch(
+    Index, getBranchBB(getLabel(Default)), LabelIndices.size()
+  );
+  auto * IndexTy = llvm::cast<llvm::IntegerType>(Index->getType());
+  for (uint32_t I = 0; I < LabelIndices.size(); I++) {
+    Switch->addCase(
+      llvm::ConstantInt::get(IndexTy, I),
+      getBranchBB(getLabel(LabelIndices[I]))
+    );
+  }
+  Builder.ClearInsertionPoint();
+}
+
+void IRGenFunction::emitReturn() {
+  emitBr(Labels.size() - 1);
+}
+
+#pragma mark - IRGenFunction Calls
+
+void IRGenFunction::emitCall(uint32_t FuncIndex) {
+  Function * Callee = Fn->getModule()->getFunction(FuncIndex);
+  if (Callee == nullptr) {
+    // TODO: Support imported functions.
+    w2n_unimplemented();
+  }
+  emitCall(
+    Callee->getType()->getType(),
+    IGM.getAddrOfFunction(Callee, NotForDefinition),
+    VMContext
+  );
+}
+
+void IRGenFunction::emitCall(
+  FuncType * Ty, llvm::Value * Callee, llvm::Value * CalleeVMContext
+) {
+  llvm::FunctionType * FTy = IGM.getFuncType(Ty);
+  SmallVector<llvm::Value *, 4> Args;
+  popCallArguments(Ty, CalleeVMContext, Args);
+
+  llvm::CallInst * Call = nullptr;
+  if (auto * Fn = dyn_cast<llvm::Function>(Callee)) {
+    Call = Builder.CreateCall(FTy, Fn, Args);
+  } else {
+    Call = Builder.CreateIndirectCall(FTy, Callee, Args);
+  }
+  pushCallResults(Ty, Call);
+}
+
+void IRGenFunction::popCallArguments(
+  FuncType * Ty,
+  llvm::Value * CalleeVMContext,
+  SmallVectorImpl<llvm::Value *>& Args
+) {
+  Args.push_back(CalleeVMContext);
+  popValues(Args, Ty->getParameters()->getValueTypes().size());
+}
+
+void IRGenFunction::pushCallResults(FuncType * Ty, llvm::Value * Result) {
+  size_t ResultCount = Ty->getReturns()->getValueTypes().size();
+  if (ResultCount == 1) {
+    TopConfig->push<Operand>(Result);
+    return;
+  }
+  for (unsigned I = 0; I < ResultCount; I++) {
+    TopConfig->push<Operand>(Builder.CreateExtractValue(Result, I));
+  }
+}
@@ -0,0 +1,323 @@
+#include "IRGenTable.h"
+#include "Address.h"
+#include "IRGenFunction.h"
+#include "IRGenModule.h"
+#include "IRGenVMContext.h"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Instructions.h>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Module.h>
+#include <w2n/AST/Table.h>
+
+using namespace w2n;
+using namespace w2n::irgen;
+
+#pragma mark - Signatures
+
+llvm::ConstantInt *
+irgen::getSignatureID(const IRGenModule& IGM, const FuncType * Ty) {
+  return llvm::ConstantInt::get(IGM.I32Ty, Ty->getCanonicalID() + 1);
+}
+
+#pragma mark - Table Elements
+
+/// Fills \p Elements with the functions the active element segments set
+/// the elements of \p T to, leaving the other elements null. Calls
+/// \p Diagnose with the segments which do not fit in \p T or which are
+/// not supported yet, and with the reason.
+static void collectTableElements(
+  Table * T,
+  std::vector<Function *>& Elements,
+  llvm::function_ref<void(ElementSegmentDecl *, StringRef)> Diagnose
+) {
+  ModuleDecl * M = T->getModule();
+  uint64_t Size = T->getMinSize();
+  Elements.assign(Size, nullptr);
+
+  auto * Section = M->getElementSection();
+  if (Section == nullptr) {
+    return;
+  }
+  for (ElementSegmentDecl * Segment : Section->getElementSegments()) {
+    // Passive and declarative segments are only read by table.init and
+    // ref.func.
+    if (!Segment->isActive()
+        || Segment->getTableIndex() != T->getIndex()) {
+      continue;
+    }
+    llvm::Optional<uint32_t> Offset = Segment->getConstantOffset();
+    if (!Offset.has_value()) {
+      // TODO: Support offsets read from imported globals.
+      Diagnose(
+        Segment, "element segment offsets of imported globals are not "
+                 "supported"
+      );
+      continue;
+    }
+    const std::vector<uint32_t>& Functions =
+      Segment->getFunctionIndices();
+    if (uint64_t(*Offset) + Functions.size() > Size) {
+      Diagnose(Segment, "element segment does not fit in the table");
+      continue;
+    }
+    for (size_t I = 0; I < Functions.size(); I++) {
+      if (Functions[I] == ElementSegmentDecl::NullFunction) {
+        continue;
+      }
+      Function * F = M->getFunction(Functions[I]);
+      if (F == nullptr) {
+        // TODO: Support imported functions.
+        Diagnose(
+          Segment, "imported functions in element segments are not "
+                   "supported"
+        );
+        break;
+      }
+      Elements[*Offset + I] = F;
+    }
+  }
+}
+
+void irgen::emitTableElements(
+  IRGenModule& IGM, Table * T, Address VMContext
+) {
+  if (!isa<FuncRefType>(T->getType()->getElementType())) {
+    // TODO: Support tables of external references.
+    IGM.error(
+      T->getDecl()->getLoc(), "tables of externref are not supported"
+    );
+    return;
+  }
+
+  auto * Context = cast<llvm::GlobalVariable>(VMContext.getAddress());
+  std::vector<Function *> Functions;
+  collectTableElements(
+    T,
+    Functions,
+    [&](ElementSegmentDecl * Segment, StringRef Reason) {
+      IGM.error(Segment->getLoc(), Reason);
+    }
+  );
+
+  uint64_t Size = Functions.size();
+  std::vector<llvm::Constant *> Elements;
+  Elements.reserve(Size);
+  for (Function * F : Functions) {
+    if (F == nullptr) {
+      Elements.push_back(llvm::Constant::getNullValue(IGM.TableEntryTy));
+      continue;
+    }
+    Elements.push_back(llvm::ConstantStruct::get(
+      IGM.TableEntryTy,
+      {IGM.getAddrOfFunction(F, NotForDefinition),
+       getSignatureID(IGM, F->getType()->getType())}
+    ));
+  }
+
+  auto * ElementsTy = llvm::ArrayType::get(IGM.TableEntryTy, Size);
+  auto * GVar = new llvm::GlobalVariable(
+    *IGM.getModule(),
+    ElementsTy,
+    /*isConstant*/ T->isImmutable(),
+    llvm::GlobalValue::InternalLinkage,
+    llvm::ConstantArray::get(ElementsTy, Elements),
+    T->getFullQualifiedDescriptiveName() + ".elements"
+  );
+  GVar->setAlignment(IGM.DataLayout.getABITypeAlign(IGM.TableEntryTy));
+
+  IGM.getVMContextLayout().initializeTable(
+    Context,
+    T,
+    llvm::ConstantStruct::get(
+      IGM.TableTy, {GVar, llvm::ConstantInt::get(IGM.I32Ty, Size)}
+    )
+  );
+}
+
+#pragma mark - IRGenModule
+
+ArrayRef<Function *> IRGenModule::getImmutableTableElements(Table * T) {
+  assert(T->isImmutable());
+  auto [Iter, Inserted] = TableElements.try_emplace(T);
+  if (Inserted) {
+    // emitTableElements diagnoses the segments.
+    collectTableElements(
+      T, Iter->second, [](ElementSegmentDecl *, StringRef) {}
+    );
+  }
+  return Iter->second;
+}
+
+ArrayRef<uint32_t>
+IRGenModule::getImmutableTableTargets(Table * T, FuncType * Ty) {
+  auto Iter = TableTargets.find({T, Ty});
+  if (Iter != TableTargets.end()) {
+    return Iter->second;
+  }
+
+  // Function types are uniqued, so the elements which pass the signature
+  // check are the functions of the very same type.
+  std::vector<uint32_t> Targets;
+  ArrayRef<Function *> Elements = getImmutableTableElements(T);
+  for (uint32_t I = 0; I < Elements.size(); I++) {
+    if (Elements[I] != nullptr
+        && Elements[I]->getType()->getType() == Ty) {
+      Targets.push_back(I);
+    }
+  }
+  return TableTargets.try_emplace({T, Ty}, std::move(Targets))
+    .first->second;
+}
+
+#pragma mark - IRGenFunction
+
+void IRGenFunction::emitCallIndirect(
+  uint32_t TypeIndex, uint32_t TableIndex
+) {
+  auto * Index = TopConfig->pop<Operand>()->getLowered();
+  ModuleDecl * M = Fn->getModule();
+  Table * T = M->getTable(TableIndex);
+  FuncType * Ty = M->getType(TypeIndex)->getType();
+  if (T == nullptr) {
+    // TODO: Support imported tables.
+    IGM.error(
+      extractNearestSourceLoc(Fn), "imported tables are not supported"
+    );
+    // Keep the stack balanced for the rest of the function.
+    SmallVector<llvm::Value *, 4> Args;
+    popCallArguments(Ty, VMContext, Args);
+    llvm::Type * ResultTy = IGM.getFuncType(Ty)->getReturnType();
+    pushCallResults(
+      Ty,
+      ResultTy->isVoidTy() ? nullptr : llvm::PoisonValue::get(ResultTy)
+    );
+    return;
+  }
+  if (T->isImmutable() && emitDevirtualizedCallIndirect(Ty, T, Index)) {
+    return;
+  }
+
+  const llvm::StructLayout * TableLayout =
+    IGM.DataLayout.getStructLayout(IGM.TableTy);
+  const llvm::StructLayout * EntryLayout =
+    IGM.DataLayout.getStructLayout(IGM.TableEntryTy);
+  Address Descriptor = getAddrOfTable(T);
+
+  Address SizeAddr = Builder.CreateStructGEP(
+    Descriptor, 1, TableLayout, "table.size.addr"
+  );
+  llvm::Value * Size = Builder.CreateLoad(SizeAddr, "table.size");
+  emitTrapIf(Builder.CreateICmpUGE(Index, Size), "table.inbounds");
+
+  Address ElementsAddr = Builder.CreateStructGEP(
+    Descriptor, 0, TableLayout, "table.elements.addr"
+  );
+  llvm::Value * Elements =
+    Builder.CreateLoad(ElementsAddr, "table.elements");
+  llvm::Value * EntryPtr = Builder.CreateInBoundsGEP(
+    IGM.TableEntryTy,
+    Elements,
+    Builder.CreateZExt(Index, IGM.I64Ty),
+    "table.entry"
+  );
+  Address Entry(
+    EntryPtr,
+    IGM.TableEntryTy,
+    Alignment(IGM.DataLayout.getABITypeAlign(IGM.TableEntryTy).value())
+  );
+
+  // Null elements have the signature id 0, so one compare checks both
+  // that the element is set and that it has the expected type.
+  Address SigAddr = Builder.CreateStructGEP(
+    Entry, 1, EntryLayout, "table.entry.sig.addr"
+  );
+  llvm::Value * Sig = Builder.CreateLoad(SigAddr, "table.entry.sig");
+  emitTrapIf(
+    Builder.CreateICmpNE(Sig, getSignatureID(IGM, Ty)), "table.sig.match"
+  );
+
+  // The elements are functions defined by the module, which run in the
+  // instance of the caller. Passing the context of the caller, rather
+  // than a copy of it loaded from the table, keeps the accesses of the
+  // callee based on the noalias context argument of the caller.
+  // TODO: Pass the context of the exporting instance along with the
+  // imported functions once tables can hold them.
+  Address CalleeAddr =
+    Builder.CreateStructGEP(Entry, 0, EntryLayout, "table.entry.fn.addr");
+  emitCall(
+    Ty, Builder.CreateLoad(CalleeAddr, "table.entry.fn"), VMContext
+  );
+}
+
+bool IRGenFunction::emitDevirtualizedCallIndirect(
+  FuncType * Ty, Table * T, llvm::Value * Index
+) {
+  // Beyond this many elements, a switch costs more than the loads and
+  // the compares of the indirect call.
+  static constexpr size_t MaxSwitchCases = 8;
+
+  // The functions of an immutable table are defined by the module and
+  // run in this instance.
+  ArrayRef<Function *> Elements = IGM.getImmutableTableElements(T);
+
+  if (auto * Const = dyn_cast<llvm::ConstantInt>(Index)) {
+    uint64_t I = Const->getZExtValue();
+    if (I >= Elements.size() || Elements[I] == nullptr
+        || Elements[I]->getType()->getType() != Ty) {
+      // Leave the trap to the checks of the indirect call.
+      return false;
+    }
+    emitCall(
+      Ty, IGM.getAddrOfFunction(Elements[I], NotForDefinition), VMContext
+    );
+    return true;
+  }
+
+  ArrayRef<uint32_t> Cases = IGM.getImmutableTableTargets(T, Ty);
+  if (Cases.empty() || Cases.size() > MaxSwitchCases) {
+    return false;
+  }
+
+  // Every other index is out of bounds, or a null element or a function
+  // of another type, so the default destination is the trap.
+  llvm::FunctionType * FTy = IGM.getFuncType(Ty);
+  SmallVector<llvm::Value *, 4> Args;
+  popCallArguments(Ty, VMContext, Args);
+  llvm::SwitchInst * Switch =
+    Builder.CreateSwitch(Index, getTrapBB(), Cases.size());
+  llvm::BasicBlock * ContBB = createBasicBlock("table.call.end");
+
+  // The elements set to the same function share a call.
+  llvm::DenseMap<Function *, llvm::BasicBlock *> CallBBs;
+  SmallVector<std::pair<llvm::Value *, llvm::BasicBlock *>, 8> Results;
+  for (uint32_t I : Cases) {
+    llvm::BasicBlock *& CallBB = CallBBs[Elements[I]];
+    if (CallBB == nullptr) {
+      CallBB = createBasicBlock("table.call");
+      CurFn->getBasicBlockList().push_back(CallBB);
+      Builder.SetInsertPoint(CallBB);
+      llvm::CallInst * Call = Builder.CreateCall(
+        FTy, IGM.getAddrOfFunction(Elements[I], NotForDefinition), Args
+      );
+      Builder.CreateBr(ContBB);
+      Results.push_back({Call, CallBB});
+    }
+    Switch->addCase(llvm::ConstantInt::get(IGM.I32Ty, I), CallBB);
+  }
+
+  CurFn->getBasicBlockList().push_back(ContBB);
+  Builder.SetInsertPoint(ContBB);
+  llvm::Value * Result = nullptr;
+  if (!FTy->getReturnType()->isVoidTy()) {
+    llvm::PHINode * Phi =
+      Builder.CreatePHI(FTy->getReturnType(), Results.size());
+    for (auto& [Call, CallBB] : Results) {
+      Phi->addIncoming(Call, CallBB);
+    }
+    Result = Phi;
+  }
+  pushCallResults(Ty, Result);
+  return true;
+}
@@ -1,6 +1,34 @@
 #ifndef W2N_IRGEN_IRGENTABLE_H
 #define W2N_IRGEN_IRGENTABLE_H
 
-namespace w2n {}
+namespace llvm {
+class ConstantInt;
+} // namespace llvm
+
+namespace w2n {
+class FuncType;
+class Table;
+
+namespace irgen {
+class Address;
+class IRGenModule;
+
+/// Returns the signature id \c call_indirect compares the elements of a
+/// table with to check that they are functions of type \p Ty .
+///
+/// Function types are uniqued by the \c ASTContext , so the id is a
+/// compile-time constant shared by the structurally equal types of the
+/// module. The id 0 is left to the null elements.
+llvm::ConstantInt *
+getSignatureID(const IRGenModule& IGM, const FuncType * Ty);
+
+/// Emits the elements of \p T , filled in by the active element segments
+/// of its module, as a static initializer, and points the descriptor of
+/// \p T in the context at \p VMContext at them.
+void emitTableElements(IRGenModule& IGM, Table * T, Address VMContext);
+
+} // namespace irgen
+
+} // namespace w2n
 
 #endif // W2N_IRGEN_IRGENTABLE_H
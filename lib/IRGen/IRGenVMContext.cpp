@@ -0,0 +1,145 @@
+#include "IRGenVMContext.h"
+#include "IRBuilder.h"
+#include "IRGenFunction.h"
+#include "IRGenModule.h"
+#include <llvm/IR/Attributes.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <w2n/AST/GlobalVariable.h>
+#include <w2n/AST/Memory.h>
+#include <w2n/AST/Module.h>
+#include <w2n/AST/Table.h>
+
+using namespace w2n;
+using namespace w2n::irgen;
+
+#pragma mark - VMContextLayout
+
+VMContextLayout::VMContextLayout(IRGenModule& IGM, ModuleDecl * M) {
+  SmallVector<llvm::Type *, 8> Fields;
+
+  for (const Memory& Mem : M->getMemories()) {
+    MemoryFields.insert({&Mem, Fields.size()});
+    Fields.push_back(IGM.MemoryTy);
+  }
+
+  for (const Table& T : M->getTables()) {
+    TableFields.insert({&T, Fields.size()});
+    Fields.push_back(IGM.TableTy);
+  }
+
+  for (const GlobalVariable& G : M->getGlobals()) {
+    GlobalFields.insert({&G, Fields.size()});
+    Fields.push_back(IGM.getType(G.getType()));
+  }
+
+  Ty =
+    llvm::StructType::create(IGM.getLLVMContext(), Fields, "w2n.vmctx");
+  Layout = IGM.DataLayout.getStructLayout(Ty);
+  Align = Alignment(IGM.DataLayout.getABITypeAlign(Ty).value());
+}
+
+Address VMContextLayout::projectMemory(
+  IRBuilder& Builder, Address VMContext, const Memory * M
+) const {
+  auto Iter = MemoryFields.find(M);
+  assert(Iter != MemoryFields.end() && "memory of another module");
+  return Builder.CreateStructGEP(
+    VMContext, Iter->second, Layout, "memory"
+  );
+}
+
+Address VMContextLayout::projectTable(
+  IRBuilder& Builder, Address VMContext, const Table * T
+) const {
+  auto Iter = TableFields.find(T);
+  assert(Iter != TableFields.end() && "table of another module");
+  return Builder.CreateStructGEP(
+    VMContext, Iter->second, Layout, "table"
+  );
+}
+
+void VMContextLayout::initializeTable(
+  llvm::GlobalVariable * VMContext,
+  const Table * T,
+  llvm::Constant * Descriptor
+) const {
+  auto Iter = TableFields.find(T);
+  assert(Iter != TableFields.end() && "table of another module");
+  initializeField(VMContext, Iter->second, Descriptor);
+}
+
+Address VMContextLayout::projectGlobalVariable(
+  IRBuilder& Builder, Address VMContext, const GlobalVariable * G
+) const {
+  auto Iter = GlobalFields.find(G);
+  assert(Iter != GlobalFields.end() && "global of another module");
+  return Builder.CreateStructGEP(
+    VMContext, Iter->second, Layout, G->getDescriptiveName()
+  );
+}
+
+void VMContextLayout::initializeGlobalVariable(
+  llvm::GlobalVariable * VMContext,
+  const GlobalVariable * G,
+  llvm::Constant * Value
+) const {
+  auto Iter = GlobalFields.find(G);
+  assert(Iter != GlobalFields.end() && "global of another module");
+  initializeField(VMContext, Iter->second, Value);
+}
+
+void VMContextLayout::initializeField(
+  llvm::GlobalVariable * VMContext, unsigned Field, llvm::Constant * Value
+) const {
+  llvm::Constant * Init = VMContext->getInitializer();
+  SmallVector<llvm::Constant *, 8> Fields;
+  for (unsigned I = 0; I < Ty->getNumElements(); I++) {
+    Fields.push_back(Init->getAggregateElement(I));
+  }
+  Fields[Field] = Value;
+  VMContext->setInitializer(llvm::ConstantStruct::get(Ty, Fields));
+}
+
+void irgen::addVMContextAttributes(IRGenModule& IGM, llvm::Function * F) {
+  const VMContextLayout& Layout = IGM.getVMContextLayout();
+  llvm::Argument * VMContext = F->getArg(0);
+  VMContext->setName("vmctx");
+
+  // Memories and globals are only accessed through the context, and the
+  // bytes of a memory are mapped apart from it, so stores to a memory
+  // leave the base and the size of the memory loaded from the context
+  // available.
+  llvm::AttrBuilder Attrs(IGM.getLLVMContext());
+  Attrs.addAttribute(llvm::Attribute::NoAlias);
+  Attrs.addAttribute(llvm::Attribute::NonNull);
+  Attrs.addAlignmentAttr(Layout.getAlignment().getValue());
+  Attrs.addDereferenceableAttr(Layout.getSize());
+  F->addParamAttrs(0, Attrs);
+}
+
+#pragma mark - IRGenFunction
+
+Address IRGenFunction::getVMContext() const {
+  const VMContextLayout& Layout = IGM.getVMContextLayout();
+  return Address(VMContext, Layout.getType(), Layout.getAlignment());
+}
+
+Address IRGenFunction::getAddrOfMemory(Memory * M) {
+  return IGM.getVMContextLayout().projectMemory(
+    Builder, getVMContext(), M
+  );
+}
+
+Address IRGenFunction::getAddrOfTable(Table * T) {
+  return IGM.getVMContextLayout().projectTable(
+    Builder, getVMContext(), T
+  );
+}
+
+Address IRGenFunction::getAddrOfGlobalVariable(GlobalVariable * G) {
+  return IGM.getVMContextLayout().projectGlobalVariable(
+    Builder, getVMContext(), G
+  );
+}
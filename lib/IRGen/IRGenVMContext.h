@@ -0,0 +1,118 @@
+#ifndef W2N_IRGEN_IRGENVMCONTEXT_H
+#define W2N_IRGEN_IRGENVMCONTEXT_H
+
+#include "Address.h"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/DerivedTypes.h>
+
+namespace llvm {
+class Constant;
+class Function;
+class GlobalVariable;
+} // namespace llvm
+
+namespace w2n {
+class GlobalVariable;
+class Memory;
+class ModuleDecl;
+class Table;
+
+namespace irgen {
+class IRBuilder;
+class IRGenModule;
+
+/**
+ * @brief The layout of the instance context, or vmctx, of a module.
+ *
+ * The instance context holds the state of an instance of a module: the
+ * descriptors of the memories and of the tables, and the values of the
+ * globals the module defines.
+ *
+ *   %w2n.vmctx = type { %w2n.memory, ..., %w2n.table, ...,
+ *                       <global type>, ... }
+ *
+ * Every function takes the context of its instance as a hidden first
+ * argument instead of addressing LLVM globals, so that several
+ * instances of a module can live in one process, and the memory base
+ * can stay in a register where nothing may grow the memory.
+ */
+class VMContextLayout {
+  llvm::StructType * Ty;
+
+  const llvm::StructLayout * Layout;
+
+  Alignment Align;
+
+  llvm::DenseMap<const Memory *, unsigned> MemoryFields;
+
+  llvm::DenseMap<const Table *, unsigned> TableFields;
+
+  llvm::DenseMap<const GlobalVariable *, unsigned> GlobalFields;
+
+  void initializeField(
+    llvm::GlobalVariable * VMContext,
+    unsigned Field,
+    llvm::Constant * Value
+  ) const;
+
+public:
+
+  VMContextLayout(IRGenModule& IGM, ModuleDecl * M);
+
+  llvm::StructType * getType() const {
+    return Ty;
+  }
+
+  Alignment getAlignment() const {
+    return Align;
+  }
+
+  uint64_t getSize() const {
+    return Layout->getSizeInBytes();
+  }
+
+  /// Returns the address of the descriptor of \p M in the context at
+  /// \p VMContext , whose type is \c IRGenModule::MemoryTy .
+  Address projectMemory(
+    IRBuilder& Builder, Address VMContext, const Memory * M
+  ) const;
+
+  /// Returns the address of the descriptor of \p T in the context at
+  /// \p VMContext , whose type is \c IRGenModule::TableTy .
+  Address projectTable(
+    IRBuilder& Builder, Address VMContext, const Table * T
+  ) const;
+
+  /// Sets the descriptor of \p T in the static initializer of the
+  /// context \p VMContext to \p Descriptor .
+  void initializeTable(
+    llvm::GlobalVariable * VMContext,
+    const Table * T,
+    llvm::Constant * Descriptor
+  ) const;
+
+  /// Returns the address of the value of \p G in the context at
+  /// \p VMContext .
+  Address projectGlobalVariable(
+    IRBuilder& Builder, Address VMContext, const GlobalVariable * G
+  ) const;
+
+  /// Sets the value of \p G in the static initializer of the context
+  /// \p VMContext to \p Value .
+  void initializeGlobalVariable(
+    llvm::GlobalVariable * VMContext,
+    const GlobalVariable * G,
+    llvm::Constant * Value
+  ) const;
+};
+
+/// Names the hidden first argument of \p F , and tells LLVM that the
+/// context it points to is only reached through it.
+void addVMContextAttributes(IRGenModule& IGM, llvm::Function * F);
+
+} // namespace irgen
+
+} // namespace w2n
+
+#endif // W2N_IRGEN_IRGENVMCONTEXT_H
@@ -1,7 +1,12 @@
 #include "IRGenerator.h"
 #include "IRGenModule.h"
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Support/MathExtras.h>
+#include <algorithm>
 #include <cassert>
+#include <w2n/AST/SourceFile.h>
 #include <w2n/Basic/Unimplemented.h>
+#include <w2n/Parse/Parser.h>
 
 using namespace w2n;
 using namespace w2n::irgen;
@@ -13,8 +18,12 @@ IRGenerator::IRGenerator(const IRGenOptions& Opts, ModuleDecl& Module) :
 }
 
 void IRGenerator::addGenModule(SourceFile * SF, IRGenModule * IGM) {
-  assert(GenModules.count(SF) == 0);
-  GenModules[SF] = IGM;
+  // In multi-threaded compilation, only the primary IRGenModule is
+  // associated with the source file.
+  if (SF != nullptr) {
+    assert(GenModules.count(SF) == 0);
+    GenModules[SF] = IGM;
+  }
   if (PrimaryIGM == nullptr) {
     PrimaryIGM = IGM;
   }
@@ -107,4 +116,76 @@ void IRGenerator::addLazyFunction(Function * F) {
 
   // Don't update the map if we already have an entry.
   DefaultIGMForFunction.insert(std::make_pair(F, CurrentIGM));
-}
\ No newline at end of file
+}
+std::vector<Function *>
+IRGenerator::collectFunctionsToEmit(SourceFile& SF) {
+  std::vector<Function *> Functions;
+  std::vector<CodeDecl *> Codes;
+  for (Decl * D : SF.getTopLevelDecls()) {
+    auto * M = dyn_cast<ModuleDecl>(D);
+    if (M == nullptr) {
+      continue;
+    }
+    for (Function& F : M->getFunctions()) {
+      if (F.isExternalDeclaration()
+          || !M->isFunctionReachable(F.getIndex())) {
+        continue;
+      }
+      Functions.push_back(&F);
+      if (F.getCode() != nullptr) {
+        Codes.push_back(F.getCode());
+      }
+    }
+  }
+
+  // Every reachable function gets emitted, so decode their bodies up
+  // front, where they can be decoded concurrently.
+  WasmParser::parseFuncDecls(Module.getASTContext(), Codes);
+  return Functions;
+}
+
+static uint64_t getCodeSize(const Function * F) {
+  return F->getCode() != nullptr ? F->getCode()->getSize() : 0;
+}
+
+static uint64_t getCodeSize(ArrayRef<Function *> Functions) {
+  uint64_t Size = 0;
+  for (const auto * F : Functions) {
+    Size += getCodeSize(F);
+  }
+  return Size;
+}
+
+unsigned
+IRGenerator::getPartitionCount(ArrayRef<Function *> Functions) const {
+  uint64_t Count =
+    llvm::divideCeil(getCodeSize(Functions), Opts.IRGenPartitionSize);
+  Count = std::min<uint64_t>(Count, Functions.size());
+  return std::max<uint64_t>(Count, 1);
+}
+
+void IRGenerator::partitionFunctions(ArrayRef<Function *> Functions) {
+  assert(!Queue.empty() && "no IRGenModule to emit the functions");
+  QueuedFunctions.clear();
+  QueuedFunctions.resize(Queue.size());
+
+  uint64_t CodeSize = getCodeSize(Functions);
+  uint64_t Offset = 0;
+  for (auto * F : Functions) {
+    uint64_t Idx = CodeSize == 0 ? 0 : Offset * Queue.size() / CodeSize;
+    QueuedFunctions[std::min<uint64_t>(Idx, Queue.size() - 1)].push_back(F
+    );
+    Offset += getCodeSize(F);
+  }
+}
+
+ArrayRef<Function *>
+IRGenerator::getQueuedFunctions(const IRGenModule * IGM) const {
+  auto It = llvm::find(Queue, IGM);
+  assert(It != Queue.end() && "IRGenModule is not queued");
+  size_t Idx = It - Queue.begin();
+  if (Idx >= QueuedFunctions.size()) {
+    return {};
+  }
+  return QueuedFunctions[Idx];
+}
@@ -68,6 +68,11 @@ private:
 
   std::atomic<int> QueueIndex;
 
+  /// The functions emitted by each IRGenModule of the queue in
+  /// multi-threaded compilation, in the order of the queue.
+  SmallVector<std::vector<Function *>, AssumedMaxQueueCount>
+    QueuedFunctions;
+
 public:
 
   explicit IRGenerator(const IRGenOptions& Opts, ModuleDecl& Module);
@@ -132,7 +137,7 @@ public:
   }
 
   bool hasMultipleIGMs() const {
-    return GenModules.size() >= 2;
+    return Queue.size() >= 2;
   }
 
   llvm::DenseMap<SourceFile *, IRGenModule *>::iterator begin() {
@@ -162,6 +167,28 @@ public:
 
   void addLazyFunction(Function * F);
 
+  /// Returns the functions defined by the modules of \p SF in index
+  /// order, with their bodies decoded.
+  std::vector<Function *> collectFunctionsToEmit(SourceFile& SF);
+
+  /// Returns the number of IRGenModules \p Functions are distributed
+  /// over in multi-threaded compilation, one per
+  /// \c IRGenOptions::IRGenPartitionSize bytes of code.
+  ///
+  /// The number only depends on the size of the code of the functions,
+  /// and not on the number of threads, so that the output is the same
+  /// for any number of threads.
+  unsigned getPartitionCount(ArrayRef<Function *> Functions) const;
+
+  /// Distributes \p Functions over the IRGenModules of the queue.
+  ///
+  /// Each IRGenModule gets a contiguous range of functions with about the
+  /// same size of code.
+  void partitionFunctions(ArrayRef<Function *> Functions);
+
+  /// Returns the functions \p IGM emits in multi-threaded compilation.
+  ArrayRef<Function *> getQueuedFunctions(const IRGenModule * IGM) const;
+
   unsigned getFunctionOrder(Function * F) {
     auto It = FunctionOrder.find(F);
     assert(
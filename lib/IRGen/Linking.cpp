@@ -118,6 +118,12 @@ static IRLinkage getIRLinkage(
         isKnownLocal
       );
 
+    // With multiple LLVM modules, an entity defined by one of them is
+    // only declared by the others.
+    if (!isDefinition
+        && info.shouldAllPrivateDeclsBeVisibleFromOtherFiles())
+      return RESULT(External, Hidden, Default);
+
     auto linkage = info.needLinkerToMergeDuplicateSymbols()
                    ? llvm::GlobalValue::LinkOnceODRLinkage
                    : llvm::GlobalValue::InternalLinkage;
@@ -200,6 +206,15 @@ LinkEntity LinkEntity::forMemory(Memory * M) {
   return Entity;
 }
 
+LinkEntity LinkEntity::forVMContext(ModuleDecl * M) {
+  LinkEntity Entity;
+  Entity.Pointer = M;
+  Entity.SecondaryPointer = nullptr;
+  Entity.Data =
+    W2N_LINK_ENTITY_SET_FIELD(Kind, unsigned(Kind::VMContext));
+  return Entity;
+}
+
 /// Mangle this entity into the given buffer.
 void LinkEntity::mangle(SmallVectorImpl<char>& buffer) const {
   llvm::raw_svector_ostream stream(buffer);
@@ -217,7 +232,12 @@ std::string LinkEntity::mangleAsString() const {
   switch (getKind()) {
   case Kind::Function: w2n_unimplemented();
   case Kind::Table: w2n_unimplemented();
-  case Kind::Memory: w2n_unimplemented();
+  case Kind::Memory: {
+    auto * Mem = getMemory();
+    return (Twine(Mem->getModule()->getName().str()) + Twine(".memory$")
+            + Twine(Mem->getIndex()))
+      .str();
+  }
   case Kind::ReadonlyGlobalVariable:
   case Kind::GlobalVariable: {
     auto * G = getGlobalVariable();
@@ -226,6 +246,9 @@ std::string LinkEntity::mangleAsString() const {
             + Twine(G->getIndex()))
       .str();
   }
+  case Kind::VMContext:
+    return (Twine(getWasmModule()->getName().str()) + Twine(".vmctx"))
+      .str();
   }
   llvm_unreachable("bad entity kind!");
 }
@@ -234,11 +257,16 @@ ASTLinkage LinkEntity::getLinkage(ForDefinition_t forDefinition) const {
   switch (getKind()) {
   case Kind::Function: w2n_unimplemented();
   case Kind::Table: w2n_unimplemented();
-  case Kind::Memory: w2n_unimplemented();
+  case Kind::Memory:
+    // FIXME: Check if the memory is exported.
+    return ASTLinkage::Internal;
   case Kind::ReadonlyGlobalVariable:
   case Kind::GlobalVariable:
     // FIXME: Check if the global variable is exported.
     return w2n_proto_implemented([&] { return ASTLinkage::Internal; });
+  case Kind::VMContext:
+    // FIXME: Expose the context to the embedder with the exports.
+    return ASTLinkage::Internal;
   }
   llvm_unreachable("bad link entity kind");
 }
@@ -246,11 +274,12 @@ ASTLinkage LinkEntity::getLinkage(ForDefinition_t forDefinition) const {
 DeclContext * LinkEntity::getDeclContextForEmission() const {
   switch (getKind()) {
   case Kind::Function: return getFunction()->getDeclContext();
-  case Kind::Table:
-  case Kind::Memory: w2n_unimplemented(); break;
+  case Kind::Table: w2n_unimplemented(); break;
+  case Kind::Memory: return getMemory()->getDecl()->getDeclContext();
   case Kind::GlobalVariable:
   case Kind::ReadonlyGlobalVariable:
     return getGlobalVariable()->getDecl()->getDeclContext();
+  case Kind::VMContext: return getWasmModule();
   }
 }
 
@@ -0,0 +1,502 @@
+#include "MemoryBoundsChecks.h"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#include <llvm/Analysis/ScalarEvolutionExpressions.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/PatternMatch.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
+#include <llvm/Transforms/Utils/Local.h>
+#include <llvm/Transforms/Utils/ScalarEvolutionExpander.h>
+#include <algorithm>
+
+using namespace w2n;
+using namespace w2n::irgen;
+using namespace llvm;
+using namespace llvm::PatternMatch;
+
+namespace {
+
+/// A bounds check emitted by \c IRGenFunction::emitMemoryAddress .
+struct BoundsCheck {
+  BranchInst * Branch;
+
+  /// The index the access is relative to, without its constant
+  /// offsets.
+  Value * Index;
+
+  /// The distance between \c Index and the end of the access.
+  uint64_t End;
+
+  LoadInst * Size;
+
+  /// The address the size of the memory is loaded from.
+  Value * SizeAddr;
+
+  BasicBlock * getBlock() const {
+    return Branch->getParent();
+  }
+
+  BasicBlock * getContinuation() const {
+    return Branch->getSuccessor(1);
+  }
+
+  bool isRemoved() const {
+    return isa<Constant>(Branch->getCondition());
+  }
+
+  bool isOnSameIndex(const BoundsCheck& Other) const {
+    return Index == Other.Index && SizeAddr == Other.SizeAddr;
+  }
+};
+
+bool isTrapBlock(BasicBlock * BB) {
+  auto * Trap = dyn_cast<IntrinsicInst>(BB->getFirstNonPHIOrDbg());
+  return Trap != nullptr && Trap->getIntrinsicID() == Intrinsic::trap
+      && isa_and_nonnull<UnreachableInst>(
+           Trap->getNextNonDebugInstruction()
+      );
+}
+
+Optional<BoundsCheck> matchBoundsCheck(BranchInst * Branch) {
+  if (!Branch->isConditional() || !isTrapBlock(Branch->getSuccessor(0))) {
+    return None;
+  }
+
+  ICmpInst::Predicate Pred;
+  Value * End;
+  Value * Size;
+  if (!match(
+        Branch->getCondition(), m_ICmp(Pred, m_Value(End), m_Value(Size))
+      )) {
+    return None;
+  }
+  if (Pred == ICmpInst::ICMP_ULT) {
+    std::swap(End, Size);
+  } else if (Pred != ICmpInst::ICMP_UGT) {
+    return None;
+  }
+
+  auto * SizeLoad = dyn_cast<LoadInst>(Size);
+  if (SizeLoad == nullptr || !SizeLoad->isSimple()
+      || !SizeLoad->getType()->isIntegerTy(64)) {
+    return None;
+  }
+
+  // Both the static offset and the size of an access fit in 32 bits.
+  uint64_t Distance = 0;
+  Value * Index = End;
+  Value * Base;
+  const APInt * Offset;
+  while (match(Index, m_NUWAdd(m_Value(Base), m_APInt(Offset)))) {
+    if (Offset->getActiveBits() > 32) {
+      return None;
+    }
+    Distance += Offset->getZExtValue();
+    Index = Base;
+  }
+  if (Distance == 0) {
+    return None;
+  }
+
+  return BoundsCheck{
+    Branch, Index, Distance, SizeLoad, SizeLoad->getPointerOperand()};
+}
+
+/// Returns \c true if moving a trap over \p I could be observed.
+bool isObservable(const Instruction& I) {
+  return I.mayHaveSideEffects()
+      || !isGuaranteedToTransferExecutionToSuccessor(&I);
+}
+
+class BoundsCheckOptimizer {
+  Function& F;
+
+  DominatorTree& DT;
+
+  LoopInfo& LI;
+
+  ScalarEvolution& SE;
+
+  SmallVector<BoundsCheck, 16> Checks;
+
+  DenseMap<BranchInst *, unsigned> ChecksByBranch;
+
+  /// The conditions of the removed checks, deleted once all the checks
+  /// have been visited.
+  SmallVector<WeakTrackingVH, 16> DeadConditions;
+
+  bool Changed = false;
+
+  void addCheck(const BoundsCheck& Check) {
+    ChecksByBranch[Check.Branch] = Checks.size();
+    Checks.push_back(Check);
+    Changed = true;
+  }
+
+  void removeCheck(BoundsCheck& Check) {
+    DeadConditions.push_back(Check.Branch->getCondition());
+    Check.Branch->setCondition(ConstantInt::getFalse(F.getContext()));
+    Changed = true;
+  }
+
+  /// Makes \p Check compare \c Index + \p End with the size of the
+  /// memory instead.
+  void widenCheck(BoundsCheck& Check, uint64_t End) {
+    IRBuilder<> Builder(Check.Branch);
+    Value * AccessEnd = Builder.CreateAdd(
+      Check.Index,
+      ConstantInt::get(Check.Index->getType(), End),
+      "",
+      /*HasNUW*/ true,
+      /*HasNSW*/ true
+    );
+    DeadConditions.push_back(Check.Branch->getCondition());
+    Check.Branch->setCondition(
+      Builder.CreateICmpUGT(AccessEnd, Check.Size)
+    );
+    Check.End = End;
+    Changed = true;
+  }
+
+  /// Follows the code executed unconditionally after the start of
+  /// \p BB , through the continuations of bounds checks, and calls
+  /// \p Visit with each check on the way until \p Visit returns \c true
+  /// or something observable is reached.
+  ///
+  /// The walk stays in \p L when it is given, whose header is the only
+  /// block allowed to be entered from more than one predecessor.
+  void walkStraightLine(
+    BasicBlock * BB, Loop * L, function_ref<bool(BoundsCheck&)> Visit
+  ) {
+    SmallPtrSet<BasicBlock *, 8> Visited;
+    while (Visited.insert(BB).second) {
+      if (L != nullptr && !L->contains(BB)) {
+        return;
+      }
+      if ((L == nullptr || BB != L->getHeader())
+          && BB->getSinglePredecessor() == nullptr) {
+        return;
+      }
+      for (Instruction& I : *BB) {
+        if (I.isTerminator()) {
+          break;
+        }
+        if (isObservable(I)) {
+          return;
+        }
+      }
+      auto * Branch = dyn_cast<BranchInst>(BB->getTerminator());
+      if (Branch == nullptr) {
+        return;
+      }
+      if (Branch->isUnconditional()) {
+        BB = Branch->getSuccessor(0);
+        continue;
+      }
+      auto It = ChecksByBranch.find(Branch);
+      if (It == ChecksByBranch.end()) {
+        return;
+      }
+      BoundsCheck& Check = Checks[It->second];
+      if (Visit(Check)) {
+        return;
+      }
+      BB = Check.getContinuation();
+    }
+  }
+
+  /// Returns \c true if each iteration of \p L which does not trap runs
+  /// to its latch.
+  bool runsToLatch(Loop * L) {
+    BasicBlock * Latch = L->getLoopLatch();
+    if (Latch == nullptr) {
+      return false;
+    }
+    SmallVector<BasicBlock *, 8> ExitingBlocks;
+    L->getExitingBlocks(ExitingBlocks);
+    for (BasicBlock * Exiting : ExitingBlocks) {
+      if (Exiting == Latch) {
+        continue;
+      }
+      for (BasicBlock * Succ : successors(Exiting)) {
+        if (!L->contains(Succ) && !isTrapBlock(Succ)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /// Expands the value the index of \p Check reaches on the last
+  /// iteration of \p L in its preheader, if the index increases with
+  /// each iteration.
+  Value * expandLastIndex(Loop * L, const BoundsCheck& Check) {
+    const SCEV * Index = SE.getSCEV(Check.Index);
+    bool IsZeroExtended = false;
+    if (auto * ZExt = dyn_cast<SCEVZeroExtendExpr>(Index)) {
+      Index = ZExt->getOperand();
+      IsZeroExtended = true;
+    }
+
+    // Without wrapping, the index is the largest on the last iteration.
+    auto * AddRec = dyn_cast<SCEVAddRecExpr>(Index);
+    if (AddRec == nullptr || AddRec->getLoop() != L
+        || !AddRec->isAffine() || !AddRec->hasNoUnsignedWrap()) {
+      return nullptr;
+    }
+    auto * Step = dyn_cast<SCEVConstant>(AddRec->getStepRecurrence(SE));
+    if (Step == nullptr || !Step->getAPInt().isStrictlyPositive()) {
+      return nullptr;
+    }
+
+    const SCEV * ExitCount = SE.getExitCount(L, L->getLoopLatch());
+    if (isa<SCEVCouldNotCompute>(ExitCount)) {
+      return nullptr;
+    }
+    const SCEV * Last = AddRec->evaluateAtIteration(ExitCount, SE);
+    if (IsZeroExtended) {
+      Last = SE.getZeroExtendExpr(Last, Check.Index->getType());
+    }
+
+    // A division could only be expanded where its divisor is known not
+    // to be zero.
+    if (!SE.isLoopInvariant(Last, L)
+        || SCEVExprContains(Last, [](const SCEV * S) {
+             return isa<SCEVUDivExpr>(S);
+           })) {
+      return nullptr;
+    }
+
+    SCEVExpander Expander(SE, F.getParent()->getDataLayout(), "memory");
+    return Expander.expandCodeFor(
+      Last, Check.Index->getType(), L->getLoopPreheader()->getTerminator()
+    );
+  }
+
+  /// Checks \c Index + \p End against the memory \p Like checks at the
+  /// end of the preheader of \p L .
+  BoundsCheck emitCheckInPreheader(
+    Loop * L, const BoundsCheck& Like, Value * Index, uint64_t End
+  ) {
+    BasicBlock * Preheader = L->getLoopPreheader();
+    LLVMContext& Context = F.getContext();
+
+    BasicBlock * TrapBB = BasicBlock::Create(Context, "memory.trap", &F);
+    IRBuilder<> TrapBuilder(TrapBB);
+    TrapBuilder.CreateIntrinsic(Intrinsic::trap, {}, {});
+    TrapBuilder.CreateUnreachable();
+
+    BasicBlock * ContBB = SplitBlock(
+      Preheader,
+      Preheader->getTerminator(),
+      &DT,
+      &LI,
+      nullptr,
+      "memory.inbounds"
+    );
+    Preheader->getTerminator()->eraseFromParent();
+    DT.addNewBlock(TrapBB, Preheader);
+
+    IRBuilder<> Builder(Preheader);
+    LoadInst * Size = Builder.CreateAlignedLoad(
+      Like.Size->getType(),
+      Like.SizeAddr,
+      Like.Size->getAlign(),
+      "memory.size"
+    );
+    Value * AccessEnd = Builder.CreateAdd(
+      Index,
+      ConstantInt::get(Index->getType(), End),
+      "",
+      /*HasNUW*/ true,
+      /*HasNSW*/ true
+    );
+    BranchInst * Branch = Builder.CreateCondBr(
+      Builder.CreateICmpUGT(AccessEnd, Size),
+      TrapBB,
+      ContBB,
+      Like.Branch->getMetadata(LLVMContext::MD_prof)
+    );
+    return BoundsCheck{Branch, Index, End, Size, Like.SizeAddr};
+  }
+
+  /// Moves the checks of \p L which can be performed once before the
+  /// loop into its preheader.
+  void hoistChecks(Loop * L) {
+    if (L->getLoopPreheader() == nullptr) {
+      return;
+    }
+
+    // The checks executed on the first iteration before anything
+    // observable can trap before the loop instead.
+    SmallPtrSet<BranchInst *, 8> RunsFirst;
+    walkStraightLine(L->getHeader(), L, [&](BoundsCheck& Check) {
+      RunsFirst.insert(Check.Branch);
+      return false;
+    });
+
+    // In an innermost loop without side effects, a check which every
+    // iteration executes can trap before the loop too.
+    bool IsObservable = any_of(L->blocks(), [](BasicBlock * BB) {
+      return any_of(*BB, isObservable);
+    });
+    bool CanTrapEarly =
+      !IsObservable && L->isInnermost() && runsToLatch(L);
+
+    unsigned NumChecks = Checks.size();
+    for (unsigned I = 0; I < NumChecks; ++I) {
+      BoundsCheck Check = Checks[I];
+      if (Check.isRemoved() || !L->contains(Check.getBlock())
+          || !L->isLoopInvariant(Check.SizeAddr)) {
+        continue;
+      }
+      bool RunsEachIteration =
+        CanTrapEarly && DT.dominates(Check.getBlock(), L->getLoopLatch());
+
+      if (L->isLoopInvariant(Check.Index)) {
+        // The check in the loop is dominated by the hoisted one, and is
+        // removed with the other dominated checks.
+        if (RunsFirst.count(Check.Branch) != 0 || RunsEachIteration) {
+          addCheck(
+            emitCheckInPreheader(L, Check, Check.Index, Check.End)
+          );
+        }
+        continue;
+      }
+
+      // Stores in the loop would have to be kept from happening before
+      // the trap, which needs a copy of the loop with the checks.
+      if (!RunsEachIteration) {
+        continue;
+      }
+      if (Value * Last = expandLastIndex(L, Check)) {
+        addCheck(emitCheckInPreheader(L, Check, Last, Check.End));
+        removeCheck(Checks[I]);
+      }
+    }
+  }
+
+  /// Widens each check to cover the checks on the same index executed
+  /// right after it, and removes the latter.
+  void mergeChecks() {
+    for (BoundsCheck& Check : Checks) {
+      if (Check.isRemoved()) {
+        continue;
+      }
+      uint64_t End = Check.End;
+      SmallVector<BoundsCheck *, 4> Covered;
+      walkStraightLine(
+        Check.getContinuation(), nullptr, [&](BoundsCheck& Other) {
+          if (&Other != &Check && !Other.isRemoved()
+              && Other.isOnSameIndex(Check)) {
+            End = std::max(End, Other.End);
+            Covered.push_back(&Other);
+          }
+          return false;
+        }
+      );
+      if (End > Check.End) {
+        widenCheck(Check, End);
+      }
+      for (BoundsCheck * Other : Covered) {
+        removeCheck(*Other);
+      }
+    }
+  }
+
+  /// Removes the checks dominated by a check on the same index reaching
+  /// at least as far, since a memory never shrinks.
+  void removeDominatedChecks() {
+    DenseMap<std::pair<Value *, Value *>, SmallVector<BoundsCheck *, 4>>
+      ChecksByIndex;
+    for (BoundsCheck& Check : Checks) {
+      if (!Check.isRemoved()) {
+        ChecksByIndex[{Check.Index, Check.SizeAddr}].push_back(&Check);
+      }
+    }
+
+    for (auto& Entry : ChecksByIndex) {
+      auto& SameIndex = Entry.second;
+      for (BoundsCheck * Check : SameIndex) {
+        for (BoundsCheck * Other : SameIndex) {
+          if (Other == Check || Other->isRemoved()
+              || Other->End < Check->End) {
+            continue;
+          }
+          BasicBlockEdge InBounds(
+            Other->getBlock(), Other->getContinuation()
+          );
+          if (DT.dominates(InBounds, Check->getBlock())) {
+            removeCheck(*Check);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+public:
+
+  BoundsCheckOptimizer(
+    Function& F,
+    SmallVectorImpl<BoundsCheck>&& Checks,
+    DominatorTree& DT,
+    LoopInfo& LI,
+    ScalarEvolution& SE
+  )
+    : F(F), DT(DT), LI(LI), SE(SE), Checks(std::move(Checks)) {
+    for (unsigned I = 0; I < this->Checks.size(); ++I) {
+      ChecksByBranch[this->Checks[I].Branch] = I;
+    }
+  }
+
+  bool run() {
+    // Inner loops first, so that their hoisted checks can be hoisted
+    // out of the outer loops.
+    for (Loop * L : reverse(LI.getLoopsInPreorder())) {
+      hoistChecks(L);
+    }
+    mergeChecks();
+    removeDominatedChecks();
+    RecursivelyDeleteTriviallyDeadInstructionsPermissive(DeadConditions);
+    return Changed;
+  }
+};
+
+} // namespace
+
+PreservedAnalyses MemoryBoundsCheckOptPass::run(
+  Function& F, FunctionAnalysisManager& AM
+) {
+  SmallVector<BoundsCheck, 16> Checks;
+  for (BasicBlock& BB : F) {
+    if (auto * Branch = dyn_cast<BranchInst>(BB.getTerminator())) {
+      if (auto Check = matchBoundsCheck(Branch)) {
+        Checks.push_back(*Check);
+      }
+    }
+  }
+  if (Checks.empty()) {
+    return PreservedAnalyses::all();
+  }
+
+  BoundsCheckOptimizer Optimizer(
+    F,
+    std::move(Checks),
+    AM.getResult<DominatorTreeAnalysis>(F),
+    AM.getResult<LoopAnalysis>(F),
+    AM.getResult<ScalarEvolutionAnalysis>(F)
+  );
+  if (!Optimizer.run()) {
+    return PreservedAnalyses::all();
+  }
+  return PreservedAnalyses::none();
+}
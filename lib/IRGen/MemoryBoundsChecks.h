@@ -0,0 +1,47 @@
+#ifndef W2N_IRGEN_MEMORYBOUNDSCHECKS_H
+#define W2N_IRGEN_MEMORYBOUNDSCHECKS_H
+
+#include <llvm/IR/PassManager.h>
+
+namespace w2n {
+
+namespace irgen {
+
+/**
+ * @brief Removes the explicit memory bounds checks which other checks
+ * already cover.
+ *
+ * IRGen checks each memory access on its own:
+ *
+ *   %end = add nuw nsw i64 %index, <offset + size>
+ *   %memory.size = load i64, ptr <size of the memory>
+ *   %oob = icmp ugt i64 %end, %memory.size
+ *   br i1 %oob, label %memory.trap, label %memory.inbounds
+ *
+ * The size of a memory never shrinks, so an access is in bounds once
+ * an access on the same index reaching at least as far has been
+ * checked. The pass:
+ *
+ * - widens the first of the checks on an index executed in a row to
+ *   the furthest of them and drops the others;
+ * - hoists the checks on loop-invariant indices executed on the first
+ *   iteration of a loop into its preheader;
+ * - checks the last value of an index increasing with a loop in its
+ *   preheader instead of every iteration, when the loop has no side
+ *   effects which could be observed before the trap;
+ * - drops the checks dominated by a check on the same index reaching
+ *   at least as far.
+ */
+class MemoryBoundsCheckOptPass
+  : public llvm::PassInfoMixin<MemoryBoundsCheckOptPass> {
+public:
+
+  llvm::PreservedAnalyses
+  run(llvm::Function& F, llvm::FunctionAnalysisManager& AM);
+};
+
+} // namespace irgen
+
+} // namespace w2n
+
+#endif // W2N_IRGEN_MEMORYBOUNDSCHECKS_H
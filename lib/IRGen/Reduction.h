@@ -21,8 +21,11 @@
 #define IRGEN_REDUCTION_H
 
 #include "Address.h"
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
 #include <llvm/Support/ErrorHandling.h>
 #include <cassert>
 #include <cstddef>
@@ -45,60 +48,181 @@ enum class ExecutionStackRecordKind {
   Label,
 };
 
-/// Represents an active structured control instruction.
+enum class LabelKind : uint8_t {
+  Function,
+  Block,
+  Loop,
+  If,
+};
+
+/// Represents an active structured control instruction, or the body of
+/// the function.
+///
+/// Locals and operands are SSA values, so a label is where the values
+/// flowing along different edges are merged: at the header of a loop,
+/// where branches to the loop jump back to, or at the continuation after
+/// the end of a block, an if or the function body.
 ///
 class Label {
+public:
+
+  /// The values flowing into a continuation along the edges from a
+  /// block: the operands carried to the label, followed by the locals.
+  struct Incoming {
+    llvm::BasicBlock * From;
+
+    /// The number of edges from \c From , which a \c switch lowered from
+    /// \c br_table may have more than one of.
+    unsigned EdgeCount;
+
+    llvm::SmallVector<llvm::Value *, 8> Values;
+  };
+
 private:
 
-  llvm::IRBuilder<> * Builder;
+  LabelKind Kind;
 
-  llvm::BasicBlock * EnterBB;
+  llvm::SmallVector<llvm::Type *, 2> ParamTypes;
 
-  /// Label'c construction guarantees \c ExitBB. Sets the Builder's insert
-  /// point to \c ExitBB while deconstructing \c Configuration.
-  llvm::BasicBlock * ExitBB;
+  llvm::SmallVector<llvm::Type *, 2> ResultTypes;
 
-  llvm::DILabel * DebugLabel;
+  /// The block that branches to the label jump to. The header of a loop,
+  /// or the continuation otherwise, which is created on the first branch.
+  llvm::BasicBlock * BranchBB;
+
+  /// The phis at the header of a loop, the params followed by the locals.
+  llvm::SmallVector<llvm::PHINode *, 8> Phis;
+
+  /// The edges into the continuation of a block, an if or the function.
+  llvm::SmallVector<Incoming, 2> Incomings;
+
+  /// The false arm of an if.
+  llvm::BasicBlock * ElseBB;
+
+  /// The params followed by the locals the false arm of an if starts
+  /// with.
+  llvm::SmallVector<llvm::Value *, 8> ElseValues;
+
+  bool HasElse;
 
 public:
 
-  explicit Label(
-    llvm::IRBuilder<> * Builder,
-    llvm::BasicBlock * EnterBB,
-    llvm::DILabel * DebugLabel
-  );
+  Label(
+    LabelKind Kind,
+    llvm::ArrayRef<llvm::Type *> ParamTypes,
+    llvm::ArrayRef<llvm::Type *> ResultTypes
+  ) :
+    Kind(Kind),
+    ParamTypes(ParamTypes.begin(), ParamTypes.end()),
+    ResultTypes(ResultTypes.begin(), ResultTypes.end()),
+    BranchBB(nullptr),
+    ElseBB(nullptr),
+    HasElse(false) {
+  }
 
   // cannot copy, only can move.
   Label(const Label&) = delete;
   Label& operator=(const Label&) = delete;
 
-  Label(Label&& X) {
-    *this = std::move(X);
+  Label(Label&& X) = default;
+  Label& operator=(Label&& X) = default;
+
+  LabelKind getKind() const {
+    return Kind;
   }
 
-  Label& operator=(Label&& X) {
-    this->Builder = X.Builder;
-    this->EnterBB = X.EnterBB;
-    this->ExitBB = X.ExitBB;
-    this->DebugLabel = X.DebugLabel;
-    X.Builder = nullptr;
-    X.EnterBB = nullptr;
-    X.ExitBB = nullptr;
-    X.DebugLabel = nullptr;
-    return *this;
+  bool isLoop() const {
+    return Kind == LabelKind::Loop;
+  }
+
+  llvm::ArrayRef<llvm::Type *> getParamTypes() const {
+    return ParamTypes;
+  }
+
+  llvm::ArrayRef<llvm::Type *> getResultTypes() const {
+    return ResultTypes;
+  }
+
+  /// Returns the types of the operands a branch to the label carries.
+  llvm::ArrayRef<llvm::Type *> getBranchTypes() const {
+    return isLoop() ? getParamTypes() : getResultTypes();
+  }
+
+  llvm::BasicBlock * getBranchBB() const {
+    return BranchBB;
+  }
+
+  void setBranchBB(llvm::BasicBlock * BB) {
+    BranchBB = BB;
+  }
+
+  llvm::SmallVectorImpl<llvm::PHINode *>& getPhis() {
+    return Phis;
+  }
+
+  llvm::ArrayRef<llvm::PHINode *> getPhis() const {
+    return Phis;
+  }
+
+  llvm::ArrayRef<Incoming> getIncomings() const {
+    return Incomings;
   }
 
-  llvm::BasicBlock * getEnterBB();
+  void addIncoming(
+    llvm::BasicBlock * From,
+    unsigned EdgeCount,
+    llvm::ArrayRef<llvm::Value *> Values
+  ) {
+    Incomings.push_back(
+      {From, EdgeCount, {Values.begin(), Values.end()}}
+    );
+  }
 
-  const llvm::BasicBlock * getEnterBB() const;
+  llvm::BasicBlock * getElseBB() const {
+    return ElseBB;
+  }
 
-  llvm::BasicBlock * getExitBB();
+  llvm::ArrayRef<llvm::Value *> getElseValues() const {
+    return ElseValues;
+  }
 
-  const llvm::BasicBlock * getExitBB() const;
+  void setElse(
+    llvm::BasicBlock * BB, llvm::ArrayRef<llvm::Value *> Values
+  ) {
+    ElseBB = BB;
+    ElseValues.assign(Values.begin(), Values.end());
+  }
+
+  bool hasElse() const {
+    return HasElse;
+  }
+
+  void setHasElse() {
+    HasElse = true;
+  }
 
-  llvm::DILabel * getDebugLabel();
+  /// Replaces the values recorded by the label with the values they map
+  /// to in \p Replacements .
+  void replaceValues(
+    const llvm::DenseMap<llvm::Value *, llvm::Value *>& Replacements
+  ) {
+    for (auto& EachIncoming : Incomings) {
+      replaceValues(EachIncoming.Values, Replacements);
+    }
+    replaceValues(ElseValues, Replacements);
+  }
 
-  const llvm::DILabel * getDebugLabel() const;
+  static void replaceValues(
+    llvm::MutableArrayRef<llvm::Value *> Values,
+    const llvm::DenseMap<llvm::Value *, llvm::Value *>& Replacements
+  ) {
+    for (auto *& Each : Values) {
+      auto Iter = Replacements.find(Each);
+      if (Iter != Replacements.end()) {
+        Each = Iter->second;
+      }
+    }
+  }
 
   static ExecutionStackRecordKind kindof() {
     return ExecutionStackRecordKind::Label;
@@ -144,6 +268,15 @@ public:
     return Val == nullptr;
   }
 
+  void replaceValues(
+    const llvm::DenseMap<llvm::Value *, llvm::Value *>& Replacements
+  ) {
+    auto Iter = Replacements.find(Val);
+    if (Iter != Replacements.end()) {
+      Val = Iter->second;
+    }
+  }
+
   static ExecutionStackRecordKind kindof() {
     return ExecutionStackRecordKind::Operand;
   }
@@ -151,23 +284,23 @@ public:
 
 /// Represents the active record of a function call.
 ///
+/// The locals, including the params, are tracked as the SSA values they
+/// currently hold rather than as stack slots.
+///
 class Frame {
 private:
 
   w2n::Function * Func;
 
-  std::vector<Address> Locals;
-
-  Address Return;
+  std::vector<llvm::Value *> Locals;
 
 public:
 
   explicit Frame(
-    w2n::Function * Func, std::vector<Address>&& Locals, Address&& Returns
+    w2n::Function * Func, std::vector<llvm::Value *>&& Locals
   ) :
     Func(Func),
-    Locals(std::move(Locals)),
-    Return(std::move(Returns)) {
+    Locals(std::move(Locals)) {
   }
 
   // cannot copy, only can move.
@@ -176,8 +309,7 @@ public:
 
   Frame(Frame&& X) :
     Func(std::move(X.Func)),
-    Locals(std::move(X.Locals)),
-    Return(std::move(X.Return)) {
+    Locals(std::move(X.Locals)) {
     X.Func = nullptr;
   }
 
@@ -185,7 +317,6 @@ public:
     this->Func = X.Func;
     X.Func = nullptr;
     this->Locals = std::move(X.Locals);
-    this->Return = std::move(X.Return);
     return *this;
   }
 
@@ -197,20 +328,20 @@ public:
     return Func;
   }
 
-  std::vector<Address>& getLocals() {
+  std::vector<llvm::Value *>& getLocals() {
     return Locals;
   }
 
-  const std::vector<Address>& getLocals() const {
+  const std::vector<llvm::Value *>& getLocals() const {
     return Locals;
   }
 
-  Address& getReturn() {
-    return Return;
+  llvm::Value * getLocal(uint32_t Index) const {
+    return Locals.at(Index);
   }
 
-  const Address& getReturn() const {
-    return Return;
+  void setLocal(uint32_t Index, llvm::Value * Val) {
+    Locals.at(Index) = Val;
   }
 
   bool hasNoReturn() const {
@@ -222,6 +353,12 @@ public:
       .empty();
   }
 
+  void replaceValues(
+    const llvm::DenseMap<llvm::Value *, llvm::Value *>& Replacements
+  ) {
+    Label::replaceValues(Locals, Replacements);
+  }
+
   static ExecutionStackRecordKind kindof() {
     return ExecutionStackRecordKind::Frame;
   }
@@ -382,12 +519,9 @@ public:
   Configuration(
     ASTContext * Context,
     w2n::Function * Func,
-    std::vector<Address>&& Locals,
-    Address&& Return
+    std::vector<llvm::Value *>&& Locals
   ) :
-    Configuration(
-      Context, Frame(Func, std::move(Locals), std::move(Return))
-    ) {
+    Configuration(Context, Frame(Func, std::move(Locals))) {
   }
 
   ~Configuration() {
@@ -470,27 +604,44 @@ public:
     return Top->getKind();
   }
 
+  /// Pops the \p K topmost contents, which must all be \c ContentTy ,
+  /// and appends them to \p V from the bottommost one.
   template <typename ContentTy>
-  void pop(llvm::SmallVectorImpl<ContentTy>& V, uint32_t K) {
-    bool ShouldStop = false;
-    while (ShouldStop) {
-      Node * Popped = Top;
-      Top = Top->getPrevious();
-      if (Popped->getKind() == ContentTy::kindof()) {
-        K -= 1;
-        V.emplace_back(&Popped->get<ContentTy>());
-        if (K == 0) {
-          ShouldStop = true;
-        }
-      }
-    };
+  void pop(llvm::SmallVectorImpl<ContentTy *>& V, uint32_t K) {
+    size_t Start = V.size();
+    V.resize(Start + K);
+    for (uint32_t I = K; I > 0; I--) {
+      V[Start + I - 1] = pop<ContentTy>();
+    }
   }
 
-  template <typename ContentTy>
-  std::vector<ContentTy *> pop(uint32_t K) {
-    std::vector<ContentTy *> PoppedContents;
-    pop(PoppedContents, K);
-    return PoppedContents;
+  /// Pops the operands above the topmost label or frame.
+  void popOperands() {
+    while (topKind() == ExecutionStackRecordKind::Operand) {
+      pop();
+    }
+  }
+
+  /// Replaces the values recorded in the configuration with the values
+  /// they map to in \p Replacements .
+  void replaceValues(
+    const llvm::DenseMap<llvm::Value *, llvm::Value *>& Replacements
+  ) {
+    for (Node * Each = Top; Each != nullptr; Each = Each->getPrevious()) {
+      switch (Each->getKind()) {
+      case ExecutionStackRecordKind::Operand:
+        Each->get<Operand>().replaceValues(Replacements);
+        break;
+      case ExecutionStackRecordKind::Frame:
+        Each->get<Frame>().replaceValues(Replacements);
+        break;
+      case ExecutionStackRecordKind::Label:
+        Each->get<Label>().replaceValues(Replacements);
+        break;
+      case ExecutionStackRecordKind::Unspecified:
+        llvm_unreachable("unspecified node kind.");
+      }
+    }
   }
 
   template <typename ContentTy>
@@ -33,34 +33,6 @@ struct StructTyKey {
   bool IsTombstone = false;
 };
 
-struct FuncTyKey {
-  std::vector<llvm::Type *> ArgumentTypes;
-
-  std::vector<llvm::Type *> ResultTypes;
-
-  struct {
-    union {
-      size_t ArgumentEltCount;
-      bool IsEmpty;
-    };
-
-    union {
-      size_t ResultEltCount;
-      bool IsTombstone;
-    };
-  };
-
-  FuncTyKey(
-    std::vector<llvm::Type *> ArgumentTypes,
-    std::vector<llvm::Type *> ResultTypes
-  ) :
-    ArgumentTypes(ArgumentTypes),
-    ResultTypes(ResultTypes),
-    ArgumentEltCount(ArgumentTypes.size()),
-    ResultEltCount(ResultTypes.size()) {
-  }
-};
-
 } // namespace w2n::irgen
 
 namespace llvm {
@@ -112,39 +84,6 @@ struct DenseMapInfo<w2n::irgen::StructTyKey> {
         && LHS.IsTombstone == RHS.IsTombstone;
   }
 };
-
-template <>
-struct DenseMapInfo<w2n::irgen::FuncTyKey> {
-  using FuncTyKey = w2n::irgen::FuncTyKey;
-
-  static inline FuncTyKey getEmptyKey() {
-    auto Key = FuncTyKey({}, {});
-    Key.IsEmpty = true;
-    return Key;
-  }
-
-  static inline FuncTyKey getTombstoneKey() {
-    auto Key = FuncTyKey({}, {});
-    Key.IsTombstone = true;
-    return Key;
-  }
-
-  static unsigned getHashValue(const FuncTyKey& Key) {
-    return hash_combine(
-      Key.ArgumentTypes,
-      Key.ResultTypes,
-      Key.ArgumentEltCount,
-      Key.ResultEltCount
-    );
-  }
-
-  static bool isEqual(const FuncTyKey& LHS, const FuncTyKey& RHS) {
-    return LHS.ArgumentTypes == RHS.ArgumentTypes
-        && LHS.ResultTypes == RHS.ResultTypes
-        && LHS.ArgumentEltCount == RHS.ArgumentEltCount
-        && LHS.ResultEltCount == RHS.ResultEltCount;
-  }
-};
 } // namespace llvm
 
 #endif // IRGEN_TYPELOWERING_H
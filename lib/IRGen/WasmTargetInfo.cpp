@@ -78,6 +78,12 @@ static void configureX86_64(
     target.LeastValidPointerValue =
       SWIFT_ABI_DARWIN_X86_64_LEAST_VALID_POINTER;
   }
+
+  // Linux leaves GS to user space, and the X86 backend lowers accesses
+  // to address space 256 to GS-relative ones.
+  if (triple.isOSLinux()) {
+    target.MemorySegmentAddressSpace = 256;
+  }
 }
 
 /// Configures target-specific information for 32-bit x86 platforms.
@@ -74,6 +74,11 @@ public:
   /// The value stored in a Builtin.once predicate to indicate that an
   /// initialization has already happened, if known.
   Optional<int64_t> OnceDonePredicateValue = None;
+
+  /// The address space whose addresses are relative to the segment
+  /// register the runtime can hold the base of a memory in, if any. See
+  /// \c IRGenMemoryBase::Segment .
+  Optional<unsigned> MemorySegmentAddressSpace = None;
 };
 
 } // namespace irgen
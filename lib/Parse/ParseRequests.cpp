@@ -83,6 +83,34 @@ void ParseWasmFileRequest::cacheResult(WasmFileParsingResult Result
   // FIXME: verify(*SF);
 }
 
+//----------------------------------------------------------------------------//
+// ParseFuncBodyRequest computation.
+//----------------------------------------------------------------------------//
+
+FuncDecl *
+ParseFuncBodyRequest::evaluate(Evaluator& Eval, CodeDecl * Code) const {
+  assert(Code);
+  auto& Ctx = Code->getASTContext();
+  if (Ctx.Stats != nullptr) {
+    ++Ctx.Stats->getFrontendCounters().NumFunctionsParsed;
+  }
+  return WasmParser::parseFuncDecl(Ctx, Code->getBody());
+}
+
+Optional<FuncDecl *> ParseFuncBodyRequest::getCachedResult() const {
+  auto * Code = std::get<0>(getStorage());
+  if (!Code->isParsed()) {
+    return None;
+  }
+
+  return Code->Func;
+}
+
+void ParseFuncBodyRequest::cacheResult(FuncDecl * Result) const {
+  auto * Code = std::get<0>(getStorage());
+  Code->Func = Result;
+}
+
 //----------------------------------------------------------------------------//
 // Parse Request Functions Registration
 //----------------------------------------------------------------------------//
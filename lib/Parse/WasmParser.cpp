@@ -7,16 +7,15 @@
 #include <llvm/ADT/Optional.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/BinaryFormat/Wasm.h>
-#include <llvm/Object/ObjectFile.h>
-#include <llvm/Object/SymbolicFile.h>
-#include <llvm/Object/Wasm.h>
-#include <llvm/Support/Error.h>
+#include <llvm/Support/Endian.h>
 #include <llvm/Support/ErrorHandling.h>
 #include <llvm/Support/LEB128.h>
-#include <llvm/Support/MemoryBufferRef.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -26,9 +25,11 @@
 #include <w2n/AST/ASTContext.h>
 #include <w2n/AST/Builtins.h>
 #include <w2n/AST/Decl.h>
+#include <w2n/AST/DiagnosticsCommon.h>
 #include <w2n/AST/Expr.h>
 #include <w2n/AST/Identifier.h>
 #include <w2n/AST/InstNode.h>
+#include <w2n/AST/InstStream.h>
 #include <w2n/AST/Instructions.h>
 #include <w2n/AST/Module.h>
 #include <w2n/AST/NameAssociation.h>
@@ -36,19 +37,24 @@
 #include <w2n/AST/Stmt.h>
 #include <w2n/AST/Type.h>
 #include <w2n/Basic/Compiler.h>
+#include <w2n/Basic/Debug.h>
 #include <w2n/Basic/ImplicitTrailingObject.h>
 #include <w2n/Basic/LLVM.h>
+#include <w2n/Basic/MemoryAdvice.h>
 #include <w2n/Basic/SourceLoc.h>
 #include <w2n/Basic/SourceManager.h>
+#include <w2n/Basic/Statistic.h>
 #include <w2n/Basic/Unimplemented.h>
+#include <w2n/Parse/LEB128.h>
 #include <w2n/Parse/Parser.h>
 
 using namespace w2n;
-using namespace llvm::object;
 
-/// Current implementation of \c WasmParser is ripped from LLVM's
-/// implementation of WebAssembly object file support. There are a lot of
-/// room to improve the performance and the organization.
+/// \c WasmParser decodes the module in a single forward pass over the
+/// buffer owned by the \c SourceManager. The module header and the
+/// section framing are walked in place and each section's contents are
+/// handed to the matching \c parse*SectionDecl method without any
+/// intermediate object file representation.
 
 namespace w2n {
 
@@ -117,6 +123,20 @@ enum class DataKindImmediate : uint32_t {
   ActiveArbitraryMemory = 2,
 };
 
+/// The flags of an element segment. Bit 0 makes the segment passive or
+/// declarative, bit 1 gives it an explicit table index or makes it
+/// declarative, and bit 2 gives its elements as expressions.
+enum class ElementKindImmediate : uint32_t {
+  ActiveZerothTable = 0,
+  Passive = 1,
+  ActiveArbitraryTable = 2,
+  Declarative = 3,
+  ActiveZerothTableExprs = 4,
+  PassiveExprs = 5,
+  ActiveArbitraryTableExprs = 6,
+  DeclarativeExprs = 7,
+};
+
 static ValueTypeKind getValueTypeKind(TypeKindImmediate Ty) {
   switch (Ty) {
   case TypeKindImmediate::I32: return ValueTypeKind::I32;
@@ -151,8 +171,6 @@ static uint8_t readUint8(ReadContext& Ctx) {
   return *Ctx.Ptr++;
 }
 
-W2N_UNUSED
-
 static uint32_t readUint32(ReadContext& Ctx) {
   if (Ctx.Ptr + 4 > Ctx.End) {
     llvm_unreachable("EOF while reading uint32");
@@ -162,8 +180,6 @@ static uint32_t readUint32(ReadContext& Ctx) {
   return Result;
 }
 
-W2N_UNUSED
-
 static int32_t readFloat32(ReadContext& Ctx) {
   if (Ctx.Ptr + 4 > Ctx.End) {
     llvm_unreachable("EOF while reading float64");
@@ -174,8 +190,6 @@ static int32_t readFloat32(ReadContext& Ctx) {
   return Result;
 }
 
-W2N_UNUSED
-
 static int64_t readFloat64(ReadContext& Ctx) {
   if (Ctx.Ptr + 8 > Ctx.End) {
     llvm_unreachable("EOF while reading float64");
@@ -187,63 +201,74 @@ static int64_t readFloat64(ReadContext& Ctx) {
 }
 
 static uint64_t readULEB128(ReadContext& Ctx) {
-  unsigned Count;
-  const char * Error = nullptr;
-  uint64_t Result = llvm::decodeULEB128(Ctx.Ptr, &Count, Ctx.End, &Error);
-  if (Error != nullptr) {
-    llvm_unreachable(Error);
+  uint64_t Result;
+  unsigned Count = leb128::decodeVaruint64(Ctx.Ptr, Ctx.End, Result);
+  if (LLVM_UNLIKELY(Count == 0)) {
+    llvm_unreachable("malformed or truncated uleb128");
   }
   Ctx.Ptr += Count;
   return Result;
 }
 
-static StringRef readString(ReadContext& Ctx) {
-  uint32_t StringLen = readULEB128(Ctx);
-  if (Ctx.Ptr + StringLen > Ctx.End) {
-    llvm_unreachable("EOF while reading string");
-  }
-  StringRef Return =
-    StringRef(reinterpret_cast<const char *>(Ctx.Ptr), StringLen);
-  Ctx.Ptr += StringLen;
-  return Return;
-}
-
 static int64_t readLEB128(ReadContext& Ctx) {
-  unsigned Count;
-  const char * Error = nullptr;
-  uint64_t Result = llvm::decodeSLEB128(Ctx.Ptr, &Count, Ctx.End, &Error);
-  if (Error != nullptr) {
-    llvm_unreachable(Error);
+  int64_t Result;
+  unsigned Count = leb128::decodeVarint64(Ctx.Ptr, Ctx.End, Result);
+  if (LLVM_UNLIKELY(Count == 0)) {
+    llvm_unreachable("malformed or truncated sleb128");
   }
   Ctx.Ptr += Count;
   return Result;
 }
 
 static uint8_t readVaruint1(ReadContext& Ctx) {
-  int64_t Result = readLEB128(Ctx);
-  if (Result > W2N_VARUIN_T1_MAX || Result < 0) {
+  uint8_t Result = readUint8(Ctx);
+  if (Result > W2N_VARUIN_T1_MAX) {
     llvm_unreachable("LEB is outside Varuint1 range");
   }
   return Result;
 }
 
 static int32_t readVarint32(ReadContext& Ctx) {
-  int64_t Result = readLEB128(Ctx);
-  if (Result > INT32_MAX || Result < INT32_MIN) {
-    llvm_unreachable("LEB is outside Varint32 range");
+  int32_t Result;
+  unsigned Count = leb128::decodeVarint32(Ctx.Ptr, Ctx.End, Result);
+  if (LLVM_UNLIKELY(Count == 0)) {
+    llvm_unreachable("LEB is malformed or outside Varint32 range");
   }
+  Ctx.Ptr += Count;
   return Result;
 }
 
 static uint32_t readVaruint32(ReadContext& Ctx) {
-  uint64_t Result = readULEB128(Ctx);
-  if (Result > UINT32_MAX) {
-    llvm_unreachable("LEB is outside Varuint32 range");
+  uint32_t Result;
+  unsigned Count = leb128::decodeVaruint32(Ctx.Ptr, Ctx.End, Result);
+  if (LLVM_UNLIKELY(Count == 0)) {
+    llvm_unreachable("LEB is malformed or outside Varuint32 range");
   }
+  Ctx.Ptr += Count;
   return Result;
 }
 
-W2N_UNUSED
+static StringRef readString(ReadContext& Ctx) {
+  uint32_t StringLen = readVaruint32(Ctx);
+  if ((size_t)(Ctx.End - Ctx.Ptr) < StringLen) {
+    llvm_unreachable("EOF while reading string");
+  }
+  StringRef Return =
+    StringRef(reinterpret_cast<const char *>(Ctx.Ptr), StringLen);
+  Ctx.Ptr += StringLen;
+  return Return;
+}
+
+/// Reads a \c vec(byte) as a view into the buffer being read.
+static ArrayRef<uint8_t> readBytes(ReadContext& Ctx) {
+  uint32_t Size = readVaruint32(Ctx);
+  if ((size_t)(Ctx.End - Ctx.Ptr) < Size) {
+    llvm_unreachable("EOF while reading bytes");
+  }
+  ArrayRef<uint8_t> Return(Ctx.Ptr, Size);
+  Ctx.Ptr += Size;
+  return Return;
+}
 
 static int64_t readVarint64(ReadContext& Ctx) {
   return readLEB128(Ctx);
@@ -257,12 +282,46 @@ static uint8_t readOpcode(ReadContext& Ctx) {
   return readUint8(Ctx);
 }
 
+/// A section located in the source buffer. \c Content refers to the
+/// bytes right after the section header (and after the name for custom
+/// sections) and is never copied.
+struct WasmSectionRef {
+  uint8_t Type;
+  StringRef Name;
+  ArrayRef<uint8_t> Content;
+};
+
+/// Returns the position of a known non-custom section kind in the order
+/// mandated by the WebAssembly specification. The data count section is
+/// placed in between the element section and the code section.
+static uint32_t getSectionOrder(SectionKindImmediate Kind) {
+  switch (Kind) {
+  case SectionKindImmediate::CustomSection: return 0;
+  case SectionKindImmediate::TypeSection: return 1;
+  case SectionKindImmediate::ImportSection: return 2;
+  case SectionKindImmediate::FuncSection: return 3;
+  case SectionKindImmediate::TableSection: return 4;
+  case SectionKindImmediate::MemorySection: return 5;
+  case SectionKindImmediate::GlobalSection: return 6;
+  case SectionKindImmediate::ExportSection: return 7;
+  case SectionKindImmediate::StartSection: return 8;
+  case SectionKindImmediate::ElementSection: return 9;
+  case SectionKindImmediate::DataCountSection: return 10;
+  case SectionKindImmediate::CodeSection: return 11;
+  case SectionKindImmediate::DataSection: return 12;
+  }
+  llvm_unreachable("unknown section type");
+}
+
 class WasmParser::Implementation {
 public:
 
   WasmParser * Parser;
 
-  std::unique_ptr<WasmObjectFile> WasmObject;
+  ASTContext * Context = nullptr;
+
+  /// The whole .wasm file, owned by the \c SourceManager .
+  ArrayRef<uint8_t> Buffer;
 
 #define DECL(Id, Parent)
 #define SECTION_DECL(Id, _) Id##Decl * Parsed##Id##Decl;
@@ -276,17 +335,16 @@ public:
   uint32_t DataSection = 0;
   uint32_t GlobalSection = 0;
   uint32_t TableSection = 0;
-  uint32_t BlockLevel = 0;
 
   explicit Implementation(WasmParser * Parser) : Parser(Parser) {
   }
 
   ASTContext& getContext() {
-    return const_cast<const SourceFile&>(Parser->File).getASTContext();
+    return *Context;
   }
 
   const ASTContext& getContext() const {
-    return Parser->File.getASTContext();
+    return *Context;
   }
 
   /// Basic templated parsing function.
@@ -412,16 +470,16 @@ public:
     ReadContext ReservedCtx = Ctx;
     TypeKindImmediate TyImm = parse<TypeKindImmediate>(Ctx);
     if (TyImm == TypeKindImmediate::Void) {
-      return BlockType::create(getContext(), getContext().getVoidType());
+      return getContext().getBlockType(getContext().getVoidType());
     }
     ValueTypeKind Kind = getValueTypeKind(TyImm);
     ValueType * ValTy = getContext().getValueTypeForKind(Kind);
     if (ValTy != nullptr) {
-      return BlockType::create(getContext(), ValTy);
+      return getContext().getBlockType(ValTy);
     }
     Ctx = ReservedCtx;
     TypeIndexType * TypeIndexTy = parse<TypeIndexType *>(Ctx);
-    return BlockType::create(getContext(), TypeIndexTy);
+    return getContext().getBlockType(TypeIndexTy);
   }
 
 #pragma mark Parsing Variant Name Associations
@@ -523,13 +581,6 @@ public:
     llvm_unreachable("unexpected export kind");
   }
 
-  template <>
-  CodeDecl * parse<CodeDecl *>(ReadContext& Ctx) {
-    uint32_t Size = readVaruint32(Ctx);
-    FuncDecl * Func = parse<FuncDecl *>(Ctx);
-    return CodeDecl::create(getContext(), Size, Func);
-  }
-
   template <>
   FuncDecl * parse<FuncDecl *>(ReadContext& Ctx) {
     std::vector<LocalDecl *> Locals = parseVector<LocalDecl *>(Ctx);
@@ -547,8 +598,10 @@ public:
 
   template <>
   ExpressionDecl * parse<ExpressionDecl *>(ReadContext& Ctx) {
-    std::vector<InstNode> Instructions = parseInstructions(Ctx);
-    return ExpressionDecl::create(getContext(), Instructions);
+    if (getContext().LangOpts.UseCompactInstructions) {
+      return ExpressionDecl::create(getContext(), parseInstStream(Ctx));
+    }
+    return parseInstructions(Ctx);
   }
 
   template <>
@@ -559,19 +612,19 @@ public:
     switch (Kind) {
     case DataKindImmediate::ActiveZerothMemory: {
       ExpressionDecl * Expression = parse<ExpressionDecl *>(Ctx);
-      std::vector<uint8_t> Data = parseVector<uint8_t>(Ctx);
+      ArrayRef<uint8_t> Data = readBytes(Ctx);
       return DataSegmentActiveDecl::create(
         getContext(), 0, Expression, Data
       );
     }
     case DataKindImmediate::Passive: {
-      std::vector<uint8_t> Data = parseVector<uint8_t>(Ctx);
+      ArrayRef<uint8_t> Data = readBytes(Ctx);
       return DataSegmentPassiveDecl::create(getContext(), Data);
     }
     case DataKindImmediate::ActiveArbitraryMemory: {
       MemIndexTy MemoryIndex = parse<MemIndexTy>(Ctx);
       ExpressionDecl * Expression = parse<ExpressionDecl *>(Ctx);
-      std::vector<uint8_t> Data = parseVector<uint8_t>(Ctx);
+      ArrayRef<uint8_t> Data = readBytes(Ctx);
       return DataSegmentActiveDecl::create(
         getContext(), MemoryIndex, Expression, Data
       );
@@ -579,6 +632,151 @@ public:
     }
   }
 
+  /**
+   * @brief Parses an element segment.
+   *
+   * @note
+   * \verbatim
+   *  elem:
+   *    0:u32 e:expr y*:vec(funcidx)
+   *    1:u32 et:elemkind y*:vec(funcidx)
+   *    2:u32 x:tableidx e:expr et:elemkind y*:vec(funcidx)
+   *    3:u32 et:elemkind y*:vec(funcidx)
+   *    4:u32 e:expr el*:vec(expr)
+   *    5:u32 et:reftype el*:vec(expr)
+   *    6:u32 x:tableidx e:expr et:reftype el*:vec(expr)
+   *    7:u32 et:reftype el*:vec(expr)
+   * \endverbatim
+   */
+  template <>
+  ElementSegmentDecl * parse<ElementSegmentDecl *>(ReadContext& Ctx) {
+    uint32_t RawKind = readVaruint32(Ctx);
+    assert(RawKind >= 0 && RawKind <= 7);
+    ElementKindImmediate Kind = (ElementKindImmediate)RawKind;
+    // The only element kind is 0x00, funcref.
+    auto ParseElemKind = [&] {
+      if (readUint8(Ctx) != 0) {
+        llvm_unreachable("invalid element kind");
+      }
+    };
+    // The segments of expressions name a reference type instead, either
+    // funcref or externref.
+    auto ParseRefType = [&] {
+      auto RefType = (TypeKindImmediate)readUint8(Ctx);
+      if (RefType != TypeKindImmediate::FuncRef
+          && RefType != TypeKindImmediate::ExternRef) {
+        llvm_unreachable("invalid reference type");
+      }
+    };
+    switch (Kind) {
+    case ElementKindImmediate::ActiveZerothTable: {
+      ExpressionDecl * Offset = parse<ExpressionDecl *>(Ctx);
+      std::vector<uint32_t> Functions = parseVector<FuncIndexTy>(Ctx);
+      return ElementSegmentDecl::createActive(
+        getContext(), 0, Offset, Functions
+      );
+    }
+    case ElementKindImmediate::Passive: {
+      ParseElemKind();
+      std::vector<uint32_t> Functions = parseVector<FuncIndexTy>(Ctx);
+      return ElementSegmentDecl::create(
+        getContext(), ElementSegmentMode::Passive, Functions
+      );
+    }
+    case ElementKindImmediate::ActiveArbitraryTable: {
+      TableIndexTy TableIndex = parse<TableIndexTy>(Ctx);
+      ExpressionDecl * Offset = parse<ExpressionDecl *>(Ctx);
+      ParseElemKind();
+      std::vector<uint32_t> Functions = parseVector<FuncIndexTy>(Ctx);
+      return ElementSegmentDecl::createActive(
+        getContext(), TableIndex, Offset, Functions
+      );
+    }
+    case ElementKindImmediate::Declarative: {
+      ParseElemKind();
+      std::vector<uint32_t> Functions = parseVector<FuncIndexTy>(Ctx);
+      return ElementSegmentDecl::create(
+        getContext(), ElementSegmentMode::Declarative, Functions
+      );
+    }
+    case ElementKindImmediate::ActiveZerothTableExprs: {
+      ExpressionDecl * Offset = parse<ExpressionDecl *>(Ctx);
+      std::vector<uint32_t> Functions = parseElementExprs(Ctx);
+      return ElementSegmentDecl::createActive(
+        getContext(), 0, Offset, Functions
+      );
+    }
+    case ElementKindImmediate::PassiveExprs: {
+      ParseRefType();
+      std::vector<uint32_t> Functions = parseElementExprs(Ctx);
+      return ElementSegmentDecl::create(
+        getContext(), ElementSegmentMode::Passive, Functions
+      );
+    }
+    case ElementKindImmediate::ActiveArbitraryTableExprs: {
+      TableIndexTy TableIndex = parse<TableIndexTy>(Ctx);
+      ExpressionDecl * Offset = parse<ExpressionDecl *>(Ctx);
+      ParseRefType();
+      std::vector<uint32_t> Functions = parseElementExprs(Ctx);
+      return ElementSegmentDecl::createActive(
+        getContext(), TableIndex, Offset, Functions
+      );
+    }
+    case ElementKindImmediate::DeclarativeExprs: {
+      ParseRefType();
+      std::vector<uint32_t> Functions = parseElementExprs(Ctx);
+      return ElementSegmentDecl::create(
+        getContext(), ElementSegmentMode::Declarative, Functions
+      );
+    }
+    }
+  }
+
+  /**
+   * @brief Parses the element expressions of an element segment into the
+   * indices of the functions they refer to.
+   *
+   * @note \c ref.null elements are \c ElementSegmentDecl::NullFunction .
+   * \verbatim
+   *  elemexpr:
+   *    0xD2 x:funcidx 0x0B
+   *    0xD0 t:reftype 0x0B
+   *    0x23 x:globalidx 0x0B
+   * \endverbatim
+   */
+  std::vector<uint32_t> parseElementExprs(ReadContext& Ctx) {
+    // llvm::wasm does not name the opcode of ref.func.
+    static constexpr uint8_t RefFuncOpcode = 0xD2;
+
+    uint32_t Count = readVaruint32(Ctx);
+    std::vector<uint32_t> Functions;
+    Functions.reserve(Count);
+    for (uint32_t I = 0; I < Count; I++) {
+      switch (readUint8(Ctx)) {
+      case RefFuncOpcode: Functions.push_back(readVaruint32(Ctx)); break;
+      case llvm::wasm::WASM_OPCODE_REF_NULL:
+        readUint8(Ctx);
+        Functions.push_back(ElementSegmentDecl::NullFunction);
+        break;
+      case llvm::wasm::WASM_OPCODE_GLOBAL_GET:
+        // TODO: Support elements read from imported globals.
+        readVaruint32(Ctx);
+        getContext().Diags.diagnose(
+          SourceLoc(),
+          diag::not_implemented,
+          "element expressions reading globals"
+        );
+        Functions.push_back(ElementSegmentDecl::NullFunction);
+        break;
+      default: llvm_unreachable("invalid element expression");
+      }
+      if (readUint8(Ctx) != llvm::wasm::WASM_OPCODE_END) {
+        llvm_unreachable("element expression without end");
+      }
+    }
+    return Functions;
+  }
+
   template <>
   SubSectionKindImmediate parse<SubSectionKindImmediate>(ReadContext& Ctx
   ) {
@@ -645,200 +843,353 @@ public:
 
 #pragma mark Parsing Instructions
 
-  std::vector<InstNode> parseInstructions(ReadContext& Ctx) {
-    std::vector<InstNode> Instructions;
-    InstNode LastInstruction;
-    std::tie(Instructions, LastInstruction) =
-      parseInstructionsUntil(Ctx, [](InstNode Instruction) -> bool {
-        return (EndStmt::classof(Instruction.dyn_cast<Stmt *>()));
-      });
-    Instructions.push_back(LastInstruction);
-    return Instructions;
-  }
+  /// The decoded immediates of an instruction. Which fields are set
+  /// depends on the \c InstImmediateKind of the instruction.
+  struct InstImmediates {
+    uint32_t Index = 0;
+    uint32_t SecondaryIndex = 0;
+    std::vector<LabelIndexTy> LabelIndices;
+    BlockType * Ty = nullptr;
+    MemoryArgument MemArg = {0, 0};
+    uint64_t Bits = 0;
+  };
+
+  /// A structured instruction whose body is being decoded by
+  /// \c parseInstructions .
+  struct ControlFrame {
+    InstNodeKind Kind;
+    BlockType * Ty;
+    /// The offset of the first instruction of the body in the scratch
+    /// buffer.
+    size_t BodyStart;
+    /// The \c else of an \c if , once decoded.
+    ElseStmt * Else = nullptr;
+    /// The offset of the first instruction of the false arm of an \c if
+    /// in the scratch buffer.
+    size_t ElseStart = 0;
+  };
 
-  std::pair<std::vector<InstNode>, InstNode> parseInstructionsUntil(
-    ReadContext& Ctx, std::function<bool(InstNode)> Predicate
-  ) {
-    BlockLevel++;
-    std::vector<InstNode> Instructions;
-    InstNode Instruction = nullptr;
-    llvm::errs(
-    ) << "[WasmParser::Implementation] [parseInstructionsUntil] ["
-      << BlockLevel << "] BEGAN\n";
-    while (Instruction.isNull() || !Predicate(Instruction)) {
-      Instruction = parseInstruction(Ctx);
-      if (!Predicate(Instruction)) {
-        Instructions.push_back(Instruction);
+  /**
+   * @brief Decodes instructions up to the \c end terminating the
+   * expression.
+   *
+   * Structured instructions are tracked with an explicit stack of
+   * control frames rather than by recursion, so the nesting depth of the
+   * input is bounded by the heap instead of the host stack. The bodies of
+   * all open frames share a single scratch buffer, and each body is
+   * copied once into the arena when its \c end is decoded.
+   */
+  ExpressionDecl * parseInstructions(ReadContext& Ctx) {
+    ASTContext& C = getContext();
+    llvm::SmallVector<InstNode, 256> Scratch;
+    llvm::SmallVector<ControlFrame, 16> Controls;
+    while (true) {
+      Instruction Inst;
+      InstImmediates Immediates;
+      const InstInfo& Info = parseInstruction(Ctx, Inst, Immediates);
+      switch (Info.Node) {
+      case InstNodeKind::Block:
+      case InstNodeKind::Loop:
+      case InstNodeKind::If:
+        Controls.push_back({Info.Node, Immediates.Ty, Scratch.size()});
+        break;
+      case InstNodeKind::Else: {
+        if (LLVM_UNLIKELY(
+              Controls.empty() || Controls.back().Kind != InstNodeKind::If
+              || Controls.back().Else != nullptr
+            )) {
+          llvm_unreachable("else without matching if");
+        }
+        Controls.back().Else = ElseStmt::create(C);
+        Controls.back().ElseStart = Scratch.size();
+        break;
+      }
+      case InstNodeKind::End: {
+        EndStmt * End = EndStmt::create(C);
+        if (Controls.empty()) {
+          Scratch.push_back(End);
+          return ExpressionDecl::create(C, Scratch);
+        }
+        ControlFrame Frame = Controls.pop_back_val();
+        ArrayRef<InstNode> Body =
+          ArrayRef<InstNode>(Scratch).drop_front(Frame.BodyStart);
+        InstNode Structured = createStructuredStmt(Frame, Body, End);
+        Scratch.truncate(Frame.BodyStart);
+        Scratch.push_back(Structured);
+        break;
+      }
+      default:
+        Scratch.push_back(createInstNode(Inst, Info, Immediates));
+        break;
       }
-    }
-    llvm::errs(
-    ) << "[WasmParser::Implementation] [parseInstructionsUntil] ["
-      << BlockLevel << "] ENDED\n";
-    BlockLevel--;
-    return std::make_pair(Instructions, Instruction);
-  }
-
-  InstNode parseInstruction(ReadContext& Ctx) {
-    auto Opcode = readOpcode(Ctx);
-    llvm::errs(
-    ) << "[WasmParser::Implementation] [parseInstruction] ["
-      << BlockLevel
-      << "] OPCODE = 0x"
-      // Adding a unary + operator before the variable of any
-      // primitive data type will give printable numerical value
-      // instead of ASCII character(in case of char type).
-      //
-      // https://stackoverflow.com/a/31991844/1393062
-      << llvm::format_hex((uint8_t)Opcode, 8) << "\n";
-    switch (Opcode) {
-#define INST(Id, Opcode0, ...)                                           \
-  case Opcode0:                                                          \
-    return parse##Id(Ctx);
-#include <w2n/AST/Instructions.def>
-    default:
-      // Unimplemented opcode!
-      w2n_unimplemented();
-      break;
     }
   }
 
-  UnreachableStmt * parseUnreachable(ReadContext& Ctx) {
-    return UnreachableStmt::create(getContext());
-  }
-
-  BlockStmt * parseBlock(ReadContext& Ctx) {
-    BlockType * Ty = parse<BlockType *>(Ctx);
-    std::vector<InstNode> Instructions;
-    InstNode EndInstruction;
-    std::tie(Instructions, EndInstruction) =
-      parseInstructionsUntil(Ctx, [](InstNode Instruction) -> bool {
-        return EndStmt::classof(Instruction.dyn_cast<Stmt *>());
-      });
-    return BlockStmt::create(
-      getContext(),
-      Ty,
-      Instructions,
-      dyn_cast<EndStmt>(EndInstruction.dyn_cast<Stmt *>())
-    );
-  }
-
-  LoopStmt * parseLoop(ReadContext& Ctx) {
-    BlockType * Ty = parse<BlockType *>(Ctx);
-    std::vector<InstNode> Instructions;
-    InstNode EndInstruction;
-    std::tie(Instructions, EndInstruction) =
-      parseInstructionsUntil(Ctx, [](InstNode Instruction) -> bool {
-        return EndStmt::classof(Instruction.dyn_cast<Stmt *>());
-      });
-    return LoopStmt::create(
-      getContext(),
-      Ty,
-      Instructions,
-      dyn_cast<EndStmt>(EndInstruction.dyn_cast<Stmt *>())
-    );
-  }
-
-  IfStmt * parseIf(ReadContext& Ctx) {
-    BlockType * Ty = parse<BlockType *>(Ctx);
-    std::vector<InstNode> TrueInstructions;
-    InstNode IntermediateInstruction;
-    std::tie(TrueInstructions, IntermediateInstruction) =
-      parseInstructionsUntil(Ctx, [](InstNode Instruction) -> bool {
-        return EndStmt::classof(Instruction.dyn_cast<Stmt *>())
-            || ElseStmt::classof(Instruction.dyn_cast<Stmt *>());
-      });
-
-    if (IntermediateInstruction.isStmt(StmtKind::End)) {
-      return IfStmt::create(
-        getContext(),
-        Ty,
-        TrueInstructions,
-        nullptr,
-        llvm::None,
-        dyn_cast<EndStmt>(IntermediateInstruction.dyn_cast<Stmt *>())
-      );
-    }
-
-    if (IntermediateInstruction.isStmt(StmtKind::Else)) {
-      std::vector<InstNode> FalseInstructions;
-      InstNode EndInstruction;
-      std::tie(FalseInstructions, EndInstruction) =
-        parseInstructionsUntil(Ctx, [](InstNode Instruction) -> bool {
-          return EndStmt::classof(Instruction.dyn_cast<Stmt *>());
-        });
+  /// Creates the statement of a structured instruction, copying \p Body
+  /// into the arena.
+  Stmt * createStructuredStmt(
+    const ControlFrame& Frame, ArrayRef<InstNode> Body, EndStmt * End
+  ) {
+    ASTContext& C = getContext();
+    switch (Frame.Kind) {
+    case InstNodeKind::Block:
+      return BlockStmt::create(C, Frame.Ty, Body, End);
+    case InstNodeKind::Loop:
+      return LoopStmt::create(C, Frame.Ty, Body, End);
+    case InstNodeKind::If:
+      if (Frame.Else == nullptr) {
+        return IfStmt::create(
+          C, Frame.Ty, Body, nullptr, llvm::None, End
+        );
+      }
       return IfStmt::create(
-        getContext(),
-        Ty,
-        TrueInstructions,
-        dyn_cast<ElseStmt>(IntermediateInstruction.dyn_cast<Stmt *>()),
-        FalseInstructions,
-        dyn_cast<EndStmt>(EndInstruction.dyn_cast<Stmt *>())
+        C,
+        Frame.Ty,
+        Body.take_front(Frame.ElseStart - Frame.BodyStart),
+        Frame.Else,
+        Body.drop_front(Frame.ElseStart - Frame.BodyStart),
+        End
       );
+    default: llvm_unreachable("not a structured instruction");
     }
-
-    llvm_unreachable("unexpected StmtKind");
-  }
-
-  EndStmt * parseEnd(ReadContext& Ctx) {
-    return EndStmt::create(getContext());
-  }
-
-  BrStmt * parseBr(ReadContext& Ctx) {
-    LabelIndexTy LabelIndex = parse<LabelIndexTy>(Ctx);
-    return BrStmt::create(getContext(), LabelIndex);
-  }
-
-  BrIfStmt * parseBrIf(ReadContext& Ctx) {
-    LabelIndexTy LabelIndex = parse<LabelIndexTy>(Ctx);
-    return BrIfStmt::create(getContext(), LabelIndex);
-  }
-
-  BrTableStmt * parseBrTable(ReadContext& Ctx) {
-    std::vector<LabelIndexTy> LabelIndices =
-      parseVector<LabelIndexTy>(Ctx);
-    LabelIndexTy DefaultLabelIndex = parse<LabelIndexTy>(Ctx);
-    return BrTableStmt::create(
-      getContext(), LabelIndices, DefaultLabelIndex
-    );
   }
 
-  ReturnStmt * parseReturn(ReadContext& Ctx) {
-    return ReturnStmt::create(getContext());
-  }
-
-  CallExpr * parseCall(ReadContext& Ctx) {
-    FuncIndexTy FuncIndex = parse<FuncIndexTy>(Ctx);
-    return CallExpr::create(getContext(), FuncIndex);
-  }
-
-  CallIndirectExpr * parseCallIndirect(ReadContext& Ctx) {
-    TypeIndexTy TypeIndex = parse<TypeIndexTy>(Ctx);
-    TableIndexTy TableIndex = parse<TableIndexTy>(Ctx);
-    return CallIndirectExpr::create(getContext(), TypeIndex, TableIndex);
-  }
-
-  DropExpr * parseDrop(ReadContext& Ctx) {
-    return DropExpr::create(getContext());
+  /**
+   * @brief Decodes instructions up to the \c end terminating the
+   * expression into a flat \c InstStream .
+   *
+   * Structured instructions are tracked by the builder rather than by
+   * recursion, so the whole expression is decoded in a single loop.
+   */
+  InstStream * parseInstStream(ReadContext& Ctx) {
+    InstStreamBuilder Builder;
+    while (true) {
+      Instruction Inst;
+      const InstInfo * Info = &parseOpcode(Ctx, Inst);
+      InstImmediates Immediates =
+        parseInstImmediates(Ctx, Info->Immediate);
+      switch (Info->Immediate) {
+      case InstImmediateKind::BlockType:
+        Builder.addBlock(Inst, Immediates.Ty);
+        break;
+      case InstImmediateKind::LabelTable:
+        Builder.addBrTable(Immediates.LabelIndices, Immediates.Index);
+        break;
+      case InstImmediateKind::TypeAndTableIdx:
+        Builder.addCallIndirect(
+          Inst, Immediates.Index, Immediates.SecondaryIndex
+        );
+        break;
+      case InstImmediateKind::MemArg:
+        Builder.addMemoryAccess(Inst, Immediates.MemArg);
+        break;
+      case InstImmediateKind::I64:
+      case InstImmediateKind::F64:
+        Builder.add64(Inst, Immediates.Bits);
+        break;
+      case InstImmediateKind::I32:
+      case InstImmediateKind::F32:
+        Builder.add(Inst, *Info, (uint32_t)Immediates.Bits);
+        break;
+      default: Builder.add(Inst, *Info, Immediates.Index); break;
+      }
+      if (Info->Node == InstNodeKind::End && Builder.getDepth() == 0) {
+        break;
+      }
+    }
+    return Builder.finish(getContext());
   }
 
-  LocalGetExpr * parseLocalGet(ReadContext& Ctx) {
-    LocalIndexTy LocalIndex = parse<LocalIndexTy>(Ctx);
-    return LocalGetExpr::create(getContext(), LocalIndex);
+  /**
+   * @brief Decodes the opcode of an instruction through the dense decode
+   * tables generated from \file w2n/AST/Instructions.def .
+   *
+   * @note
+   * \verbatim
+   *  instr:
+   *    opcode immediates
+   *    0xFC varuint32 immediates
+   *    0xFD varuint32 immediates
+   * \endverbatim
+   */
+  const InstInfo& parseOpcode(ReadContext& Ctx, Instruction& Inst) {
+    uint8_t Opcode = readOpcode(Ctx);
+    uint16_t Prefix = 0;
+    const InstInfo * Info = &getInstInfo(Opcode);
+    if (LLVM_UNLIKELY(!Info->isValid())) {
+      if (Opcode == (uint8_t)InstPrefix::Misc
+          || Opcode == (uint8_t)InstPrefix::Vector) {
+        uint32_t SubOpcode = readVaruint32(Ctx);
+        Info = &getPrefixedInstInfo((InstPrefix)Opcode, SubOpcode);
+        Prefix = Opcode;
+        Opcode = SubOpcode;
+      }
+    }
+    if (LLVM_UNLIKELY(!Info->isValid())) {
+      // Unimplemented opcode!
+      w2n_unimplemented();
+    }
+    Inst = (Instruction)((Prefix << 8) | Opcode);
+    return *Info;
   }
 
-  LocalSetExpr * parseLocalSet(ReadContext& Ctx) {
-    LocalIndexTy LocalIndex = parse<LocalIndexTy>(Ctx);
-    return LocalSetExpr::create(getContext(), LocalIndex);
+  /// Decodes an instruction and its immediates.
+  const InstInfo& parseInstruction(
+    ReadContext& Ctx, Instruction& Inst, InstImmediates& Immediates
+  ) {
+    const InstInfo& Info = parseOpcode(Ctx, Inst);
+    W2N_TRACE(Parse, Verbose, "instruction", {"opcode", (uint16_t)Inst});
+    Immediates = parseInstImmediates(Ctx, Info.Immediate);
+    return Info;
   }
 
-  GlobalGetExpr * parseGlobalGet(ReadContext& Ctx) {
-    GlobalIndexTy GlobalIndex = parse<GlobalIndexTy>(Ctx);
-    return GlobalGetExpr::create(getContext(), GlobalIndex);
+  InstImmediates
+  parseInstImmediates(ReadContext& Ctx, InstImmediateKind Kind) {
+    InstImmediates Immediates;
+    switch (Kind) {
+    case InstImmediateKind::None: break;
+    case InstImmediateKind::BlockType:
+      Immediates.Ty = parse<BlockType *>(Ctx);
+      break;
+    case InstImmediateKind::LabelIdx:
+    case InstImmediateKind::FuncIdx:
+    case InstImmediateKind::LocalIdx:
+    case InstImmediateKind::GlobalIdx:
+      Immediates.Index = readVaruint32(Ctx);
+      break;
+    case InstImmediateKind::LabelTable:
+      Immediates.LabelIndices = parseVector<LabelIndexTy>(Ctx);
+      Immediates.Index = parse<LabelIndexTy>(Ctx);
+      break;
+    case InstImmediateKind::TypeAndTableIdx:
+      Immediates.Index = parse<TypeIndexTy>(Ctx);
+      Immediates.SecondaryIndex = parse<TableIndexTy>(Ctx);
+      break;
+    case InstImmediateKind::MemArg:
+      Immediates.MemArg = parseMemArg(Ctx);
+      break;
+    case InstImmediateKind::MemIdx:
+      if (readUint8(Ctx) != 0x00) {
+        llvm_unreachable("memory index must be zero");
+      }
+      break;
+    case InstImmediateKind::I32:
+      Immediates.Bits = (uint32_t)readVarint32(Ctx);
+      break;
+    case InstImmediateKind::I64:
+      Immediates.Bits = (uint64_t)readVarint64(Ctx);
+      break;
+    case InstImmediateKind::F32:
+      Immediates.Bits = (uint32_t)readFloat32(Ctx);
+      break;
+    case InstImmediateKind::F64:
+      Immediates.Bits = (uint64_t)readFloat64(Ctx);
+      break;
+    }
+    return Immediates;
   }
 
-  GlobalSetExpr * parseGlobalSet(ReadContext& Ctx) {
-    GlobalIndexTy GlobalIndex = parse<GlobalIndexTy>(Ctx);
-    return GlobalSetExpr::create(getContext(), GlobalIndex);
+  /// Creates the node of an unstructured instruction. Structured
+  /// instructions and their terminators are assembled by
+  /// \c parseInstructions .
+  InstNode createInstNode(
+    Instruction Inst, const InstInfo& Info, InstImmediates& Immediates
+  ) {
+    ASTContext& C = getContext();
+    switch (Info.Node) {
+    case InstNodeKind::Invalid: llvm_unreachable("invalid instruction");
+    case InstNodeKind::Unreachable: return UnreachableStmt::create(C);
+    case InstNodeKind::Nop: return NopStmt::create(C);
+    case InstNodeKind::Block:
+    case InstNodeKind::Loop:
+    case InstNodeKind::If:
+    case InstNodeKind::Else:
+    case InstNodeKind::End:
+      llvm_unreachable("handled by parseInstructions");
+    case InstNodeKind::Br: return BrStmt::create(C, Immediates.Index);
+    case InstNodeKind::BrIf: return BrIfStmt::create(C, Immediates.Index);
+    case InstNodeKind::BrTable:
+      return BrTableStmt::create(
+        C, std::move(Immediates.LabelIndices), Immediates.Index
+      );
+    case InstNodeKind::Return: return ReturnStmt::create(C);
+    case InstNodeKind::Call: return CallExpr::create(C, Immediates.Index);
+    case InstNodeKind::CallIndirect:
+      return CallIndirectExpr::create(
+        C, Immediates.Index, Immediates.SecondaryIndex
+      );
+    case InstNodeKind::Drop: return DropExpr::create(C);
+    case InstNodeKind::Select: return SelectExpr::create(C);
+    case InstNodeKind::LocalGet:
+      return LocalGetExpr::create(C, Immediates.Index);
+    case InstNodeKind::LocalSet:
+      return LocalSetExpr::create(C, Immediates.Index);
+    case InstNodeKind::LocalTee:
+      return LocalTeeExpr::create(C, Immediates.Index);
+    case InstNodeKind::GlobalGet:
+      return GlobalGetExpr::create(C, Immediates.Index);
+    case InstNodeKind::GlobalSet:
+      return GlobalSetExpr::create(C, Immediates.Index);
+    case InstNodeKind::Load:
+      return LoadExpr::create(
+        C,
+        Immediates.MemArg,
+        C.getValueTypeForKind(Info.MemoryType),
+        C.getValueTypeForKind(Info.ResultType)
+      );
+    case InstNodeKind::Store:
+      return StoreExpr::create(
+        C,
+        Immediates.MemArg,
+        C.getValueTypeForKind(Info.OperandType),
+        C.getValueTypeForKind(Info.MemoryType)
+      );
+    case InstNodeKind::MemorySize:
+      return MemorySizeExpr::create(
+        C, C.getValueTypeForKind(Info.ResultType)
+      );
+    case InstNodeKind::MemoryGrow:
+      return MemoryGrowExpr::create(
+        C, C.getValueTypeForKind(Info.ResultType)
+      );
+    case InstNodeKind::IntegerConst: {
+      auto * Ty =
+        cast<IntegerType>(C.getValueTypeForKind(Info.ResultType));
+      unsigned BitWidth = Info.ResultType == ValueTypeKind::I64 ? 64 : 32;
+      return IntegerConstExpr::create(
+        C, llvm::APInt(BitWidth, Immediates.Bits, true), Ty
+      );
+    }
+    case InstNodeKind::FloatConst: {
+      auto * Ty = cast<FloatType>(C.getValueTypeForKind(Info.ResultType));
+      if (Info.ResultType == ValueTypeKind::F64) {
+        return FloatConstExpr::create(
+          C,
+          llvm::APFloat(
+            llvm::APFloat::IEEEdouble(), llvm::APInt(64, Immediates.Bits)
+          ),
+          Ty
+        );
+      }
+      return FloatConstExpr::create(
+        C,
+        llvm::APFloat(
+          llvm::APFloat::IEEEsingle(), llvm::APInt(32, Immediates.Bits)
+        ),
+        Ty
+      );
+    }
+    case InstNodeKind::Builtin: {
+      StringRef BuiltinName = getBuiltinName(Info.Builtin);
+      return CallBuiltinExpr::create(
+        C,
+        Inst,
+        C.getIdentifier(BuiltinName),
+        C.getValueTypeForKind(Info.ResultType)
+      );
+    }
+    }
+    llvm_unreachable("unexpected InstNodeKind");
   }
 
   MemoryArgument parseMemArg(ReadContext& Ctx) {
@@ -847,102 +1198,6 @@ public:
     return MemoryArgument{Align, Offset};
   }
 
-  LoadExpr * parseI32Load(ReadContext& Ctx) {
-    MemoryArgument MemArg = parseMemArg(Ctx);
-    return LoadExpr::create(
-      getContext(),
-      MemArg,
-      getContext().getI32Type(),
-      getContext().getI32Type()
-    );
-  }
-
-  LoadExpr * parseI32Load8u(ReadContext& Ctx) {
-    MemoryArgument MemArg = parseMemArg(Ctx);
-    return LoadExpr::create(
-      getContext(),
-      MemArg,
-      getContext().getU8Type(),
-      getContext().getI32Type()
-    );
-  }
-
-  StoreExpr * parseI32Store(ReadContext& Ctx) {
-    MemoryArgument MemArg = parseMemArg(Ctx);
-    return StoreExpr::create(
-      getContext(),
-      MemArg,
-      getContext().getI32Type(),
-      getContext().getI32Type()
-    );
-  }
-
-  IntegerConstExpr * parseI32Const(ReadContext& Ctx) {
-    uint32_t BitPattern = readVaruint32(Ctx);
-    return IntegerConstExpr::create(
-      getContext(),
-      llvm::APInt(32, BitPattern, true),
-      getContext().getI32Type()
-    );
-  }
-
-  CallBuiltinExpr * parseI32Eqz(ReadContext& Ctx) {
-    StringRef BuiltinName = getBuiltinName(BuiltinValueKind::ICMP_EQZ);
-    return CallBuiltinExpr::create(
-      getContext(),
-      getContext().getIdentifier(BuiltinName),
-      /// FIXME: May need \c BooleanType ?
-      getContext().getI32Type()
-    );
-  }
-
-  CallBuiltinExpr * parseI32Eq(ReadContext& Ctx) {
-    StringRef BuiltinName = getBuiltinName(BuiltinValueKind::ICMP_EQ);
-    return CallBuiltinExpr::create(
-      getContext(),
-      getContext().getIdentifier(BuiltinName),
-      /// FIXME: May need \c BooleanType ?
-      getContext().getI32Type()
-    );
-  }
-
-  CallBuiltinExpr * parseI32Ne(ReadContext& Ctx) {
-    StringRef BuiltinName = getBuiltinName(BuiltinValueKind::ICMP_NE);
-    return CallBuiltinExpr::create(
-      getContext(),
-      getContext().getIdentifier(BuiltinName),
-      /// FIXME: May need \c BooleanType ?
-      getContext().getI32Type()
-    );
-  }
-
-  CallBuiltinExpr * parseI32Add(ReadContext& Ctx) {
-    StringRef BuiltinName = getBuiltinName(BuiltinValueKind::Add);
-    return CallBuiltinExpr::create(
-      getContext(),
-      getContext().getIdentifier(BuiltinName),
-      getContext().getI32Type()
-    );
-  }
-
-  CallBuiltinExpr * parseI32Sub(ReadContext& Ctx) {
-    StringRef BuiltinName = getBuiltinName(BuiltinValueKind::Sub);
-    return CallBuiltinExpr::create(
-      getContext(),
-      getContext().getIdentifier(BuiltinName),
-      getContext().getI32Type()
-    );
-  }
-
-  CallBuiltinExpr * parseI32And(ReadContext& Ctx) {
-    StringRef BuiltinName = getBuiltinName(BuiltinValueKind::And);
-    return CallBuiltinExpr::create(
-      getContext(),
-      getContext().getIdentifier(BuiltinName),
-      getContext().getI32Type()
-    );
-  }
-
 #pragma mark Parsing Sections
 
   /**
@@ -956,20 +1211,68 @@ public:
    * \endverbatim
    */
   ModuleDecl * parseModuleDecl() {
+    ReadContext Ctx;
+    Ctx.Start = Buffer.data();
+    Ctx.Ptr = Ctx.Start;
+    Ctx.End = Ctx.Start + Buffer.size();
+
+    uint32_t Magic = parseMagic(Ctx);
+    uint32_t Version = parseVersion(Ctx);
+
+    // Sections are scanned front to back once. Function bodies are
+    // decoded later and possibly out of order, so the hint is reset
+    // afterwards to keep the read-ahead from evicting them.
+    adviseMemoryAccess(Buffer, MemoryAccess::Sequential);
     llvm::SmallVector<SectionDecl *> SectionDecls;
-    parseSectionDecls(SectionDecls);
+    parseSectionDecls(Ctx, SectionDecls);
+    adviseMemoryAccess(Buffer, MemoryAccess::Normal);
     StringRef Filename = Parser->File.getFilename();
     Identifier ModuleName = getContext().getIdentifier(Filename);
     ModuleDecl * Mod =
       ModuleDecl::create(ModuleName, Parser->File.getASTContext());
+    Mod->setMagic(Magic);
+    Mod->setVersion(Version);
     for (auto& EachSectionDecl : SectionDecls) {
       Mod->addSectionDecl(EachSectionDecl);
     }
     return Mod;
   }
 
+  /**
+   * @note
+   * \verbatim
+   *  magic:
+   *    0x00 0x61 0x73 0x6D
+   * \endverbatim
+   */
+  uint32_t parseMagic(ReadContext& Ctx) {
+    const size_t MagicSize = sizeof(llvm::wasm::WasmMagic);
+    if (Ctx.Ptr + MagicSize > Ctx.End) {
+      llvm_unreachable("EOF while reading magic");
+    }
+    if (memcmp(Ctx.Ptr, llvm::wasm::WasmMagic, MagicSize) != 0) {
+      llvm_unreachable("invalid magic number");
+    }
+    return readUint32(Ctx);
+  }
+
+  /**
+   * @note
+   * \verbatim
+   *  version:
+   *    0x01 0x00 0x00 0x00
+   * \endverbatim
+   */
+  uint32_t parseVersion(ReadContext& Ctx) {
+    uint32_t Version = readUint32(Ctx);
+    if (Version != llvm::wasm::WasmVersion) {
+      llvm_unreachable("invalid version number");
+    }
+    return Version;
+  }
+
   CustomSectionDecl * parseCustomSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     if (Section.Name == "name") {
       return parseNameSectionDecl(Section, Ctx, SectionIdx);
@@ -978,7 +1281,7 @@ public:
   }
 
   NameSectionDecl * parseNameSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     if (Ctx.Ptr == Ctx.End) {
       return NameSectionDecl::create(
@@ -1071,7 +1374,7 @@ public:
   }
 
   TypeSectionDecl * parseTypeSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     uint32_t Count = readVaruint32(Ctx);
     NumTypes = Count;
@@ -1094,7 +1397,7 @@ public:
   }
 
   ImportSectionDecl * parseImportSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     std::vector<ImportDecl *> Imports = parseVector<ImportDecl *>(Ctx);
     if (Ctx.Ptr != Ctx.End) {
@@ -1104,7 +1407,7 @@ public:
   }
 
   FuncSectionDecl * parseFuncSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     std::vector<uint32_t> Functions = parseVector<uint32_t>(Ctx);
     if (Ctx.Ptr != Ctx.End) {
@@ -1114,7 +1417,7 @@ public:
   }
 
   TableSectionDecl * parseTableSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     TableSection = SectionIdx;
     std::vector<TableDecl *> Tables = parseVector<TableDecl *>(Ctx);
@@ -1125,7 +1428,7 @@ public:
   }
 
   MemorySectionDecl * parseMemorySectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     std::vector<MemoryDecl *> Mems = parseVector<MemoryDecl *>(Ctx);
     if (Ctx.Ptr != Ctx.End) {
@@ -1135,7 +1438,7 @@ public:
   }
 
   GlobalSectionDecl * parseGlobalSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     GlobalSection = SectionIdx;
     std::vector<GlobalDecl *> Globals = parseVector<GlobalDecl *>(Ctx);
@@ -1146,7 +1449,7 @@ public:
   }
 
   ExportSectionDecl * parseExportSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     std::vector<ExportDecl *> Exports = parseVector<ExportDecl *>(Ctx);
     if (Ctx.Ptr != Ctx.End) {
@@ -1155,23 +1458,75 @@ public:
     return ExportSectionDecl::create(getContext(), Exports);
   }
 
+  /**
+   * @brief Parses the index of the function a start section calls once
+   * the module is instantiated.
+   *
+   * @note
+   * \verbatim
+   *  start-section:
+   *    x:funcidx
+   * \endverbatim
+   */
   StartSectionDecl * parseStartSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
-    w2n_unimplemented();
+    uint32_t FunctionIndex = readVaruint32(Ctx);
+    if (Ctx.Ptr != Ctx.End) {
+      llvm_unreachable("start section ended prematurely");
+    }
+    return StartSectionDecl::create(getContext(), FunctionIndex);
   }
 
   ElementSectionDecl * parseElementSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
-    w2n_unimplemented();
+    std::vector<ElementSegmentDecl *> Segments =
+      parseVector<ElementSegmentDecl *>(Ctx);
+    if (Ctx.Ptr != Ctx.End) {
+      llvm_unreachable("element section ended prematurely");
+    }
+    return ElementSectionDecl::create(getContext(), Segments);
   }
 
+  /**
+   * @brief Parses the code section.
+   *
+   * Each function body is prefixed with its size, so only the boundaries
+   * of the bodies are recorded here. The bodies are decoded on demand by
+   * \c ParseFuncBodyRequest , or in bulk by
+   * \c WasmParser::parseFuncDecls .
+   *
+   * @note
+   * \verbatim
+   *  code-section:
+   *    vec(code)
+   *  code:
+   *    size:u32 func
+   * \endverbatim
+   */
   CodeSectionDecl * parseCodeSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     CodeSection = SectionIdx;
-    std::vector<CodeDecl *> Codes = parseVector<CodeDecl *>(Ctx);
+    // Only the size prefixes are touched here, but all the bodies are
+    // decoded soon after.
+    adviseMemoryAccess(
+      ArrayRef<uint8_t>(Ctx.Ptr, Ctx.End), MemoryAccess::WillNeed
+    );
+    uint32_t Count = readVaruint32(Ctx);
+    std::vector<CodeDecl *> Codes;
+    Codes.reserve(Count);
+    for (uint32_t I = 0; I < Count; I++) {
+      uint32_t Size = readVaruint32(Ctx);
+      if (Size > (size_t)(Ctx.End - Ctx.Ptr)) {
+        llvm_unreachable("function body too large");
+      }
+      Codes.push_back(
+        CodeDecl::create(getContext(), ArrayRef<uint8_t>(Ctx.Ptr, Size))
+      );
+      Ctx.Ptr += Size;
+    }
     // FIXME: FunctionCount != Functions.size() -> "invalid fn count"
     if (Ctx.Ptr != Ctx.End) {
       llvm_unreachable("code section ended prematurely");
@@ -1179,8 +1534,29 @@ public:
     return CodeSectionDecl::create(getContext(), Codes);
   }
 
+  /**
+   * @brief Parses a function body recorded by a \c CodeDecl .
+   *
+   * @note
+   * \verbatim
+   *  func:
+   *    vec(locals) expr
+   * \endverbatim
+   */
+  FuncDecl * parseFuncBody(ArrayRef<uint8_t> Body) {
+    ReadContext Ctx;
+    Ctx.Start = Body.data();
+    Ctx.Ptr = Ctx.Start;
+    Ctx.End = Ctx.Start + Body.size();
+    FuncDecl * Func = parse<FuncDecl *>(Ctx);
+    if (Ctx.Ptr != Ctx.End) {
+      llvm_unreachable("function body ended prematurely");
+    }
+    return Func;
+  }
+
   DataSectionDecl * parseDataSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     DataSection = SectionIdx;
     /// FIXME: \c Validate vector count with DataCountSection's data;
@@ -1193,7 +1569,7 @@ public:
   }
 
   DataCountSectionDecl * parseDataCountSectionDecl(
-    const WasmSection& Section, ReadContext& Ctx, size_t SectionIdx
+    const WasmSectionRef& Section, ReadContext& Ctx, size_t SectionIdx
   ) {
     w2n_unimplemented();
   }
@@ -1208,7 +1584,7 @@ public:
    * \endverbatim
    */
   SectionDecl *
-  parseSectionDecl(const WasmSection& Section, size_t SectionIdx) {
+  parseSectionDecl(const WasmSectionRef& Section, size_t SectionIdx) {
     ReadContext Ctx;
     Ctx.Start = Section.Content.data();
     Ctx.End = Ctx.Start + Section.Content.size();
@@ -1219,28 +1595,79 @@ public:
 #define CUSTOM_SECTION_DECL(Id, Parent)
 #define SECTION_DECL(Id, _)                                              \
   case SectionKindImmediate::Id:                                         \
-    llvm::errs() << "Parse " << #Id << "\n";                             \
+    W2N_TRACE(Parse, Info, "section", {"kind", #Id});                   \
     Parsed##Id##Decl = parse##Id##Decl(Section, Ctx, SectionIdx);        \
     return Parsed##Id##Decl;
 #include <w2n/AST/DeclNodes.def>
     case SectionKindImmediate::CustomSection:
-      llvm::errs() << "Parse CustomSection\n";
+      W2N_TRACE(
+        Parse,
+        Info,
+        "section",
+        {"kind", "CustomSection"},
+        {"name", Section.Name}
+      );
       return parseCustomSectionDecl(Section, Ctx, SectionIdx);
     }
     llvm_unreachable("unknown section type");
   }
 
-  void parseSectionDecls(llvm::SmallVectorImpl<SectionDecl *>& Sections) {
-    section_iterator CurrentSect = WasmObject->section_begin();
-    const section_iterator SectEnd = WasmObject->section_end();
+  /**
+   * @brief Reads the framing of the next section in place: the section
+   * id, the size and, for custom sections, the name. \p Ctx is advanced
+   * to the end of the section.
+   *
+   * @note
+   * \verbatim
+   *  section:
+   *    section-id:byte size:u32 content:byte{size}
+   *  custom-section-content:
+   *    name byte*
+   * \endverbatim
+   */
+  WasmSectionRef parseSectionRef(ReadContext& Ctx) {
+    WasmSectionRef Section;
+    Section.Type = readUint8(Ctx);
+    uint32_t Size = readVaruint32(Ctx);
+    if (Size > (size_t)(Ctx.End - Ctx.Ptr)) {
+      llvm_unreachable("section too large");
+    }
+    ReadContext SectionCtx;
+    SectionCtx.Start = Ctx.Ptr;
+    SectionCtx.Ptr = Ctx.Ptr;
+    SectionCtx.End = Ctx.Ptr + Size;
+    Ctx.Ptr += Size;
+    if (Section.Type == llvm::wasm::WASM_SEC_CUSTOM) {
+      Section.Name = readString(SectionCtx);
+    }
+    Section.Content = ArrayRef<uint8_t>(
+      SectionCtx.Ptr, (size_t)(SectionCtx.End - SectionCtx.Ptr)
+    );
+    return Section;
+  }
+
+  void parseSectionDecls(
+    ReadContext& Ctx, llvm::SmallVectorImpl<SectionDecl *>& Sections
+  ) {
     size_t SectionIdx = 0;
-    while (CurrentSect != SectEnd) {
-      const auto& Section = WasmObject->getWasmSection(*CurrentSect);
+    uint32_t LastSectionOrder = 0;
+    while (Ctx.Ptr < Ctx.End) {
+      WasmSectionRef Section = parseSectionRef(Ctx);
+      if (Section.Type > llvm::wasm::WASM_SEC_LAST_KNOWN) {
+        llvm_unreachable("unknown section type");
+      }
+      auto Kind = (SectionKindImmediate)Section.Type;
+      if (Kind != SectionKindImmediate::CustomSection) {
+        uint32_t SectionOrder = getSectionOrder(Kind);
+        if (SectionOrder <= LastSectionOrder) {
+          llvm_unreachable("out of order section type");
+        }
+        LastSectionOrder = SectionOrder;
+      }
       SectionDecl * SectionDecl = parseSectionDecl(Section, SectionIdx);
       if (SectionDecl != nullptr) {
         Sections.push_back(SectionDecl);
       }
-      CurrentSect = CurrentSect.operator++();
       SectionIdx++;
     }
   }
@@ -1257,13 +1684,10 @@ WasmParser::WasmParser(
   File(SF),
   SourceMgr(SF.getASTContext().SourceMgr),
   LexerDiags(LexerDiags) {
-  StringRef Filename = SF.getFilename();
   StringRef Contents =
     SourceMgr.extractText(SourceMgr.getRangeForBuffer(BufferID));
-  auto Object = llvm::MemoryBufferRef(Contents, Filename);
-  auto ObjectFile =
-    llvm::cantFail(ObjectFile::createWasmObjectFile(Object));
-  getImpl().WasmObject = std::move(ObjectFile);
+  getImpl().Context = &SF.getASTContext();
+  getImpl().Buffer = llvm::arrayRefFromStringRef(Contents);
 }
 
 std::unique_ptr<WasmParser> WasmParser::createWasmParser(
@@ -1282,6 +1706,55 @@ WasmParser::~WasmParser() {
   getImpl().~Implementation();
 }
 
+FuncDecl *
+WasmParser::parseFuncDecl(ASTContext& Ctx, ArrayRef<uint8_t> Body) {
+  Implementation Impl(nullptr);
+  Impl.Context = &Ctx;
+  return Impl.parseFuncBody(Body);
+}
+
+void WasmParser::parseFuncDecls(
+  ASTContext& Ctx, ArrayRef<CodeDecl *> Codes
+) {
+  std::vector<CodeDecl *> Unparsed;
+  Unparsed.reserve(Codes.size());
+  for (CodeDecl * Code : Codes) {
+    if (!Code->isParsed()) {
+      Unparsed.push_back(Code);
+    }
+  }
+
+  auto ParseCode = [&Ctx](CodeDecl * Code) {
+    Code->Func = parseFuncDecl(Ctx, Code->getBody());
+  };
+
+  if (Unparsed.size() < MinParallelFuncCount) {
+    for (CodeDecl * Code : Unparsed) {
+      ParseCode(Code);
+    }
+  } else {
+    // Each task decodes into an arena of its own, which the context
+    // adopts once the pool has finished.
+    ASTContext::TaskArenas Arenas(Ctx);
+    llvm::ThreadPool Pool(llvm::hardware_concurrency());
+    for (CodeDecl * Code : Unparsed) {
+      Pool.async(
+        [&](CodeDecl * Code) {
+          ASTContext::TaskArenas::Scope Arena(Arenas);
+          ParseCode(Code);
+        },
+        Code
+      );
+    }
+    Pool.wait();
+  }
+
+  if (Ctx.Stats != nullptr) {
+    Ctx.Stats->getFrontendCounters().NumFunctionsParsed +=
+      Unparsed.size();
+  }
+}
+
 /**
  * @brief Main entrypoint for the parser.
  *
@@ -1 +1,173 @@
+#include <llvm/Support/Compiler.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
 #include <w2n/Runtime/Runtime.h>
+
+#if LLVM_ON_UNIX
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__x86_64__)
+#include <asm/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+/// The size of a WebAssembly page.
+constexpr uint64_t WasmPageSize = 64 * 1024;
+
+/// The address ranges reserved for memories. The trap handler reads them
+/// from a signal handler, so they live in a fixed-size lock-free table.
+struct Reservation {
+  std::atomic<uintptr_t> Begin;
+  std::atomic<uintptr_t> End;
+};
+
+constexpr unsigned MaxReservations = 64;
+
+Reservation Reservations[MaxReservations];
+
+std::atomic<unsigned> ReservationCount(0);
+
+[[noreturn]] void fail(const char * Message) {
+  fprintf(stderr, "w2n runtime: %s\n", Message);
+  abort();
+}
+
+bool isReserved(uintptr_t Addr) {
+  unsigned Count = std::min(ReservationCount.load(), MaxReservations);
+  for (unsigned I = 0; I < Count; I++) {
+    if (Addr >= Reservations[I].Begin.load()
+        && Addr < Reservations[I].End.load()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void addReservation(uintptr_t Begin, uintptr_t End) {
+  unsigned I = ReservationCount.fetch_add(1);
+  if (I >= MaxReservations) {
+    fail("too many memories");
+  }
+  Reservations[I].Begin.store(Begin);
+  Reservations[I].End.store(End);
+}
+
+#if LLVM_ON_UNIX
+
+struct sigaction PreviousSEGVAction;
+
+struct sigaction PreviousBUSAction;
+
+/// Turns faults in the inaccessible part of a memory into a trap, and
+/// forwards the others to the handler installed before.
+void handleFault(int Signal, siginfo_t * Info, void * Context) {
+  if (isReserved(reinterpret_cast<uintptr_t>(Info->si_addr))) {
+    static const char Message[] =
+      "w2n runtime: trap: out of bounds memory access\n";
+    (void)!write(STDERR_FILENO, Message, sizeof(Message) - 1);
+    abort();
+  }
+  // Returning re-executes the faulting instruction with the previous
+  // handler in place.
+  sigaction(
+    Signal,
+    Signal == SIGSEGV ? &PreviousSEGVAction : &PreviousBUSAction,
+    nullptr
+  );
+}
+
+void installTrapHandler() {
+  struct sigaction Action = {};
+  Action.sa_sigaction = handleFault;
+  Action.sa_flags = SA_SIGINFO | SA_NODEFER;
+  sigemptyset(&Action.sa_mask);
+  sigaction(SIGSEGV, &Action, &PreviousSEGVAction);
+  // Darwin raises SIGBUS for accesses to inaccessible pages.
+  sigaction(SIGBUS, &Action, &PreviousBUSAction);
+}
+
+#endif
+
+} // namespace
+
+void w2n_memory_init(
+  w2n_memory * M, uint64_t Size, uint64_t ReservedSize
+) {
+  ReservedSize = std::max(Size, ReservedSize);
+  M->base = nullptr;
+  M->size = Size;
+  if (ReservedSize == 0) {
+    return;
+  }
+
+#if LLVM_ON_UNIX
+  static std::once_flag TrapHandlerInstalled;
+  std::call_once(TrapHandlerInstalled, installTrapHandler);
+
+  void * Base = mmap(
+    nullptr,
+    ReservedSize,
+    PROT_NONE,
+    MAP_PRIVATE | MAP_ANON | MAP_NORESERVE,
+    -1,
+    0
+  );
+  if (Base == MAP_FAILED) {
+    fail("cannot reserve the address space of a memory");
+  }
+  if (Size != 0 && mprotect(Base, Size, PROT_READ | PROT_WRITE) != 0) {
+    fail("cannot map a memory");
+  }
+  M->base = static_cast<uint8_t *>(Base);
+  addReservation(
+    reinterpret_cast<uintptr_t>(Base),
+    reinterpret_cast<uintptr_t>(Base) + ReservedSize
+  );
+#else
+  // TODO: Reserve address space with VirtualAlloc on Windows.
+  M->base = static_cast<uint8_t *>(calloc(1, ReservedSize));
+  if (M->base == nullptr) {
+    fail("cannot allocate a memory");
+  }
+#endif
+}
+
+void w2n_memory_set_segment_base(const w2n_memory * M) {
+#if defined(__linux__) && defined(__x86_64__)
+  // WRGSBASE would be cheaper, but it needs both CPU and kernel support.
+  // The base is set once per thread, so the system call does not matter.
+  if (syscall(SYS_arch_prctl, ARCH_SET_GS, M->base) != 0) {
+    fail("cannot set the segment base of a memory");
+  }
+#else
+  fail("memory segment bases are not supported on this target");
+#endif
+}
+
+int32_t
+w2n_memory_grow(w2n_memory * M, uint32_t Delta, uint64_t MaxSize) {
+  uint64_t Size = M->size;
+  uint64_t NewSize = Size + uint64_t(Delta) * WasmPageSize;
+  if (NewSize > MaxSize) {
+    return -1;
+  }
+#if LLVM_ON_UNIX
+  if (NewSize != Size
+      && mprotect(M->base + Size, NewSize - Size, PROT_READ | PROT_WRITE)
+           != 0) {
+    return -1;
+  }
+#else
+  // The reserved bytes are allocated zeroed up front.
+#endif
+  M->size = NewSize;
+  return static_cast<int32_t>(Size / WasmPageSize);
+}
@@ -0,0 +1,145 @@
+//===--- Reachability.cpp - Reachable Functions ---------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// This file implements the search for the functions of a module which
+// can be called once it is instantiated. The other functions are not
+// emitted, and their bodies are not even decoded when only the reachable
+// functions are validated.
+//
+// The search goes in waves: the bodies of the functions reached by the
+// previous wave are decoded together, on a thread pool when there are
+// enough of them, and then scanned for the functions they call.
+//
+//===----------------------------------------------------------------===//
+
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/SmallVector.h>
+#include <vector>
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Expr.h>
+#include <w2n/AST/Function.h>
+#include <w2n/AST/InstStream.h>
+#include <w2n/AST/Module.h>
+#include <w2n/AST/ModuleIndex.h>
+#include <w2n/AST/Stmt.h>
+#include <w2n/AST/TypeCheckerRequests.h>
+#include <w2n/Basic/Debug.h>
+#include <w2n/Parse/Parser.h>
+
+using namespace w2n;
+
+/// Calls \p Visit with the index of each function \p E calls directly.
+///
+/// The bodies of structured instructions are kept on a worklist rather
+/// than visited by recursion, as deeply nested input would overflow the
+/// host stack.
+static void forEachCallee(
+  const ExpressionDecl * E, llvm::function_ref<void(uint32_t)> Visit
+) {
+  if (E->hasInstStream()) {
+    for (InstRef Inst : *E->getInstStream()) {
+      if (Inst.getInfo().Node == InstNodeKind::Call) {
+        Visit(Inst.getIndexImmediate());
+      }
+    }
+    return;
+  }
+
+  llvm::SmallVector<ArrayRef<InstNode>, 8> Worklist;
+  Worklist.push_back(E->getInstructions());
+  while (!Worklist.empty()) {
+    for (InstNode Node : Worklist.pop_back_val()) {
+      if (auto * Child = Node.dyn_cast<Expr *>()) {
+        if (auto * Call = dyn_cast<CallExpr>(Child)) {
+          Visit(Call->getFuncIndex());
+        }
+        continue;
+      }
+      auto * S = Node.get<Stmt *>();
+      if (auto * Block = dyn_cast<BlockStmt>(S)) {
+        Worklist.push_back(Block->getInstructions());
+      } else if (auto * Loop = dyn_cast<LoopStmt>(S)) {
+        Worklist.push_back(Loop->getInstructions());
+      } else if (auto * If = dyn_cast<IfStmt>(S)) {
+        Worklist.push_back(If->getTrueInstructions());
+        if (auto False = If->getFalseInstructions()) {
+          Worklist.push_back(*False);
+        }
+      }
+    }
+  }
+}
+
+ReachableFunctionRequest::OutputType ReachableFunctionRequest::evaluate(
+  Evaluator& Eval, ModuleDecl * Mod
+) const {
+  assert(Mod);
+  const ModuleIndex& Index = Mod->getModuleIndex();
+  uint32_t FunctionCount =
+    Index.getImportedFunctionCount() + Mod->getFunctionList().size();
+
+  auto Reachable = std::make_shared<llvm::BitVector>(FunctionCount);
+  std::vector<Function *> Reached;
+  auto Reach = [&](uint32_t FuncIndex) {
+    // Validation diagnoses the indices out of range.
+    if (FuncIndex >= FunctionCount || Reachable->test(FuncIndex)) {
+      return;
+    }
+    Reachable->set(FuncIndex);
+    Function * F = Mod->getFunction(FuncIndex);
+    if (F != nullptr && F->getCode() != nullptr) {
+      Reached.push_back(F);
+    }
+  };
+
+  for (uint32_t I = 0; I < FunctionCount; I++) {
+    if (Index.isFunctionExported(I)) {
+      Reach(I);
+    }
+  }
+  // Any element of a table may be the target of a call_indirect, and the
+  // elements of the other segments are read by table.init and ref.func.
+  if (auto * Section = Mod->getElementSection()) {
+    for (ElementSegmentDecl * Segment : Section->getElementSegments()) {
+      for (uint32_t FuncIndex : Segment->getFunctionIndices()) {
+        Reach(FuncIndex);
+      }
+    }
+  }
+  // The start function runs once the module is instantiated.
+  if (auto * Section = Mod->getStartSection()) {
+    Reach(Section->getFunctionIndex());
+  }
+
+  ASTContext& Ctx = Mod->getASTContext();
+  while (!Reached.empty()) {
+    std::vector<Function *> Wave;
+    std::swap(Wave, Reached);
+    std::vector<CodeDecl *> Codes;
+    Codes.reserve(Wave.size());
+    for (Function * F : Wave) {
+      Codes.push_back(F->getCode());
+    }
+    WasmParser::parseFuncDecls(Ctx, Codes);
+    for (Function * F : Wave) {
+      forEachCallee(F->getExpression(), Reach);
+    }
+  }
+
+  W2N_TRACE(
+    AST, Info, "reachable-functions", {"count", Reachable->count()}
+  );
+
+  return Reachable;
+}
@@ -1,12 +1,54 @@
+#include <llvm/ADT/SmallVector.h>
 #include <w2n/AST/ASTContext.h>
+#include <w2n/AST/DiagnosticsSema.h>
+#include <w2n/AST/FunctionValidation.h>
+#include <w2n/AST/Module.h>
 #include <w2n/AST/SourceFile.h>
+#include <w2n/AST/TypeCheckerRequests.h>
 #include <w2n/Sema/Sema.h>
+#include <w2n/Sema/TypeCheck.h>
 
 using namespace w2n;
 
 void w2n::performTypeChecking(SourceFile& SF) {
-  // TODO: Type checking
-  // return (void)evaluateOrDefault(
-  //   SF.getASTContext().Eval, TypeCheckSourceFileRequest{&SF}, {}
-  // );
+  ASTContext& Ctx = SF.getASTContext();
+  for (Decl * D : SF.getTopLevelDecls()) {
+    ModuleDecl * M = dyn_cast<ModuleDecl>(D);
+    if (M == nullptr) {
+      continue;
+    }
+
+    llvm::SmallVector<Function *, 64> Functions;
+    for (GlobalVariable& V : M->getGlobals()) {
+      if (Function * Init = V.getInit()) {
+        Functions.push_back(Init);
+      }
+    }
+    // A module with an invalid body is invalid even if the function
+    // cannot be called, unless only the reachable functions are asked
+    // for, whose bodies are the only ones decoded then.
+    bool ReachableOnly = Ctx.LangOpts.ValidateReachableFunctionsOnly;
+    for (Function& F : M->getFunctions()) {
+      if (F.getCode() != nullptr
+          && (!ReachableOnly || M->isFunctionReachable(F.getIndex()))) {
+        Functions.push_back(&F);
+      }
+    }
+    validateFunctions(Ctx, Functions);
+
+    // Diagnose in order, after all the functions have been validated.
+    for (Function * F : Functions) {
+      const FunctionValidation * Validation = evaluateOrDefault(
+        Ctx.Eval, ValidateFunctionRequest{F}, nullptr
+      );
+      if (Validation != nullptr && !Validation->isValid()) {
+        Ctx.Diags.diagnose(
+          SourceLoc(),
+          diag::invalid_function_body,
+          F->getDescriptiveName(),
+          Validation->getError()
+        );
+      }
+    }
+  }
 }
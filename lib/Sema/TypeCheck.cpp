@@ -0,0 +1,1075 @@
+//===--- TypeCheck.cpp - Function Body Validation -------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2017 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+//
+// This file implements the validation of function bodies and global init
+// expressions, following the validation algorithm of the appendix of the
+// WebAssembly specification: a single pass over the instructions with a
+// stack of operand types and a stack of control frames.
+//
+// Both encodings of an expression are validated by the same checks. The
+// nodes of structured instructions are visited through the control
+// frames rather than by recursion, so the nesting depth of the input is
+// bounded by the heap instead of the host stack.
+//
+//===----------------------------------------------------------------===//
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/Decl.h>
+#include <w2n/AST/Expr.h>
+#include <w2n/AST/Function.h>
+#include <w2n/AST/FunctionValidation.h>
+#include <w2n/AST/InstStream.h>
+#include <w2n/AST/Instructions.h>
+#include <w2n/AST/Module.h>
+#include <w2n/AST/Stmt.h>
+#include <w2n/AST/TypeCheckerRequests.h>
+#include <w2n/Basic/Statistic.h>
+#include <w2n/Parse/Parser.h>
+#include <w2n/Sema/TypeCheck.h>
+
+using namespace w2n;
+
+namespace {
+
+/// Stands for an operand of any type, which is what popping from the
+/// operand stack yields in unreachable code.
+constexpr ValueTypeKind UnknownType = ValueTypeKind::None;
+
+StringRef getValueTypeName(ValueTypeKind Kind) {
+  switch (Kind) {
+  case ValueTypeKind::I32: return "i32";
+  case ValueTypeKind::I64: return "i64";
+  case ValueTypeKind::F32: return "f32";
+  case ValueTypeKind::F64: return "f64";
+  case ValueTypeKind::V128: return "v128";
+  case ValueTypeKind::FuncRef: return "funcref";
+  case ValueTypeKind::ExternRef: return "externref";
+  case ValueTypeKind::None: return "unknown";
+  default: return "invalid";
+  }
+}
+
+/// Returns the binary logarithm of the natural alignment of an access to
+/// a value of \p Kind in memory.
+unsigned getNaturalAlignment(ValueTypeKind Kind) {
+  switch (Kind) {
+  case ValueTypeKind::I8:
+  case ValueTypeKind::U8: return 0;
+  case ValueTypeKind::I16:
+  case ValueTypeKind::U16: return 1;
+  case ValueTypeKind::I32:
+  case ValueTypeKind::U32:
+  case ValueTypeKind::F32: return 2;
+  case ValueTypeKind::I64:
+  case ValueTypeKind::U64:
+  case ValueTypeKind::F64: return 3;
+  case ValueTypeKind::V128: return 4;
+  default: llvm_unreachable("not a memory type");
+  }
+}
+
+StringRef getInstName(InstNodeKind Kind) {
+  switch (Kind) {
+  case InstNodeKind::Unreachable: return "unreachable";
+  case InstNodeKind::Nop: return "nop";
+  case InstNodeKind::Block: return "block";
+  case InstNodeKind::Loop: return "loop";
+  case InstNodeKind::If: return "if";
+  case InstNodeKind::Else: return "else";
+  case InstNodeKind::End: return "end";
+  case InstNodeKind::Br: return "br";
+  case InstNodeKind::BrIf: return "br_if";
+  case InstNodeKind::BrTable: return "br_table";
+  case InstNodeKind::Return: return "return";
+  case InstNodeKind::Call: return "call";
+  case InstNodeKind::CallIndirect: return "call_indirect";
+  case InstNodeKind::Drop: return "drop";
+  case InstNodeKind::Select: return "select";
+  case InstNodeKind::LocalGet: return "local.get";
+  case InstNodeKind::LocalSet: return "local.set";
+  case InstNodeKind::LocalTee: return "local.tee";
+  case InstNodeKind::GlobalGet: return "global.get";
+  case InstNodeKind::GlobalSet: return "global.set";
+  case InstNodeKind::Load: return "load";
+  case InstNodeKind::Store: return "store";
+  case InstNodeKind::MemorySize: return "memory.size";
+  case InstNodeKind::MemoryGrow: return "memory.grow";
+  case InstNodeKind::IntegerConst:
+  case InstNodeKind::FloatConst: return "const";
+  case InstNodeKind::Builtin: return "builtin";
+  case InstNodeKind::Invalid: break;
+  }
+  llvm_unreachable("invalid instruction");
+}
+
+InstNodeKind getInstNodeKind(Stmt * S) {
+  switch (S->getKind()) {
+#define STMT(Id, Parent)                                                 \
+  case StmtKind::Id:                                                     \
+    return InstNodeKind::Id;
+#include <w2n/AST/StmtNodes.def>
+  }
+  llvm_unreachable("unexpected StmtKind");
+}
+
+InstNodeKind getInstNodeKind(Expr * E) {
+  switch (E->getKind()) {
+  case ExprKind::Call: return InstNodeKind::Call;
+  case ExprKind::CallIndirect: return InstNodeKind::CallIndirect;
+  case ExprKind::Drop: return InstNodeKind::Drop;
+  case ExprKind::Select: return InstNodeKind::Select;
+  case ExprKind::LocalGet: return InstNodeKind::LocalGet;
+  case ExprKind::LocalSet: return InstNodeKind::LocalSet;
+  case ExprKind::LocalTee: return InstNodeKind::LocalTee;
+  case ExprKind::GlobalGet: return InstNodeKind::GlobalGet;
+  case ExprKind::GlobalSet: return InstNodeKind::GlobalSet;
+  case ExprKind::Load: return InstNodeKind::Load;
+  case ExprKind::Store: return InstNodeKind::Store;
+  case ExprKind::MemorySize: return InstNodeKind::MemorySize;
+  case ExprKind::MemoryGrow: return InstNodeKind::MemoryGrow;
+  case ExprKind::IntegerConst: return InstNodeKind::IntegerConst;
+  case ExprKind::FloatConst: return InstNodeKind::FloatConst;
+  case ExprKind::CallBuiltin: return InstNodeKind::Builtin;
+  }
+  llvm_unreachable("unexpected ExprKind");
+}
+
+void appendValueTypes(
+  const ResultType * Ty, SmallVectorImpl<ValueTypeKind>& Types
+) {
+  for (const ValueType * T : Ty->getValueTypes()) {
+    Types.push_back(T->getValueTypeKind());
+  }
+}
+
+/// The declarations of a module that function bodies refer to by index.
+///
+/// Every lookup reads sections that are immutable once the module is
+/// parsed, so functions of the same module can be validated
+/// concurrently.
+class ModuleInfo {
+  const ModuleDecl * Mod;
+
+  const TypeSectionDecl * Types;
+
+  const FuncSectionDecl * Funcs;
+
+  const GlobalSectionDecl * Globals;
+
+  size_t TableCount = 0;
+
+  size_t MemoryCount = 0;
+
+public:
+
+  explicit ModuleInfo(const ModuleDecl * Mod) :
+    Mod(Mod),
+    Types(Mod->getTypeSection()),
+    Funcs(Mod->getFuncSection()),
+    Globals(Mod->getGlobalSection()) {
+    if (const auto * Tables = Mod->getTableSection()) {
+      TableCount = Tables->getTables().size();
+    }
+    if (const auto * Memories = Mod->getMemorySection()) {
+      MemoryCount = Memories->getMemories().size();
+    }
+  }
+
+  const ModuleDecl * getModule() const {
+    return Mod;
+  }
+
+  const FuncType * getType(uint32_t TypeIndex) const {
+    if (Types == nullptr || TypeIndex >= Types->getTypes().size()) {
+      return nullptr;
+    }
+    return Types->getTypes()[TypeIndex]->getType();
+  }
+
+  const FuncType * getFuncType(uint32_t FuncIndex) const {
+    if (Funcs == nullptr || FuncIndex >= Funcs->getFuncTypes().size()) {
+      return nullptr;
+    }
+    return getType(Funcs->getFuncTypes()[FuncIndex]);
+  }
+
+  const GlobalType * getGlobalType(uint32_t GlobalIndex) const {
+    if (Globals == nullptr
+        || GlobalIndex >= Globals->getGlobals().size()) {
+      return nullptr;
+    }
+    return Globals->getGlobals()[GlobalIndex]->getType();
+  }
+
+  bool hasTable(uint32_t TableIndex) const {
+    return TableIndex < TableCount;
+  }
+
+  bool hasMemory() const {
+    return MemoryCount > 0;
+  }
+};
+
+class FunctionValidator {
+  struct ControlFrame {
+    InstNodeKind Kind;
+    SmallVector<ValueTypeKind, 2> StartTypes;
+    SmallVector<ValueTypeKind, 2> EndTypes;
+    /// The height of the operand stack when the frame was entered.
+    size_t Height;
+    bool Unreachable = false;
+    bool HasElse = false;
+    /// The nodes of the frame that are not visited yet.
+    ArrayRef<InstNode> Rest;
+    /// The nodes of the false arm of an \c if , until the true arm is
+    /// visited.
+    Optional<ArrayRef<InstNode>> FalseArm;
+
+    ArrayRef<ValueTypeKind> getLabelTypes() const {
+      return Kind == InstNodeKind::Loop ? StartTypes : EndTypes;
+    }
+  };
+
+  const ModuleInfo& Module;
+
+  Function * Fn;
+
+  /// The types of the parameters and the locals, one entry per group of
+  /// locals of the same type.
+  SmallVector<ValueTypeKind, 16> LocalTypes;
+
+  /// The index past the last local of each group in \c LocalTypes .
+  SmallVector<uint64_t, 16> LocalEnds;
+
+  SmallVector<ValueTypeKind, 32> Operands;
+
+  SmallVector<ControlFrame, 16> Controls;
+
+  StringRef CurrentInst;
+
+  std::string Error;
+
+  bool fail(const Twine& Message) {
+    if (CurrentInst.empty()) {
+      Error = Message.str();
+    } else {
+      Error = (Message + " in " + CurrentInst).str();
+    }
+    return false;
+  }
+
+#pragma mark Operand Stack
+
+  void push(ValueTypeKind Type) {
+    Operands.push_back(Type);
+  }
+
+  void push(ArrayRef<ValueTypeKind> Types) {
+    for (ValueTypeKind Type : Types) {
+      push(Type);
+    }
+  }
+
+  bool pop(ValueTypeKind& Type) {
+    const ControlFrame& Frame = Controls.back();
+    if (Operands.size() == Frame.Height) {
+      if (Frame.Unreachable) {
+        Type = UnknownType;
+        return true;
+      }
+      return fail("operand stack underflow");
+    }
+    Type = Operands.pop_back_val();
+    return true;
+  }
+
+  bool popExpecting(ValueTypeKind Expected) {
+    ValueTypeKind Actual;
+    if (!pop(Actual)) {
+      return false;
+    }
+    if (Actual != Expected && Actual != UnknownType
+        && Expected != UnknownType) {
+      return fail(
+        Twine("type mismatch: expected ") + getValueTypeName(Expected)
+        + ", found " + getValueTypeName(Actual)
+      );
+    }
+    return true;
+  }
+
+  bool popExpecting(ArrayRef<ValueTypeKind> Types) {
+    for (ValueTypeKind Type : llvm::reverse(Types)) {
+      if (!popExpecting(Type)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+#pragma mark Control Stack
+
+  void pushControl(
+    InstNodeKind Kind,
+    ArrayRef<ValueTypeKind> StartTypes,
+    ArrayRef<ValueTypeKind> EndTypes,
+    ArrayRef<InstNode> Body = {}
+  ) {
+    ControlFrame Frame;
+    Frame.Kind = Kind;
+    Frame.StartTypes.assign(StartTypes.begin(), StartTypes.end());
+    Frame.EndTypes.assign(EndTypes.begin(), EndTypes.end());
+    Frame.Height = Operands.size();
+    Frame.Rest = Body;
+    Controls.push_back(std::move(Frame));
+    push(StartTypes);
+  }
+
+  /// Checks that the operand stack holds exactly the results of the
+  /// innermost frame, and pops them.
+  bool popFrameResults() {
+    const ControlFrame& Frame = Controls.back();
+    if (!popExpecting(ArrayRef<ValueTypeKind>(Frame.EndTypes))) {
+      return false;
+    }
+    if (Operands.size() != Frame.Height) {
+      return fail("values remaining on the operand stack");
+    }
+    return true;
+  }
+
+  void setUnreachable() {
+    ControlFrame& Frame = Controls.back();
+    Operands.truncate(Frame.Height);
+    Frame.Unreachable = true;
+  }
+
+  const ControlFrame * getLabel(uint32_t LabelIndex) {
+    if (LabelIndex >= Controls.size()) {
+      fail(Twine("unknown label ") + Twine(LabelIndex));
+      return nullptr;
+    }
+    return &Controls[Controls.size() - 1 - LabelIndex];
+  }
+
+  bool getLocalType(uint32_t LocalIndex, ValueTypeKind& Type) {
+    const auto * Group =
+      std::upper_bound(LocalEnds.begin(), LocalEnds.end(), LocalIndex);
+    if (Group == LocalEnds.end()) {
+      return fail(Twine("unknown local ") + Twine(LocalIndex));
+    }
+    Type = LocalTypes[Group - LocalEnds.begin()];
+    return true;
+  }
+
+  bool getBlockTypes(
+    const BlockType * Ty,
+    SmallVectorImpl<ValueTypeKind>& StartTypes,
+    SmallVectorImpl<ValueTypeKind>& EndTypes
+  ) {
+    BlockType::Types T = Ty->getType();
+    if (T.is<VoidType *>()) {
+      return true;
+    }
+    if (auto * ValueTy = T.dyn_cast<ValueType *>()) {
+      if (!isa<VoidType>(ValueTy)) {
+        EndTypes.push_back(ValueTy->getValueTypeKind());
+      }
+      return true;
+    }
+    uint32_t TypeIndex = T.get<TypeIndexType *>()->getTypeIndex();
+    const FuncType * FnTy = Module.getType(TypeIndex);
+    if (FnTy == nullptr) {
+      return fail(Twine("unknown type ") + Twine(TypeIndex));
+    }
+    appendValueTypes(FnTy->getParameters(), StartTypes);
+    appendValueTypes(FnTy->getReturns(), EndTypes);
+    return true;
+  }
+
+  bool collectLocals() {
+    uint64_t LocalCount = 0;
+    const FuncType * Ty = Fn->getType()->getType();
+    for (const auto * Param : Ty->getParameters()->getValueTypes()) {
+      LocalTypes.push_back(Param->getValueTypeKind());
+      LocalEnds.push_back(++LocalCount);
+    }
+    for (const auto * Local : Fn->getLocals()) {
+      LocalCount += Local->getCount();
+      if (LocalCount > UINT32_MAX) {
+        return fail("too many locals");
+      }
+      LocalTypes.push_back(Local->getType()->getValueTypeKind());
+      LocalEnds.push_back(LocalCount);
+    }
+    return true;
+  }
+
+#pragma mark Instructions
+
+  /// Checks that only constant instructions appear in the init
+  /// expression of a global.
+  bool checkConstant(InstNodeKind Kind) {
+    switch (Kind) {
+    case InstNodeKind::End:
+    case InstNodeKind::IntegerConst:
+    case InstNodeKind::FloatConst:
+    case InstNodeKind::GlobalGet: return true;
+    default: return fail("constant expression required");
+    }
+  }
+
+  /// Checks that the numeric instructions in the init expression of a
+  /// global are the integer \c add , \c sub and \c mul of the extended
+  /// constant expressions.
+  bool checkConstant(Instruction Opcode) {
+    switch (Opcode) {
+    case Instruction::I32Add:
+    case Instruction::I32Sub:
+    case Instruction::I32Mul:
+    case Instruction::I64Add:
+    case Instruction::I64Sub:
+    case Instruction::I64Mul: return true;
+    default: return fail("constant expression required");
+    }
+  }
+
+  bool visitStructured(InstNodeKind Kind, const BlockType * Ty) {
+    SmallVector<ValueTypeKind, 2> StartTypes;
+    SmallVector<ValueTypeKind, 2> EndTypes;
+    if (!getBlockTypes(Ty, StartTypes, EndTypes)) {
+      return false;
+    }
+    if (Kind == InstNodeKind::If && !popExpecting(ValueTypeKind::I32)) {
+      return false;
+    }
+    if (!popExpecting(ArrayRef<ValueTypeKind>(StartTypes))) {
+      return false;
+    }
+    pushControl(Kind, StartTypes, EndTypes);
+    return true;
+  }
+
+  bool visitElse() {
+    ControlFrame& Frame = Controls.back();
+    if (Frame.Kind != InstNodeKind::If || Frame.HasElse) {
+      return fail("else without matching if");
+    }
+    if (!popFrameResults()) {
+      return false;
+    }
+    Frame.HasElse = true;
+    Frame.Unreachable = false;
+    push(ArrayRef<ValueTypeKind>(Frame.StartTypes));
+    return true;
+  }
+
+  bool visitEnd() {
+    ControlFrame& Frame = Controls.back();
+    if (Frame.Kind == InstNodeKind::If && !Frame.HasElse
+        && Frame.StartTypes != Frame.EndTypes) {
+      return fail("type mismatch: if without else");
+    }
+    if (!popFrameResults()) {
+      return false;
+    }
+    SmallVector<ValueTypeKind, 2> EndTypes = std::move(Frame.EndTypes);
+    Controls.pop_back();
+    if (!Controls.empty()) {
+      push(EndTypes);
+    }
+    return true;
+  }
+
+  bool visitBr(uint32_t LabelIndex) {
+    const ControlFrame * Label = getLabel(LabelIndex);
+    if (Label == nullptr || !popExpecting(Label->getLabelTypes())) {
+      return false;
+    }
+    setUnreachable();
+    return true;
+  }
+
+  bool visitBrIf(uint32_t LabelIndex) {
+    if (!popExpecting(ValueTypeKind::I32)) {
+      return false;
+    }
+    const ControlFrame * Label = getLabel(LabelIndex);
+    if (Label == nullptr || !popExpecting(Label->getLabelTypes())) {
+      return false;
+    }
+    push(Label->getLabelTypes());
+    return true;
+  }
+
+  bool
+  visitBrTable(ArrayRef<uint32_t> LabelIndices, uint32_t DefaultLabel) {
+    if (!popExpecting(ValueTypeKind::I32)) {
+      return false;
+    }
+    const ControlFrame * Default = getLabel(DefaultLabel);
+    if (Default == nullptr) {
+      return false;
+    }
+    size_t Arity = Default->getLabelTypes().size();
+    for (uint32_t LabelIndex : LabelIndices) {
+      const ControlFrame * Label = getLabel(LabelIndex);
+      if (Label == nullptr) {
+        return false;
+      }
+      ArrayRef<ValueTypeKind> Types = Label->getLabelTypes();
+      if (Types.size() != Arity) {
+        return fail("type mismatch: labels of different arities");
+      }
+      // Check the operands against the label without consuming them. The
+      // operands popped from an unreachable frame take the label types.
+      size_t Height = Operands.size();
+      if (!popExpecting(Types)) {
+        return false;
+      }
+      size_t Popped = Height - Operands.size();
+      Operands.append(Types.end() - Popped, Types.end());
+    }
+    if (!popExpecting(Default->getLabelTypes())) {
+      return false;
+    }
+    setUnreachable();
+    return true;
+  }
+
+  bool visitReturn() {
+    const ControlFrame& Function = Controls.front();
+    if (!popExpecting(ArrayRef<ValueTypeKind>(Function.EndTypes))) {
+      return false;
+    }
+    setUnreachable();
+    return true;
+  }
+
+  bool visitCall(const FuncType * Ty) {
+    SmallVector<ValueTypeKind, 4> Params;
+    SmallVector<ValueTypeKind, 2> Results;
+    appendValueTypes(Ty->getParameters(), Params);
+    appendValueTypes(Ty->getReturns(), Results);
+    if (!popExpecting(ArrayRef<ValueTypeKind>(Params))) {
+      return false;
+    }
+    push(Results);
+    return true;
+  }
+
+  bool visitCall(uint32_t FuncIndex) {
+    const FuncType * Ty = Module.getFuncType(FuncIndex);
+    if (Ty == nullptr) {
+      return fail(Twine("unknown function ") + Twine(FuncIndex));
+    }
+    return visitCall(Ty);
+  }
+
+  bool visitCallIndirect(uint32_t TypeIndex, uint32_t TableIndex) {
+    if (!Module.hasTable(TableIndex)) {
+      return fail(Twine("unknown table ") + Twine(TableIndex));
+    }
+    const FuncType * Ty = Module.getType(TypeIndex);
+    if (Ty == nullptr) {
+      return fail(Twine("unknown type ") + Twine(TypeIndex));
+    }
+    return popExpecting(ValueTypeKind::I32) && visitCall(Ty);
+  }
+
+  bool visitDrop() {
+    ValueTypeKind Type;
+    return pop(Type);
+  }
+
+  bool visitSelect() {
+    ValueTypeKind Type1;
+    ValueTypeKind Type2;
+    if (!popExpecting(ValueTypeKind::I32) || !pop(Type1)
+        || !pop(Type2)) {
+      return false;
+    }
+    if (Type1 != Type2 && Type1 != UnknownType && Type2 != UnknownType) {
+      return fail("type mismatch: operands of different types");
+    }
+    ValueTypeKind Type = Type1 == UnknownType ? Type2 : Type1;
+    if (Type == ValueTypeKind::FuncRef
+        || Type == ValueTypeKind::ExternRef) {
+      return fail("type mismatch: operands of reference types");
+    }
+    push(Type);
+    return true;
+  }
+
+  bool visitLocalGet(uint32_t LocalIndex) {
+    ValueTypeKind Type;
+    if (!getLocalType(LocalIndex, Type)) {
+      return false;
+    }
+    push(Type);
+    return true;
+  }
+
+  bool visitLocalSet(uint32_t LocalIndex) {
+    ValueTypeKind Type;
+    return getLocalType(LocalIndex, Type) && popExpecting(Type);
+  }
+
+  bool visitLocalTee(uint32_t LocalIndex) {
+    ValueTypeKind Type;
+    if (!getLocalType(LocalIndex, Type) || !popExpecting(Type)) {
+      return false;
+    }
+    push(Type);
+    return true;
+  }
+
+  bool visitGlobalGet(uint32_t GlobalIndex) {
+    const GlobalType * Ty = Module.getGlobalType(GlobalIndex);
+    if (Ty == nullptr) {
+      return fail(Twine("unknown global ") + Twine(GlobalIndex));
+    }
+    // The init expression of a global may only read the immutable
+    // globals defined before it.
+    if (Fn->isGlobalInit()
+        && (Ty->isMutable() || GlobalIndex >= Fn->getIndex())) {
+      return fail("constant expression required");
+    }
+    push(Ty->getType()->getValueTypeKind());
+    return true;
+  }
+
+  bool visitGlobalSet(uint32_t GlobalIndex) {
+    const GlobalType * Ty = Module.getGlobalType(GlobalIndex);
+    if (Ty == nullptr) {
+      return fail(Twine("unknown global ") + Twine(GlobalIndex));
+    }
+    if (!Ty->isMutable()) {
+      return fail(
+        Twine("global ") + Twine(GlobalIndex) + " is immutable"
+      );
+    }
+    return popExpecting(Ty->getType()->getValueTypeKind());
+  }
+
+  bool checkMemArg(MemoryArgument MemArg, ValueTypeKind MemoryType) {
+    if (!Module.hasMemory()) {
+      return fail("unknown memory 0");
+    }
+    if (MemArg.Align > getNaturalAlignment(MemoryType)) {
+      return fail("alignment must not be larger than natural");
+    }
+    return true;
+  }
+
+  bool visitLoad(
+    MemoryArgument MemArg, ValueTypeKind MemoryType, ValueTypeKind Type
+  ) {
+    if (!checkMemArg(MemArg, MemoryType)
+        || !popExpecting(ValueTypeKind::I32)) {
+      return false;
+    }
+    push(Type);
+    return true;
+  }
+
+  bool visitStore(
+    MemoryArgument MemArg, ValueTypeKind Type, ValueTypeKind MemoryType
+  ) {
+    return checkMemArg(MemArg, MemoryType) && popExpecting(Type)
+        && popExpecting(ValueTypeKind::I32);
+  }
+
+  bool visitMemorySize() {
+    if (!Module.hasMemory()) {
+      return fail("unknown memory 0");
+    }
+    push(ValueTypeKind::I32);
+    return true;
+  }
+
+  bool visitMemoryGrow() {
+    if (!Module.hasMemory()) {
+      return fail("unknown memory 0");
+    }
+    if (!popExpecting(ValueTypeKind::I32)) {
+      return false;
+    }
+    push(ValueTypeKind::I32);
+    return true;
+  }
+
+  bool visitBuiltin(const InstInfo& Info) {
+    for (uint8_t I = 0; I < Info.Pops; I++) {
+      if (!popExpecting(Info.OperandType)) {
+        return false;
+      }
+    }
+    if (Info.Pushes == 1) {
+      push(Info.ResultType);
+    }
+    return true;
+  }
+
+#pragma mark Instruction Nodes
+
+  bool visitStmt(Stmt * S) {
+    switch (S->getKind()) {
+    case StmtKind::Unreachable: setUnreachable(); return true;
+    case StmtKind::Nop: return true;
+    case StmtKind::Block: {
+      auto * Block = cast<BlockStmt>(S);
+      if (!visitStructured(InstNodeKind::Block, Block->getType())) {
+        return false;
+      }
+      Controls.back().Rest = Block->getInstructions();
+      return true;
+    }
+    case StmtKind::Loop: {
+      auto * Loop = cast<LoopStmt>(S);
+      if (!visitStructured(InstNodeKind::Loop, Loop->getType())) {
+        return false;
+      }
+      Controls.back().Rest = Loop->getInstructions();
+      return true;
+    }
+    case StmtKind::If: {
+      auto * If = cast<IfStmt>(S);
+      if (!visitStructured(InstNodeKind::If, If->getType())) {
+        return false;
+      }
+      Controls.back().Rest = If->getTrueInstructions();
+      Controls.back().FalseArm = If->getFalseInstructions();
+      return true;
+    }
+    case StmtKind::Else:
+      // The parser keeps the arms of an if apart.
+      return fail("else without matching if");
+    case StmtKind::End:
+      // Only the expression itself keeps its end among its nodes.
+      if (Controls.size() != 1 || !Controls.back().Rest.empty()) {
+        return fail("unexpected end");
+      }
+      return visitEnd();
+    case StmtKind::Br: return visitBr(cast<BrStmt>(S)->getLabelIndex());
+    case StmtKind::BrIf:
+      return visitBrIf(cast<BrIfStmt>(S)->getLabelIndex());
+    case StmtKind::BrTable: {
+      auto * Table = cast<BrTableStmt>(S);
+      return visitBrTable(
+        Table->getLabelIndices(), Table->getDefaultLabelIndex()
+      );
+    }
+    case StmtKind::Return: return visitReturn();
+    }
+    llvm_unreachable("unexpected StmtKind");
+  }
+
+  bool visitExpr(Expr * E) {
+    switch (E->getKind()) {
+    case ExprKind::Call:
+      return visitCall(cast<CallExpr>(E)->getFuncIndex());
+    case ExprKind::CallIndirect: {
+      auto * Call = cast<CallIndirectExpr>(E);
+      return visitCallIndirect(
+        Call->getTypeIndex(), Call->getTableIndex()
+      );
+    }
+    case ExprKind::Drop: return visitDrop();
+    case ExprKind::Select: return visitSelect();
+    case ExprKind::LocalGet:
+      return visitLocalGet(cast<LocalGetExpr>(E)->getLocalIndex());
+    case ExprKind::LocalSet:
+      return visitLocalSet(cast<LocalSetExpr>(E)->getLocalIndex());
+    case ExprKind::LocalTee:
+      return visitLocalTee(cast<LocalTeeExpr>(E)->getLocalIndex());
+    case ExprKind::GlobalGet:
+      return visitGlobalGet(cast<GlobalGetExpr>(E)->getGlobalIndex());
+    case ExprKind::GlobalSet:
+      return visitGlobalSet(cast<GlobalSetExpr>(E)->getGlobalIndex());
+    case ExprKind::Load: {
+      auto * Load = cast<LoadExpr>(E);
+      return visitLoad(
+        Load->getMemArg(),
+        Load->getSourceType()->getValueTypeKind(),
+        Load->getDestinationType()->getValueTypeKind()
+      );
+    }
+    case ExprKind::Store: {
+      auto * Store = cast<StoreExpr>(E);
+      return visitStore(
+        Store->getMemArg(),
+        Store->getSourceType()->getValueTypeKind(),
+        Store->getDestinationType()->getValueTypeKind()
+      );
+    }
+    case ExprKind::MemorySize: return visitMemorySize();
+    case ExprKind::MemoryGrow: return visitMemoryGrow();
+    case ExprKind::IntegerConst:
+    case ExprKind::FloatConst:
+      push(cast<ValueType>(E->getType())->getValueTypeKind());
+      return true;
+    case ExprKind::CallBuiltin:
+      return visitBuiltin(
+        getInstInfo(cast<CallBuiltinExpr>(E)->getInstruction())
+      );
+    }
+    llvm_unreachable("unexpected ExprKind");
+  }
+
+  bool visitNodes() {
+    while (!Controls.empty()) {
+      ControlFrame& Frame = Controls.back();
+      if (Frame.Rest.empty()) {
+        if (Controls.size() == 1) {
+          CurrentInst = StringRef();
+          return fail("missing end of expression");
+        }
+        if (Frame.FalseArm.has_value()) {
+          CurrentInst = "else";
+          Frame.Rest = *Frame.FalseArm;
+          Frame.FalseArm.reset();
+          if (!visitElse()) {
+            return false;
+          }
+          continue;
+        }
+        CurrentInst = "end";
+        if (!visitEnd()) {
+          return false;
+        }
+        continue;
+      }
+      InstNode Node = Frame.Rest.front();
+      Frame.Rest = Frame.Rest.drop_front();
+      bool IsValid;
+      if (auto * S = Node.dyn_cast<Stmt *>()) {
+        InstNodeKind Kind = getInstNodeKind(S);
+        CurrentInst = getInstName(Kind);
+        IsValid =
+          (!Fn->isGlobalInit() || checkConstant(Kind)) && visitStmt(S);
+      } else {
+        auto * E = Node.get<Expr *>();
+        InstNodeKind Kind = getInstNodeKind(E);
+        CurrentInst = getInstName(Kind);
+        bool IsConstant = true;
+        if (auto * Builtin = dyn_cast<CallBuiltinExpr>(E)) {
+          CurrentInst = getInstInfo(Builtin->getInstruction()).Name;
+          IsConstant = !Fn->isGlobalInit()
+                    || checkConstant(Builtin->getInstruction());
+        } else {
+          IsConstant = !Fn->isGlobalInit() || checkConstant(Kind);
+        }
+        IsValid = IsConstant && visitExpr(E);
+      }
+      if (!IsValid) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+#pragma mark Instruction Streams
+
+  bool visitInst(InstRef Inst) {
+    const InstInfo& Info = Inst.getInfo();
+    switch (Info.Node) {
+    case InstNodeKind::Unreachable: setUnreachable(); return true;
+    case InstNodeKind::Nop: return true;
+    case InstNodeKind::Block:
+    case InstNodeKind::Loop:
+    case InstNodeKind::If:
+      return visitStructured(Info.Node, Inst.getBlockType());
+    case InstNodeKind::Else: return visitElse();
+    case InstNodeKind::End: return visitEnd();
+    case InstNodeKind::Br: return visitBr(Inst.getIndexImmediate());
+    case InstNodeKind::BrIf: return visitBrIf(Inst.getIndexImmediate());
+    case InstNodeKind::BrTable:
+      return visitBrTable(Inst.getLabelTable(), Inst.getIndexImmediate());
+    case InstNodeKind::Return: return visitReturn();
+    case InstNodeKind::Call: return visitCall(Inst.getIndexImmediate());
+    case InstNodeKind::CallIndirect:
+      return visitCallIndirect(
+        Inst.getIndexImmediate(), Inst.getTableIndex()
+      );
+    case InstNodeKind::Drop: return visitDrop();
+    case InstNodeKind::Select: return visitSelect();
+    case InstNodeKind::LocalGet:
+      return visitLocalGet(Inst.getIndexImmediate());
+    case InstNodeKind::LocalSet:
+      return visitLocalSet(Inst.getIndexImmediate());
+    case InstNodeKind::LocalTee:
+      return visitLocalTee(Inst.getIndexImmediate());
+    case InstNodeKind::GlobalGet:
+      return visitGlobalGet(Inst.getIndexImmediate());
+    case InstNodeKind::GlobalSet:
+      return visitGlobalSet(Inst.getIndexImmediate());
+    case InstNodeKind::Load:
+      return visitLoad(
+        Inst.getMemArg(), Info.MemoryType, Info.ResultType
+      );
+    case InstNodeKind::Store:
+      return visitStore(
+        Inst.getMemArg(), Info.OperandType, Info.MemoryType
+      );
+    case InstNodeKind::MemorySize: return visitMemorySize();
+    case InstNodeKind::MemoryGrow: return visitMemoryGrow();
+    case InstNodeKind::IntegerConst:
+    case InstNodeKind::FloatConst: push(Info.ResultType); return true;
+    case InstNodeKind::Builtin: return visitBuiltin(Info);
+    case InstNodeKind::Invalid: break;
+    }
+    llvm_unreachable("invalid instruction in stream");
+  }
+
+  bool visitStream(const InstStream& Stream) {
+    for (InstRef Inst : Stream) {
+      const InstInfo& Info = Inst.getInfo();
+      if (Info.Node == InstNodeKind::Builtin) {
+        CurrentInst = Info.Name;
+      } else {
+        CurrentInst = getInstName(Info.Node);
+      }
+      if (Controls.empty()) {
+        return fail("instruction after the end of expression");
+      }
+      if (Fn->isGlobalInit()
+          && !(Info.Node == InstNodeKind::Builtin
+                 ? checkConstant(Inst.getOpcode())
+                 : checkConstant(Info.Node))) {
+        return false;
+      }
+      if (!visitInst(Inst)) {
+        return false;
+      }
+    }
+    if (!Controls.empty()) {
+      CurrentInst = StringRef();
+      return fail("missing end of expression");
+    }
+    return true;
+  }
+
+public:
+
+  FunctionValidator(const ModuleInfo& Module, Function * Fn) :
+    Module(Module),
+    Fn(Fn) {
+  }
+
+  FunctionValidation * validate() {
+    ASTContext& Ctx = Fn->getASTContext();
+    if (!collectLocals()) {
+      return FunctionValidation::createInvalid(Ctx, Error);
+    }
+
+    // The frame of the function itself, whose label is the results of
+    // the function.
+    SmallVector<ValueTypeKind, 2> Results;
+    appendValueTypes(Fn->getType()->getType()->getReturns(), Results);
+    ExpressionDecl * Expression = Fn->getExpression();
+    pushControl(
+      InstNodeKind::Block, {}, Results, Expression->getInstructions()
+    );
+
+    bool IsValid = Expression->hasInstStream()
+                   ? visitStream(*Expression->getInstStream())
+                   : visitNodes();
+    if (!IsValid) {
+      return FunctionValidation::createInvalid(Ctx, Error);
+    }
+    return FunctionValidation::createValid(Ctx);
+  }
+};
+
+} // namespace
+
+ValidateFunctionRequest::OutputType
+ValidateFunctionRequest::evaluate(Evaluator& Eval, Function * Fn) const {
+  assert(Fn);
+  auto& Ctx = Fn->getASTContext();
+  if (Ctx.Stats != nullptr) {
+    ++Ctx.Stats->getFrontendCounters().NumFunctionsValidated;
+  }
+  ModuleInfo Module(Fn->getModule());
+  return FunctionValidator(Module, Fn).validate();
+}
+
+void w2n::validateFunctions(
+  ASTContext& Ctx, ArrayRef<Function *> Functions
+) {
+  std::vector<Function *> Unvalidated;
+  std::vector<CodeDecl *> Codes;
+  Unvalidated.reserve(Functions.size());
+  for (Function * Fn : Functions) {
+    if (ValidateFunctionRequest{Fn}.getCachedResult().has_value()) {
+      continue;
+    }
+    Unvalidated.push_back(Fn);
+    if (Fn->getCode() != nullptr) {
+      Codes.push_back(Fn->getCode());
+    }
+  }
+  if (Unvalidated.empty()) {
+    return;
+  }
+
+  // Bodies are otherwise decoded on first access through the evaluator,
+  // which is not thread-safe.
+  WasmParser::parseFuncDecls(Ctx, Codes);
+
+  // Each function only reads the module and its own body, and fills the
+  // cache of its own request without going through the evaluator.
+  ModuleInfo Module(Unvalidated.front()->getModule());
+  auto Validate = [&Module](Function * Fn) {
+    assert(
+      Fn->getModule() == Module.getModule()
+      && "validating functions of different modules at once"
+    );
+    ValidateFunctionRequest{Fn}.cacheResult(
+      FunctionValidator(Module, Fn).validate()
+    );
+  };
+
+  if (Unvalidated.size() < MinParallelValidationCount) {
+    for (Function * Fn : Unvalidated) {
+      Validate(Fn);
+    }
+  } else {
+    ASTContext::TaskArenas Arenas(Ctx);
+    llvm::ThreadPool Pool(llvm::hardware_concurrency());
+    for (Function * Fn : Unvalidated) {
+      Pool.async(
+        [&](Function * Fn) {
+          ASTContext::TaskArenas::Scope Arena(Arenas);
+          Validate(Fn);
+        },
+        Fn
+      );
+    }
+    Pool.wait();
+  }
+
+  if (Ctx.Stats != nullptr) {
+    Ctx.Stats->getFrontendCounters().NumFunctionsValidated +=
+      Unvalidated.size();
+  }
+}
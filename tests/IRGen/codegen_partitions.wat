@@ -0,0 +1,12 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -O -codegen-partitions 2 -emit-assembly -o - | %FileCheck %s
+(module
+  (func $0 (export "0") (result i32)
+    i32.const 1)
+  (func $1 (export "1") (result i32)
+    i32.const 2)
+)
+
+;; Both partitions are written to the standard output.
+;; CHECK-DAG: {{"?_?function\$0"?}}:
+;; CHECK-DAG: {{"?_?function\$1"?}}:
@@ -0,0 +1,15 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -compact-instructions -emit-ir | %FileCheck %s
+(module
+  (global $a (mut i32) (i32.const 10))
+  (func $0 (export "0") (local i32)
+    i32.const 10
+    local.set 0)
+)
+
+;; CHECK: @".vmctx" = internal global %w2n.vmctx { i32 10 }, align 4
+;; CHECK-NOT: global-init
+
+;; CHECK-LABEL: void @"function$0"(ptr {{.*}}%vmctx)
+;; CHECK-NEXT: entry:
+;; CHECK-NEXT: ret void
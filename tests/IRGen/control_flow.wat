@@ -0,0 +1,79 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+(module
+  (func $merge (export "merge") (param i32) (result i32) (local i32)
+    block
+      i32.const 1
+      local.set 1
+      local.get 0
+      br_if 0
+      i32.const 2
+      local.set 1
+    end
+    local.get 1)
+  (func $if_else (export "if_else") (param i32) (result i32)
+    local.get 0
+    if (result i32)
+      i32.const 10
+    else
+      i32.const 20
+    end)
+  (func $loop (export "loop") (param i32) (result i32) (local i32)
+    loop
+      local.get 0
+      local.set 1
+      local.get 0
+      br_if 0
+    end
+    local.get 1)
+  (func $early_return (export "early_return") (param i32) (result i32)
+    block
+      i32.const 7
+      local.get 0
+      br_if 1
+      drop
+    end
+    i32.const 9)
+)
+
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK-NEXT: entry:
+;; CHECK-NEXT: %[[COND:[0-9]+]] = icmp ne i32 %0, 0
+;; CHECK-NEXT: br i1 %[[COND]], label %block.end, label %br_if.cont
+;; CHECK: br_if.cont:
+;; CHECK-NEXT: br label %block.end
+;; CHECK: block.end:
+;; CHECK-NEXT: %"$local1" = phi i32 [ 1, %entry ], [ 2, %br_if.cont ]
+;; CHECK-NEXT: ret i32 %"$local1"
+
+;; CHECK-LABEL: i32 @"function$1"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK-NEXT: entry:
+;; CHECK-NEXT: %[[COND:[0-9]+]] = icmp ne i32 %0, 0
+;; CHECK-NEXT: br i1 %[[COND]], label %if.then, label %if.else
+;; CHECK: if.then:
+;; CHECK-NEXT: br label %if.end
+;; CHECK: if.else:
+;; CHECK-NEXT: br label %if.end
+;; CHECK: if.end:
+;; CHECK-NEXT: %[[RESULT:[0-9]+]] = phi i32 [ 10, %if.then ], [ 20, %if.else ]
+;; CHECK-NEXT: ret i32 %[[RESULT]]
+
+;; CHECK-LABEL: i32 @"function$2"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK-NEXT: entry:
+;; CHECK-NEXT: br label %loop
+;; CHECK: loop:
+;; CHECK-NOT: %"$local0" = phi
+;; CHECK: %"$local1" = phi i32 [ 0, %entry ], [ %0, %loop ]
+;; CHECK: br i1 %{{[0-9]+}}, label %loop, label %br_if.cont
+;; CHECK: br_if.cont:
+;; CHECK-NEXT: ret i32 %0
+
+;; CHECK-LABEL: i32 @"function$3"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK-NEXT: entry:
+;; CHECK-NEXT: %[[COND:[0-9]+]] = icmp ne i32 %0, 0
+;; CHECK-NEXT: br i1 %[[COND]], label %return, label %br_if.cont
+;; CHECK: br_if.cont:
+;; CHECK-NEXT: br label %return
+;; CHECK: return:
+;; CHECK-NEXT: %[[RESULT:[0-9]+]] = phi i32 [ 7, %entry ], [ 9, %br_if.cont ]
+;; CHECK-NEXT: ret i32 %[[RESULT]]
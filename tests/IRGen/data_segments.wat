@@ -0,0 +1,24 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+(module
+  (memory 1)
+  (global $offset i32 (i32.const 32))
+  (data (i32.const 16) "hello")
+  (data (global.get $offset) "\00\01\02\ff")
+  (data "passive")
+)
+;; CHECK: @data.segment.0 = private unnamed_addr constant [5 x i8] c"hello", align 1
+;; CHECK: @data.segment.1 = private unnamed_addr constant [4 x i8] c"\00\01\02\FF", align 1
+;; CHECK: @data.segment.2 = private unnamed_addr constant [7 x i8] c"passive", align 1
+
+;; The constructor of the memory copies the active segments to their
+;; offsets once the runtime has mapped the memory.
+;; CHECK-LABEL: @".memory$0-initializer"()
+;; CHECK: call void @w2n_memory_init(
+;; CHECK: %memory.base = load ptr, ptr %memory.base.addr
+;; CHECK: %[[DST0:[0-9]+]] = getelementptr inbounds i8, ptr %memory.base, i64 16
+;; CHECK: call void @llvm.memcpy.p0.p0.i64(ptr align 1 %[[DST0]], ptr align 1 @data.segment.0, i64 5, i1 false)
+;; CHECK: %[[DST1:[0-9]+]] = getelementptr inbounds i8, ptr %memory.base, i64 32
+;; CHECK: call void @llvm.memcpy.p0.p0.i64(ptr align 1 %[[DST1]], ptr align 1 @data.segment.1, i64 4, i1 false)
+;; CHECK-NOT: @data.segment.2
+;; CHECK: ret void
@@ -0,0 +1,8 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: not %target-w2n-frontend %t.wasm -emit-ir 2>&1 | %FileCheck %s
+(module
+  (memory 1)
+  (data (i32.const 65534) "abc")
+)
+
+;; CHECK: error: IR generation failure: data segment does not fit in the memory
@@ -0,0 +1,52 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -compact-instructions -emit-ir | %FileCheck %s
+(module
+  (func $arith (export "arith") (param f64 f64) (result f64)
+    local.get 0
+    local.get 1
+    f64.add
+    local.get 1
+    f64.min)
+  (func $compare (export "compare") (param f32 f32) (result i32)
+    local.get 0
+    local.get 1
+    f32.ne)
+  (func $nearest (export "nearest") (param f32) (result f32)
+    local.get 0
+    f32.nearest)
+  (func $truncate (export "truncate") (param f64) (result i32)
+    local.get 0
+    i32.trunc_f64_s)
+  (func $saturate (export "saturate") (param f32) (result i64)
+    local.get 0
+    i64.trunc_sat_f32_u)
+)
+
+;; Wasm min propagates NaNs and orders -0 below +0.
+;; CHECK-LABEL: double @"function$0"(ptr {{.*}}%vmctx, double %0, double %1)
+;; CHECK: %[[SUM:[0-9]+]] = fadd double %0, %1
+;; CHECK: %[[MIN:[0-9]+]] = call double @llvm.minimum.f64(double %[[SUM]], double %1)
+;; CHECK: ret double %[[MIN]]
+
+;; Comparisons produce an i32, and ne is true for NaNs.
+;; CHECK-LABEL: i32 @"function$1"(ptr {{.*}}%vmctx, float %0, float %1)
+;; CHECK: %[[NE:[0-9]+]] = fcmp une float %0, %1
+;; CHECK: zext i1 %[[NE]] to i32
+
+;; CHECK-LABEL: float @"function$2"(ptr {{.*}}%vmctx, float %0)
+;; CHECK: call float @llvm.roundeven.f32(float %0)
+
+;; Truncations trap on NaNs and on the values out of the range of the
+;; integer.
+;; CHECK-LABEL: i32 @"function$3"(ptr {{.*}}%vmctx, double %0)
+;; CHECK: fcmp ogt double %0, 0xC1E0000000200000
+;; CHECK: fcmp olt double %0, 0x41E0000000000000
+;; CHECK: br i1 %{{[0-9]+}}, label %memory.trap, label %trunc.inrange
+;; CHECK: trunc.inrange:
+;; CHECK: fptosi double %0 to i32
+
+;; Saturating truncations do not trap.
+;; CHECK-LABEL: i64 @"function$4"(ptr {{.*}}%vmctx, float %0)
+;; CHECK-NOT: memory.trap
+;; CHECK: call i64 @llvm.fptoui.sat.i64.f32(float %0)
@@ -0,0 +1,33 @@
+;; RUN: %target-wat2wasm --enable-extended-const %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -compact-instructions -emit-ir | %FileCheck %s
+(module
+  (global $base i32 (i32.const 1024))
+  (global $end i32 (i32.add (global.get $base) (i32.mul (i32.const 4) (i32.const 16))))
+  (global $wrap i64 (i64.sub (i64.const 0) (i64.const 1)))
+  (global $scale f64 (f64.const 0.5))
+  (global $counter (mut i32) (global.get $end))
+  (func $get_end (export "get_end") (result i32)
+    global.get $end)
+  (func $get_counter (export "get_counter") (result i32)
+    global.get $counter)
+)
+
+;; The initializers, including the extended constant expressions, are
+;; evaluated at compile time into the static initializer of the instance
+;; context.
+;; CHECK: %w2n.vmctx = type { i32, i32, i64, double, i32 }
+;; CHECK: @".vmctx" = internal global %w2n.vmctx { i32 1024, i32 1088, i64 -1, double 5.000000e-01, i32 1088 }, align 8
+;; CHECK-NOT: @llvm.global_ctors
+;; CHECK-NOT: global-init
+
+;; The reads of an immutable global fold to its value.
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx)
+;; CHECK-NOT: load
+;; CHECK: ret i32 1088
+
+;; The reads of a mutable global load it from the instance context.
+;; CHECK-LABEL: i32 @"function$1"(ptr {{.*}}%vmctx)
+;; CHECK: %[[ADDR:.+]] = getelementptr inbounds %w2n.vmctx, ptr %vmctx, i32 0, i32 4
+;; CHECK: %[[VALUE:.+]] = load i32, ptr %[[ADDR]], align 4
+;; CHECK: ret i32 %[[VALUE]]
@@ -3,28 +3,20 @@
 (module
   (global $a (mut i32) (i32.const 0))
   (global $b (mut i32) (i32.const 10))
+  (func $get_b (export "get_b") (result i32)
+    global.get $b)
 )
-;; CHECK: @".global$0" = internal global i32 0, align 4
-;; CHECK: @".global$1" = internal global i32 0, align 4
 
-;; CHECK-LABEL: @"global-init$0"(
-;; CHECK: %"$return-value" = alloca i32, align 4
-;; CHECK: store i32 0, ptr %"$return-value", align 4
-;; CHECK: %"$loaded-return-value" = load i32, ptr %"$return-value", align 4
-;; CHECK: ret i32 %"$loaded-return-value"
+;; The globals are the fields of the instance context, whose static
+;; initializer holds the values of their initializers, so no constructor
+;; runs.
+;; CHECK: %w2n.vmctx = type { i32, i32 }
+;; CHECK: @".vmctx" = internal global %w2n.vmctx { i32 0, i32 10 }, align 4
+;; CHECK-NOT: @llvm.global_ctors
+;; CHECK-NOT: global-init
+;; CHECK-NOT: @constructor
 
-;; CHECK-LABEL: @constructor
-;; CHECK: %0 = call i32 @"global-init$0"()
-;; CHECK: store i32 %0, ptr @".global$0", align 4
-;; CHECK: ret void
-
-;; CHECK-LABEL: @"global-init$1"(
-;; CHECK: %"$return-value" = alloca i32, align 4
-;; CHECK: store i32 10, ptr %"$return-value", align 4
-;; CHECK: %"$loaded-return-value" = load i32, ptr %"$return-value", align 4
-;; CHECK: ret i32 %"$loaded-return-value"
-
-;; CHECK-LABEL: @constructor.1
-;; CHECK: %0 = call i32 @"global-init$1"()
-;; CHECK: store i32 %0, ptr @".global$1", align 4
-;; CHECK: ret void
+;; Functions reach the globals through their instance context.
+;; CHECK-LABEL: i32 @"function$0"(ptr noalias nonnull align 4 dereferenceable(8) %vmctx)
+;; CHECK: %[[ADDR:.+]] = getelementptr inbounds %w2n.vmctx, ptr %vmctx, i32 0, i32 1
+;; CHECK: load i32, ptr %[[ADDR]], align 4
@@ -0,0 +1,16 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: not %target-w2n-frontend %t.wasm -emit-ir 2>&1 | %FileCheck %s
+(module
+  (import "env" "memory" (memory 1))
+  (func $load (export "load") (param i32) (result i32)
+    local.get 0
+    i32.load
+    drop
+    local.get 0
+    i32.load offset=4)
+)
+
+;; The accesses to an imported memory are diagnosed once per function
+;; rather than crashing the compiler.
+;; CHECK: error: unimplemented IR generation feature imported memories
+;; CHECK-NOT: error:
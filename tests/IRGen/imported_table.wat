@@ -0,0 +1,17 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: not %target-w2n-frontend %t.wasm -emit-ir 2>&1 | %FileCheck %s
+(module
+  (type $unary (func (param i32) (result i32)))
+  (import "env" "table" (table 1 funcref))
+  (func $dispatch (export "dispatch") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    call_indirect (type $unary)
+    i32.const 1
+    i32.add)
+)
+
+;; Indirect calls through an imported table are diagnosed rather than
+;; crashing the compiler.
+;; CHECK: error: IR generation failure: imported tables are not supported
+;; CHECK-NOT: error:
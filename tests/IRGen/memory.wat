@@ -0,0 +1,73 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -memory-bounds-checks=guard-pages -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -memory-bounds-checks=explicit -emit-ir | %FileCheck %s --check-prefix=EXPLICIT
+(module
+  (memory 1 2)
+  (func $load (export "load") (param i32) (result i32)
+    local.get 0
+    i32.load offset=4)
+  (func $load8_s (export "load8_s") (param i32) (result i64)
+    local.get 0
+    i64.load8_s)
+  (func $store16 (export "store16") (param i32 i32)
+    local.get 0
+    local.get 1
+    i32.store16 offset=2)
+  (func $large_offset (export "large_offset") (param i32) (result i32)
+    local.get 0
+    i32.load offset=0x80000000)
+)
+
+;; The descriptor of the memory is the first field of the instance
+;; context.
+;; CHECK-DAG: %w2n.memory = type { ptr, i64 }
+;; CHECK-DAG: %w2n.vmctx = type { %w2n.memory }
+;; CHECK: @".vmctx" = internal global %w2n.vmctx zeroinitializer
+
+;; The runtime reserves 4 GiB plus a 2 GiB guard region.
+;; CHECK-LABEL: @".memory$0-initializer"()
+;; CHECK: call void @w2n_memory_init(ptr {{.*}}@".vmctx"{{.*}}, i64 65536, i64 6442450944)
+
+;; Accesses covered by the guard region are not checked.
+;; CHECK-LABEL: i32 @"function$0"(ptr noalias nonnull align 8 dereferenceable(16) %vmctx, i32 %0)
+;; CHECK-NOT: icmp
+;; CHECK: %memory = getelementptr inbounds %w2n.vmctx, ptr %vmctx, i32 0, i32 0
+;; CHECK: %[[EXT:[0-9]+]] = zext i32 %0 to i64
+;; CHECK: %[[EA:[0-9]+]] = add nuw nsw i64 %[[EXT]], 4
+;; CHECK: %memory.base.addr = getelementptr inbounds %w2n.memory, ptr %memory, i32 0, i32 0
+;; CHECK: %memory.base = load ptr, ptr %memory.base.addr, align 8, !invariant.load
+;; CHECK: %[[ADDR:[0-9]+]] = getelementptr inbounds i8, ptr %memory.base, i64 %[[EA]]
+;; CHECK: %[[VAL:[0-9]+]] = load i32, ptr %[[ADDR]], align 1
+;; CHECK: ret i32 %[[VAL]]
+
+;; CHECK-LABEL: i64 @"function$1"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK: %[[BYTE:[0-9]+]] = load i8, ptr %{{[0-9]+}}, align 1
+;; CHECK: sext i8 %[[BYTE]] to i64
+
+;; CHECK-LABEL: void @"function$2"(ptr {{.*}}%vmctx, i32 %0, i32 %1)
+;; CHECK-NOT: icmp
+;; CHECK: %[[HALF:[0-9]+]] = trunc i32 %1 to i16
+;; CHECK: store i16 %[[HALF]], ptr %{{[0-9]+}}, align 1
+
+;; Offsets past the guard region are checked.
+;; CHECK-LABEL: i32 @"function$3"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK: %memory.size = load i64
+;; CHECK: icmp ugt i64 %{{[0-9]+}}, %memory.size
+;; CHECK: br i1 %{{[0-9]+}}, label %memory.trap, label %memory.inbounds
+;; CHECK: memory.trap:
+;; CHECK-NEXT: call void @llvm.trap()
+;; CHECK-NEXT: unreachable
+
+;; Only the maximum size of the memory is reserved.
+;; EXPLICIT-LABEL: @".memory$0-initializer"()
+;; EXPLICIT: call void @w2n_memory_init(ptr {{.*}}@".vmctx"{{.*}}, i64 65536, i64 131072)
+
+;; EXPLICIT-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx, i32 %0)
+;; EXPLICIT: %memory.size = load i64
+;; EXPLICIT: %[[END:[0-9]+]] = add nuw nsw i64 %{{[0-9]+}}, 4
+;; EXPLICIT: %[[OOB:[0-9]+]] = icmp ugt i64 %[[END]], %memory.size
+;; EXPLICIT: br i1 %[[OOB]], label %memory.trap, label %memory.inbounds
+;; EXPLICIT: memory.inbounds:
+;; EXPLICIT: %memory.base = load ptr, ptr %memory.base.addr, align 8
+;; EXPLICIT-NOT: invariant.load
+;; EXPLICIT: load i32, ptr %{{[0-9]+}}, align 1
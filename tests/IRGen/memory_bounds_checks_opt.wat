@@ -0,0 +1,51 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -O -memory-bounds-checks=explicit -emit-ir | %FileCheck %s
+(module
+  (memory 1)
+  (func $adjacent (export "adjacent") (param i32) (result i32)
+    local.get 0
+    i32.load
+    local.get 0
+    i32.load offset=4
+    i32.add
+    local.get 0
+    i32.load offset=8
+    i32.add)
+  (func $sum_bytes (export "sum_bytes") (param $n i32) (result i32)
+    (local $i i32) (local $sum i32)
+    block
+      local.get $n
+      i32.eqz
+      br_if 0
+      loop
+        local.get $i
+        i32.load8_u
+        local.get $sum
+        i32.add
+        local.set $sum
+        local.get $i
+        i32.const 1
+        i32.add
+        local.tee $i
+        local.get $n
+        i32.ne
+        br_if 0
+      end
+    end
+    local.get $sum)
+)
+
+;; The three accesses are covered by a single check reaching the end of
+;; the last one.
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK: %[[EXT:[0-9]+]] = zext i32 %0 to i64
+;; CHECK: %[[END:[0-9]+]] = add nuw nsw i64 %[[EXT]], 12
+;; CHECK: icmp ugt i64 %[[END]], %memory.size
+;; CHECK-NOT: icmp
+;; CHECK: ret i32
+
+;; The last byte the loop reads is checked once before the loop.
+;; CHECK-LABEL: i32 @"function$1"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK: icmp ugt i64 %{{[0-9]+}}, %memory.size
+;; CHECK-NOT: %memory.size
+;; CHECK: ret i32
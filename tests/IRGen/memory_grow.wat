@@ -0,0 +1,30 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -memory-bounds-checks=guard-pages -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -compact-instructions -memory-bounds-checks=guard-pages -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -memory-bounds-checks=explicit -emit-ir | %FileCheck %s --check-prefix=EXPLICIT
+(module
+  (memory 1 4)
+  (func $size (export "size") (result i32)
+    memory.size)
+  (func $grow (export "grow") (param i32) (result i32)
+    local.get 0
+    memory.grow)
+)
+
+;; The size of the memory is kept in bytes.
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx)
+;; CHECK: %memory.size = load i64, ptr %memory.size.addr
+;; CHECK: %memory.pages = lshr i64 %memory.size, 16
+;; CHECK: %[[PAGES:[0-9]+]] = trunc i64 %memory.pages to i32
+;; CHECK: ret i32 %[[PAGES]]
+
+;; The runtime maps the new pages within the reservation, up to the
+;; maximum of the memory.
+;; CHECK-LABEL: i32 @"function$1"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK: %memory.grow = call i32 @w2n_memory_grow(ptr %memory, i32 %0, i64 262144)
+;; CHECK: ret i32 %memory.grow
+
+;; EXPLICIT-LABEL: @".memory$0-initializer"()
+;; EXPLICIT: call void @w2n_memory_init(ptr {{.*}}@".vmctx"{{.*}}, i64 65536, i64 262144)
+;; EXPLICIT-LABEL: i32 @"function$1"(ptr {{.*}}%vmctx, i32 %0)
+;; EXPLICIT: call i32 @w2n_memory_grow(ptr %memory, i32 %0, i64 262144)
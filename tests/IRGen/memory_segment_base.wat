@@ -0,0 +1,39 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -target x86_64-unknown-linux-gnu -memory-base=segment -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -target x86_64-apple-macosx13.0 -memory-base=segment -emit-ir | %FileCheck %s --check-prefix=FALLBACK
+(module
+  (memory 1)
+  (func $load (export "load") (param i32) (result i32)
+    local.get 0
+    i32.load offset=4)
+  (func $store (export "store") (param i32 i64)
+    local.get 0
+    local.get 1
+    i64.store)
+)
+
+;; The constructor points GS at the base of the memory.
+;; CHECK-LABEL: @".memory$0-initializer"()
+;; CHECK: call void @w2n_memory_init(ptr {{.*}}@".vmctx"{{.*}}, i64 65536, i64 6442450944)
+;; CHECK: call void @w2n_memory_set_segment_base(ptr {{.*}}@".vmctx"{{.*}})
+
+;; Accesses are relative to GS, without loading the base.
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK-NOT: %memory.base
+;; CHECK: %[[EXT:[0-9]+]] = zext i32 %0 to i64
+;; CHECK: %[[EA:[0-9]+]] = add nuw nsw i64 %[[EXT]], 4
+;; CHECK: %[[ADDR:[0-9]+]] = inttoptr i64 %[[EA]] to ptr addrspace(256)
+;; CHECK: load i32, ptr addrspace(256) %[[ADDR]], align 1
+
+;; CHECK-LABEL: void @"function$1"(ptr {{.*}}%vmctx, i32 %0, i64 %1)
+;; CHECK-NOT: %memory.base
+;; CHECK: %[[ADDR:[0-9]+]] = inttoptr i64 %{{[0-9]+}} to ptr addrspace(256)
+;; CHECK: store i64 %1, ptr addrspace(256) %[[ADDR]], align 1
+
+;; Targets without a free segment register load the base as usual.
+;; FALLBACK-LABEL: @".memory$0-initializer"()
+;; FALLBACK: call void @w2n_memory_init(
+;; FALLBACK-NEXT: ret void
+;; FALLBACK-LABEL: i32 @"function$0"(
+;; FALLBACK: %memory.base = load ptr
+;; FALLBACK-NOT: addrspace(256)
@@ -0,0 +1,51 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -compact-instructions -emit-ir | %FileCheck %s
+(module
+  (func $arith (export "arith") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    i32.add
+    local.get 1
+    i32.sub)
+  (func $compare (export "compare") (param i64 i64) (result i32)
+    local.get 0
+    local.get 1
+    i64.lt_u
+    i32.eqz)
+  (func $shift (export "shift") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    i32.shl)
+  (func $divide (export "divide") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    i32.div_s)
+)
+
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx, i32 %0, i32 %1)
+;; CHECK: %[[SUM:[0-9]+]] = add i32 %0, %1
+;; CHECK: %[[DIFF:[0-9]+]] = sub i32 %[[SUM]], %1
+;; CHECK: ret i32 %[[DIFF]]
+
+;; Comparisons produce an i32.
+;; CHECK-LABEL: i32 @"function$1"(ptr {{.*}}%vmctx, i64 %0, i64 %1)
+;; CHECK: %[[LT:[0-9]+]] = icmp ult i64 %0, %1
+;; CHECK: %[[LT32:[0-9]+]] = zext i1 %[[LT]] to i32
+;; CHECK: %[[EQZ:[0-9]+]] = icmp eq i32 %[[LT32]], 0
+;; CHECK: %[[RESULT:[0-9]+]] = zext i1 %[[EQZ]] to i32
+;; CHECK: ret i32 %[[RESULT]]
+
+;; Shift counts are taken modulo the bit width.
+;; CHECK-LABEL: i32 @"function$2"(ptr {{.*}}%vmctx, i32 %0, i32 %1)
+;; CHECK: %shift.count = and i32 %1, 31
+;; CHECK: shl i32 %0, %shift.count
+
+;; Division traps on a zero divisor and on overflow.
+;; CHECK-LABEL: i32 @"function$3"(ptr {{.*}}%vmctx, i32 %0, i32 %1)
+;; CHECK: %[[ZERO:[0-9]+]] = icmp eq i32 %1, 0
+;; CHECK: br i1 %[[ZERO]], label %memory.trap, label %div.nonzero
+;; CHECK: div.nonzero:
+;; CHECK: br i1 %{{[0-9]+}}, label %memory.trap, label %div.nooverflow
+;; CHECK: div.nooverflow:
+;; CHECK: sdiv i32 %0, %1
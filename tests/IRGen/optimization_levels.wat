@@ -0,0 +1,23 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -O -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -Osize -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -Onone -emit-ir | %FileCheck %s --check-prefix=ONONE
+(module
+  (func $if_else (export "if_else") (param i32) (result i32)
+    local.get 0
+    if (result i32)
+      i32.const 10
+    else
+      i32.const 20
+    end)
+)
+
+;; The arms of the if are folded into a select.
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK-NOT: br
+;; CHECK: select
+;; CHECK: ret i32
+
+;; ONONE-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx, i32 %0)
+;; ONONE: br i1
+;; ONONE: phi i32 [ 10, %if.then ], [ 20, %if.else ]
@@ -0,0 +1,34 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: rm -rf %t.1 %t.4 && mkdir -p %t.1 %t.4
+;; RUN: %target-w2n-frontend %t.wasm -num-threads 1 -irgen-partition-size 1 -emit-ir -o %t.1/out.ll
+;; RUN: %target-w2n-frontend %t.wasm -num-threads 4 -irgen-partition-size 1 -emit-ir -o %t.4/out.ll
+;; RUN: diff %t.1/out.ll %t.4/out.ll
+;; RUN: diff %t.1/out.1.ll %t.4/out.1.ll
+;; RUN: %FileCheck %s < %t.4/out.ll
+;; RUN: %FileCheck %s --check-prefix=PARTITION < %t.4/out.1.ll
+(module
+  (global $a (mut i32) (i32.const 10))
+  (func $0 (export "get") (result i32)
+    global.get 0)
+  (func $1 (export "set") (param i32)
+    local.get 0
+    global.set 0)
+)
+
+;; With one partition per byte of code, each function is emitted into an
+;; LLVM module of its own, and the output does not depend on the number
+;; of threads.
+
+;; The first partition also holds the instance context.
+;; CHECK: @".vmctx" = {{.*}}global %w2n.vmctx { i32 10 }, align 4
+;; CHECK-NOT: global-init
+
+;; CHECK-LABEL: i32 @"function$0"(ptr {{.*}}%vmctx)
+;; CHECK: %[[ADDR:.+]] = getelementptr inbounds %w2n.vmctx, ptr %vmctx, i32 0, i32 0
+;; CHECK: load i32, ptr %[[ADDR]]
+;; CHECK-NOT: define {{.*}}@"function$1"
+
+;; PARTITION-NOT: define {{.*}}@"function$0"
+;; PARTITION-LABEL: void @"function$1"(ptr {{.*}}%vmctx, i32 %0)
+;; PARTITION: %[[ADDR:.+]] = getelementptr inbounds %w2n.vmctx, ptr %vmctx, i32 0, i32 0
+;; PARTITION: store i32 %0, ptr %[[ADDR]]
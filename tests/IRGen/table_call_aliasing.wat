@@ -0,0 +1,32 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -O -emit-ir | %FileCheck %s
+(module
+  (type $void (func))
+  (table (export "table") 1 funcref)
+  (global $counter (mut i32) (i32.const 0))
+  (elem (i32.const 0) $bump)
+  (func $bump (export "bump")
+    global.get $counter
+    i32.const 1
+    i32.add
+    global.set $counter)
+  (func $dispatch (export "dispatch") (param i32) (result i32)
+    global.get $counter
+    local.get 0
+    call_indirect (type $void)
+    global.get $counter
+    i32.add)
+)
+
+;; The instance context stays noalias in the callee.
+;; CHECK-LABEL: void @"function$0"(ptr noalias nonnull {{.*}}%vmctx)
+;; CHECK: store i32
+
+;; The callee of an indirect call gets the context of the caller, so the
+;; global it sets is read again after the call instead of being forwarded
+;; from the read before the call.
+;; CHECK-LABEL: i32 @"function$1"(ptr noalias nonnull {{.*}}%vmctx, i32 %0)
+;; CHECK: %[[BEFORE:[0-9a-z.]+]] = load i32, ptr %[[ADDR:[0-9a-z.]+]]
+;; CHECK: call void %table.entry.fn(ptr %vmctx)
+;; CHECK: %[[AFTER:[0-9a-z.]+]] = load i32, ptr %[[ADDR]]
+;; CHECK: add i32 {{.*}}%[[AFTER]]
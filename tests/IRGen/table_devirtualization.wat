@@ -0,0 +1,62 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -compact-instructions -emit-ir | %FileCheck %s
+(module
+  (type $unary (func (param i32) (result i32)))
+  (table 4 funcref)
+  (elem (i32.const 0) $first $second $first $binary)
+  (func $first (param i32) (result i32)
+    local.get 0)
+  (func $second (param i32) (result i32)
+    i32.const 2)
+  (func $binary (param i32 i32) (result i32)
+    local.get 1)
+  (func $dispatch (export "dispatch") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    call_indirect (type $unary))
+  (func $constant (export "constant") (param i32) (result i32)
+    local.get 0
+    i32.const 1
+    call_indirect (type $unary))
+  (func $mismatch (export "mismatch") (param i32) (result i32)
+    local.get 0
+    i32.const 3
+    call_indirect (type $unary))
+)
+
+;; Nothing writes the table after instantiation, so its elements are
+;; constant.
+;; CHECK: @".table$0.elements" = internal constant [4 x %w2n.table.entry]
+
+;; An indirect call on the immutable table switches over the elements
+;; of the expected type, sharing the calls of the same function, and
+;; traps on any other index.
+;; CHECK-LABEL: i32 @"function$3"(ptr {{.*}}%vmctx, i32 %0, i32 %1)
+;; CHECK-NOT: %table
+;; CHECK: switch i32 %1, label %memory.trap [
+;; CHECK-NEXT: i32 0, label %table.call
+;; CHECK-NEXT: i32 1, label %table.call1
+;; CHECK-NEXT: i32 2, label %table.call
+;; CHECK-NEXT: ]
+;; CHECK: table.call:
+;; CHECK-NEXT: %[[FIRST:[0-9]+]] = call i32 @"function$0"(ptr %vmctx, i32 %0)
+;; CHECK-NEXT: br label %table.call.end
+;; CHECK: table.call1:
+;; CHECK-NEXT: %[[SECOND:[0-9]+]] = call i32 @"function$1"(ptr %vmctx, i32 %0)
+;; CHECK-NEXT: br label %table.call.end
+;; CHECK: table.call.end:
+;; CHECK-NEXT: %[[RESULT:[0-9]+]] = phi i32 [ %[[FIRST]], %table.call ], [ %[[SECOND]], %table.call1 ]
+;; CHECK: ret i32 %[[RESULT]]
+
+;; A constant index selects the callee at compile time.
+;; CHECK-LABEL: i32 @"function$4"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK-NOT: %table
+;; CHECK: %[[RESULT:[0-9]+]] = call i32 @"function$1"(ptr %vmctx, i32 %0)
+;; CHECK: ret i32 %[[RESULT]]
+
+;; A constant index of a function of another type keeps the checks,
+;; which trap.
+;; CHECK-LABEL: i32 @"function$5"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK: icmp uge i32 3, %table.size
+;; CHECK: icmp ne i32 %table.entry.sig
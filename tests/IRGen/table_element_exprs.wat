@@ -0,0 +1,17 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+(module
+  (type $unary (func (param i32) (result i32)))
+  (table (export "table") 3 funcref)
+  (elem (i32.const 0) funcref (ref.func $first) (ref.null func) (ref.func $first))
+  (func $first (param i32) (result i32)
+    local.get 0)
+  (func $dispatch (export "dispatch") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    call_indirect (type $unary))
+)
+
+;; The ref.func expressions set the elements to the functions, and the
+;; ref.null expressions leave the elements null.
+;; CHECK: @".table$0.elements" = internal global [3 x %w2n.table.entry] [%w2n.table.entry { ptr @"function$0", i32 [[SIG:[0-9]+]] }, %w2n.table.entry zeroinitializer, %w2n.table.entry { ptr @"function$0", i32 [[SIG]] }], align 8
@@ -0,0 +1,53 @@
+;; RUN: %target-wat2wasm %s --output %t.wasm
+;; RUN: %target-w2n-frontend %t.wasm -emit-ir | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -compact-instructions -emit-ir | %FileCheck %s
+(module
+  (type $unary (func (param i32) (result i32)))
+  (table (export "table") 4 funcref)
+  (elem (i32.const 1) $first $second)
+  (func $first (param i32) (result i32)
+    local.get 0)
+  (func $second (param i32) (result i32)
+    i32.const 2)
+  (func $dispatch (export "dispatch") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    call_indirect (type $unary))
+  (func $direct (export "direct") (param i32) (result i32)
+    local.get 0
+    call $second)
+)
+
+;; The descriptor of the table is a field of the instance context, and
+;; points at elements initialized statically. The host may write the
+;; exported table, so its elements stay writable.
+;; CHECK-DAG: %w2n.table = type { ptr, i32 }
+;; CHECK-DAG: %w2n.table.entry = type { ptr, i32 }
+;; CHECK-DAG: %w2n.vmctx = type { %w2n.table }
+;; CHECK: @".vmctx" = internal global %w2n.vmctx { %w2n.table { ptr @".table$0.elements", i32 4 } }
+;; CHECK: @".table$0.elements" = internal global [4 x %w2n.table.entry] [%w2n.table.entry zeroinitializer, %w2n.table.entry { ptr @"function$0", i32 [[SIG:[0-9]+]] }, %w2n.table.entry { ptr @"function$1", i32 [[SIG]] }, %w2n.table.entry zeroinitializer], align 8
+
+;; An indirect call on the exported table checks the bounds of the table, then the signature
+;; id of the element, which is 0 for null elements. The element runs in the instance of the
+;; caller.
+;; CHECK-LABEL: i32 @"function$2"(ptr {{.*}}%vmctx, i32 %0, i32 %1)
+;; CHECK: %table = getelementptr inbounds %w2n.vmctx, ptr %vmctx, i32 0, i32 0
+;; CHECK: %table.size.addr = getelementptr inbounds %w2n.table, ptr %table, i32 0, i32 1
+;; CHECK: %table.size = load i32, ptr %table.size.addr
+;; CHECK: %[[OOB:[0-9]+]] = icmp uge i32 %1, %table.size
+;; CHECK: br i1 %[[OOB]], label %memory.trap, label %table.inbounds
+;; CHECK: table.inbounds:
+;; CHECK: %table.elements = load ptr, ptr %table.elements.addr
+;; CHECK: %table.entry = getelementptr inbounds %w2n.table.entry, ptr %table.elements, i64 %{{[0-9]+}}
+;; CHECK: %table.entry.sig = load i32, ptr %table.entry.sig.addr
+;; CHECK: %[[MISMATCH:[0-9]+]] = icmp ne i32 %table.entry.sig, [[SIG]]
+;; CHECK: br i1 %[[MISMATCH]], label %memory.trap, label %table.sig.match
+;; CHECK: table.sig.match:
+;; CHECK: %table.entry.fn = load ptr, ptr %table.entry.fn.addr
+;; CHECK: %[[RESULT:[0-9]+]] = call i32 %table.entry.fn(ptr %vmctx, i32 %0)
+;; CHECK: ret i32 %[[RESULT]]
+
+;; Direct calls pass the instance context along.
+;; CHECK-LABEL: i32 @"function$3"(ptr {{.*}}%vmctx, i32 %0)
+;; CHECK: %[[RESULT:[0-9]+]] = call i32 @"function$1"(ptr %vmctx, i32 %0)
+;; CHECK: ret i32 %[[RESULT]]
@@ -0,0 +1,13 @@
+;; RUN: %target-wat2wasm --enable-extended-const --no-check %s --output %t.wasm
+;; RUN: not %target-w2n-frontend %t.wasm -emit-ir 2>&1 | %FileCheck %s
+;; RUN: not %target-w2n-frontend %t.wasm -compact-instructions -emit-ir 2>&1 | %FileCheck %s
+(module
+  (global $a i32 (i32.const 8))
+  (global $b i32 (i32.sub (i32.mul (global.get $a) (i32.const 2)) (i32.const 1)))
+  (global $c i32 (i32.div_u (global.get $a) (i32.const 2)))
+)
+
+;; The extended constant expressions may add, subtract and multiply
+;; integers, but not divide them.
+;; CHECK-NOT: 'global-init$1'
+;; CHECK: error: invalid body of 'global-init$2': constant expression required in i32.div_u
@@ -0,0 +1,34 @@
+;; RUN: %target-wat2wasm --no-check %s --output %t.wasm
+;; RUN: not %target-w2n-frontend %t.wasm -emit-ir 2>&1 | %FileCheck %s --check-prefix=ALL
+;; RUN: not %target-w2n-frontend %t.wasm -compact-instructions -emit-ir 2>&1 | %FileCheck %s --check-prefix=ALL
+;; RUN: %target-w2n-frontend %t.wasm -validate-reachable-functions-only -emit-ir 2>&1 | %FileCheck %s
+;; RUN: %target-w2n-frontend %t.wasm -validate-reachable-functions-only -compact-instructions -emit-ir 2>&1 | %FileCheck %s
+(module
+  (table 1 funcref)
+  (elem (i32.const 0) $element)
+  (start $start)
+  (func $dead (result i32)
+    i64.const 1)
+  (func $callee (result i32)
+    i32.const 1)
+  (func $element (result i32)
+    i32.const 2)
+  (func $entry (export "entry") (result i32)
+    call $callee)
+  (func $start)
+)
+
+;; Every body is validated by default, so the invalid body of the dead
+;; function is diagnosed even though it cannot be called.
+;; ALL: error: invalid body of 'function$0': type mismatch: expected i32, found i64 in end
+
+;; Only the functions reachable from the exports, the element segments
+;; and the start function are decoded, validated and emitted when asked
+;; for, so the invalid body of the dead function is never diagnosed.
+;; CHECK-NOT: error:
+;; CHECK-NOT: @"function$0"
+;; CHECK-DAG: define {{.*}}i32 @"function$1"(ptr {{.*}}%vmctx)
+;; CHECK-DAG: define {{.*}}i32 @"function$2"(ptr {{.*}}%vmctx)
+;; CHECK-DAG: define {{.*}}i32 @"function$3"(ptr {{.*}}%vmctx)
+;; CHECK-DAG: define {{.*}}void @"function$4"(ptr {{.*}}%vmctx)
+;; CHECK-NOT: @"function$0"
@@ -0,0 +1,20 @@
+;; RUN: %target-wat2wasm --no-check %s --output %t.wasm
+;; RUN: not %target-w2n-frontend %t.wasm -emit-ir 2>&1 | %FileCheck %s
+;; RUN: not %target-w2n-frontend %t.wasm -compact-instructions -emit-ir 2>&1 | %FileCheck %s
+(module
+  (global $a i32 (i32.const 0))
+  (func $0 (export "0") (result i32)
+    i64.const 1)
+  (func $1 (export "1") (param i32)
+    local.get 0
+    if
+      i32.const 1
+    end)
+  (func $2 (export "2")
+    i32.const 1
+    global.set $a)
+)
+
+;; CHECK: error: invalid body of 'function$0': type mismatch: expected i32, found i64 in end
+;; CHECK: error: invalid body of 'function$1': values remaining on the operand stack in end
+;; CHECK: error: invalid body of 'function$2': global 0 is immutable in global.set
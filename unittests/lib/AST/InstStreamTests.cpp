@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/DiagnosticEngine.h>
+#include <w2n/AST/InstStream.h>
+#include <w2n/Basic/LanguageOptions.h>
+#include <w2n/Basic/SourceManager.h>
+
+using namespace w2n;
+
+namespace {
+
+class InstStreamTest : public ::testing::Test {
+protected:
+
+  LanguageOptions LangOpts;
+  SourceManager SourceMgr;
+  DiagnosticEngine Diags;
+  std::unique_ptr<ASTContext> Context;
+
+  InstStreamTest() :
+    Diags(SourceMgr),
+    Context(ASTContext::get(LangOpts, SourceMgr, Diags)) {
+  }
+
+  void
+  add(InstStreamBuilder& Builder, Instruction Inst, uint32_t Imm = 0) {
+    Builder.add(Inst, getInstInfo((uint16_t)Inst & 0xFF), Imm);
+  }
+};
+
+} // namespace
+
+TEST_F(InstStreamTest, MatchesStructuredInstructions) {
+  BlockType * Ty = BlockType::create(*Context, Context->getVoidType());
+  InstStreamBuilder Builder;
+  Builder.addBlock(Instruction::Block, Ty); // 0
+  Builder.addBlock(Instruction::If, Ty);    // 1
+  add(Builder, Instruction::Nop);           // 2
+  add(Builder, Instruction::Else);          // 3
+  add(Builder, Instruction::Br, 1);         // 4
+  add(Builder, Instruction::End);           // 5
+  add(Builder, Instruction::End);           // 6
+  EXPECT_EQ(Builder.getDepth(), 0U);
+  add(Builder, Instruction::End);           // 7
+
+  InstStream * Stream = Builder.finish(*Context);
+  ASSERT_EQ(Stream->size(), 8U);
+  EXPECT_EQ((*Stream)[0].getMatch(), 6U);
+  EXPECT_EQ((*Stream)[1].getMatch(), 3U);
+  EXPECT_EQ((*Stream)[3].getMatch(), 5U);
+  EXPECT_EQ((*Stream)[7].getMatch(), NoMatchingInst);
+  EXPECT_EQ((*Stream)[1].getBlockType(), Ty);
+  EXPECT_EQ((*Stream)[4].getIndexImmediate(), 1U);
+  EXPECT_EQ((*Stream)[5].getInfo().Node, InstNodeKind::End);
+}
+
+TEST_F(InstStreamTest, StoresWideImmediatesOutOfLine) {
+  InstStreamBuilder Builder;
+  Builder.add64(Instruction::I64Const, 0x123456789ABCDEF0ULL);
+  Builder.addMemoryAccess(Instruction::I32Load, MemoryArgument{2, 16});
+  uint32_t Labels[] = {0, 1, 2};
+  Builder.addBrTable(Labels, 3);
+  Builder.addCallIndirect(Instruction::CallIndirect, 4, 0);
+  add(Builder, Instruction::End);
+
+  InstStream * Stream = Builder.finish(*Context);
+  ASSERT_EQ(Stream->size(), 5U);
+  EXPECT_EQ((*Stream)[0].getBits(), 0x123456789ABCDEF0ULL);
+  EXPECT_EQ((*Stream)[1].getMemArg().Align, 2U);
+  EXPECT_EQ((*Stream)[1].getMemArg().Offset, 16U);
+  EXPECT_EQ((*Stream)[2].getLabelTable().size(), 3U);
+  EXPECT_EQ((*Stream)[2].getLabelTable()[2], 2U);
+  EXPECT_EQ((*Stream)[2].getIndexImmediate(), 3U);
+  EXPECT_EQ((*Stream)[3].getIndexImmediate(), 4U);
+  EXPECT_EQ((*Stream)[3].getTableIndex(), 0U);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <w2n/AST/ASTContext.h>
+#include <w2n/AST/DiagnosticEngine.h>
+#include <w2n/AST/Type.h>
+#include <w2n/Basic/LanguageOptions.h>
+#include <w2n/Basic/SourceManager.h>
+
+using namespace w2n;
+
+namespace {
+
+class TypeUniquingTest : public ::testing::Test {
+protected:
+
+  LanguageOptions LangOpts;
+  SourceManager SourceMgr;
+  DiagnosticEngine Diags;
+  std::unique_ptr<ASTContext> Context;
+
+  TypeUniquingTest() :
+    Diags(SourceMgr),
+    Context(ASTContext::get(LangOpts, SourceMgr, Diags)) {
+  }
+};
+
+} // namespace
+
+TEST_F(TypeUniquingTest, UniquesStructurallyEqualSignatures) {
+  auto * I32 = Context->getI32Type();
+  auto * I64 = Context->getI64Type();
+
+  auto * Params = Context->getResultType({I32, I64});
+  EXPECT_EQ(Params, Context->getResultType({I32, I64}));
+  EXPECT_NE(Params, Context->getResultType({I64, I32}));
+
+  auto * Returns = Context->getResultType({I32});
+  FuncType * Ty = Context->getFuncType(Params, Returns);
+  FuncType * Same = Context->getFuncType(
+    Context->getResultType({I32, I64}), Context->getResultType({I32})
+  );
+  FuncType * Other =
+    Context->getFuncType(Returns, Context->getResultType({}));
+
+  EXPECT_EQ(Ty, Same);
+  EXPECT_EQ(Ty->getCanonicalID(), Same->getCanonicalID());
+  EXPECT_NE(Ty, Other);
+  EXPECT_EQ(Other->getCanonicalID(), Ty->getCanonicalID() + 1);
+}
+
+TEST_F(TypeUniquingTest, UniquesLimitsAndBlockTypes) {
+  EXPECT_EQ(Context->getLimits(1, None), Context->getLimits(1, None));
+  EXPECT_NE(Context->getLimits(1, None), Context->getLimits(1, 2));
+
+  auto * Void = Context->getVoidType();
+  EXPECT_EQ(Context->getBlockType(Void), Context->getBlockType(Void));
+  EXPECT_NE(
+    Context->getBlockType(Void),
+    Context->getBlockType(Context->getTypeIndexType(0))
+  );
+}
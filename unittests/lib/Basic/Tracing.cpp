@@ -0,0 +1,69 @@
+//===--- Tracing.cpp ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2021 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://swift.org/LICENSE.txt for license information
+// See https://swift.org/CONTRIBUTORS.txt for the list of Swift project
+// authors
+//
+//===----------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+#include <w2n/Basic/Debug.h>
+
+using namespace w2n;
+using namespace w2n::trace;
+
+namespace {
+
+class TracingTest : public ::testing::Test {
+protected:
+
+  void SetUp() override {
+    EnabledCategories = 0;
+    EnabledLevel = (uint8_t)Level::Info;
+  }
+
+  void TearDown() override {
+    SetUp();
+  }
+};
+
+} // namespace
+
+TEST_F(TracingTest, DisabledByDefault) {
+  EXPECT_FALSE(isEnabled(Category::Parse, Level::Info));
+  EXPECT_FALSE(isEnabled(Category::IRGen, Level::Verbose));
+}
+
+TEST_F(TracingTest, EnableCategories) {
+  EXPECT_FALSE(enableCategories("parse, irgen"));
+  EXPECT_TRUE(isEnabled(Category::Parse, Level::Info));
+  EXPECT_TRUE(isEnabled(Category::IRGen, Level::Info));
+  EXPECT_FALSE(isEnabled(Category::AST, Level::Info));
+  EXPECT_FALSE(isEnabled(Category::Parse, Level::Verbose));
+}
+
+TEST_F(TracingTest, EnableAllCategories) {
+  EXPECT_FALSE(enableCategories("all"));
+#define TRACE_CATEGORY(Id, Name)                                         \
+  EXPECT_TRUE(isEnabled(Category::Id, Level::Info)) << Name;
+#include <w2n/Basic/TraceCategories.def>
+}
+
+TEST_F(TracingTest, UnknownCategory) {
+  EXPECT_TRUE(enableCategories("parse,bogus"));
+  EXPECT_FALSE(isEnabled(Category::Parse, Level::Info));
+}
+
+TEST_F(TracingTest, Level) {
+  EXPECT_FALSE(enableCategories("parse"));
+  EXPECT_FALSE(setLevel("verbose"));
+  EXPECT_TRUE(isEnabled(Category::Parse, Level::Verbose));
+  EXPECT_TRUE(setLevel("chatty"));
+  EXPECT_FALSE(setLevel("info"));
+  EXPECT_FALSE(isEnabled(Category::Parse, Level::Verbose));
+}